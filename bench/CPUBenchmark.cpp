@@ -0,0 +1,377 @@
+// Per-opcode throughput benchmark for the CPU core.
+//
+// Every scenario is a synthetic instruction stream placed in read-only PRG space
+// at $8000 and looped with a JMP. Results are printed one JSON object per line:
+//
+//   {"benchmark":"ADC_Immediate","opcode":"0x69","mode":"Immediate","engine":"step",
+//    "instructions":...,"cycles":...,"seconds":...,"ns_per_instruction":...,"emulated_mhz":...}
+//
+// The lockstep engine runs LOCKSTEP_LANES copies of the scenario from the same state,
+// sharing the cycle budget between them, and reports lane instructions. Identical
+// lanes never diverge, so it is the best case for that engine.
+//
+// Usage: CPUBenchmark [--cycles N] [--filter TEXT] [--engine step|cached|jit|lockstep|all]
+//
+// The jit engine needs an x86-64 host; "all" leaves it out elsewhere.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../include/Bus.hpp"
+#include "../include/CPU.hpp"
+#include "../include/DecodeCache.hpp"
+#include "../include/Jit.hpp"
+#include "../include/LockstepCPU.hpp"
+#include "../include/OpcodeTable.hpp"
+
+namespace {
+    constexpr Address PROGRAM_START = 0x8000;
+    constexpr Address INTERRUPT_HANDLER = 0xF000;
+    constexpr size_t PROGRAM_SIZE = 0x8000;
+    constexpr size_t STREAM_LENGTH = 0x0400; // Bytes of repeated instructions before looping
+    constexpr size_t LOCKSTEP_LANES = 32;
+
+    // Operand choices that keep every access in RAM
+    constexpr Byte ZERO_PAGE_OPERAND = 0x10;
+    constexpr Address ABSOLUTE_OPERAND = 0x0200;
+    constexpr Address ABSOLUTE_PAGE_CROSS_OPERAND = 0x02FF;
+    constexpr Byte INDIRECT_X_OPERAND = 0x20; // Pointer at $24 with X = 4
+    constexpr Byte INDIRECT_Y_OPERAND = 0x30;
+    constexpr Byte INDEX_REGISTER_VALUE = 0x04;
+
+    struct Scenario {
+        std::string name;
+        int opcode; // -1 for multi-instruction scenarios
+        std::string mode;
+        std::vector<Byte> program;
+        Byte statusRegister;
+        Address indirectYTarget;
+    };
+
+    struct Options {
+        uint64_t cycles = 2000000;
+        std::string filter;
+        bool runStep = true;
+        bool runCached = true;
+        bool runJit = JitCompiler::IsSupported();
+        bool runLockstep = true;
+    };
+
+    bool IsControlFlow(const Operations::Operation operation)
+    {
+        switch (operation) {
+            case Operations::BCC: case Operations::BCS: case Operations::BEQ: case Operations::BMI:
+            case Operations::BNE: case Operations::BPL: case Operations::BVC: case Operations::BVS:
+            case Operations::BRK: case Operations::JMP: case Operations::JSR: case Operations::RTI:
+            case Operations::RTS:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    void AppendJump(std::vector<Byte>& program, const Address target)
+    {
+        program.push_back(0x4C);
+        program.push_back(target & 0x00FF);
+        program.push_back(target >> 8);
+    }
+
+    std::vector<Byte> RepeatInstruction(const std::vector<Byte>& instruction)
+    {
+        std::vector<Byte> program;
+        while (program.size() + instruction.size() <= STREAM_LENGTH) {
+            program.insert(program.end(), instruction.begin(), instruction.end());
+        }
+        AppendJump(program, PROGRAM_START);
+        return program;
+    }
+
+    std::vector<Byte> EncodeOperand(const AddressingModes::Mode mode, const bool crossesPage)
+    {
+        const Address absolute = crossesPage ? ABSOLUTE_PAGE_CROSS_OPERAND : ABSOLUTE_OPERAND;
+        switch (mode) {
+            case AddressingModes::Immediate: return { 0x01 };
+            case AddressingModes::ZeroPage:
+            case AddressingModes::ZeroPageX:
+            case AddressingModes::ZeroPageY: return { ZERO_PAGE_OPERAND };
+            case AddressingModes::Absolute:
+            case AddressingModes::AbsoluteX:
+            case AddressingModes::AbsoluteY: return { static_cast<Byte>(absolute & 0x00FF), static_cast<Byte>(absolute >> 8) };
+            case AddressingModes::IndirectX: return { INDIRECT_X_OPERAND };
+            case AddressingModes::IndirectY: return { INDIRECT_Y_OPERAND };
+            default: return {};
+        }
+    }
+
+    void AddOpcodeScenarios(std::vector<Scenario>& scenarios)
+    {
+        for (size_t opcode = 0; opcode < NUMBER_OF_OPCODES; ++opcode) {
+            const Instruction& instruction = OPCODE_TABLE[opcode];
+            if (!instruction.isLegal || IsControlFlow(instruction.operation)) {
+                continue;
+            }
+
+            const std::string name = std::string(OPERATION_NAMES[instruction.operation]) + "_" + ADDRESSING_MODE_NAMES[instruction.addressingMode];
+            const std::string mode = ADDRESSING_MODE_NAMES[instruction.addressingMode];
+
+            for (int crossesPage = 0; crossesPage < 2; ++crossesPage) {
+                const bool indexed = instruction.addressingMode == AddressingModes::AbsoluteX
+                    || instruction.addressingMode == AddressingModes::AbsoluteY
+                    || instruction.addressingMode == AddressingModes::IndirectY;
+                if (crossesPage && !indexed) {
+                    continue;
+                }
+
+                std::vector<Byte> bytes = { static_cast<Byte>(opcode) };
+                const std::vector<Byte> operand = EncodeOperand(instruction.addressingMode, crossesPage);
+                bytes.insert(bytes.end(), operand.begin(), operand.end());
+
+                Scenario scenario;
+                scenario.name = crossesPage ? name + "_PageCross" : name;
+                scenario.opcode = static_cast<int>(opcode);
+                scenario.mode = mode;
+                scenario.program = RepeatInstruction(bytes);
+                scenario.statusRegister = StatusRegisterFlags::U | StatusRegisterFlags::I;
+                scenario.indirectYTarget = crossesPage ? 0x03FF : 0x0300;
+                scenarios.push_back(scenario);
+            }
+        }
+    }
+
+    void AddBranchScenarios(std::vector<Scenario>& scenarios)
+    {
+        struct Branch { Byte opcode; StatusRegisterFlags::Flags flag; bool takenWhenSet; };
+        const Branch branches[] = {
+            { 0x90, StatusRegisterFlags::C, false }, { 0xB0, StatusRegisterFlags::C, true },
+            { 0xD0, StatusRegisterFlags::Z, false }, { 0xF0, StatusRegisterFlags::Z, true },
+            { 0x10, StatusRegisterFlags::N, false }, { 0x30, StatusRegisterFlags::N, true },
+            { 0x50, StatusRegisterFlags::V, false }, { 0x70, StatusRegisterFlags::V, true },
+        };
+
+        for (const Branch& branch : branches) {
+            const std::string mnemonic = OPERATION_NAMES[OPCODE_TABLE[branch.opcode].operation];
+            const Byte baseStatus = StatusRegisterFlags::U | StatusRegisterFlags::I;
+            const Byte takenStatus = branch.takenWhenSet ? baseStatus | branch.flag : baseStatus;
+            const Byte notTakenStatus = branch.takenWhenSet ? baseStatus : baseStatus | branch.flag;
+
+            // An offset of zero lands on the next instruction, so taken branches never cross a page.
+            Scenario taken { mnemonic + "_Taken", branch.opcode, "Relative", RepeatInstruction({ branch.opcode, 0x00 }), takenStatus, 0x0300 };
+            Scenario notTaken { mnemonic + "_NotTaken", branch.opcode, "Relative", RepeatInstruction({ branch.opcode, 0x00 }), notTakenStatus, 0x0300 };
+
+            // The branch sits at $80FC and lands at $810E, then a JMP goes back to it.
+            Scenario pageCross { mnemonic + "_TakenPageCross", branch.opcode, "Relative", {}, takenStatus, 0x0300 };
+            std::vector<Byte> jump;
+            AppendJump(jump, 0x80FC);
+            pageCross.program.assign(0x0111, 0xEA);
+            std::copy(jump.begin(), jump.end(), pageCross.program.begin());
+            pageCross.program[0x00FC] = branch.opcode;
+            pageCross.program[0x00FD] = 0x10;
+            std::copy(jump.begin(), jump.end(), pageCross.program.begin() + 0x010E);
+
+            scenarios.push_back(taken);
+            scenarios.push_back(notTaken);
+            scenarios.push_back(pageCross);
+        }
+    }
+
+    void AddControlFlowScenarios(std::vector<Scenario>& scenarios)
+    {
+        const Byte status = StatusRegisterFlags::U | StatusRegisterFlags::I;
+
+        // JMP to itself
+        scenarios.push_back({ "JMP_Absolute", 0x4C, "Absolute", { 0x4C, 0x00, 0x80 }, status, 0x0300 });
+
+        // JMP ($0040) with $0040 pointing back at $8000
+        scenarios.push_back({ "JMP_Indirect", 0x6C, "Indirect", { 0x6C, 0x40, 0x00 }, status, 0x0300 });
+
+        // JSR to an RTS at $9000, then loop
+        std::vector<Byte> subroutine = RepeatInstruction({ 0x20, 0x00, 0x90 });
+        subroutine.resize(0x1001, 0xEA);
+        subroutine[0x1000] = 0x60;
+        scenarios.push_back({ "JSR_RTS", -1, "Absolute", subroutine, status, 0x0300 });
+
+        scenarios.push_back({ "PHA_PLA", -1, "Implicit", RepeatInstruction({ 0x48, 0x68 }), status, 0x0300 });
+        scenarios.push_back({ "PHP_PLP", -1, "Implicit", RepeatInstruction({ 0x08, 0x28 }), status, 0x0300 });
+
+        // BRK into an RTI handler; RTI resumes two bytes past the BRK
+        scenarios.push_back({ "BRK_RTI", -1, "Implicit", RepeatInstruction({ 0x00, 0xEA }), status, 0x0300 });
+
+        // Add and subtract chains with the carry feeding through
+        scenarios.push_back({ "ADC_SBC_Chain", -1, "Immediate", RepeatInstruction({ 0x69, 0x37, 0xE9, 0x11, 0x65, 0x10, 0xE5, 0x11 }), status, 0x0300 });
+    }
+
+    void Setup(const Scenario& scenario, std::vector<Byte>& rom, CPU& cpu, Bus& bus)
+    {
+        rom.assign(PROGRAM_SIZE, 0xEA);
+        std::copy(scenario.program.begin(), scenario.program.end(), rom.begin());
+        rom[INTERRUPT_HANDLER - PROGRAM_START] = 0x40; // RTI
+        rom[0xFFFE - PROGRAM_START] = INTERRUPT_HANDLER & 0x00FF;
+        rom[0xFFFF - PROGRAM_START] = INTERRUPT_HANDLER >> 8;
+        bus.MapReadOnlyMemory(PROGRAM_START, 0xFFFF, rom.data(), rom.size());
+
+        Byte* ram = bus.GetRam();
+        ram[INDIRECT_X_OPERAND + INDEX_REGISTER_VALUE] = 0x00;
+        ram[INDIRECT_X_OPERAND + INDEX_REGISTER_VALUE + 1] = 0x03;
+        ram[INDIRECT_Y_OPERAND] = scenario.indirectYTarget & 0x00FF;
+        ram[INDIRECT_Y_OPERAND + 1] = scenario.indirectYTarget >> 8;
+        ram[0x40] = PROGRAM_START & 0x00FF;
+        ram[0x41] = PROGRAM_START >> 8;
+
+        CPUState state{};
+        state.programCounter = PROGRAM_START;
+        state.stackPointer = 0xFD;
+        state.statusRegister = scenario.statusRegister;
+        state.x = INDEX_REGISTER_VALUE;
+        state.y = INDEX_REGISTER_VALUE;
+        cpu.RestoreState(state);
+    }
+
+    void Report(const Scenario& scenario, const char* engine, const uint64_t instructions, const uint64_t cycles, const double seconds)
+    {
+        char opcode[16] = "null";
+        if (scenario.opcode >= 0) {
+            std::snprintf(opcode, sizeof(opcode), "\"0x%02X\"", scenario.opcode);
+        }
+        std::printf("{\"benchmark\":\"%s\",\"opcode\":%s,\"mode\":\"%s\",\"engine\":\"%s\","
+                    "\"instructions\":%llu,\"cycles\":%llu,\"seconds\":%.6f,"
+                    "\"ns_per_instruction\":%.3f,\"emulated_mhz\":%.3f}\n",
+                    scenario.name.c_str(), opcode, scenario.mode.c_str(), engine,
+                    static_cast<unsigned long long>(instructions), static_cast<unsigned long long>(cycles), seconds,
+                    instructions ? seconds * 1e9 / instructions : 0.0,
+                    seconds > 0.0 ? cycles / seconds / 1e6 : 0.0);
+    }
+
+    void RunConnected(const Scenario& scenario, const Options& options, const char* engine, const double instructionsPerCycle,
+                      std::vector<Byte>& rom, CPU& cpu, Bus& bus)
+    {
+        Setup(scenario, rom, cpu, bus);
+        cpu.SetIdleLoopSkipping(false); // Measure execution, not skipped loops
+        const auto start = std::chrono::steady_clock::now();
+        const uint64_t cycles = cpu.RunCycles(options.cycles);
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        Report(scenario, engine, static_cast<uint64_t>(cycles * instructionsPerCycle + 0.5), cycles, seconds);
+    }
+
+    void RunLockstep(const Scenario& scenario, const Options& options, const double instructionsPerCycle,
+                     std::vector<Byte>& rom, CPU& cpu, Bus& bus)
+    {
+        Setup(scenario, rom, cpu, bus);
+        SaveState state;
+        state.Capture(cpu, bus);
+
+        std::unique_ptr<LockstepCPU<LOCKSTEP_LANES>> lockstep = std::make_unique<LockstepCPU<LOCKSTEP_LANES>>();
+        lockstep->MapProgram(rom.data(), rom.size());
+        for (size_t lane = 0; lane < LOCKSTEP_LANES; ++lane) {
+            lockstep->LoadLane(lane, state);
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        lockstep->RunCycles((options.cycles + LOCKSTEP_LANES - 1) / LOCKSTEP_LANES);
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        uint64_t cycles = 0;
+        for (size_t lane = 0; lane < LOCKSTEP_LANES; ++lane) {
+            cycles += lockstep->GetTotalCycles(lane) - state.cpu.totalCycles;
+        }
+        Report(scenario, "lockstep", static_cast<uint64_t>(cycles * instructionsPerCycle + 0.5), cycles, seconds);
+    }
+
+    void Run(const Scenario& scenario, const Options& options)
+    {
+        std::vector<Byte> rom;
+        std::unique_ptr<Bus> bus = std::make_unique<Bus>();
+        std::unique_ptr<CPU> cpu = std::make_unique<CPU>();
+        cpu->ConnectBus(bus.get());
+
+        Setup(scenario, rom, *cpu, *bus);
+        uint64_t instructions = 0;
+        uint64_t cycles = 0;
+        const auto stepStart = std::chrono::steady_clock::now();
+        while (cycles < options.cycles) {
+            cycles += cpu->Step();
+            ++instructions;
+        }
+        const double stepSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - stepStart).count();
+        if (options.runStep) {
+            Report(scenario, "step", instructions, cycles, stepSeconds);
+        }
+
+        // The stream is deterministic, so the stepped run gives its exact instruction mix.
+        const double instructionsPerCycle = static_cast<double>(instructions) / cycles;
+        if (options.runCached) {
+            DecodeCache decodeCache(*bus);
+            cpu->ConnectDecodeCache(&decodeCache);
+            RunConnected(scenario, options, "cached", instructionsPerCycle, rom, *cpu, *bus);
+            cpu->ConnectDecodeCache(nullptr);
+        }
+
+        if (options.runJit) {
+            JitCompiler jit(*bus);
+            cpu->ConnectJit(&jit);
+            RunConnected(scenario, options, "jit", instructionsPerCycle, rom, *cpu, *bus);
+            cpu->ConnectJit(nullptr);
+        }
+
+        if (options.runLockstep) {
+            RunLockstep(scenario, options, instructionsPerCycle, rom, *cpu, *bus);
+        }
+    }
+
+    bool IsEngineName(const std::string& engine)
+    {
+        return engine == "step" || engine == "cached" || engine == "jit" || engine == "lockstep" || engine == "all";
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        for (int index = 1; index < argc; ++index) {
+            const std::string argument = argv[index];
+            if (argument == "--cycles" && index + 1 < argc) {
+                options.cycles = std::strtoull(argv[++index], nullptr, 10);
+            } else if (argument == "--filter" && index + 1 < argc) {
+                options.filter = argv[++index];
+            } else if (argument == "--engine" && index + 1 < argc && IsEngineName(argv[index + 1])) {
+                const std::string engine = argv[++index];
+                if (engine == "jit" && !JitCompiler::IsSupported()) {
+                    std::fprintf(stderr, "%s: the jit engine is not supported on this host\n", argv[0]);
+                    return false;
+                }
+                options.runStep = engine == "step" || engine == "all";
+                options.runCached = engine == "cached" || engine == "all";
+                options.runJit = engine == "jit" || (engine == "all" && JitCompiler::IsSupported());
+                options.runLockstep = engine == "lockstep" || engine == "all";
+            } else {
+                std::fprintf(stderr, "Usage: %s [--cycles N] [--filter TEXT] [--engine step|cached|jit|lockstep|all]\n", argv[0]);
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    std::vector<Scenario> scenarios;
+    AddOpcodeScenarios(scenarios);
+    AddBranchScenarios(scenarios);
+    AddControlFlowScenarios(scenarios);
+
+    for (const Scenario& scenario : scenarios) {
+        if (options.filter.empty() || scenario.name.find(options.filter) != std::string::npos) {
+            Run(scenario, options);
+        }
+    }
+    return 0;
+}
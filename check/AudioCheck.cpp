@@ -0,0 +1,113 @@
+// Check that silent APU channels stay silent.
+//
+// Each case sets up one or more channels so that they run their timers but make no
+// sound: disabled in $4015, at volume 0, with a pulse period below 8 or a sweep
+// target out of range, a triangle with its linear counter at 0, an idle DMC. Two
+// seconds of audio must then come out as exactly zero, which only happens if the
+// blip buffer never received a delta. The audible versions of the same channels
+// must not, so the check would see a delta if there were one.
+//
+// Usage: AudioCheck
+
+#include <cstdio>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "../include/APU.hpp"
+#include "../include/Bus.hpp"
+
+namespace {
+    constexpr uint64_t RUN_CYCLES = static_cast<uint64_t>(NTSC_CPU_CLOCK_RATE * 2);
+    constexpr uint64_t TIMESLICE = 1000;
+
+    using RegisterWrites = std::vector<std::pair<Address, Byte>>;
+
+    struct Case {
+        const char* name;
+        RegisterWrites writes;
+    };
+
+    const Case SILENT_CASES[] = {
+        { "pulse 1 disabled", { { 0x4015, 0x00 }, { 0x4000, 0xBF }, { 0x4002, 0x80 }, { 0x4003, 0x01 } } },
+        { "pulse 2 at volume 0", { { 0x4015, 0x02 }, { 0x4004, 0xB0 }, { 0x4006, 0x80 }, { 0x4007, 0x08 } } },
+        { "pulse 1 with a period below 8", { { 0x4015, 0x01 }, { 0x4000, 0xBF }, { 0x4002, 0x05 }, { 0x4003, 0x08 } } },
+        { "pulse 2 muted by its sweep target", { { 0x4015, 0x02 }, { 0x4004, 0xBF }, { 0x4005, 0x00 }, { 0x4006, 0x00 }, { 0x4007, 0x0D } } },
+        { "triangle with its linear counter at 0", { { 0x4015, 0x04 }, { 0x4008, 0x80 }, { 0x400A, 0x40 }, { 0x400B, 0x08 } } },
+        { "triangle disabled", { { 0x4015, 0x00 }, { 0x4008, 0xFF }, { 0x400A, 0x40 }, { 0x400B, 0x08 } } },
+        { "noise at volume 0", { { 0x4015, 0x08 }, { 0x400C, 0x30 }, { 0x400E, 0x03 }, { 0x400F, 0x08 } } },
+        { "noise disabled", { { 0x4015, 0x00 }, { 0x400C, 0x3F }, { 0x400E, 0x03 }, { 0x400F, 0x08 } } },
+        { "DMC idle", { { 0x4010, 0x0F } } },
+        { "all of them at once", {
+            { 0x4015, 0x0E }, { 0x4000, 0xBF }, { 0x4002, 0x80 }, { 0x4003, 0x01 }, { 0x4004, 0xB0 }, { 0x4006, 0x80 },
+            { 0x4007, 0x08 }, { 0x4008, 0x80 }, { 0x400A, 0x40 }, { 0x400B, 0x08 }, { 0x400C, 0x30 }, { 0x400E, 0x03 },
+            { 0x400F, 0x08 }, { 0x4010, 0x0F } } },
+    };
+
+    const Case AUDIBLE_CASES[] = {
+        { "pulse 1", { { 0x4015, 0x01 }, { 0x4000, 0xBF }, { 0x4002, 0xFD }, { 0x4003, 0x08 } } },
+        { "triangle", { { 0x4015, 0x04 }, { 0x4008, 0xFF }, { 0x400A, 0x40 }, { 0x400B, 0x08 } } },
+        { "noise", { { 0x4015, 0x08 }, { 0x400C, 0x3F }, { 0x400E, 0x03 }, { 0x400F, 0x08 } } },
+    };
+
+    class CountingSink : public AudioSink
+    {
+        public:
+            void WriteSamples(const int16_t* samples, const size_t count) override
+            {
+                Samples += count;
+                for (size_t index = 0; index < count; ++index) {
+                    NonZeroSamples += samples[index] != 0 ? 1 : 0;
+                }
+            }
+
+            uint64_t Samples = 0;
+            uint64_t NonZeroSamples = 0;
+    };
+
+    CountingSink Play(const RegisterWrites& writes)
+    {
+        Bus bus;
+        std::unique_ptr<APU> apu = std::make_unique<APU>(bus);
+        CountingSink sink;
+        apu->ConnectAudioSink(&sink);
+        apu->Reset();
+        for (const std::pair<Address, Byte>& write : writes) {
+            apu->Write(write.first, write.second);
+        }
+        for (uint64_t cycle = TIMESLICE; cycle <= RUN_CYCLES; cycle += TIMESLICE) {
+            apu->CatchUp(cycle);
+        }
+        apu->FlushAudio();
+        return sink;
+    }
+
+    bool Check()
+    {
+        // Two seconds, give or take the block still being mixed
+        const uint64_t minimumSamples = 2 * AUDIO_SAMPLE_RATE - AUDIO_SAMPLE_RATE / 10;
+        for (const Case& silent : SILENT_CASES) {
+            const CountingSink sink = Play(silent.writes);
+            if (sink.Samples < minimumSamples || sink.NonZeroSamples != 0) {
+                std::printf("%s: %llu of %llu samples not silent\n", silent.name,
+                            static_cast<unsigned long long>(sink.NonZeroSamples), static_cast<unsigned long long>(sink.Samples));
+                return false;
+            }
+        }
+        for (const Case& audible : AUDIBLE_CASES) {
+            const CountingSink sink = Play(audible.writes);
+            if (sink.Samples < minimumSamples || sink.NonZeroSamples == 0) {
+                std::printf("%s: %llu samples all silent\n", audible.name, static_cast<unsigned long long>(sink.Samples));
+                return false;
+            }
+        }
+        std::printf("%zu silent and %zu audible setups passed\n", sizeof(SILENT_CASES) / sizeof(SILENT_CASES[0]),
+                    sizeof(AUDIBLE_CASES) / sizeof(AUDIBLE_CASES[0]));
+        return true;
+    }
+}
+
+int main()
+{
+    return Check() ? 0 : 1;
+}
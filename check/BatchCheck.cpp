@@ -0,0 +1,157 @@
+// Check and thread sweep for BatchRunner.
+//
+// Every job runs its own random program (see MakeTestProgram()) from random RAM,
+// with its own device at $2000-$3FFF, and saves its final state. The batch runs on
+// one thread and then on more and more threads; every job must end in the same state
+// and with the same device accesses as when the instance is run directly, whatever
+// thread ran it. Aggregate emulated MHz is printed for each thread count, so the
+// scaling with core count can be read off on the machine at hand.
+//
+// Usage: BatchCheck [--jobs N] [--cycles N] [--threads N]
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../include/BatchRunner.hpp"
+#include "../include/Bus.hpp"
+#include "../include/CPU.hpp"
+#include "../include/SaveState.hpp"
+#include "TestPrograms.hpp"
+
+namespace {
+    struct Options {
+        size_t jobs = 64;
+        uint64_t cycles = 1000000;
+        size_t maximumThreads = 0; // 0 sweeps up to the hardware thread count, and at least 8
+    };
+
+    struct JobInput {
+        std::vector<Byte> program;
+        std::vector<Byte> ram;
+    };
+
+    struct JobOutput {
+        SaveState state;
+        CountingDevice device;
+    };
+
+    void Setup(const JobInput& input, CountingDevice& device, CPU& cpu, Bus& bus)
+    {
+        bus.MapReadOnlyMemory(TEST_PROGRAM_START, TEST_PROGRAM_END, input.program.data(), input.program.size());
+        bus.MapDevice(0x2000, 0x3FFF, &device);
+        std::memcpy(bus.GetRam(), input.ram.data(), input.ram.size());
+
+        CPUState state{};
+        state.programCounter = TEST_PROGRAM_START;
+        state.stackPointer = 0xFD;
+        state.statusRegister = 0x24;
+        cpu.RestoreState(state);
+    }
+
+    // The same jobs without the runner, as the results to compare against
+    std::vector<JobOutput> RunDirectly(const std::vector<JobInput>& inputs, const Options& options)
+    {
+        std::vector<JobOutput> outputs(inputs.size());
+        for (size_t job = 0; job < inputs.size(); ++job) {
+            std::unique_ptr<Bus> bus = std::make_unique<Bus>();
+            CPU cpu;
+            cpu.ConnectBus(bus.get());
+            Setup(inputs[job], outputs[job].device, cpu, *bus);
+            cpu.RunCycles(options.cycles);
+            outputs[job].state.Capture(cpu, *bus);
+        }
+        return outputs;
+    }
+
+    bool RunBatch(const std::vector<JobInput>& inputs, const std::vector<JobOutput>& expected, const size_t threads,
+                  const Options& options)
+    {
+        std::vector<JobOutput> outputs(inputs.size());
+        std::vector<BatchJob> jobs(inputs.size());
+        for (size_t job = 0; job < inputs.size(); ++job) {
+            jobs[job].setup = [&, job](CPU& cpu, Bus& bus) { Setup(inputs[job], outputs[job].device, cpu, bus); };
+            jobs[job].cycles = options.cycles;
+            jobs[job].finish = [&, job](const CPU& cpu, const Bus& bus) { outputs[job].state.Capture(cpu, bus); };
+        }
+
+        BatchRunner runner(threads);
+        const BatchReport report = runner.Run(jobs);
+
+        uint64_t totalCycles = 0;
+        for (size_t job = 0; job < inputs.size(); ++job) {
+            totalCycles += report.results[job].cyclesExecuted;
+            if (report.results[job].cyclesExecuted < options.cycles
+                || std::memcmp(&outputs[job].state, &expected[job].state, SaveState::GetSize()) != 0
+                || !(outputs[job].device == expected[job].device)) {
+                std::printf("%zu threads: job %zu differs from the direct run\n", threads, job);
+                return false;
+            }
+        }
+        if (totalCycles != report.totalCycles) {
+            std::printf("%zu threads: %llu cycles reported, %llu run\n", threads,
+                        static_cast<unsigned long long>(report.totalCycles), static_cast<unsigned long long>(totalCycles));
+            return false;
+        }
+
+        std::printf("%zu threads: %zu jobs passed, %.1f emulated MHz\n", threads, inputs.size(), report.cyclesPerSecond / 1e6);
+        return true;
+    }
+
+    bool Check(const Options& options)
+    {
+        std::mt19937 rng(0);
+        std::vector<JobInput> inputs(options.jobs);
+        for (JobInput& input : inputs) {
+            input.program = MakeTestProgram(rng);
+            input.ram.resize(MEMORY_SIZE);
+            for (Byte& data : input.ram) {
+                data = rng();
+            }
+        }
+        const std::vector<JobOutput> expected = RunDirectly(inputs, options);
+
+        size_t maximumThreads = options.maximumThreads;
+        if (maximumThreads == 0) {
+            maximumThreads = std::thread::hardware_concurrency() > 8 ? std::thread::hardware_concurrency() : 8;
+        }
+        for (size_t threads = 1; threads < maximumThreads; threads *= 2) {
+            if (!RunBatch(inputs, expected, threads, options)) {
+                return false;
+            }
+        }
+        return RunBatch(inputs, expected, maximumThreads, options);
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        for (int index = 1; index < argc; ++index) {
+            const std::string argument = argv[index];
+            if (argument == "--jobs" && index + 1 < argc) {
+                options.jobs = std::strtoull(argv[++index], nullptr, 10);
+            } else if (argument == "--cycles" && index + 1 < argc) {
+                options.cycles = std::strtoull(argv[++index], nullptr, 10);
+            } else if (argument == "--threads" && index + 1 < argc) {
+                options.maximumThreads = std::strtoull(argv[++index], nullptr, 10);
+            } else {
+                std::fprintf(stderr, "Usage: %s [--jobs N] [--cycles N] [--threads N]\n", argv[0]);
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        return 1;
+    }
+    return Check(options) ? 0 : 1;
+}
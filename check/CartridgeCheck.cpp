@@ -0,0 +1,165 @@
+// Loader check for NES 2.0 RAM and ROM sizes.
+//
+// Builds NES 2.0 headers for every supported board with each PRG-RAM and CHR-RAM
+// size the header can describe, including the ones smaller than a Bus page or a
+// pattern slot. After Reset() every page of $6000-$7FFF must point inside PRG-RAM,
+// and a write to every address of $6000-$7FFF and of the pattern tables must read
+// back as RAM of the allocated size mirrored across the window. Headers with ROM
+// sizes that are not whole Bus pages or pattern slots must be refused.
+//
+// Usage: CartridgeCheck
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "../include/Bus.hpp"
+#include "../include/Cartridge.hpp"
+#include "../include/Mapper.hpp"
+#include "../include/PPU.hpp"
+
+namespace {
+    constexpr int NUMBER_OF_BOARDS = 5;
+    constexpr Byte MAXIMUM_SHIFT = 10;
+    constexpr Address PPU_ADDRESS_REGISTER = 0x2006;
+    constexpr Address PPU_DATA_REGISTER = 0x2007;
+
+    std::vector<Byte> MakeImage(const int mapperNumber, const Byte prgRamShifts, const Byte chrRamShifts)
+    {
+        std::vector<Byte> image(INES_HEADER_SIZE + 2 * PRG_ROM_UNIT_SIZE, 0xEA);
+        const Byte header[INES_HEADER_SIZE] = {
+            'N', 'E', 'S', 0x1A, 2, 0, static_cast<Byte>(mapperNumber << 4), 0x08, 0, 0, prgRamShifts, chrRamShifts,
+        };
+        std::copy(header, header + INES_HEADER_SIZE, image.begin());
+        return image;
+    }
+
+    size_t DecodeRamSize(const Byte shift)
+    {
+        return shift == 0 ? 0 : static_cast<size_t>(64) << shift;
+    }
+
+    Byte Pattern(const Address address) { return static_cast<Byte>(address * 7 + (address >> 8)); }
+
+    bool CheckPrgRam(Bus& bus, Mapper& mapper)
+    {
+        const Byte* ram = mapper.GetPrgRam();
+        const size_t size = mapper.GetPrgRamSize();
+        for (size_t page = PRG_RAM_UNIT.first >> 8; page <= static_cast<size_t>(PRG_RAM_UNIT.second >> 8); ++page) {
+            const Byte* memory = bus.GetPageMemory(page);
+            if (size == 0 ? memory != nullptr : memory < ram || memory + BUS_PAGE_SIZE > ram + size) {
+                return false;
+            }
+        }
+        if (size == 0) {
+            return true;
+        }
+
+        std::vector<Byte> model(size);
+        for (uint32_t address = PRG_RAM_UNIT.first; address <= PRG_RAM_UNIT.second; ++address) {
+            bus.Write(static_cast<Address>(address), Pattern(static_cast<Address>(address)));
+            model[(address - PRG_RAM_UNIT.first) % size] = Pattern(static_cast<Address>(address));
+        }
+        for (uint32_t address = PRG_RAM_UNIT.first; address <= PRG_RAM_UNIT.second; ++address) {
+            if (bus.Read(static_cast<Address>(address)) != model[(address - PRG_RAM_UNIT.first) % size]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool CheckChrRam(PPU& ppu, Mapper& mapper)
+    {
+        const size_t size = mapper.GetChrRamSize();
+        const Address patternTablesEnd = PPU_GRAPHICS_SIZE * 2;
+        std::vector<Byte> model(size);
+
+        ppu.Write(PPU_ADDRESS_REGISTER, 0x00);
+        ppu.Write(PPU_ADDRESS_REGISTER, 0x00);
+        for (Address address = 0; address < patternTablesEnd; ++address) {
+            ppu.Write(PPU_DATA_REGISTER, Pattern(address));
+            model[address % size] = Pattern(address);
+        }
+
+        // $2007 reads are buffered, so the first one only primes the buffer
+        ppu.Write(PPU_ADDRESS_REGISTER, 0x00);
+        ppu.Write(PPU_ADDRESS_REGISTER, 0x00);
+        ppu.Read(PPU_DATA_REGISTER);
+        for (Address address = 0; address < patternTablesEnd; ++address) {
+            if (ppu.Read(PPU_DATA_REGISTER) != model[address % size]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool CheckRamSizes()
+    {
+        int headers = 0;
+        for (int mapperNumber = 0; mapperNumber < NUMBER_OF_BOARDS; ++mapperNumber) {
+            for (Byte volatileShift = 0; volatileShift <= MAXIMUM_SHIFT; ++volatileShift) {
+                for (const Byte batteryShift : { 0, 1, 7 }) {
+                    const Byte chrRamShift = (volatileShift + batteryShift) % (MAXIMUM_SHIFT + 1);
+                    const std::vector<Byte> image = MakeImage(mapperNumber, volatileShift | (batteryShift << 4), chrRamShift);
+
+                    Cartridge cartridge;
+                    if (!cartridge.LoadFromData(image.data(), image.size())
+                        || cartridge.GetPrgRamSize() != DecodeRamSize(volatileShift) + DecodeRamSize(batteryShift)
+                        || cartridge.GetChrRamSize() != DecodeRamSize(chrRamShift)) {
+                        std::printf("mapper %d, PRG-RAM shifts %d/%d: header not decoded\n", mapperNumber, volatileShift, batteryShift);
+                        return false;
+                    }
+
+                    Bus bus;
+                    std::unique_ptr<PPU> ppu = std::make_unique<PPU>();
+                    std::unique_ptr<Mapper> mapper = Mapper::Create(cartridge, bus, *ppu);
+                    bus.MapDevice(PRG_ROM_UNIT.first, PRG_ROM_UNIT.second, mapper.get());
+                    mapper->Reset();
+
+                    if (!CheckPrgRam(bus, *mapper)) {
+                        std::printf("mapper %d, PRG-RAM shifts %d/%d: $6000-$7FFF leaves %zu bytes of PRG-RAM\n",
+                                    mapperNumber, volatileShift, batteryShift, mapper->GetPrgRamSize());
+                        return false;
+                    }
+                    if (!CheckChrRam(*ppu, *mapper)) {
+                        std::printf("mapper %d, CHR-RAM shift %d: pattern tables leave %zu bytes of CHR-RAM\n",
+                                    mapperNumber, chrRamShift, mapper->GetChrRamSize());
+                        return false;
+                    }
+                    ++headers;
+                }
+            }
+        }
+        std::printf("%d NES 2.0 RAM headers passed\n", headers);
+        return true;
+    }
+
+    // Exponent-multiplier sizes: 2^7 bytes of PRG-ROM, and 2^9 * 3 bytes of CHR-ROM
+    bool CheckOddRomSizes()
+    {
+        std::vector<Byte> image = MakeImage(0, 0x07, 0x00);
+        image[4] = 7 << 2;
+        image[9] = 0x0F;
+        Cartridge cartridge;
+        if (cartridge.LoadFromData(image.data(), image.size())) {
+            std::printf("128-byte PRG-ROM was accepted\n");
+            return false;
+        }
+
+        image = MakeImage(0, 0x07, 0x00);
+        image[5] = (9 << 2) | 0x01;
+        image[9] = 0xF0;
+        if (cartridge.LoadFromData(image.data(), image.size())) {
+            std::printf("1536-byte CHR-ROM was accepted\n");
+            return false;
+        }
+        std::printf("odd ROM sizes refused\n");
+        return true;
+    }
+}
+
+int main()
+{
+    return CheckRamSizes() && CheckOddRomSizes() ? 0 : 1;
+}
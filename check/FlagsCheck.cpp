@@ -0,0 +1,243 @@
+// Exhaustive check of the lazily kept N/Z/C/V flags.
+//
+// Runs every flag-setting ALU instruction on every accumulator, operand and carry
+// input, starting from varied N/V/Z/I/D bits, and compares the result with an
+// eager reference model:
+//
+//   * the status byte from CaptureState(), which GetStatusRegister() assembles;
+//   * the byte a following PHP pushes;
+//   * whether a following branch (each of the eight in turn) is taken.
+//
+// Then PLP of every byte must give the same byte back through PHP.
+//
+// Usage: FlagsCheck
+
+#include <cstdio>
+#include <vector>
+
+#include "../include/Bus.hpp"
+#include "../include/CPU.hpp"
+
+namespace {
+    constexpr Address CODE_ADDRESS = 0x0200;
+    constexpr Byte OPERAND_ADDRESS = 0x10; // For BIT, which has no immediate form
+    constexpr Byte STACK_TOP = 0xFD;
+
+    namespace Flags {
+        constexpr Byte C = 0x01;
+        constexpr Byte Z = 0x02;
+        constexpr Byte I = 0x04;
+        constexpr Byte D = 0x08;
+        constexpr Byte B = 0x10;
+        constexpr Byte U = 0x20;
+        constexpr Byte V = 0x40;
+        constexpr Byte N = 0x80;
+    }
+
+    // The branch opcodes with the flag each tests and the value that takes it
+    struct Branch {
+        Byte opcode;
+        Byte flag;
+        bool isTakenWhenSet;
+    };
+
+    constexpr Branch BRANCHES[] = {
+        { 0x10, Flags::N, false }, { 0x30, Flags::N, true },
+        { 0x50, Flags::V, false }, { 0x70, Flags::V, true },
+        { 0x90, Flags::C, false }, { 0xB0, Flags::C, true },
+        { 0xD0, Flags::Z, false }, { 0xF0, Flags::Z, true },
+    };
+
+    enum class Target { Accumulator, X, Y };
+
+    struct Case {
+        const char* name;
+        Byte opcode;
+        bool hasOperand;
+        Target target;
+    };
+
+    constexpr Case CASES[] = {
+        { "ADC", 0x69, true, Target::Accumulator }, { "SBC", 0xE9, true, Target::Accumulator },
+        { "AND", 0x29, true, Target::Accumulator }, { "ORA", 0x09, true, Target::Accumulator },
+        { "EOR", 0x49, true, Target::Accumulator }, { "LDA", 0xA9, true, Target::Accumulator },
+        { "CMP", 0xC9, true, Target::Accumulator }, { "CPX", 0xE0, true, Target::X },
+        { "CPY", 0xC0, true, Target::Y }, { "BIT", 0x24, true, Target::Accumulator },
+        { "ASL", 0x0A, false, Target::Accumulator }, { "LSR", 0x4A, false, Target::Accumulator },
+        { "ROL", 0x2A, false, Target::Accumulator }, { "ROR", 0x6A, false, Target::Accumulator },
+        { "INX", 0xE8, false, Target::X }, { "DEX", 0xCA, false, Target::X },
+        { "INY", 0xC8, false, Target::Y }, { "DEY", 0x88, false, Target::Y },
+        { "TAX", 0xAA, false, Target::Accumulator }, { "TXA", 0x8A, false, Target::X },
+    };
+
+    Byte SetZeroAndNegative(const Byte status, const Byte result)
+    {
+        return (status & ~(Flags::Z | Flags::N)) | (result == 0 ? Flags::Z : 0) | (result & Flags::N);
+    }
+
+    Byte SetFlag(const Byte status, const Byte flag, const bool isSet)
+    {
+        return isSet ? (status | flag) : (status & ~flag);
+    }
+
+    // Status after the instruction, computed one flag at a time
+    Byte GetExpectedStatus(const Byte opcode, const Byte input, const Byte operand, Byte status)
+    {
+        const bool carry = (status & Flags::C) != 0;
+        switch (opcode) {
+            case 0x69:
+            case 0xE9: {
+                const Byte addend = opcode == 0xE9 ? static_cast<Byte>(~operand) : operand;
+                const unsigned sum = input + addend + (carry ? 1 : 0);
+                const Byte result = static_cast<Byte>(sum);
+                status = SetFlag(status, Flags::C, sum > 0xFF);
+                status = SetFlag(status, Flags::V, (~(input ^ addend) & (input ^ result) & 0x80) != 0);
+                return SetZeroAndNegative(status, result);
+            }
+            case 0x29: return SetZeroAndNegative(status, input & operand);
+            case 0x09: return SetZeroAndNegative(status, input | operand);
+            case 0x49: return SetZeroAndNegative(status, input ^ operand);
+            case 0xA9: return SetZeroAndNegative(status, operand);
+            case 0xC9:
+            case 0xE0:
+            case 0xC0:
+                status = SetFlag(status, Flags::C, input >= operand);
+                return SetZeroAndNegative(status, static_cast<Byte>(input - operand));
+            case 0x24:
+                status = SetFlag(status, Flags::Z, (input & operand) == 0);
+                status = SetFlag(status, Flags::V, (operand & 0x40) != 0);
+                return SetFlag(status, Flags::N, (operand & 0x80) != 0);
+            case 0x0A:
+                status = SetFlag(status, Flags::C, (input & 0x80) != 0);
+                return SetZeroAndNegative(status, static_cast<Byte>(input << 1));
+            case 0x4A:
+                status = SetFlag(status, Flags::C, (input & 0x01) != 0);
+                return SetZeroAndNegative(status, input >> 1);
+            case 0x2A:
+                status = SetFlag(status, Flags::C, (input & 0x80) != 0);
+                return SetZeroAndNegative(status, static_cast<Byte>((input << 1) | (carry ? 1 : 0)));
+            case 0x6A:
+                status = SetFlag(status, Flags::C, (input & 0x01) != 0);
+                return SetZeroAndNegative(status, static_cast<Byte>((input >> 1) | (carry ? 0x80 : 0)));
+            case 0xE8:
+            case 0xC8: return SetZeroAndNegative(status, static_cast<Byte>(input + 1));
+            case 0xCA:
+            case 0x88: return SetZeroAndNegative(status, static_cast<Byte>(input - 1));
+            default: return SetZeroAndNegative(status, input); // Transfers
+        }
+    }
+
+    class FlagsChecker
+    {
+        public:
+            FlagsChecker() { Cpu.ConnectBus(&ConnectedBus); }
+
+            bool CheckCase(const Case& check)
+            {
+                const Address php = CODE_ADDRESS + (check.hasOperand ? 2 : 1);
+                const Address branch = php + 1;
+                uint64_t runs = 0;
+
+                for (unsigned input = 0; input < 0x100; ++input) {
+                    for (unsigned operand = 0; operand < (check.hasOperand ? 0x100u : 1u); ++operand) {
+                        for (unsigned variant = 0; variant < 8; ++variant) {
+                            // Carry in, plus every other flag set or clear in turn
+                            const Byte status = static_cast<Byte>(Flags::U | ((variant & 1) ? Flags::C : 0)
+                                | ((variant & 2) ? (Flags::N | Flags::V) : Flags::Z)
+                                | ((variant & 4) ? (Flags::I | Flags::D) : 0));
+                            const Branch& test = BRANCHES[(input + operand + variant) % 8];
+
+                            Byte* ram = ConnectedBus.GetRam();
+                            ram[CODE_ADDRESS] = check.opcode;
+                            ram[CODE_ADDRESS + 1] = check.opcode == 0x24 ? OPERAND_ADDRESS : static_cast<Byte>(operand);
+                            ram[php] = 0x08;
+                            ram[branch] = test.opcode;
+                            ram[branch + 1] = 0x02;
+                            ram[OPERAND_ADDRESS] = static_cast<Byte>(operand);
+
+                            CPUState state{};
+                            state.programCounter = CODE_ADDRESS;
+                            state.stackPointer = STACK_TOP;
+                            state.statusRegister = status;
+                            state.accumulator = check.target == Target::Accumulator ? input : 0x5A;
+                            state.x = check.target == Target::X ? input : 0xA5;
+                            state.y = check.target == Target::Y ? input : 0x3C;
+                            Cpu.RestoreState(state);
+
+                            const Byte expected = GetExpectedStatus(check.opcode, static_cast<Byte>(input), static_cast<Byte>(operand), status);
+                            Cpu.Step();
+                            Cpu.CaptureState(state);
+                            const Byte captured = state.statusRegister;
+                            Cpu.Step();
+                            const Byte pushed = ram[0x0100 + STACK_TOP];
+                            Cpu.Step();
+                            Cpu.CaptureState(state);
+
+                            const bool isTaken = ((expected & test.flag) != 0) == test.isTakenWhenSet;
+                            const Address expectedPc = branch + 2 + (isTaken ? 2 : 0);
+                            if ((captured & ~(Flags::B | Flags::U)) != (expected & ~(Flags::B | Flags::U))
+                                || (pushed & ~Flags::B) != ((expected | Flags::B | Flags::U) & ~Flags::B)
+                                || state.programCounter != expectedPc) {
+                                std::printf("%s: input $%02X operand $%02X status $%02X: captured $%02X pushed $%02X, expected $%02X; "
+                                            "branch $%02X went to $%04X, expected $%04X\n",
+                                            check.name, input, operand, status, captured, pushed, expected,
+                                            test.opcode, state.programCounter, expectedPc);
+                                return false;
+                            }
+                            ++runs;
+                        }
+                    }
+                }
+                Runs += runs;
+                return true;
+            }
+
+            bool CheckPullPush()
+            {
+                for (unsigned value = 0; value < 0x100; ++value) {
+                    Byte* ram = ConnectedBus.GetRam();
+                    ram[CODE_ADDRESS] = 0x28; // PLP / PHP
+                    ram[CODE_ADDRESS + 1] = 0x08;
+                    ram[0x0100 + STACK_TOP] = static_cast<Byte>(value);
+
+                    CPUState state{};
+                    state.programCounter = CODE_ADDRESS;
+                    state.stackPointer = STACK_TOP - 1;
+                    Cpu.RestoreState(state);
+                    Cpu.Step();
+                    Cpu.Step();
+
+                    // PHP always pushes B and U set
+                    const Byte pushed = ram[0x0100 + STACK_TOP];
+                    if (pushed != (value | Flags::B | Flags::U)) {
+                        std::printf("PLP/PHP: pulled $%02X, pushed $%02X\n", value, pushed);
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            uint64_t GetRuns() const { return Runs; }
+
+        private:
+            Bus ConnectedBus;
+            CPU Cpu;
+            uint64_t Runs = 0;
+    };
+}
+
+int main()
+{
+    FlagsChecker checker;
+    for (const Case& check : CASES) {
+        if (!checker.CheckCase(check)) {
+            return 1;
+        }
+    }
+    if (!checker.CheckPullPush()) {
+        return 1;
+    }
+    std::printf("%zu instructions, %llu inputs and PLP/PHP of every byte passed\n", sizeof(CASES) / sizeof(CASES[0]),
+                static_cast<unsigned long long>(checker.GetRuns()));
+    return 0;
+}
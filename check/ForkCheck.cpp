@@ -0,0 +1,234 @@
+// Differential check for ForkTracker's copy-on-write forks.
+//
+// Two machines run the same random program (see MakeTestProgram()) with PRG-RAM at
+// $6000-$7FFF and take the same random writes through the Bus, through the RAM
+// mirrors and straight into memory reported with MarkDirty(). One takes forks with a
+// ForkTracker; the other keeps a full copy of every writable page and its registers
+// for each fork. Restoring a fork must leave the two with the same registers, RAM,
+// PRG-RAM and device accesses, and they must stay equal as they run on. The forked
+// machine runs through a decode cache, and the program jumps into RAM, so a restore
+// that leaves decoded RAM code current shows up as a divergence.
+//
+// Now and then the PRG-RAM window is remapped: all of one buffer, a smaller buffer
+// mirrored across it, or half of it unmapped. Forks taken under another layout must
+// be refused without touching the machine, and forks from an earlier layout must
+// restore again once it is mapped back.
+//
+// Usage: ForkCheck [--seeds N]
+
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../include/Bus.hpp"
+#include "../include/CPU.hpp"
+#include "../include/DecodeCache.hpp"
+#include "../include/Fork.hpp"
+#include "TestPrograms.hpp"
+
+namespace {
+    constexpr int OPERATIONS = 3000;
+    constexpr size_t MAXIMUM_FORKS = 16;
+    constexpr int NUMBER_OF_LAYOUTS = 3;
+    constexpr int REMAP_CHANCE = 60; // One operation in this many
+    constexpr size_t PRG_RAM_SIZE = 0x2000;
+    constexpr size_t SMALL_PRG_RAM_SIZE = 0x0800;
+
+    struct Options {
+        int seeds = 100;
+    };
+
+    struct Machine {
+        Bus bus;
+        CPU cpu;
+        CountingDevice device;
+        std::array<Byte, PRG_RAM_SIZE> prgRam{};
+        std::array<Byte, SMALL_PRG_RAM_SIZE> smallPrgRam{};
+
+        explicit Machine(const std::vector<Byte>& program)
+        {
+            bus.MapReadOnlyMemory(TEST_PROGRAM_START, TEST_PROGRAM_END, program.data(), program.size());
+            bus.MapDevice(0x2000, 0x3FFF, &device);
+            cpu.ConnectBus(&bus);
+            MapLayout(0);
+
+            CPUState state{};
+            state.programCounter = TEST_PROGRAM_START;
+            state.stackPointer = 0xFD;
+            state.statusRegister = 0x24;
+            cpu.RestoreState(state);
+        }
+
+        void MapLayout(const int layout)
+        {
+            switch (layout) {
+                case 0:
+                    bus.MapMemory(0x6000, 0x7FFF, prgRam.data(), prgRam.size());
+                    break;
+                case 1:
+                    bus.MapMemory(0x6000, 0x7FFF, smallPrgRam.data(), smallPrgRam.size());
+                    break;
+                default:
+                    bus.MapMemory(0x6000, 0x6FFF, prgRam.data(), prgRam.size());
+                    bus.Unmap(0x7000, 0x7FFF);
+                    break;
+            }
+        }
+    };
+
+    // What the reference machine keeps for a fork: every writable page and the registers
+    struct Snapshot {
+        CPUState cpu;
+        std::vector<Byte> pages;
+        int layout;
+    };
+
+    Snapshot TakeSnapshot(Machine& machine, const int layout)
+    {
+        Snapshot snapshot{};
+        machine.cpu.CaptureState(snapshot.cpu);
+        snapshot.pages.resize(NUMBER_OF_BUS_PAGES * BUS_PAGE_SIZE);
+        for (size_t page = 0; page < NUMBER_OF_BUS_PAGES; ++page) {
+            if (const Byte* memory = machine.bus.GetWritablePageMemory(page)) {
+                std::memcpy(&snapshot.pages[page * BUS_PAGE_SIZE], memory, BUS_PAGE_SIZE);
+            }
+        }
+        snapshot.layout = layout;
+        return snapshot;
+    }
+
+    void RestoreSnapshot(Machine& machine, const Snapshot& snapshot)
+    {
+        for (size_t page = 0; page < NUMBER_OF_BUS_PAGES; ++page) {
+            if (Byte* memory = machine.bus.GetWritablePageMemory(page)) {
+                std::memcpy(memory, &snapshot.pages[page * BUS_PAGE_SIZE], BUS_PAGE_SIZE);
+            }
+        }
+        machine.cpu.RestoreState(snapshot.cpu);
+    }
+
+    bool IsSameState(const Machine& a, const Machine& b)
+    {
+        CPUState stateA;
+        CPUState stateB;
+        a.cpu.CaptureState(stateA);
+        b.cpu.CaptureState(stateB);
+        return stateA.totalCycles == stateB.totalCycles && stateA.programCounter == stateB.programCounter
+            && stateA.accumulator == stateB.accumulator && stateA.x == stateB.x && stateA.y == stateB.y
+            && stateA.stackPointer == stateB.stackPointer && stateA.statusRegister == stateB.statusRegister
+            && std::memcmp(a.bus.GetRam(), b.bus.GetRam(), MEMORY_SIZE) == 0 && a.prgRam == b.prgRam
+            && a.smallPrgRam == b.smallPrgRam && a.device == b.device;
+    }
+
+    // RAM and its mirrors, or the PRG-RAM window
+    Address RandomWritableAddress(std::mt19937& rng)
+    {
+        return static_cast<Address>(rng() % 2 == 0 ? rng() % 0x2000 : 0x6000 + rng() % 0x2000);
+    }
+
+    bool Check(const Options& options)
+    {
+        uint64_t forks = 0;
+        uint64_t restores = 0;
+        uint64_t pagesCopied = 0;
+        uint64_t pagesRestored = 0;
+        for (int seed = 0; seed < options.seeds; ++seed) {
+            std::mt19937 rng(seed);
+            const std::vector<Byte> program = MakeTestProgram(rng);
+            std::unique_ptr<Machine> forked = std::make_unique<Machine>(program);
+            std::unique_ptr<Machine> reference = std::make_unique<Machine>(program);
+            DecodeCache decodeCache(forked->bus);
+            forked->cpu.ConnectDecodeCache(&decodeCache);
+            ForkTracker tracker(forked->cpu, forked->bus);
+            std::vector<StateFork> stateForks;
+            std::vector<Snapshot> snapshots;
+            int layout = 0;
+
+            for (int operation = 0; operation < OPERATIONS; ++operation) {
+                const unsigned kind = rng() % 8;
+                if (rng() % REMAP_CHANCE == 0) {
+                    layout = rng() % NUMBER_OF_LAYOUTS;
+                    forked->MapLayout(layout);
+                    reference->MapLayout(layout);
+                } else if (kind == 0) {
+                    if (stateForks.size() == MAXIMUM_FORKS) {
+                        const size_t dropped = rng() % MAXIMUM_FORKS;
+                        stateForks.erase(stateForks.begin() + dropped);
+                        snapshots.erase(snapshots.begin() + dropped);
+                    }
+                    stateForks.push_back(tracker.Fork());
+                    snapshots.push_back(TakeSnapshot(*reference, layout));
+                    ++forks;
+                } else if (kind == 1 && !stateForks.empty()) {
+                    const size_t index = rng() % stateForks.size();
+                    const bool isRestored = tracker.Restore(stateForks[index]);
+                    if (isRestored != (snapshots[index].layout == layout)) {
+                        std::printf("seed %d: fork from layout %d %s under layout %d\n", seed, snapshots[index].layout,
+                                    isRestored ? "restored" : "refused", layout);
+                        return false;
+                    }
+                    if (isRestored) {
+                        RestoreSnapshot(*reference, snapshots[index]);
+                        ++restores;
+                    }
+                } else if (kind == 2) {
+                    const Address address = RandomWritableAddress(rng);
+                    const Byte data = rng();
+                    forked->bus.Write(address, data);
+                    reference->bus.Write(address, data);
+                } else if (kind == 3) {
+                    // A write that bypasses the Bus, as a loader or debugger would make
+                    const Address address = rng() % MEMORY_SIZE;
+                    const Byte data = rng();
+                    forked->bus.GetRam()[address] = data;
+                    forked->bus.MarkDirty(address, address);
+                    reference->bus.GetRam()[address] = data;
+                } else {
+                    const uint64_t cycles = 1 + rng() % 500;
+                    forked->cpu.RunCycles(cycles);
+                    reference->cpu.RunCycles(cycles);
+                }
+
+                if (!IsSameState(*forked, *reference)) {
+                    std::printf("seed %d: diverged at operation %d (layout %d)\n", seed, operation, layout);
+                    return false;
+                }
+            }
+            pagesCopied += tracker.GetPagesCopied();
+            pagesRestored += tracker.GetPagesRestored();
+        }
+        std::printf("%d seeds passed: %llu forks, %llu restores, %.1f pages copied per fork, %.1f restored per restore\n",
+                    options.seeds, static_cast<unsigned long long>(forks), static_cast<unsigned long long>(restores),
+                    forks ? static_cast<double>(pagesCopied) / forks : 0.0,
+                    restores ? static_cast<double>(pagesRestored) / restores : 0.0);
+        return true;
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        for (int index = 1; index < argc; ++index) {
+            const std::string argument = argv[index];
+            if (argument == "--seeds" && index + 1 < argc) {
+                options.seeds = std::atoi(argv[++index]);
+            } else {
+                std::fprintf(stderr, "Usage: %s [--seeds N]\n", argv[0]);
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        return 1;
+    }
+    return Check(options) ? 0 : 1;
+}
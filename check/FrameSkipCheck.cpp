@@ -0,0 +1,164 @@
+// Differential check for PPU frame skipping.
+//
+// Runs generated NROM games on two Systems, one skipping most frames. The games
+// poll $2002 for vblank and sprite 0, read $2007, rewrite scroll, mask and control
+// mid-frame and start OAM DMAs, so everything a skipped frame still has to get right
+// is observable. After every random timeslice both PPUs are caught up and their
+// status register, VRAM address, scanline and dot must match, along with the CPU
+// registers and RAM.
+//
+// Usage: FrameSkipCheck [--games N]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../include/SaveState.hpp"
+#include "../include/System.hpp"
+#include "TestRoms.hpp"
+
+namespace {
+    constexpr int FRAMES = 120;
+    constexpr uint64_t MAXIMUM_TIMESLICE = 3000; // CPU cycles, about 26 scanlines
+    constexpr int DRAWN_FRAME_CHANCE = 8; // One frame in this many is drawn
+
+    struct Options {
+        int games = 50;
+    };
+
+    std::vector<Byte> MakeGame(const unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        TestRomBuilder rom;
+        for (size_t index = 0; index < CHR_ROM_UNIT_SIZE; ++index) {
+            rom.GetChr()[index] = (rng() % 3) ? rng() : 0;
+        }
+        for (size_t index = 0; index < OAM_SIZE; ++index) {
+            rom.GetPrg()[0x1000 + index] = rng(); // Sprites at $9000
+        }
+
+        rom.Emit({ 0x78, 0xA2, 0xFF, 0x9A, 0xA2, 0x00, 0xBD, 0x00, 0x90, 0x9D, 0x00, 0x02, 0xE8, 0xD0, 0xF7 });
+        rom.Emit({ 0xA9, 0x80, 0x8D, 0x00, 0x20, 0xA9, 0x1E, 0x8D, 0x01, 0x20, 0xA2, 0x00 });
+        const Address mainLoop = rom.GetAddress();
+        while (rom.GetOffset() < 0x0F00) {
+            const int kind = rng() % 14;
+            if (kind < 4) {
+                rom.Emit({ 0xAD, 0x02, 0x20, 0x95, 0x20, 0xE8 }); // LDA $2002 / STA $20,X / INX
+            } else if (kind < 5) {
+                rom.Emit({ 0xAD, 0x07, 0x20, 0x95, 0x20, 0xE8 }); // The same from $2007
+            } else if (kind < 7) {
+                static const int REGISTERS[] = { 0x05, 0x06, 0x03, 0x04, 0x00 };
+                const int reg = REGISTERS[rng() % 5];
+                const int data = static_cast<int>(rng() & 0xFF) | (reg == 0x00 ? 0x80 : 0x00);
+                rom.Emit({ 0xA9, data, 0x8D, reg, 0x20 });
+            } else if (kind < 8) {
+                rom.Emit({ 0xA9, static_cast<int>((rng() & 0xE7) | (rng() % 4 ? 0x18 : 0x08)), 0x8D, 0x01, 0x20 });
+            } else if (kind < 9) {
+                rom.Emit({ 0xA9, 0x02, 0x8D, 0x14, 0x40 });
+            } else if (kind < 10) {
+                // Poll for sprite 0 hit with a timeout and keep what was left of it
+                rom.Emit({ 0xA0, static_cast<int>(rng() % 200), 0x2C, 0x02, 0x20, 0x70, 0x03, 0x88, 0xD0, 0xF8, 0x98, 0x95, 0x20, 0xE8 });
+            } else if (kind < 11) {
+                rom.Emit({ 0xA0, static_cast<int>(rng() % 50), 0x88, 0xD0, 0xFD });
+            } else {
+                rom.Emit({ 0xE6, static_cast<int>(rng() % 16) });
+            }
+        }
+        rom.EmitJump(mainLoop);
+
+        const Address nmiHandler = rom.GetAddress();
+        rom.Emit({ 0xE6, 0x10, 0xAD, 0x02, 0x20, 0x85, 0x11, 0x40 });
+        rom.SetVector(0xFFFA, nmiHandler);
+        rom.SetVector(0xFFFC, PRG_ROM_UNIT.first);
+        rom.SetVector(0xFFFE, PRG_ROM_UNIT.first);
+        return rom.GetImage();
+    }
+
+    bool IsSameState(System& a, System& b)
+    {
+        SaveState stateA;
+        SaveState stateB;
+        stateA.Capture(a.GetCPU(), a.GetBus());
+        stateB.Capture(b.GetCPU(), b.GetBus());
+        const PPU& ppuA = a.GetPPU();
+        const PPU& ppuB = b.GetPPU();
+        return std::memcmp(stateA.GetData(), stateB.GetData(), SaveState::GetSize()) == 0
+            && ppuA.GetStatusRegister() == ppuB.GetStatusRegister() && ppuA.GetVramAddress() == ppuB.GetVramAddress()
+            && ppuA.GetScanline() == ppuB.GetScanline() && ppuA.GetDot() == ppuB.GetDot();
+    }
+
+    bool Check(const Options& options)
+    {
+        double drawnSeconds = 0.0;
+        double skippingSeconds = 0.0;
+        for (int seed = 0; seed < options.games; ++seed) {
+            const std::vector<Byte> image = MakeGame(seed);
+            Cartridge cartridge;
+            if (!cartridge.LoadFromData(image.data(), image.size())) {
+                std::printf("seed %d did not load\n", seed);
+                return false;
+            }
+
+            System drawn;
+            System skipping;
+            drawn.InsertCartridge(cartridge);
+            skipping.InsertCartridge(cartridge);
+            drawn.Reset();
+            skipping.Reset();
+
+            std::mt19937 rng(seed * 7 + 1);
+            for (int frame = 0; frame < FRAMES; ++frame) {
+                skipping.GetPPU().SetFrameSkipping(rng() % DRAWN_FRAME_CHANCE != 0);
+                const uint64_t frameEnd = drawn.GetPPU().GetFrameEndCycle();
+                while (drawn.GetCPU().GetTotalCycles() < frameEnd) {
+                    const uint64_t cycles = 1 + rng() % MAXIMUM_TIMESLICE;
+                    const auto start = std::chrono::steady_clock::now();
+                    drawn.RunCycles(cycles);
+                    drawn.GetScheduler().CatchUpAll(drawn.GetCPU().GetTotalCycles());
+                    const auto middle = std::chrono::steady_clock::now();
+                    skipping.RunCycles(cycles);
+                    skipping.GetScheduler().CatchUpAll(skipping.GetCPU().GetTotalCycles());
+                    const auto end = std::chrono::steady_clock::now();
+                    drawnSeconds += std::chrono::duration<double>(middle - start).count();
+                    skippingSeconds += std::chrono::duration<double>(end - middle).count();
+
+                    if (!IsSameState(drawn, skipping)) {
+                        std::printf("seed %d diverged in frame %d at scanline %u, dot %u\n", seed, frame,
+                                    drawn.GetPPU().GetScanline(), drawn.GetPPU().GetDot());
+                        return false;
+                    }
+                }
+            }
+        }
+        std::printf("%d games passed, %.2fx faster skipping\n", options.games,
+                    skippingSeconds > 0.0 ? drawnSeconds / skippingSeconds : 0.0);
+        return true;
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        for (int index = 1; index < argc; ++index) {
+            const std::string argument = argv[index];
+            if (argument == "--games" && index + 1 < argc) {
+                options.games = std::atoi(argv[++index]);
+            } else {
+                std::fprintf(stderr, "Usage: %s [--games N]\n", argv[0]);
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        return 1;
+    }
+    return Check(options) ? 0 : 1;
+}
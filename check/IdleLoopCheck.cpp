@@ -0,0 +1,310 @@
+// Differential check for CPU idle-loop skipping.
+//
+// Runs every program twice, once with SetIdleLoopSkipping(false), and compares the
+// CPU registers and RAM after every timeslice:
+//
+//   * Loop kernels: random short loops of pure instructions closed by a branch or
+//     JMP, polling RAM or a device register that changes at a random cycle, on a
+//     bare CPU with random timeslices.
+//   * Games: generated NROM programs on the whole System that wait on vblank,
+//     sprite 0, an NMI counter or RAM, compared after every frame.
+//
+// Prints one summary line per part and exits non-zero on the first mismatch.
+//
+// Usage: IdleLoopCheck [--kernels N] [--games N]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../include/Bus.hpp"
+#include "../include/CPU.hpp"
+#include "../include/SaveState.hpp"
+#include "../include/System.hpp"
+#include "TestRoms.hpp"
+
+namespace {
+    constexpr Address KERNEL_START = 0x8100;
+    constexpr int KERNEL_TIMESLICES = 20;
+    constexpr int GAME_FRAMES = 200;
+
+    struct Options {
+        int kernels = 60000;
+        int games = 200;
+    };
+
+    // Reads $80 before the given cycle and $00 from then on, and says so when asked
+    // how long its value holds.
+    class SwitchingDevice : public BusDevice
+    {
+        public:
+            SwitchingDevice(const CPU& cpu, const uint64_t switchCycle) : ConnectedCPU(cpu), SwitchCycle(switchCycle) {}
+
+            Byte Read(const Address) override { return ConnectedCPU.GetAccessCycle() >= SwitchCycle ? 0x80 : 0x00; }
+            void Write(const Address, const Byte) override {}
+            uint64_t GetStableReadCycle(const Address) override
+            {
+                return ConnectedCPU.GetTotalCycles() < SwitchCycle ? SwitchCycle : NO_PENDING_EVENT;
+            }
+
+        private:
+            const CPU& ConnectedCPU;
+            uint64_t SwitchCycle;
+    };
+
+    struct KernelMachine {
+        Bus bus;
+        CPU cpu;
+        SwitchingDevice device;
+
+        KernelMachine(const std::vector<Byte>& rom, const uint64_t switchCycle) : device(cpu, switchCycle)
+        {
+            bus.MapReadOnlyMemory(PRG_ROM_UNIT.first, PRG_ROM_UNIT.second, rom.data(), rom.size());
+            bus.MapDevice(0x2000, 0x3FFF, &device);
+            cpu.ConnectBus(&bus);
+        }
+    };
+
+    bool IsSameState(const CPU& cpuA, const Bus& busA, const CPU& cpuB, const Bus& busB)
+    {
+        SaveState a;
+        SaveState b;
+        a.Capture(cpuA, busA);
+        b.Capture(cpuB, busB);
+        return std::memcmp(a.GetData(), b.GetData(), SaveState::GetSize()) == 0;
+    }
+
+    // A few instructions that only read memory or registers, then a branch or JMP
+    // back to the start. Straddles a page boundary now and then.
+    std::vector<Byte> MakeKernel(std::mt19937& rng, Address& start)
+    {
+        static const Byte PURE_OPCODES[] = {
+            0xA5, 0xB5, 0xAD, 0xBD, 0xB9, 0xC9, 0xC5, 0x24, 0x2C, 0x29, 0x09,
+            0x49, 0xEA, 0x18, 0x38, 0xB8, 0xAA, 0xA8, 0x8A, 0x98, 0xE8, 0x85,
+        };
+        static const Byte CLOSING_OPCODES[] = { 0x10, 0x30, 0xD0, 0xF0, 0x50, 0x70, 0x90, 0xB0, 0x4C };
+
+        std::vector<Byte> rom(PRG_ROM_UNIT.second - PRG_ROM_UNIT.first + 1, 0xEA);
+        size_t offset = (KERNEL_START - PRG_ROM_UNIT.first) - rng() % 8;
+        start = static_cast<Address>(PRG_ROM_UNIT.first + offset);
+
+        const int length = 1 + rng() % 4;
+        for (int index = 0; index < length; ++index) {
+            const Byte opcode = PURE_OPCODES[rng() % sizeof(PURE_OPCODES)];
+            rom[offset++] = opcode;
+            switch (opcode) {
+                case 0xA5: case 0xB5: case 0xC5: case 0x24: case 0x85:
+                    rom[offset++] = rng() % 4;
+                    break;
+                case 0xAD: case 0x2C: case 0xBD: case 0xB9:
+                    if (rng() % 2) {
+                        rom[offset++] = 0x02; // $2002
+                        rom[offset++] = 0x20;
+                    } else {
+                        rom[offset++] = rng() % 4;
+                        rom[offset++] = rng() % 2 ? 0x00 : 0x90;
+                    }
+                    break;
+                case 0xC9: case 0x29: case 0x09: case 0x49:
+                    rom[offset++] = rng();
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        const Byte closing = CLOSING_OPCODES[rng() % sizeof(CLOSING_OPCODES)];
+        rom[offset] = closing;
+        if (closing == 0x4C) {
+            rom[offset + 1] = start & 0xFF;
+            rom[offset + 2] = start >> 8;
+        } else {
+            rom[offset + 1] = static_cast<Byte>(start - (PRG_ROM_UNIT.first + offset + 2));
+        }
+        return rom;
+    }
+
+    bool CheckKernels(const Options& options)
+    {
+        uint64_t skippedCycles = 0;
+        uint64_t totalCycles = 0;
+        for (int seed = 0; seed < options.kernels; ++seed) {
+            std::mt19937 rng(seed);
+            Address start;
+            const std::vector<Byte> rom = MakeKernel(rng, start);
+            const uint64_t switchCycle = rng() % 3000;
+
+            KernelMachine reference(rom, switchCycle);
+            KernelMachine skipping(rom, switchCycle);
+            skipping.cpu.SetIdleLoopSkipping(true);
+            for (Address address = 0; address < 4; ++address) {
+                const Byte data = rng() % 3;
+                reference.bus.Write(address, data);
+                skipping.bus.Write(address, data);
+            }
+
+            CPUState state{};
+            state.programCounter = start;
+            state.stackPointer = 0xFD;
+            state.statusRegister = rng() & 0xCF;
+            state.accumulator = rng();
+            state.x = rng() % 4;
+            state.y = rng() % 4;
+            reference.cpu.RestoreState(state);
+            skipping.cpu.RestoreState(state);
+
+            for (int timeslice = 0; timeslice < KERNEL_TIMESLICES; ++timeslice) {
+                const uint64_t cycles = rng() % 500;
+                reference.cpu.RunCycles(cycles);
+                skipping.cpu.RunCycles(cycles);
+                if (!IsSameState(reference.cpu, reference.bus, skipping.cpu, skipping.bus)) {
+                    std::printf("kernels: seed %d diverged in timeslice %d\n", seed, timeslice);
+                    return false;
+                }
+            }
+            skippedCycles += skipping.cpu.GetIdleCyclesSkipped();
+            totalCycles += skipping.cpu.GetTotalCycles();
+        }
+        std::printf("kernels: %d passed, %.1f%% of cycles skipped\n", options.kernels, totalCycles ? 100.0 * skippedCycles / totalCycles : 0.0);
+        return true;
+    }
+
+    // Waits on an NMI counter, vblank, sprite 0 and RAM in a random order, with the
+    // APU frame IRQ off so nothing keeps the System polling.
+    std::vector<Byte> MakeGame(const unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        TestRomBuilder rom;
+        for (size_t index = 0; index < CHR_ROM_UNIT_SIZE; ++index) {
+            rom.GetChr()[index] = (rng() % 3) ? rng() : 0;
+        }
+        for (size_t index = 0; index < OAM_SIZE; ++index) {
+            rom.GetPrg()[0x1000 + index] = rng(); // Sprites at $9000
+        }
+
+        rom.Emit({ 0x78, 0xD8, 0xA2, 0xFF, 0x9A, 0xA9, 0x40, 0x8D, 0x17, 0x40 });
+        for (int wait = 0; wait < 2; ++wait) {
+            rom.Emit({ 0x2C, 0x02, 0x20, 0x10, 0xFB });
+        }
+        rom.Emit({ 0xA2, 0x00, 0xBD, 0x00, 0x90, 0x9D, 0x00, 0x02, 0xE8, 0xD0, 0xF7 });
+        rom.Emit({ 0xA9, 0x02, 0x8D, 0x14, 0x40 });
+        const int control = 0x80 | (rng() % 2 ? 0x20 : 0) | (rng() % 2 ? 0x08 : 0);
+        rom.Emit({ 0xA9, control, 0x8D, 0x00, 0x20, 0xA9, static_cast<int>(rng() % 3 ? 0x1E : 0x00), 0x8D, 0x01, 0x20 });
+
+        const int mode = rng() % 3;
+        if (mode == 0) {
+            rom.EmitJump(rom.GetAddress());
+        }
+        const Address mainLoop = rom.GetAddress();
+        while (rom.GetOffset() < 0x0E00) {
+            const int kind = rng() % 10;
+            if (kind < 3) {
+                rom.Emit({ 0xA5, 0x10, 0xC5, 0x10, 0xF0, 0xFC }); // Wait for the NMI counter
+            } else if (kind < 4) {
+                rom.Emit({ 0xAD, 0x02, 0x20, 0x10, 0xFB }); // LDA $2002 / BPL
+            } else if (kind < 5) {
+                rom.Emit({ 0xA0, static_cast<int>(rng() % 100), 0x2C, 0x02, 0x20, 0x70, 0x03, 0x88, 0xD0, 0xF8 }); // Sprite 0 with a timeout
+            } else if (kind < 6) {
+                rom.Emit({ 0xA2, static_cast<int>(rng() % 8), 0xB5, 0x10, 0xF0, 0xFC }); // LDA $10,X / BEQ
+            } else if (kind < 8) {
+                rom.Emit({ 0xA0, static_cast<int>(rng() % 40), 0x88, 0xD0, 0xFD });
+            } else if (kind < 9) {
+                rom.Emit({ 0xE6, static_cast<int>(0x18 + rng() % 8), 0xA5, 0x11, 0x85, static_cast<int>(0x30 + rng() % 16) });
+            } else {
+                rom.Emit({ 0xA9, static_cast<int>(rng() & 0xFF), 0x8D, 0x05, 0x20 });
+            }
+            if (mode == 2 && rng() % 20 == 0) {
+                rom.Emit({ 0x58, 0x78 });
+            }
+        }
+        rom.EmitJump(mainLoop);
+
+        const Address nmiHandler = rom.GetAddress();
+        rom.Emit({ 0x48, 0xE6, 0x10, 0xAD, 0x02, 0x20, 0x85, 0x11, 0xA9, 0x02, 0x8D, 0x14, 0x40 });
+        for (int index = 0; index < 4; ++index) {
+            rom.Emit({ 0xA9, static_cast<int>(rng() % 8), 0x95, 0x10 + index });
+        }
+        rom.Emit({ 0x68, 0x40 });
+        rom.SetVector(0xFFFA, nmiHandler);
+        rom.SetVector(0xFFFC, PRG_ROM_UNIT.first);
+        rom.SetVector(0xFFFE, nmiHandler);
+        return rom.GetImage();
+    }
+
+    bool CheckGames(const Options& options)
+    {
+        double referenceSeconds = 0.0;
+        double skippingSeconds = 0.0;
+        uint64_t skippedCycles = 0;
+        uint64_t totalCycles = 0;
+        for (int seed = 0; seed < options.games; ++seed) {
+            const std::vector<Byte> image = MakeGame(seed);
+            Cartridge cartridge;
+            if (!cartridge.LoadFromData(image.data(), image.size())) {
+                std::printf("games: seed %d did not load\n", seed);
+                return false;
+            }
+
+            System reference;
+            System skipping;
+            reference.InsertCartridge(cartridge);
+            skipping.InsertCartridge(cartridge);
+            reference.GetCPU().SetIdleLoopSkipping(false);
+            reference.Reset();
+            skipping.Reset();
+
+            for (int frame = 0; frame < GAME_FRAMES; ++frame) {
+                const auto start = std::chrono::steady_clock::now();
+                reference.RunFrame();
+                const auto middle = std::chrono::steady_clock::now();
+                skipping.RunFrame();
+                const auto end = std::chrono::steady_clock::now();
+                referenceSeconds += std::chrono::duration<double>(middle - start).count();
+                skippingSeconds += std::chrono::duration<double>(end - middle).count();
+
+                if (!IsSameState(reference.GetCPU(), reference.GetBus(), skipping.GetCPU(), skipping.GetBus())
+                    || reference.GetPPU().GetScanline() != skipping.GetPPU().GetScanline()
+                    || reference.GetPPU().GetDot() != skipping.GetPPU().GetDot()) {
+                    std::printf("games: seed %d diverged in frame %d\n", seed, frame);
+                    return false;
+                }
+            }
+            skippedCycles += skipping.GetCPU().GetIdleCyclesSkipped();
+            totalCycles += skipping.GetCPU().GetTotalCycles();
+        }
+        std::printf("games: %d passed, %.1f%% of cycles skipped, %.2fx faster\n", options.games,
+                    totalCycles ? 100.0 * skippedCycles / totalCycles : 0.0,
+                    skippingSeconds > 0.0 ? referenceSeconds / skippingSeconds : 0.0);
+        return true;
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        for (int index = 1; index < argc; ++index) {
+            const std::string argument = argv[index];
+            if (argument == "--kernels" && index + 1 < argc) {
+                options.kernels = std::atoi(argv[++index]);
+            } else if (argument == "--games" && index + 1 < argc) {
+                options.games = std::atoi(argv[++index]);
+            } else {
+                std::fprintf(stderr, "Usage: %s [--kernels N] [--games N]\n", argv[0]);
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        return 1;
+    }
+    const bool isPassed = CheckKernels(options);
+    return isPassed && CheckGames(options) ? 0 : 1;
+}
@@ -0,0 +1,133 @@
+// Differential check for the x86-64 JIT.
+//
+// Runs random programs (see MakeTestProgram(), which mixes in instructions the JIT
+// does not compile) on two CPUs, one with a JitCompiler connected. After every random
+// timeslice the registers, cycle counts, RAM and device accesses must match. Now and
+// then both swap the bank at $C000 for another one, so compiled blocks and rejected
+// starts have to be dropped on the page generation change.
+//
+// On hosts without JIT support the check passes trivially.
+//
+// Usage: JitCheck [--seeds N]
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../include/Bus.hpp"
+#include "../include/CPU.hpp"
+#include "../include/Jit.hpp"
+#include "TestPrograms.hpp"
+
+namespace {
+    constexpr size_t BANK_SIZE = 0x4000;
+    constexpr Address SWITCHED_BANK = 0xC000;
+    constexpr int TIMESLICES = 3000;
+    constexpr int BANK_SWITCH_CHANCE = 50; // One timeslice in this many
+
+    struct Options {
+        int seeds = 200;
+    };
+
+    struct Machine {
+        Bus bus;
+        CPU cpu;
+        CountingDevice device;
+
+        Machine(const std::vector<Byte>& program, const std::vector<Byte>& ram)
+        {
+            bus.MapReadOnlyMemory(TEST_PROGRAM_START, TEST_PROGRAM_END, program.data(), program.size());
+            bus.MapDevice(0x2000, 0x3FFF, &device);
+            std::memcpy(bus.GetRam(), ram.data(), ram.size());
+            cpu.ConnectBus(&bus);
+
+            CPUState state{};
+            state.programCounter = TEST_PROGRAM_START;
+            state.stackPointer = 0xFD;
+            state.statusRegister = 0x24;
+            cpu.RestoreState(state);
+        }
+    };
+
+    bool IsSameState(const Machine& a, const Machine& b)
+    {
+        CPUState stateA;
+        CPUState stateB;
+        a.cpu.CaptureState(stateA);
+        b.cpu.CaptureState(stateB);
+        return stateA.totalCycles == stateB.totalCycles && stateA.programCounter == stateB.programCounter
+            && stateA.accumulator == stateB.accumulator && stateA.x == stateB.x && stateA.y == stateB.y
+            && stateA.stackPointer == stateB.stackPointer && stateA.statusRegister == stateB.statusRegister
+            && std::memcmp(a.bus.GetRam(), b.bus.GetRam(), MEMORY_SIZE) == 0 && a.device == b.device;
+    }
+
+    bool Check(const Options& options)
+    {
+        uint64_t blocksCompiled = 0;
+        for (int seed = 0; seed < options.seeds; ++seed) {
+            std::mt19937 rng(seed);
+            const std::vector<Byte> program = MakeTestProgram(rng);
+            const std::vector<Byte> otherBanks = MakeTestProgram(rng);
+            std::vector<Byte> ram(MEMORY_SIZE);
+            for (Byte& data : ram) {
+                data = rng();
+            }
+
+            Machine reference(program, ram);
+            Machine compiled(program, ram);
+            JitCompiler jit(compiled.bus);
+            compiled.cpu.ConnectJit(&jit);
+
+            bool isSwitched = false;
+            for (int timeslice = 0; timeslice < TIMESLICES; ++timeslice) {
+                if (rng() % BANK_SWITCH_CHANCE == 0) {
+                    isSwitched = !isSwitched;
+                    const Byte* bank = (isSwitched ? otherBanks : program).data() + BANK_SIZE;
+                    reference.bus.MapReadOnlyMemory(SWITCHED_BANK, TEST_PROGRAM_END, bank, BANK_SIZE);
+                    compiled.bus.MapReadOnlyMemory(SWITCHED_BANK, TEST_PROGRAM_END, bank, BANK_SIZE);
+                }
+
+                const uint64_t cycles = 1 + rng() % 3000;
+                reference.cpu.RunCycles(cycles);
+                compiled.cpu.RunCycles(cycles);
+                if (!IsSameState(reference, compiled)) {
+                    std::printf("seed %d diverged in timeslice %d\n", seed, timeslice);
+                    return false;
+                }
+            }
+            blocksCompiled += jit.GetBlocksCompiled();
+        }
+        std::printf("%d programs passed, %llu blocks compiled\n", options.seeds, static_cast<unsigned long long>(blocksCompiled));
+        return true;
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        for (int index = 1; index < argc; ++index) {
+            const std::string argument = argv[index];
+            if (argument == "--seeds" && index + 1 < argc) {
+                options.seeds = std::atoi(argv[++index]);
+            } else {
+                std::fprintf(stderr, "Usage: %s [--seeds N]\n", argv[0]);
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        return 1;
+    }
+    if (!JitCompiler::IsSupported()) {
+        std::printf("JIT not supported on this host, nothing to check\n");
+        return 0;
+    }
+    return Check(options) ? 0 : 1;
+}
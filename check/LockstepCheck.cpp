@@ -0,0 +1,163 @@
+// Differential check for LockstepCPU against the scalar CPU.
+//
+// Every lane of a LockstepCPU runs the same random program (see MakeTestProgram())
+// next to its own scalar CPU. Lanes start from different RAM, registers and cycle
+// counts, so they diverge on branches and regroup; each has its own device on its
+// lane Bus, and single lanes take NMIs and IRQs now and then. After every random
+// timeslice each lane's registers, cycles, RAM and device accesses must match its
+// scalar twin. Runs with 8, 16 and 32 lanes.
+//
+// Usage: LockstepCheck [--seeds N]
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../include/Bus.hpp"
+#include "../include/CPU.hpp"
+#include "../include/LockstepCPU.hpp"
+#include "../include/SaveState.hpp"
+#include "TestPrograms.hpp"
+
+namespace {
+    constexpr int TIMESLICES = 300;
+    constexpr int INTERRUPT_CHANCE = 10; // One timeslice in this many, for each kind
+
+    struct Options {
+        int seeds = 50;
+    };
+
+    struct ScalarLane {
+        Bus bus;
+        CPU cpu;
+        CountingDevice device;
+
+        explicit ScalarLane(const std::vector<Byte>& program)
+        {
+            bus.MapReadOnlyMemory(TEST_PROGRAM_START, TEST_PROGRAM_END, program.data(), program.size());
+            bus.MapDevice(0x2000, 0x3FFF, &device);
+            cpu.ConnectBus(&bus);
+        }
+    };
+
+    // The lockstep side keeps RAM itself, so its lane Buses only hold the device
+    struct LaneIo {
+        Bus bus;
+        CountingDevice device;
+
+        LaneIo() { bus.MapDevice(0x2000, 0x3FFF, &device); }
+    };
+
+    template <size_t Lanes>
+    bool IsSameLane(const size_t lane, const LockstepCPU<Lanes>& lockstep, const ScalarLane& scalar, const LaneIo& io)
+    {
+        CPUState expected;
+        scalar.cpu.CaptureState(expected);
+        SaveState actual;
+        lockstep.StoreLane(lane, actual);
+        return expected.totalCycles == actual.cpu.totalCycles && expected.programCounter == actual.cpu.programCounter
+            && expected.accumulator == actual.cpu.accumulator && expected.x == actual.cpu.x && expected.y == actual.cpu.y
+            && expected.stackPointer == actual.cpu.stackPointer && expected.statusRegister == actual.cpu.statusRegister
+            && std::memcmp(scalar.bus.GetRam(), actual.ram.data(), MEMORY_SIZE) == 0 && scalar.device == io.device;
+    }
+
+    template <size_t Lanes>
+    bool Check(const Options& options)
+    {
+        uint64_t groups = 0;
+        uint64_t laneInstructions = 0;
+        for (int seed = 0; seed < options.seeds; ++seed) {
+            std::mt19937 rng(seed);
+            const std::vector<Byte> program = MakeTestProgram(rng);
+
+            std::unique_ptr<LockstepCPU<Lanes>> lockstep = std::make_unique<LockstepCPU<Lanes>>();
+            lockstep->MapProgram(program.data(), program.size());
+            std::vector<std::unique_ptr<ScalarLane>> scalars;
+            std::vector<std::unique_ptr<LaneIo>> ios;
+            for (size_t lane = 0; lane < Lanes; ++lane) {
+                scalars.push_back(std::make_unique<ScalarLane>(program));
+                ios.push_back(std::make_unique<LaneIo>());
+                ScalarLane& scalar = *scalars.back();
+
+                // A quarter of the lanes share one RAM pattern and start in step
+                const bool isShared = rng() % 4 == 0;
+                for (Address address = 0; address < MEMORY_SIZE; ++address) {
+                    scalar.bus.GetRam()[address] = isShared ? static_cast<Byte>(address * 13) : static_cast<Byte>(rng());
+                }
+                CPUState state{};
+                state.programCounter = TEST_PROGRAM_START;
+                state.stackPointer = 0xFD;
+                state.statusRegister = 0x24;
+                state.accumulator = rng();
+                state.x = isShared ? 0x00 : rng();
+                state.totalCycles = rng() % 5;
+                scalar.cpu.RestoreState(state);
+
+                SaveState saveState;
+                saveState.Capture(scalar.cpu, scalar.bus);
+                lockstep->LoadLane(lane, saveState);
+                lockstep->ConnectLaneBus(lane, &ios.back()->bus);
+            }
+
+            for (int timeslice = 0; timeslice < TIMESLICES; ++timeslice) {
+                if (rng() % INTERRUPT_CHANCE == 0) {
+                    const size_t lane = rng() % Lanes;
+                    scalars[lane]->cpu.NonMaskableInterrupt();
+                    scalars[lane]->cpu.RunCycles(0);
+                    lockstep->NonMaskableInterrupt(lane);
+                }
+                if (rng() % INTERRUPT_CHANCE == 0) {
+                    const size_t lane = rng() % Lanes;
+                    scalars[lane]->cpu.InterruptRequest();
+                    scalars[lane]->cpu.RunCycles(0);
+                    lockstep->InterruptRequest(lane);
+                }
+
+                const uint64_t cycles = 1 + rng() % 3000;
+                for (std::unique_ptr<ScalarLane>& scalar : scalars) {
+                    scalar->cpu.RunCycles(cycles);
+                }
+                lockstep->RunCycles(cycles);
+
+                for (size_t lane = 0; lane < Lanes; ++lane) {
+                    if (!IsSameLane(lane, *lockstep, *scalars[lane], *ios[lane])) {
+                        std::printf("%zu lanes: seed %d lane %zu diverged in timeslice %d\n", Lanes, seed, lane, timeslice);
+                        return false;
+                    }
+                }
+            }
+            groups += lockstep->GetGroupsExecuted();
+            laneInstructions += lockstep->GetLaneInstructionsExecuted();
+        }
+        std::printf("%zu lanes: %d programs passed, %.2f lanes per group\n", Lanes, options.seeds,
+                    groups ? static_cast<double>(laneInstructions) / groups : 0.0);
+        return true;
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        for (int index = 1; index < argc; ++index) {
+            const std::string argument = argv[index];
+            if (argument == "--seeds" && index + 1 < argc) {
+                options.seeds = std::atoi(argv[++index]);
+            } else {
+                std::fprintf(stderr, "Usage: %s [--seeds N]\n", argv[0]);
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        return 1;
+    }
+    return Check<8>(options) && Check<16>(options) && Check<32>(options) ? 0 : 1;
+}
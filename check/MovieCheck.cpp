@@ -0,0 +1,204 @@
+// Round-trip check for input movies.
+//
+// Records random controller input on a generated game that reads both ports every
+// frame and folds the bits into RAM, with idle-loop skipping off and every frame
+// drawn. Then:
+//
+//   * plays it back with the defaults and frame skipping on, which must reach the
+//     end with every frame's state hash matching;
+//   * plays a copy with one input byte flipped, which must report a divergence;
+//   * plays a truncated copy, which must fail at the cut;
+//   * opens it on a system that has already run a frame, which must be refused.
+//
+// Usage: MovieCheck [--frames N] [--path FILE]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../include/Movie.hpp"
+#include "../include/System.hpp"
+#include "TestRoms.hpp"
+
+namespace {
+    constexpr int INPUT_CHANGE_CHANCE = 30; // Frames between input changes, on average
+
+    struct Options {
+        uint64_t frames = 20000;
+        std::string path = "MovieCheck.nesm";
+    };
+
+    // NMI: strobe the controllers, shift in eight bits from each port, and fold both
+    // bytes into a running sum at $22 and a history at $0300.
+    std::vector<Byte> MakeGame()
+    {
+        TestRomBuilder rom;
+        rom.Emit({ 0x78, 0xD8, 0xA2, 0xFF, 0x9A, 0xA9, 0x40, 0x8D, 0x17, 0x40 });
+        for (int wait = 0; wait < 2; ++wait) {
+            rom.Emit({ 0x2C, 0x02, 0x20, 0x10, 0xFB });
+        }
+        rom.Emit({ 0xA9, 0x80, 0x8D, 0x00, 0x20, 0xA9, 0x1E, 0x8D, 0x01, 0x20 });
+        rom.EmitJump(rom.GetAddress());
+
+        const Address nmiHandler = rom.GetAddress();
+        rom.Emit({ 0x48, 0xA9, 0x01, 0x8D, 0x16, 0x40, 0xA9, 0x00, 0x8D, 0x16, 0x40 });
+        rom.Emit({ 0xA2, 0x08, 0xAD, 0x16, 0x40, 0x4A, 0x26, 0x20, 0xAD, 0x17, 0x40, 0x4A, 0x26, 0x21, 0xCA, 0xD0, 0xF1 });
+        rom.Emit({ 0xA5, 0x22, 0x18, 0x65, 0x20, 0x45, 0x21, 0x85, 0x22, 0xA6, 0x23, 0xA5, 0x20, 0x9D, 0x00, 0x03, 0xE6, 0x23, 0x68, 0x40 });
+        rom.SetVector(0xFFFA, nmiHandler);
+        rom.SetVector(0xFFFC, PRG_ROM_UNIT.first);
+        rom.SetVector(0xFFFE, PRG_ROM_UNIT.first);
+        return rom.GetImage();
+    }
+
+    bool Record(const Cartridge& cartridge, const Options& options)
+    {
+        System system;
+        system.InsertCartridge(cartridge);
+        system.GetCPU().SetIdleLoopSkipping(false);
+        system.Reset();
+
+        MovieRecorder recorder(system);
+        if (!recorder.Open(options.path.c_str())) {
+            std::printf("record: cannot create %s\n", options.path.c_str());
+            return false;
+        }
+        std::mt19937 rng(1);
+        Byte port1 = 0x00;
+        Byte port2 = 0x00;
+        for (uint64_t frame = 0; frame < options.frames; ++frame) {
+            if (rng() % INPUT_CHANGE_CHANCE == 0) {
+                port1 = rng();
+                port2 = rng();
+            }
+            if (!recorder.RunFrame(port1, port2)) {
+                std::printf("record: write failed in frame %llu\n", static_cast<unsigned long long>(frame));
+                return false;
+            }
+        }
+        if (!recorder.Close()) {
+            std::printf("record: close failed\n");
+            return false;
+        }
+        return true;
+    }
+
+    bool Play(const Cartridge& cartridge, const char* path, const bool shouldRunFrame, MovieStatus::Status& status, uint64_t& frames, double& seconds)
+    {
+        System system;
+        system.InsertCartridge(cartridge);
+        system.Reset();
+        if (shouldRunFrame) {
+            system.RunFrame();
+        }
+
+        MoviePlayer player(system);
+        if (!player.Open(path)) {
+            return false;
+        }
+        const auto start = std::chrono::steady_clock::now();
+        status = player.Play();
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        frames = player.GetFrameCount();
+        return true;
+    }
+
+    std::vector<Byte> ReadFile(const std::string& path)
+    {
+        std::vector<Byte> data;
+        if (std::FILE* file = std::fopen(path.c_str(), "rb")) {
+            Byte buffer[4096];
+            size_t count;
+            while ((count = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+                data.insert(data.end(), buffer, buffer + count);
+            }
+            std::fclose(file);
+        }
+        return data;
+    }
+
+    bool WriteFile(const std::string& path, const std::vector<Byte>& data)
+    {
+        std::FILE* file = std::fopen(path.c_str(), "wb");
+        if (file == nullptr) {
+            return false;
+        }
+        const bool isWritten = std::fwrite(data.data(), 1, data.size(), file) == data.size();
+        return std::fclose(file) == 0 && isWritten;
+    }
+
+    bool Check(const Options& options)
+    {
+        const std::vector<Byte> image = MakeGame();
+        Cartridge cartridge;
+        if (!cartridge.LoadFromData(image.data(), image.size()) || !Record(cartridge, options)) {
+            return false;
+        }
+        const std::vector<Byte> movie = ReadFile(options.path);
+
+        MovieStatus::Status status = MovieStatus::Failed;
+        uint64_t frames = 0;
+        double seconds = 0.0;
+        if (!Play(cartridge, options.path.c_str(), false, status, frames, seconds)
+            || status != MovieStatus::Finished || frames != options.frames) {
+            std::printf("replay: status %d after %llu frames\n", status, static_cast<unsigned long long>(frames));
+            return false;
+        }
+        std::printf("replay: %llu frames matched, %.2f bytes a frame, %.0f frames/s\n", static_cast<unsigned long long>(frames),
+                    static_cast<double>(movie.size()) / options.frames, seconds > 0.0 ? frames / seconds : 0.0);
+
+        // The first run's buttons, once the game has started reading them
+        std::vector<Byte> mutated = movie;
+        mutated[sizeof(MovieFileHeader) + 1] ^= ControllerButtons::Start;
+        if (!WriteFile(options.path, mutated) || !Play(cartridge, options.path.c_str(), false, status, frames, seconds)
+            || status != MovieStatus::Diverged) {
+            std::printf("mutated: status %d, expected a divergence\n", status);
+            return false;
+        }
+        std::printf("mutated: diverged in frame %llu\n", static_cast<unsigned long long>(frames));
+
+        const std::vector<Byte> truncated(movie.begin(), movie.begin() + movie.size() / 2);
+        if (!WriteFile(options.path, truncated) || !Play(cartridge, options.path.c_str(), false, status, frames, seconds)
+            || status != MovieStatus::Failed) {
+            std::printf("truncated: status %d, expected a failure\n", status);
+            return false;
+        }
+        std::printf("truncated: failed in frame %llu\n", static_cast<unsigned long long>(frames));
+
+        if (!WriteFile(options.path, movie) || Play(cartridge, options.path.c_str(), true, status, frames, seconds)) {
+            std::printf("wrong start: the movie was accepted\n");
+            return false;
+        }
+        std::printf("wrong start: refused\n");
+        return true;
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        for (int index = 1; index < argc; ++index) {
+            const std::string argument = argv[index];
+            if (argument == "--frames" && index + 1 < argc) {
+                options.frames = std::strtoull(argv[++index], nullptr, 10);
+            } else if (argument == "--path" && index + 1 < argc) {
+                options.path = argv[++index];
+            } else {
+                std::fprintf(stderr, "Usage: %s [--frames N] [--path FILE]\n", argv[0]);
+                return false;
+            }
+        }
+        return options.frames > 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        return 1;
+    }
+    const bool isPassed = Check(options);
+    std::remove(options.path.c_str());
+    return isPassed ? 0 : 1;
+}
@@ -0,0 +1,209 @@
+// Producer/consumer stress check for OutputPipeline.
+//
+// An emulation thread fills every frame with its own frame number and publishes it,
+// and writes a counting sequence of audio samples in chunks of random size. A
+// presentation thread acquires frames and reads samples in chunks of random size as
+// fast as it can. Both sides yield at random to shake up the interleaving.
+//
+// The consumer must only ever see whole frames whose numbers go up, and the samples
+// it reads must be exactly the ones the ring accepted, in order. Once both sides
+// are done, every published frame must have been presented or dropped, every sample
+// offered written or dropped, and the late frames and underruns must match what the
+// consumer saw.
+//
+// Usage: PipelineCheck [--frames N]
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../include/OutputPipeline.hpp"
+
+namespace {
+    constexpr size_t MAXIMUM_CHUNK = 1600; // A frame of samples at 96 kHz
+    constexpr int YIELD_CHANCE = 16;       // One step in this many yields
+
+    struct Options {
+        uint64_t frames = 20000;
+    };
+
+    struct ProducerResult {
+        uint64_t samplesOffered = 0;
+        uint64_t samplesAccepted = 0;
+    };
+
+    struct ConsumerResult {
+        bool isPassing = true;
+        uint64_t framesAcquired = 0;
+        uint64_t framesLate = 0;
+        uint64_t samplesRead = 0;
+        uint64_t underruns = 0;
+    };
+
+    void Produce(OutputPipeline& pipeline, const Options& options, ProducerResult& result, std::atomic<bool>& isDone)
+    {
+        std::mt19937 rng(1);
+        std::vector<int16_t> samples(MAXIMUM_CHUNK);
+        int16_t nextSample = 0;
+        Byte* frame = pipeline.GetBackBuffer();
+        for (uint64_t frameNumber = 1; frameNumber <= options.frames; ++frameNumber) {
+            std::fill(frame, frame + FRAME_SIZE, static_cast<Byte>(frameNumber));
+            frame = pipeline.PublishFrame();
+
+            // Only the samples the ring took are part of the sequence
+            const size_t count = rng() % (MAXIMUM_CHUNK + 1);
+            for (size_t index = 0; index < count; ++index) {
+                samples[index] = static_cast<int16_t>(nextSample + index);
+            }
+            const uint64_t writtenBefore = pipeline.GetStatistics().samplesWritten;
+            pipeline.WriteSamples(samples.data(), count);
+            const uint64_t accepted = pipeline.GetStatistics().samplesWritten - writtenBefore;
+            nextSample = static_cast<int16_t>(nextSample + accepted);
+            result.samplesOffered += count;
+            result.samplesAccepted += accepted;
+
+            if (rng() % YIELD_CHANCE == 0) {
+                std::this_thread::yield();
+            }
+        }
+        isDone.store(true, std::memory_order_release);
+    }
+
+    bool IsWholeFrame(const Byte* frame, const uint64_t frameNumber)
+    {
+        const Byte expected = static_cast<Byte>(frameNumber);
+        return std::all_of(frame, frame + FRAME_SIZE, [expected](const Byte pixel) { return pixel == expected; });
+    }
+
+    void Consume(OutputPipeline& pipeline, ConsumerResult& result, const std::atomic<bool>& isDone)
+    {
+        std::mt19937 rng(2);
+        std::vector<int16_t> samples(MAXIMUM_CHUNK);
+        int16_t nextSample = 0;
+        uint64_t lastFrameNumber = 0;
+        bool isFinalPass = false;
+        while (result.isPassing) {
+            // Once the producer is done, one more pass takes whatever it left behind
+            const bool isProducerDone = isDone.load(std::memory_order_acquire);
+
+            if (pipeline.AcquireFrame()) {
+                const uint64_t frameNumber = pipeline.GetFrontFrameNumber();
+                if (frameNumber <= lastFrameNumber || !IsWholeFrame(pipeline.GetFrontBuffer(), frameNumber)) {
+                    std::printf("frame %llu presented after frame %llu, or torn\n",
+                                static_cast<unsigned long long>(frameNumber), static_cast<unsigned long long>(lastFrameNumber));
+                    result.isPassing = false;
+                }
+                lastFrameNumber = frameNumber;
+                ++result.framesAcquired;
+            } else {
+                ++result.framesLate;
+            }
+
+            size_t count = rng() % (MAXIMUM_CHUNK + 1);
+            if (isFinalPass) {
+                count = pipeline.GetSamplesAvailable();
+                samples.resize(std::max(samples.size(), count));
+            }
+            const size_t samplesRead = pipeline.ReadSamples(samples.data(), count);
+            result.underruns += samplesRead < count ? 1 : 0;
+            for (size_t index = 0; index < samplesRead; ++index) {
+                if (samples[index] != nextSample) {
+                    std::printf("sample %llu is %d, expected %d\n", static_cast<unsigned long long>(result.samplesRead + index),
+                                samples[index], nextSample);
+                    result.isPassing = false;
+                    break;
+                }
+                ++nextSample;
+            }
+            result.samplesRead += samplesRead;
+
+            if (isFinalPass) {
+                break;
+            }
+            isFinalPass = isProducerDone;
+            if (rng() % YIELD_CHANCE == 0) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    bool Check(const Options& options)
+    {
+        std::unique_ptr<OutputPipeline> pipeline = std::make_unique<OutputPipeline>();
+        ProducerResult produced;
+        ConsumerResult consumed;
+        std::atomic<bool> isDone{ false };
+
+        std::thread consumer(Consume, std::ref(*pipeline), std::ref(consumed), std::cref(isDone));
+        std::thread producer(Produce, std::ref(*pipeline), std::cref(options), std::ref(produced), std::ref(isDone));
+        producer.join();
+        consumer.join();
+        if (!consumed.isPassing) {
+            return false;
+        }
+
+        const OutputStatistics statistics = pipeline->GetStatistics();
+        if (statistics.framesPublished != options.frames
+            || statistics.framesPresented != consumed.framesAcquired
+            || statistics.framesPresented + statistics.framesDropped != statistics.framesPublished
+            || statistics.framesLate != consumed.framesLate) {
+            std::printf("frames: %llu published, %llu presented, %llu dropped, %llu late; consumer took %llu and missed %llu\n",
+                        static_cast<unsigned long long>(statistics.framesPublished),
+                        static_cast<unsigned long long>(statistics.framesPresented),
+                        static_cast<unsigned long long>(statistics.framesDropped),
+                        static_cast<unsigned long long>(statistics.framesLate),
+                        static_cast<unsigned long long>(consumed.framesAcquired),
+                        static_cast<unsigned long long>(consumed.framesLate));
+            return false;
+        }
+        if (statistics.samplesWritten != produced.samplesAccepted
+            || statistics.samplesWritten + statistics.samplesDropped != produced.samplesOffered
+            || consumed.samplesRead != statistics.samplesWritten
+            || statistics.audioUnderruns != consumed.underruns) {
+            std::printf("samples: %llu offered, %llu written, %llu dropped, %llu read, %llu underruns\n",
+                        static_cast<unsigned long long>(produced.samplesOffered),
+                        static_cast<unsigned long long>(statistics.samplesWritten),
+                        static_cast<unsigned long long>(statistics.samplesDropped),
+                        static_cast<unsigned long long>(consumed.samplesRead),
+                        static_cast<unsigned long long>(statistics.audioUnderruns));
+            return false;
+        }
+
+        std::printf("%llu frames passed: %llu presented, %llu dropped; %llu samples, %llu dropped\n",
+                    static_cast<unsigned long long>(statistics.framesPublished),
+                    static_cast<unsigned long long>(statistics.framesPresented),
+                    static_cast<unsigned long long>(statistics.framesDropped),
+                    static_cast<unsigned long long>(statistics.samplesWritten),
+                    static_cast<unsigned long long>(statistics.samplesDropped));
+        return true;
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        for (int index = 1; index < argc; ++index) {
+            const std::string argument = argv[index];
+            if (argument == "--frames" && index + 1 < argc) {
+                options.frames = std::strtoull(argv[++index], nullptr, 10);
+            } else {
+                std::fprintf(stderr, "Usage: %s [--frames N]\n", argv[0]);
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        return 1;
+    }
+    return Check(options) ? 0 : 1;
+}
@@ -0,0 +1,141 @@
+// Check for ExecutionProfiler's attribution.
+//
+// Steps a short hand-assembled program under StepWith() and compares every counter
+// with the numbers worked out by hand: executions and cycles per opcode, page-cross
+// penalties on indexed reads, taken branches (one within a page, one across), the
+// addressing-mode and Program Counter counters, the cycle histogram and the hot spots.
+//
+// Usage: ProfilerCheck
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "../include/Bus.hpp"
+#include "../include/CPU.hpp"
+#include "../include/Profiler.hpp"
+
+namespace {
+    constexpr Address PROGRAM_START = 0x8000;
+    constexpr int STEPS = 31;
+
+    //   $8000  LDX #$05
+    //   $8002  LDA $02FE,X    crosses a page while X >= 2: four times out of five
+    //   $8005  DEX
+    //   $8006  BNE $8002      taken four times within the page
+    //   $8008  LDY #$03
+    //   $800A  LDA $0300,Y    no crossing
+    //   $800D  JMP $80FA
+    //   $80FA  LDA #$00
+    //   $80FC  BEQ $810E      taken across a page
+    //   $810E  JMP $810E      ten times
+    std::vector<Byte> MakeProgram()
+    {
+        std::vector<Byte> program(0x8000, 0xEA);
+        const Byte first[] = { 0xA2, 0x05, 0xBD, 0xFE, 0x02, 0xCA, 0xD0, 0xFA, 0xA0, 0x03, 0xB9, 0x00, 0x03, 0x4C, 0xFA, 0x80 };
+        const Byte second[] = { 0xA9, 0x00, 0xF0, 0x10 };
+        const Byte third[] = { 0x4C, 0x0E, 0x81 };
+        std::copy(first, first + sizeof(first), program.begin());
+        std::copy(second, second + sizeof(second), program.begin() + 0xFA);
+        std::copy(third, third + sizeof(third), program.begin() + 0x10E);
+        return program;
+    }
+
+    struct ExpectedOpcode {
+        Opcode opcode;
+        OpcodeProfile profile;
+    };
+
+    const ExpectedOpcode EXPECTED_OPCODES[] = {
+        { 0xA2, { 1, 2, 0, 0 } },
+        { 0xBD, { 5, 24, 4, 0 } },
+        { 0xCA, { 5, 10, 0, 0 } },
+        { 0xD0, { 5, 14, 0, 4 } },
+        { 0xA0, { 1, 2, 0, 0 } },
+        { 0xB9, { 1, 4, 0, 0 } },
+        { 0x4C, { 11, 33, 0, 0 } },
+        { 0xA9, { 1, 2, 0, 0 } },
+        { 0xF0, { 1, 4, 1, 1 } },
+    };
+
+    const uint64_t EXPECTED_HISTOGRAM[PROFILER_HISTOGRAM_BINS] = { 0, 0, 9, 15, 3, 4, 0, 0, 0 };
+
+    bool Expect(const char* what, const uint64_t actual, const uint64_t expected)
+    {
+        if (actual != expected) {
+            std::printf("%s: %llu, expected %llu\n", what, static_cast<unsigned long long>(actual),
+                        static_cast<unsigned long long>(expected));
+            return false;
+        }
+        return true;
+    }
+
+    bool Check()
+    {
+        const std::vector<Byte> program = MakeProgram();
+        Bus bus;
+        bus.MapReadOnlyMemory(PROGRAM_START, 0xFFFF, program.data(), program.size());
+        CPU cpu;
+        cpu.ConnectBus(&bus);
+        CPUState state{};
+        state.programCounter = PROGRAM_START;
+        state.stackPointer = 0xFD;
+        state.statusRegister = 0x24;
+        cpu.RestoreState(state);
+
+        ExecutionProfiler profiler;
+        uint64_t cycles = 0;
+        for (int step = 0; step < STEPS; ++step) {
+            cycles += cpu.StepWith(profiler);
+        }
+
+        bool isPassing = Expect("instructions", profiler.GetTotalInstructions(), STEPS)
+            && Expect("cycles", profiler.GetTotalCycles(), cycles)
+            && Expect("cycles", cycles, 95)
+            && Expect("page-cross penalties", profiler.GetTotalPageCrossPenalties(), 5)
+            && Expect("branches taken", profiler.GetTotalBranchesTaken(), 5);
+
+        char what[64];
+        for (const ExpectedOpcode& expected : EXPECTED_OPCODES) {
+            const OpcodeProfile& actual = profiler.GetOpcodeProfile(expected.opcode);
+            std::snprintf(what, sizeof(what), "opcode $%02X", expected.opcode);
+            isPassing = isPassing && Expect(what, actual.executions, expected.profile.executions)
+                && Expect(what, actual.cycles, expected.profile.cycles)
+                && Expect(what, actual.pageCrossPenalties, expected.profile.pageCrossPenalties)
+                && Expect(what, actual.branchesTaken, expected.profile.branchesTaken);
+        }
+
+        isPassing = isPassing && Expect("AbsoluteX executions", profiler.GetModeProfile(AddressingModes::AbsoluteX).executions, 5)
+            && Expect("AbsoluteX cycles", profiler.GetModeProfile(AddressingModes::AbsoluteX).cycles, 24)
+            && Expect("Relative executions", profiler.GetModeProfile(AddressingModes::Relative).executions, 6)
+            && Expect("Relative cycles", profiler.GetModeProfile(AddressingModes::Relative).cycles, 18)
+            && Expect("$8002 executions", profiler.GetProgramCounterProfile(0x8002).executions, 5)
+            && Expect("$8002 cycles", profiler.GetProgramCounterProfile(0x8002).cycles, 24)
+            && Expect("$810E cycles", profiler.GetProgramCounterProfile(0x810E).cycles, 30);
+
+        for (uint8_t bin = 0; bin < PROFILER_HISTOGRAM_BINS; ++bin) {
+            std::snprintf(what, sizeof(what), "%u-cycle instructions", bin);
+            isPassing = isPassing && Expect(what, profiler.GetHistogramBin(bin), EXPECTED_HISTOGRAM[bin]);
+        }
+
+        const std::vector<HotSpot> hotSpots = profiler.GetHotSpots(3);
+        isPassing = isPassing && Expect("hot spots", hotSpots.size(), 3)
+            && Expect("hottest", hotSpots[0].programCounter, 0x810E)
+            && Expect("second hottest", hotSpots[1].programCounter, 0x8002)
+            && Expect("third hottest", hotSpots[2].programCounter, 0x8006);
+
+        profiler.Reset();
+        isPassing = isPassing && Expect("instructions after Reset()", profiler.GetTotalInstructions(), 0)
+            && Expect("$8002 executions after Reset()", profiler.GetProgramCounterProfile(0x8002).executions, 0);
+
+        if (isPassing) {
+            std::printf("%d instructions attributed as expected\n", STEPS);
+        }
+        return isPassing;
+    }
+}
+
+int main()
+{
+    return Check() ? 0 : 1;
+}
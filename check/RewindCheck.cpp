@@ -0,0 +1,211 @@
+// Round-trip check for RewindBuffer.
+//
+// A CPU runs a random program (see MakeTestProgram()) and its SaveState is pushed
+// after every random timeslice. Some frames have every other byte flipped, the worst
+// case for the delta encoding. Now and then a few frames are popped, must match the
+// states that were pushed, and the CPU carries on from the last one. Buffer sizes,
+// arena sizes and keyframe intervals are random, so the oldest groups are dropped
+// all the time.
+//
+// Then 60 seconds of frames, from the program and worst-case, must all fit under 64 MB,
+// and popping them must take under a millisecond per frame.
+//
+// Usage: RewindCheck [--seeds N]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../include/Bus.hpp"
+#include "../include/CPU.hpp"
+#include "../include/Rewind.hpp"
+#include "../include/SaveState.hpp"
+#include "TestPrograms.hpp"
+
+namespace {
+    constexpr int OPERATIONS = 2000;
+    constexpr int POP_CHANCE = 8;         // One operation in this many rewinds
+    constexpr int ADVERSARIAL_CHANCE = 4; // One pushed frame in this many
+    constexpr size_t MAXIMUM_POPS = 40;
+    constexpr size_t STATE_SIZE = SaveState::GetSize();
+    constexpr size_t HEADER_SIZE = 8; // magic, version and size stay intact
+
+    constexpr size_t FRAMES_PER_MINUTE = 60 * 60;
+    constexpr size_t MEMORY_BOUND = 64 * 1024 * 1024;
+    constexpr double STEP_BOUND_US = 1000.0;
+
+    struct Options {
+        int seeds = 100;
+    };
+
+    struct Machine {
+        Bus bus;
+        CPU cpu;
+        CountingDevice device;
+
+        explicit Machine(const std::vector<Byte>& program)
+        {
+            bus.MapReadOnlyMemory(TEST_PROGRAM_START, TEST_PROGRAM_END, program.data(), program.size());
+            bus.MapDevice(0x2000, 0x3FFF, &device);
+            cpu.ConnectBus(&bus);
+
+            CPUState state{};
+            state.programCounter = TEST_PROGRAM_START;
+            state.stackPointer = 0xFD;
+            state.statusRegister = 0x24;
+            cpu.RestoreState(state);
+        }
+    };
+
+    // Alternating changed and unchanged bytes: three delta bytes for every two
+    // state bytes if it were stored as a delta
+    void FlipEveryOtherByte(SaveState& state, std::mt19937& rng)
+    {
+        Byte* data = reinterpret_cast<Byte*>(&state);
+        for (size_t index = HEADER_SIZE; index < STATE_SIZE; index += 2) {
+            data[index] ^= static_cast<Byte>(1 + rng() % 255);
+        }
+    }
+
+    bool Check(const Options& options)
+    {
+        for (int seed = 0; seed < options.seeds; ++seed) {
+            std::mt19937 rng(seed);
+            const std::vector<Byte> program = MakeTestProgram(rng);
+            Machine machine(program);
+
+            const size_t maximumFrames = 1 + rng() % 400;
+            const size_t arenaSize = rng() % 2 == 0 ? 0 : rng() % (maximumFrames * STATE_SIZE);
+            const size_t keyframeInterval = 1 + rng() % 60;
+            RewindBuffer rewind(maximumFrames, arenaSize, keyframeInterval);
+            std::deque<SaveState> pushed;
+
+            for (int operation = 0; operation < OPERATIONS; ++operation) {
+                if (rng() % POP_CHANCE == 0 && !pushed.empty()) {
+                    const size_t pops = 1 + rng() % MAXIMUM_POPS;
+                    for (size_t pop = 0; pop < pops && !pushed.empty(); ++pop) {
+                        SaveState state;
+                        if (!rewind.Pop(state) || std::memcmp(&state, &pushed.back(), STATE_SIZE) != 0) {
+                            std::printf("seed %d: frame %zu from the end differs at operation %d\n", seed, pop, operation);
+                            return false;
+                        }
+                        pushed.pop_back();
+                    }
+                    if (!pushed.empty() && !pushed.back().Restore(machine.cpu, machine.bus)) {
+                        std::printf("seed %d: popped state does not restore at operation %d\n", seed, operation);
+                        return false;
+                    }
+                    continue;
+                }
+
+                machine.cpu.RunCycles(1 + rng() % 3000);
+                SaveState state;
+                state.Capture(machine.cpu, machine.bus);
+                if (rng() % ADVERSARIAL_CHANCE == 0) {
+                    FlipEveryOtherByte(state, rng);
+                }
+                rewind.Push(state);
+                pushed.push_back(state);
+
+                // Dropping frames may only ever take the oldest ones
+                const size_t count = rewind.GetFrameCount();
+                if (count == 0 || count > maximumFrames || count > pushed.size()) {
+                    std::printf("seed %d: %zu frames held after %zu pushes\n", seed, count, pushed.size());
+                    return false;
+                }
+                pushed.erase(pushed.begin(), pushed.end() - count);
+            }
+
+            while (!pushed.empty()) {
+                SaveState state;
+                if (!rewind.Pop(state) || std::memcmp(&state, &pushed.back(), STATE_SIZE) != 0) {
+                    std::printf("seed %d: frame %zu differs while draining\n", seed, pushed.size());
+                    return false;
+                }
+                pushed.pop_back();
+            }
+            SaveState state;
+            if (rewind.Pop(state)) {
+                std::printf("seed %d: drained buffer still pops a frame\n", seed);
+                return false;
+            }
+        }
+        std::printf("%d seeds passed\n", options.seeds);
+        return true;
+    }
+
+    // A minute of frames must all fit, even when none of them compress and each takes
+    // a keyframe-sized entry, and stepping back through them must stay well under a
+    // frame.
+    bool CheckMinute(const bool isWorstCase)
+    {
+        const char* name = isWorstCase ? "worst-case" : "program";
+        std::mt19937 rng(0);
+        const std::vector<Byte> program = MakeTestProgram(rng);
+        Machine machine(program);
+        RewindBuffer rewind(FRAMES_PER_MINUTE, FRAMES_PER_MINUTE * STATE_SIZE, 60);
+
+        std::vector<SaveState> pushed(FRAMES_PER_MINUTE);
+        for (SaveState& state : pushed) {
+            machine.cpu.RunCycles(29781);
+            state.Capture(machine.cpu, machine.bus);
+            if (isWorstCase) {
+                FlipEveryOtherByte(state, rng);
+            }
+            rewind.Push(state);
+        }
+        if (rewind.GetFrameCount() != FRAMES_PER_MINUTE || rewind.GetMemoryUsage() >= MEMORY_BOUND) {
+            std::printf("60 s of %s frames: %zu frames held in %zu bytes\n", name, rewind.GetFrameCount(),
+                        rewind.GetMemoryUsage());
+            return false;
+        }
+
+        double totalUs = 0.0;
+        double slowestUs = 0.0;
+        for (size_t frame = FRAMES_PER_MINUTE; frame-- > 0;) {
+            const auto stepStart = std::chrono::steady_clock::now();
+            SaveState state;
+            const bool isPopped = rewind.Pop(state);
+            const double stepUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - stepStart).count();
+            totalUs += stepUs;
+            slowestUs = stepUs > slowestUs ? stepUs : slowestUs;
+            if (!isPopped || std::memcmp(&state, &pushed[frame], STATE_SIZE) != 0) {
+                std::printf("60 s of %s frames: frame %zu differs\n", name, frame);
+                return false;
+            }
+        }
+        const double averageUs = totalUs / FRAMES_PER_MINUTE;
+
+        std::printf("60 s of %s frames in %.1f MB, rewind step %.2f us average, %.2f us slowest\n",
+                    name, rewind.GetMemoryUsage() / (1024.0 * 1024.0), averageUs, slowestUs);
+        return averageUs < STEP_BOUND_US;
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        for (int index = 1; index < argc; ++index) {
+            const std::string argument = argv[index];
+            if (argument == "--seeds" && index + 1 < argc) {
+                options.seeds = std::atoi(argv[++index]);
+            } else {
+                std::fprintf(stderr, "Usage: %s [--seeds N]\n", argv[0]);
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        return 1;
+    }
+    return Check(options) && CheckMinute(false) && CheckMinute(true) ? 0 : 1;
+}
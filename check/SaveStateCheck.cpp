@@ -0,0 +1,192 @@
+// Round-trip check for SaveState.
+//
+// A CPU runs a random program (see MakeTestProgram()) for a random time and its
+// state is written out as a blob. The machine runs on, and the blob is then loaded
+// back both into it and into a second machine that has been running elsewhere and
+// decodes through a decode cache. Both must then run to exactly the state and device
+// accesses of the first run. This is repeated a few times per seed; the program
+// jumps into RAM, so a restore that leaves decoded RAM code current shows up as a
+// divergence.
+//
+// Blobs with a wrong magic, version or size field, or of the wrong length, must be
+// refused, and restoring a refused state must leave the machine untouched.
+//
+// Usage: SaveStateCheck [--seeds N]
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../include/Bus.hpp"
+#include "../include/CPU.hpp"
+#include "../include/DecodeCache.hpp"
+#include "../include/SaveState.hpp"
+#include "TestPrograms.hpp"
+
+namespace {
+    constexpr size_t STATE_SIZE = SaveState::GetSize();
+    constexpr int ROUNDS = 8;
+    constexpr uint64_t MAXIMUM_CYCLES = 100000;
+
+    struct Options {
+        int seeds = 100;
+    };
+
+    struct Machine {
+        Bus bus;
+        CPU cpu;
+        CountingDevice device;
+
+        explicit Machine(const std::vector<Byte>& program)
+        {
+            bus.MapReadOnlyMemory(TEST_PROGRAM_START, TEST_PROGRAM_END, program.data(), program.size());
+            bus.MapDevice(0x2000, 0x3FFF, &device);
+            cpu.ConnectBus(&bus);
+
+            CPUState state{};
+            state.programCounter = TEST_PROGRAM_START;
+            state.stackPointer = 0xFD;
+            state.statusRegister = 0x24;
+            cpu.RestoreState(state);
+        }
+    };
+
+    bool IsSameState(const Machine& machine, const SaveState& expected)
+    {
+        SaveState state;
+        state.Capture(machine.cpu, machine.bus);
+        return std::memcmp(&state, &expected, STATE_SIZE) == 0;
+    }
+
+    // Loads the blob into the machine and runs it on; the device is put back as it was
+    // when the blob was taken, since it is not part of the state
+    bool RunFromBlob(Machine& machine, const std::vector<Byte>& blob, const CountingDevice& device, const uint64_t cycles)
+    {
+        SaveState state;
+        if (!state.LoadFromData(blob.data(), blob.size()) || !state.Restore(machine.cpu, machine.bus)) {
+            return false;
+        }
+        machine.device = device;
+        machine.cpu.RunCycles(cycles);
+        return true;
+    }
+
+    bool Check(const Options& options)
+    {
+        for (int seed = 0; seed < options.seeds; ++seed) {
+            std::mt19937 rng(seed);
+            const std::vector<Byte> program = MakeTestProgram(rng);
+            std::unique_ptr<Machine> source = std::make_unique<Machine>(program);
+            std::unique_ptr<Machine> target = std::make_unique<Machine>(program);
+            DecodeCache decodeCache(target->bus);
+            target->cpu.ConnectDecodeCache(&decodeCache);
+
+            for (int round = 0; round < ROUNDS; ++round) {
+                source->cpu.RunCycles(1 + rng() % MAXIMUM_CYCLES);
+                SaveState captured;
+                captured.Capture(source->cpu, source->bus);
+                const std::vector<Byte> blob(captured.GetData(), captured.GetData() + STATE_SIZE);
+                const CountingDevice deviceAtCapture = source->device;
+
+                const uint64_t cycles = 1 + rng() % MAXIMUM_CYCLES;
+                source->cpu.RunCycles(cycles);
+                SaveState expected;
+                expected.Capture(source->cpu, source->bus);
+                const CountingDevice expectedDevice = source->device;
+
+                if (!RunFromBlob(*target, blob, deviceAtCapture, cycles) || !IsSameState(*target, expected)
+                    || !(target->device == expectedDevice)) {
+                    std::printf("seed %d: second machine diverged after loading state %d\n", seed, round);
+                    return false;
+                }
+                if (!RunFromBlob(*source, blob, deviceAtCapture, cycles) || !IsSameState(*source, expected)
+                    || !(source->device == expectedDevice)) {
+                    std::printf("seed %d: machine diverged after rewinding to state %d\n", seed, round);
+                    return false;
+                }
+                target->cpu.RunCycles(1 + rng() % MAXIMUM_CYCLES);
+            }
+        }
+        std::printf("%d seeds passed\n", options.seeds);
+        return true;
+    }
+
+    bool CheckRejection()
+    {
+        std::mt19937 rng(0);
+        const std::vector<Byte> program = MakeTestProgram(rng);
+        Machine machine(program);
+        machine.cpu.RunCycles(MAXIMUM_CYCLES);
+        SaveState original;
+        original.Capture(machine.cpu, machine.bus);
+        const std::vector<Byte> blob(original.GetData(), original.GetData() + STATE_SIZE);
+
+        struct Corruption {
+            const char* name;
+            size_t offset;
+        };
+        const Corruption corruptions[] = {
+            { "magic", offsetof(SaveState, magic) },
+            { "version", offsetof(SaveState, version) },
+            { "size", offsetof(SaveState, size) },
+        };
+
+        machine.cpu.RunCycles(MAXIMUM_CYCLES);
+        SaveState current;
+        current.Capture(machine.cpu, machine.bus);
+
+        for (const Corruption& corruption : corruptions) {
+            std::vector<Byte> corrupted = blob;
+            corrupted[corruption.offset] ^= 0x01;
+            SaveState state;
+            if (state.LoadFromData(corrupted.data(), corrupted.size())) {
+                std::printf("state with a wrong %s was accepted\n", corruption.name);
+                return false;
+            }
+            if (state.Restore(machine.cpu, machine.bus) || !IsSameState(machine, current)) {
+                std::printf("state with a wrong %s was restored\n", corruption.name);
+                return false;
+            }
+        }
+
+        for (const size_t length : { STATE_SIZE - 1, STATE_SIZE + 1, static_cast<size_t>(0) }) {
+            std::vector<Byte> resized = blob;
+            resized.resize(length);
+            SaveState state;
+            if (state.LoadFromData(resized.data(), resized.size())) {
+                std::printf("%zu-byte state was accepted\n", length);
+                return false;
+            }
+        }
+        std::printf("corrupted states refused\n");
+        return true;
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        for (int index = 1; index < argc; ++index) {
+            const std::string argument = argv[index];
+            if (argument == "--seeds" && index + 1 < argc) {
+                options.seeds = std::atoi(argv[++index]);
+            } else {
+                std::fprintf(stderr, "Usage: %s [--seeds N]\n", argv[0]);
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        return 1;
+    }
+    return Check(options) && CheckRejection() ? 0 : 1;
+}
@@ -0,0 +1,129 @@
+#ifndef TEST_PROGRAMS_HPP
+#define TEST_PROGRAMS_HPP
+
+#include <initializer_list>
+#include <random>
+#include <vector>
+
+#include "../include/Bus.hpp"
+#include "../include/OpcodeTable.hpp"
+#include "../include/Typedefs.hpp"
+
+constexpr Address TEST_PROGRAM_START = 0x8000;
+constexpr Address TEST_PROGRAM_END = 0xFFFF;
+constexpr size_t TEST_PROGRAM_SIZE = 0x8000;
+
+// Answers reads with a running count and remembers the writes, so a missed or
+// repeated device access shows up when two runs are compared.
+class CountingDevice : public BusDevice
+{
+    public:
+        Byte Read(const Address address) override { ++Reads; return static_cast<Byte>(address * 7 + Reads); }
+        void Write(const Address address, const Byte data) override { ++Writes; LastWrite = data ^ static_cast<Byte>(address); }
+
+        bool operator==(const CountingDevice& other) const
+        {
+            return Reads == other.Reads && Writes == other.Writes && LastWrite == other.LastWrite;
+        }
+
+    private:
+        uint64_t Reads = 0;
+        uint64_t Writes = 0;
+        Byte LastWrite = 0x00;
+};
+
+// A random 32 KB program for $8000-$FFFF: loads, stores, ALU and flag work, counted
+// loops, forward branches, JSR/RTS, BRK, JMP ($xxxx) and accesses to devices at
+// $2000-$3FFF, ending in a JMP back to the start. Interrupts and BRK go to an
+// INC $FF / RTI handler. Operands range over all of RAM, and the indirect jumps
+// land anywhere, code in RAM included.
+inline std::vector<Byte>
+MakeTestProgram(std::mt19937& rng)
+{
+    static const Byte OPCODES[] = {
+        0xA9, 0xA5, 0xB5, 0xAD, 0xBD, 0xB9, 0xA1, 0xB1, 0xA2, 0xA6, 0xB6, 0xAE, 0xBE, 0xA0, 0xA4, 0xB4, 0xAC, 0xBC,
+        0x85, 0x95, 0x8D, 0x9D, 0x99, 0x81, 0x91, 0x86, 0x96, 0x8E, 0x84, 0x94, 0x8C,
+        0x69, 0x65, 0x75, 0x6D, 0x7D, 0x79, 0x61, 0x71, 0xE9, 0xE5, 0xF5, 0xED, 0xFD, 0xF9, 0xE1, 0xF1,
+        0x29, 0x25, 0x2D, 0x3D, 0x09, 0x05, 0x0D, 0x1D, 0x49, 0x45, 0x4D, 0x5D,
+        0xC9, 0xC5, 0xCD, 0xDD, 0xD9, 0xE0, 0xE4, 0xEC, 0xC0, 0xC4, 0xCC, 0x24, 0x2C,
+        0xE6, 0xF6, 0xEE, 0xFE, 0xC6, 0xD6, 0xCE, 0xDE, 0x0A, 0x06, 0x16, 0x0E, 0x1E, 0x4A, 0x46, 0x56, 0x4E, 0x5E,
+        0x2A, 0x26, 0x36, 0x2E, 0x3E, 0x6A, 0x66, 0x76, 0x6E, 0x7E, 0xE8, 0xC8, 0xCA, 0x88, 0xAA, 0xA8, 0x8A, 0x98, 0xBA, 0x9A,
+        0x18, 0x38, 0xB8, 0xEA, 0x48, 0x68, 0x08, 0x28, 0x58, 0x78, 0xD8, 0xF8, 0x1C, 0x04, 0x80, 0xEB, 0xA7,
+    };
+    static const Byte BRANCHES[] = { 0x90, 0xB0, 0xF0, 0xD0, 0x10, 0x30, 0x50, 0x70 };
+    static const Byte DEVICE_ACCESSES[] = { 0xAD, 0x8D, 0x2C };
+
+    std::vector<Byte> program(TEST_PROGRAM_SIZE, 0xEA);
+    size_t offset = 0;
+    auto emit = [&](const int data) { program[offset++] = static_cast<Byte>(data); };
+    auto address = [](const size_t at) { return static_cast<Address>(TEST_PROGRAM_START + at); };
+
+    while (offset < TEST_PROGRAM_SIZE - 0x100) {
+        const int kind = rng() % 100;
+        if (kind < 8) {
+            // LDX #n / three INCs / DEX / BNE
+            emit(0xA2);
+            emit(1 + rng() % 20);
+            const size_t body = offset;
+            for (int index = 0; index < 3; ++index) {
+                emit(0xE6);
+                emit(rng() % 0x40);
+            }
+            emit(0xCA);
+            emit(0xD0);
+            emit(static_cast<int>(body) - static_cast<int>(offset + 1));
+        } else if (kind < 12) {
+            emit(BRANCHES[rng() % sizeof(BRANCHES)]);
+            emit(rng() % 12);
+        } else if (kind < 13) {
+            // JSR to an INX / RTS that a JMP steps over
+            const Address subroutine = address(offset + 6);
+            const Address after = address(offset + 8);
+            emit(0x20);
+            emit(subroutine & 0xFF);
+            emit(subroutine >> 8);
+            emit(0x4C);
+            emit(after & 0xFF);
+            emit(after >> 8);
+            emit(0xE8);
+            emit(0x60);
+        } else if (kind < 15) {
+            // BRK, or now and then a JMP through a random pointer
+            emit(rng() % 4 ? 0x00 : 0x6C);
+            emit(rng() & 0xFF);
+            emit(rng() % 8);
+        } else if (kind < 16) {
+            emit(DEVICE_ACCESSES[rng() % sizeof(DEVICE_ACCESSES)]);
+            emit(rng() & 0xFF);
+            emit(0x20 + rng() % 0x20);
+        } else {
+            const Byte opcode = OPCODES[rng() % sizeof(OPCODES)];
+            emit(opcode);
+            const uint8_t length = GetOperandLength(OPCODE_TABLE[opcode].addressingMode);
+            if (length == 1) {
+                emit(rng() & 0x7F);
+            } else if (length == 2) {
+                const Address operand = rng() % MEMORY_SIZE;
+                emit(operand & 0xFF);
+                emit(operand >> 8);
+            }
+        }
+    }
+    emit(0x4C);
+    emit(TEST_PROGRAM_START & 0xFF);
+    emit(TEST_PROGRAM_START >> 8);
+
+    const Address handler = address(offset);
+    emit(0xE6); // INC $FF / RTI
+    emit(0xFF);
+    emit(0x40);
+    for (const size_t vector : { 0x7FFA, 0x7FFE }) {
+        program[vector] = handler & 0xFF;
+        program[vector + 1] = handler >> 8;
+    }
+    program[0x7FFC] = TEST_PROGRAM_START & 0xFF;
+    program[0x7FFD] = TEST_PROGRAM_START >> 8;
+    return program;
+}
+
+#endif
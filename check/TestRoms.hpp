@@ -0,0 +1,51 @@
+#ifndef TEST_ROMS_HPP
+#define TEST_ROMS_HPP
+
+#include <cstring>
+#include <initializer_list>
+#include <vector>
+
+#include "../include/Cartridge.hpp"
+#include "../include/Typedefs.hpp"
+
+// Builds NROM images (32 KB PRG at $8000, 8 KB CHR) from generated code for the
+// System-level checks. PRG space not written is NOPs.
+class TestRomBuilder
+{
+    public:
+        TestRomBuilder()
+            : Image(INES_HEADER_SIZE + 2 * PRG_ROM_UNIT_SIZE + CHR_ROM_UNIT_SIZE, 0x00)
+        {
+            const Byte header[INES_HEADER_SIZE] = { 'N', 'E', 'S', 0x1A, 2, 1 };
+            std::memcpy(Image.data(), header, sizeof(header));
+            std::memset(GetPrg(), 0xEA, 2 * PRG_ROM_UNIT_SIZE);
+        }
+
+        Byte* GetPrg() { return Image.data() + INES_HEADER_SIZE; }
+        Byte* GetChr() { return GetPrg() + 2 * PRG_ROM_UNIT_SIZE; }
+
+        void Emit(std::initializer_list<int> bytes)
+        {
+            for (const int data : bytes) {
+                GetPrg()[Offset++] = static_cast<Byte>(data);
+            }
+        }
+        void EmitJump(const Address target) { Emit({ 0x4C, target & 0xFF, target >> 8 }); }
+
+        Address GetAddress() const { return static_cast<Address>(PRG_ROM_UNIT.first + Offset); }
+        size_t GetOffset() const { return Offset; }
+
+        void SetVector(const Address vector, const Address target)
+        {
+            GetPrg()[vector - PRG_ROM_UNIT.first] = target & 0xFF;
+            GetPrg()[vector - PRG_ROM_UNIT.first + 1] = target >> 8;
+        }
+
+        const std::vector<Byte>& GetImage() const { return Image; }
+
+    private:
+        std::vector<Byte> Image;
+        size_t Offset = 0;
+};
+
+#endif
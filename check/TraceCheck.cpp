@@ -0,0 +1,186 @@
+// Check for TraceRecorder's nestest.log listing and binary dumps.
+//
+// Runs the first instructions of nestest (automation mode, from $C000) under
+// StepWith() and compares each formatted line with the line nestest.log has for it,
+// the "= xx" memory values taken out. Records a few cycles either side of a scanline
+// and a frame boundary pin down the PPU column, and an unofficial opcode the '*'
+// column. A ring smaller than the run must hold just the newest records, and a
+// binary dump must load back record for record.
+//
+// Usage: TraceCheck
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "../include/Bus.hpp"
+#include "../include/CPU.hpp"
+#include "../include/TraceRecorder.hpp"
+
+namespace {
+    constexpr Address PROGRAM_START = 0x8000;
+    constexpr Address NESTEST_START = 0xC000;
+    constexpr uint64_t NESTEST_START_CYCLE = 7;
+    constexpr size_t DISASSEMBLY_COLUMN = 16;
+    constexpr size_t REGISTERS_COLUMN = 48;
+    constexpr size_t SMALL_CAPACITY = 4;
+    constexpr const char* DUMP_PATH = "TraceCheck.trace";
+
+    const char* const NESTEST_LINES[] = {
+        "C000  4C F5 C5  JMP $C5F5                       A:00 X:00 Y:00 P:24 SP:FD PPU:  0, 21 CYC:7",
+        "C5F5  A2 00     LDX #$00                        A:00 X:00 Y:00 P:24 SP:FD PPU:  0, 30 CYC:10",
+        "C5F7  86 00     STX $00 = 00                    A:00 X:00 Y:00 P:26 SP:FD PPU:  0, 36 CYC:12",
+        "C5F9  86 10     STX $10 = 00                    A:00 X:00 Y:00 P:26 SP:FD PPU:  0, 45 CYC:15",
+        "C5FB  86 11     STX $11 = 00                    A:00 X:00 Y:00 P:26 SP:FD PPU:  0, 54 CYC:18",
+        "C5FD  20 2D C7  JSR $C72D                       A:00 X:00 Y:00 P:26 SP:FD PPU:  0, 63 CYC:21",
+        "C72D  EA        NOP                             A:00 X:00 Y:00 P:26 SP:FB PPU:  0, 81 CYC:27",
+        "C72E  38        SEC                             A:00 X:00 Y:00 P:26 SP:FB PPU:  0, 87 CYC:29",
+        "C72F  B0 04     BCS $C735                       A:00 X:00 Y:00 P:27 SP:FB PPU:  0, 93 CYC:31",
+        "C735  EA        NOP                             A:00 X:00 Y:00 P:27 SP:FB PPU:  0,102 CYC:34",
+    };
+    constexpr size_t NUMBER_OF_NESTEST_LINES = sizeof(NESTEST_LINES) / sizeof(NESTEST_LINES[0]);
+
+    // Instructions placed where nestest has them
+    struct Placement {
+        Address address;
+        std::vector<Byte> bytes;
+    };
+
+    const Placement NESTEST_PROGRAM[] = {
+        { 0xC000, { 0x4C, 0xF5, 0xC5 } },
+        { 0xC5F5, { 0xA2, 0x00, 0x86, 0x00, 0x86, 0x10, 0x86, 0x11, 0x20, 0x2D, 0xC7 } },
+        { 0xC72D, { 0xEA, 0x38, 0xB0, 0x04 } },
+        { 0xC735, { 0xEA } },
+    };
+
+    // Lines built from records alone, where the machine state does not matter
+    struct FormattedRecord {
+        TraceRecord record;
+        const char* line;
+    };
+
+    const FormattedRecord FORMATTED_RECORDS[] = {
+        { { 113, 0xC000, 0x0000, 0xEA, 0, 0, 0, 0x24, 0xFD, {} },
+          "C000  EA        NOP                             A:00 X:00 Y:00 P:24 SP:FD PPU:  0,339 CYC:113" },
+        { { 114, 0xC000, 0x0000, 0xEA, 0, 0, 0, 0x24, 0xFD, {} },
+          "C000  EA        NOP                             A:00 X:00 Y:00 P:24 SP:FD PPU:  1,  1 CYC:114" },
+        { { 29780, 0xC000, 0x0000, 0xEA, 0, 0, 0, 0x24, 0xFD, {} },
+          "C000  EA        NOP                             A:00 X:00 Y:00 P:24 SP:FD PPU:261,339 CYC:29780" },
+        { { 29781, 0xC000, 0x0000, 0xEA, 0, 0, 0, 0x24, 0xFD, {} },
+          "C000  EA        NOP                             A:00 X:00 Y:00 P:24 SP:FD PPU:  0,  1 CYC:29781" },
+        { { 10, 0xE4CC, 0x00A9, 0x04, 0x12, 0x34, 0x56, 0xA5, 0xF0, {} },
+          "E4CC  04 A9    *NOP $A9                         A:12 X:34 Y:56 P:A5 SP:F0 PPU:  0, 30 CYC:10" },
+        { { 10, 0xC5D3, 0x0678, 0xBD, 0x12, 0x34, 0x56, 0xA5, 0xF0, {} },
+          "C5D3  BD 78 06  LDA $0678,X                     A:12 X:34 Y:56 P:A5 SP:F0 PPU:  0, 30 CYC:10" },
+    };
+
+    // nestest.log with the "= xx" memory values taken out of the disassembly column
+    std::string WithoutMemoryValues(const std::string& line)
+    {
+        std::string disassembly = line.substr(DISASSEMBLY_COLUMN, REGISTERS_COLUMN - DISASSEMBLY_COLUMN);
+        const size_t value = disassembly.find(" = ");
+        if (value != std::string::npos) {
+            disassembly.erase(value);
+        }
+        disassembly.resize(REGISTERS_COLUMN - DISASSEMBLY_COLUMN, ' ');
+        return line.substr(0, DISASSEMBLY_COLUMN) + disassembly + line.substr(REGISTERS_COLUMN);
+    }
+
+    bool ExpectLine(const TraceRecord& record, const std::string& expected)
+    {
+        char line[NESTEST_LINE_SIZE];
+        const size_t length = TraceRecorder::FormatNestestLine(record, line);
+        if (std::string(line, length) != expected) {
+            std::printf("formatted: %.*s\nexpected:  %s\n", static_cast<int>(length), line, expected.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    bool IsSameRecord(const TraceRecord& a, const TraceRecord& b)
+    {
+        return a.cycle == b.cycle && a.programCounter == b.programCounter && a.operand == b.operand
+            && a.opcode == b.opcode && a.accumulator == b.accumulator && a.x == b.x && a.y == b.y
+            && a.statusRegister == b.statusRegister && a.stackPointer == b.stackPointer;
+    }
+
+    bool Check()
+    {
+        std::vector<Byte> program(0x8000, 0x00);
+        for (const Placement& placement : NESTEST_PROGRAM) {
+            std::copy(placement.bytes.begin(), placement.bytes.end(), program.begin() + (placement.address - PROGRAM_START));
+        }
+        Bus bus;
+        bus.MapReadOnlyMemory(PROGRAM_START, 0xFFFF, program.data(), program.size());
+        CPU cpu;
+        cpu.ConnectBus(&bus);
+        CPUState state{};
+        state.programCounter = NESTEST_START;
+        state.stackPointer = 0xFD;
+        state.statusRegister = 0x24;
+        state.totalCycles = NESTEST_START_CYCLE;
+        cpu.RestoreState(state);
+
+        TraceRecorder trace;
+        TraceRecorder smallTrace(SMALL_CAPACITY);
+        for (size_t step = 0; step < NUMBER_OF_NESTEST_LINES; ++step) {
+            CPUState before;
+            cpu.CaptureState(before);
+            cpu.StepWith(trace);
+            cpu.RestoreState(before);
+            cpu.StepWith(smallTrace);
+        }
+
+        if (trace.GetCount() != NUMBER_OF_NESTEST_LINES) {
+            std::printf("%zu records held after %zu instructions\n", trace.GetCount(), NUMBER_OF_NESTEST_LINES);
+            return false;
+        }
+        for (size_t index = 0; index < NUMBER_OF_NESTEST_LINES; ++index) {
+            if (!ExpectLine(trace.GetRecord(index), WithoutMemoryValues(NESTEST_LINES[index]))) {
+                return false;
+            }
+        }
+        for (const FormattedRecord& formatted : FORMATTED_RECORDS) {
+            if (!ExpectLine(formatted.record, formatted.line)) {
+                return false;
+            }
+        }
+
+        if (smallTrace.GetCount() != SMALL_CAPACITY || smallTrace.GetTotalRecorded() != NUMBER_OF_NESTEST_LINES) {
+            std::printf("ring of %zu holds %zu of %llu records\n", SMALL_CAPACITY, smallTrace.GetCount(),
+                        static_cast<unsigned long long>(smallTrace.GetTotalRecorded()));
+            return false;
+        }
+        for (size_t index = 0; index < SMALL_CAPACITY; ++index) {
+            const size_t newer = NUMBER_OF_NESTEST_LINES - SMALL_CAPACITY + index;
+            if (!IsSameRecord(smallTrace.GetRecord(index), trace.GetRecord(newer))) {
+                std::printf("ring of %zu: record %zu is not instruction %zu\n", SMALL_CAPACITY, index, newer);
+                return false;
+            }
+        }
+
+        TraceRecorder loaded(NUMBER_OF_NESTEST_LINES);
+        const bool isLoaded = trace.SaveBinary(DUMP_PATH) && loaded.LoadBinary(DUMP_PATH);
+        std::remove(DUMP_PATH);
+        if (!isLoaded || loaded.GetCount() != trace.GetCount()) {
+            std::printf("binary dump did not load back\n");
+            return false;
+        }
+        for (size_t index = 0; index < trace.GetCount(); ++index) {
+            if (!IsSameRecord(loaded.GetRecord(index), trace.GetRecord(index))) {
+                std::printf("binary dump: record %zu differs\n", index);
+                return false;
+            }
+        }
+
+        std::printf("%zu nestest lines and %zu formatted records passed\n", NUMBER_OF_NESTEST_LINES,
+                    sizeof(FORMATTED_RECORDS) / sizeof(FORMATTED_RECORDS[0]));
+        return true;
+    }
+}
+
+int main()
+{
+    return Check() ? 0 : 1;
+}
@@ -0,0 +1,180 @@
+#ifndef APU_HPP
+#define APU_HPP
+
+#include <array>
+#include <cstddef>
+
+#include "BlipBuffer.hpp"
+#include "Bus.hpp"
+#include "Constants.hpp"
+#include "Typedefs.hpp"
+
+constexpr double NTSC_CPU_CLOCK_RATE = 39375000.0 / 22.0;
+constexpr uint32_t AUDIO_SAMPLE_RATE = 48000;
+
+// Audio is mixed one block at a time; a block is about one video frame
+constexpr uint32_t AUDIO_BLOCK_CYCLES = 29780;
+
+// Frame sequencer steps in CPU cycles after the sequence starts. The 4-step mode
+// stops after the fourth entry.
+constexpr std::array<uint32_t, 5> APU_FRAME_STEP_CYCLES = { 7457, 14913, 22371, 29829, 37281 };
+constexpr uint32_t APU_FOUR_STEP_PERIOD = 29830;
+constexpr uint32_t APU_FIVE_STEP_PERIOD = 37282;
+
+// Takes each finished block of samples. Called from the emulation thread, so it
+// must not block.
+class AudioSink
+{
+    public:
+        virtual ~AudioSink() = default;
+
+        virtual void WriteSamples(const int16_t*, const size_t) = 0;
+};
+
+struct Envelope {
+    bool start = false;
+    bool loop = false; // Doubles as the length counter halt flag
+    bool constantVolume = false;
+    Byte period = 0;
+    Byte divider = 0;
+    Byte decay = 0;
+};
+
+struct PulseChannel {
+    Envelope envelope;
+    Byte duty = 0;
+    Byte step = 0;
+    uint16_t timer = 0;
+    Byte lengthCounter = 0;
+
+    bool sweepEnabled = false;
+    bool sweepNegate = false;
+    bool sweepReload = false;
+    Byte sweepPeriod = 0;
+    Byte sweepShift = 0;
+    Byte sweepDivider = 0;
+    bool isFirstChannel = false; // Pulse 1 negates in ones' complement
+
+    uint64_t nextClock = 0;
+    int output = 0;
+};
+
+struct TriangleChannel {
+    bool control = false; // Doubles as the length counter halt flag
+    Byte linearReload = 0;
+    Byte linearCounter = 0;
+    bool linearReloadFlag = false;
+    Byte step = 0;
+    uint16_t timer = 0;
+    Byte lengthCounter = 0;
+
+    uint64_t nextClock = 0;
+    int output = 0;
+};
+
+struct NoiseChannel {
+    Envelope envelope;
+    bool shortMode = false;
+    Byte periodIndex = 0;
+    uint16_t shiftRegister = 0x0001;
+    Byte lengthCounter = 0;
+
+    uint64_t nextClock = 0;
+    int output = 0;
+};
+
+struct DmcChannel {
+    bool irqEnabled = false;
+    bool loop = false;
+    Byte rateIndex = 0;
+    Address sampleAddress = 0xC000;
+    uint16_t sampleLength = 1;
+
+    Address currentAddress = 0xC000;
+    uint16_t bytesRemaining = 0;
+    Byte sampleBuffer = 0x00;
+    bool isBufferEmpty = true;
+    Byte shiftRegister = 0x00;
+    Byte bitsRemaining = 8;
+    bool isSilent = true;
+
+    uint64_t nextClock = 0;
+    int output = 0;
+};
+
+// Audio processing unit, mapped over $4000-$4013 and $4015. $4017 is shared with the
+// second controller port, so the System passes frame counter writes on.
+//
+// Nothing runs per cycle. Catching up walks each channel from one timer expiry to
+// the next and hands only the level changes to a blip buffer, which band-limits
+// them into 48 kHz samples; a muted pulse or halted triangle is skipped over in one
+// step. Finished blocks go to the connected audio sink.
+//
+// The frame counter and DMC IRQs are predicted like the PPU's NMI, so the CPU runs
+// straight up to them.
+class APU : public BusDevice, public SynchronizedDevice
+{
+    public:
+        APU(Bus&, const uint32_t = AUDIO_SAMPLE_RATE);
+        ~APU() override = default;
+
+        APU(const APU&) = delete;
+        APU& operator=(const APU&) = delete;
+
+        Byte Read(const Address) override;
+        void Write(const Address, const Byte) override;
+
+        void Reset();
+
+        void CatchUp(const uint64_t) override;
+        uint64_t GetNextEventCycle() const override;
+        EventTypes::Type GetEventType() const override { return EventTypes::InterruptRequest; }
+        bool IsInterruptRequested() const override { return FrameIrq || DmcIrq; }
+
+        // Ends the current audio block early so everything up to the last catch-up
+        // reaches the output, e.g. at the end of a video frame.
+        void FlushAudio();
+
+        // Without a sink the samples are still produced and then discarded.
+        void ConnectAudioSink(AudioSink* sink) { ConnectedAudioSink = sink; }
+
+    private:
+        void RunPulse(PulseChannel&, const uint64_t);
+        void RunTriangle(const uint64_t);
+        void RunNoise(const uint64_t);
+        void RunDmc(const uint64_t);
+        void FetchSample();
+
+        void ClockFrameStep();
+        void ClockQuarterFrame();
+        void ClockHalfFrame();
+        void RestartFrameCounter(const uint64_t);
+
+        void UpdateOutputs(const uint64_t);
+        void SetOutput(int&, const int, const float, const uint64_t);
+        void EndBlock(const uint32_t);
+
+    private:
+        Bus& ConnectedBus;
+        BlipBuffer Blip;
+        AudioSink* ConnectedAudioSink = nullptr;
+
+        PulseChannel Pulse1;
+        PulseChannel Pulse2;
+        TriangleChannel Triangle;
+        NoiseChannel Noise;
+        DmcChannel Dmc;
+        Byte EnabledChannels = 0x00; // $4015 bits 0-4
+
+        bool IsFiveStepMode = false;
+        bool IsFrameIrqInhibited = false;
+        bool FrameIrq = false;
+        bool DmcIrq = false;
+        uint64_t FrameCounterStart = 0;
+        uint8_t FrameStep = 0;
+
+        uint64_t SynchronizedCycle = 0;
+        uint64_t BlockStartCycle = 0;
+};
+
+#endif
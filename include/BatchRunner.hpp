@@ -0,0 +1,63 @@
+#ifndef BATCH_RUNNER_HPP
+#define BATCH_RUNNER_HPP
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "Typedefs.hpp"
+
+class Bus;
+
+struct BatchJob {
+    // Prepares a freshly constructed instance, e.g. by mapping a shared read-only
+    // program and restoring a SaveState. Must not touch state owned by other jobs.
+    std::function<void(CPU&, Bus&)> setup;
+    uint64_t cycles;
+
+    // Reads what the job produced, e.g. a SaveState, before the instance is destroyed.
+    // Must only write to storage owned by this job.
+    std::function<void(const CPU&, const Bus&)> finish;
+};
+
+struct BatchResult {
+    uint64_t cyclesExecuted;
+    double seconds;
+};
+
+struct BatchReport {
+    std::vector<BatchResult> results;
+    uint64_t totalCycles;
+    double wallSeconds;
+    double cyclesPerSecond; // Aggregate emulated cycles per wall-clock second
+};
+
+// Runs every job on its own CPU and Bus. Jobs are dealt round-robin into one
+// queue per worker; a worker drains its own queue from the back and steals from
+// the front of the others once it runs dry.
+class BatchRunner
+{
+    public:
+        explicit BatchRunner(const size_t threadCount = 0); // 0 picks the hardware thread count
+        ~BatchRunner() = default;
+
+        BatchReport Run(const std::vector<BatchJob>&);
+
+        size_t GetThreadCount() const { return ThreadCount; }
+
+    private:
+        struct alignas(64) WorkQueue {
+            std::mutex mutex;
+            std::deque<size_t> jobs;
+        };
+
+        bool TakeJob(std::vector<WorkQueue>&, const size_t, size_t&);
+        void RunWorker(std::vector<WorkQueue>&, const size_t, const std::vector<BatchJob>&, std::vector<BatchResult>&);
+
+    private:
+        size_t ThreadCount;
+};
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef BLIP_BUFFER_HPP
+#define BLIP_BUFFER_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+constexpr uint8_t BLIP_PHASE_BITS = 5;
+constexpr uint8_t BLIP_PHASES = 1 << BLIP_PHASE_BITS;
+constexpr uint8_t BLIP_KERNEL_WIDTH = 16;
+
+// Band-limited step synthesis. Channels report only the moments their output level
+// changes; each change is added as a windowed-sinc impulse at its sub-sample
+// position, and reading integrates the impulses back into steps. The output is
+// alias-free at the target rate without filtering at the 1.79 MHz CPU clock.
+class BlipBuffer
+{
+    public:
+        BlipBuffer(const double clockRate, const uint32_t sampleRate, const uint32_t maximumClocks);
+        ~BlipBuffer() = default;
+
+        // Times are clocks since the last EndFrame() and must stay below maximumClocks.
+        void AddDelta(const uint32_t, const float);
+
+        // Makes everything before the given clock readable and starts a new frame there.
+        void EndFrame(const uint32_t);
+
+        size_t GetSamplesAvailable() const { return static_cast<size_t>(Offset >> 32); }
+        size_t ReadSamples(int16_t*, const size_t);
+        void Clear();
+
+    private:
+        std::array<std::array<float, BLIP_KERNEL_WIDTH>, BLIP_PHASES> Kernel{};
+        std::vector<float> Deltas;
+
+        uint64_t Factor; // Samples per clock as 32.32 fixed point
+        uint64_t Offset = 0; // Start of the current frame in 32.32 samples
+
+        float Integrator = 0.0f;
+        float HighPassInput = 0.0f;
+        float HighPassOutput = 0.0f;
+};
+
+#endif
@@ -0,0 +1,145 @@
+#ifndef BUS_HPP
+#define BUS_HPP
+
+#include <array>
+#include <cstddef>
+
+#include "Constants.hpp"
+#include "Typedefs.hpp"
+
+// Anything on the bus that is not plain memory (PPU/APU registers, mapper ports)
+// implements this and is reached through the slow path.
+class BusDevice
+{
+    public:
+        virtual ~BusDevice() = default;
+
+        virtual Byte Read(const Address) = 0;
+        virtual void Write(const Address, const Byte) = 0;
+
+        // Cycle before which reading the address again returns the same byte and
+        // changes nothing, so the CPU may skip a loop that polls it. Devices that
+        // cannot promise anything keep the default.
+        virtual uint64_t GetStableReadCycle(const Address) { return 0; }
+};
+
+// Devices that run on their own clock (PPU, APU) are kept behind the CPU and only
+// brought up to date when something could observe them. Cycles are CPU cycles.
+class SynchronizedDevice
+{
+    public:
+        virtual ~SynchronizedDevice() = default;
+
+        virtual void CatchUp(const uint64_t) = 0;
+
+        // Earliest cycle at which the device raises an interrupt if nothing touches
+        // it before then, or NO_PENDING_EVENT.
+        virtual uint64_t GetNextEventCycle() const = 0;
+        virtual EventTypes::Type GetEventType() const = 0;
+
+        // Level of the device's IRQ output; devices that never raise one keep the default.
+        virtual bool IsInterruptRequested() const { return false; }
+};
+
+class Bus
+{
+    public:
+        Bus();
+        ~Bus() = default;
+
+        Bus(const Bus&) = delete;
+        Bus& operator=(const Bus&) = delete;
+
+        // Memory pages are a single indexed load; only device pages take a call.
+        inline Byte Read(const Address address)
+        {
+            const Byte* page = ReadPages[address >> 8];
+            if (page != nullptr) {
+                return page[address & 0x00FF];
+            }
+            return ReadFromDevice(address);
+        }
+
+        inline void Write(const Address address, const Byte data)
+        {
+            Byte* page = WritePages[address >> 8];
+            if (page != nullptr) {
+                page[address & 0x00FF] = data;
+                return;
+            }
+            WriteToDevice(address, data);
+        }
+
+        // Ranges must start and end on page boundaries. Memory smaller than the range
+        // is mirrored across it by pointing several pages at the same storage.
+        void MapMemory(const Address, const Address, Byte*, const size_t);
+        void MapReadOnlyMemory(const Address, const Address, const Byte*, const size_t);
+        void MapDevice(const Address, const Address, BusDevice*);
+        void Unmap(const Address, const Address);
+
+        // Generations change whenever a page is remapped or a watched page is written,
+        // which lets caches of decoded code notice bank switches and self-modifying code.
+        uint32_t GetPageGeneration(const size_t page) const { return PageGenerations[page]; }
+        bool IsMemoryPage(const size_t page) const { return ReadPages[page] != nullptr; }
+        bool IsWritablePage(const size_t page) const { return MemoryPages[page] != nullptr; }
+        const Byte* GetPageMemory(const size_t page) const { return ReadPages[page]; }
+        void WatchPage(const size_t);
+
+        // Memory and unmapped pages are stable until something writes to them.
+        uint64_t GetStableReadCycle(const Address);
+
+        // Dirty tracking for forks. A cleaned page (with its mirrors) leaves the fast
+        // path until its next write, which marks it dirty again. Remapped pages start
+        // dirty. Writes made straight into memory handed out by GetRam() or a mapper
+        // bypass the Bus and have to be reported with MarkDirty().
+        void CleanPage(const size_t);
+        bool IsDirtyPage(const size_t page) const { return DirtyPages[page]; }
+        void MarkDirty(const Address, const Address);
+        Byte* GetWritablePageMemory(const size_t page) { return MemoryPages[page]; }
+
+        // The page tables behind Read()/Write(), for generated code that inlines the
+        // fast paths. A null entry means the access has to go through the Bus.
+        const Byte* const* GetReadPageTable() const { return ReadPages.data(); }
+        Byte* const* GetWritePageTable() const { return WritePages.data(); }
+        const uint32_t* GetPageGenerationTable() const { return PageGenerations.data(); }
+
+        Byte* GetRam() { return Ram.data(); }
+        const Byte* GetRam() const { return Ram.data(); }
+
+    private:
+        Byte ReadFromDevice(const Address);
+        void WriteToDevice(const Address, const Byte);
+        void RemapPage(const size_t);
+        void LinkAliases(const size_t);
+        void MarkPageDirty(const size_t);
+
+        // Calls the function for the page and every page mapped to the same memory
+        template <typename Function>
+        void ForEachAlias(const size_t page, Function function)
+        {
+            size_t alias = page;
+            do {
+                function(alias);
+                alias = NextAlias[alias];
+            } while (alias != page);
+        }
+
+    private:
+        std::array<Byte, MEMORY_SIZE> Ram{};
+
+        std::array<const Byte*, NUMBER_OF_BUS_PAGES> ReadPages{};
+        std::array<Byte*, NUMBER_OF_BUS_PAGES> WritePages{};
+        std::array<BusDevice*, NUMBER_OF_BUS_PAGES> Devices{};
+
+        std::array<Byte*, NUMBER_OF_BUS_PAGES> MemoryPages{}; // Writable memory, even while watched
+        std::array<uint32_t, NUMBER_OF_BUS_PAGES> PageGenerations{};
+        std::array<bool, NUMBER_OF_BUS_PAGES> WatchedPages{};
+        std::array<bool, NUMBER_OF_BUS_PAGES> DirtyPages{};
+
+        // Pages sharing writable memory form a ring, built when they are mapped, so
+        // watching, cleaning or dirtying a page costs one step per mirror. Every other
+        // page is a ring of its own.
+        std::array<uint8_t, NUMBER_OF_BUS_PAGES> NextAlias{};
+};
+
+#endif
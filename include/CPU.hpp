@@ -1,7 +1,16 @@
 #ifndef CPU_HPP
 #define CPU_HPP
 
+#include "Bus.hpp"
+#include "DecodeCache.hpp"
+#include "Jit.hpp"
+#include "Profiler.hpp"
+#include "SaveState.hpp"
 #include "Typedefs.hpp"
+#include "OpcodeTable.hpp"
+
+// Longest loop, in bytes of code, that RunCycles() tries to skip as idle
+constexpr Address MAXIMUM_IDLE_LOOP_LENGTH = 16;
 
 class CPU
 {
@@ -9,20 +18,68 @@ class CPU
         CPU() = default;
         ~CPU() = default;
 
-        // Input Signals into the CPU are Public
+        void ConnectBus(Bus* bus) { ConnectedBus = bus; }
+        void ConnectDecodeCache(DecodeCache* decodeCache) { ConnectedDecodeCache = decodeCache; }
+        void ConnectJit(JitCompiler* jit) { ConnectedJit = jit; }
+
+        // Input Signals into the CPU are Public. The interrupt entry points are taken
+        // between instructions and leave their 7 cycles pending for Clock()/Step().
         void Clock();
         void Reset();
         void InterruptRequest();
         void NonMaskableInterrupt();
 
+        // Cycles the CPU spends halted, e.g. while OAM DMA owns the bus.
+        void Stall(const uint32_t);
+
+        // Instruction-stepped execution for headless runs. Both run whole instructions
+        // and return the number of cycles consumed, matching what Clock() would spend.
+        uint32_t Step();
+        uint64_t RunCycles(const uint64_t);
+
+        // The same, reporting every instruction to a profiling policy (see Profiler.hpp).
+        // Profiled runs bypass the decode cache so each instruction is seen at its PC.
+        template <typename Profiler> void ClockWith(Profiler&);
+        template <typename Profiler> uint32_t StepWith(Profiler&);
+        template <typename Profiler> uint64_t RunCyclesWith(const uint64_t, Profiler&);
+
+        // Reads an instruction without executing it or moving the Program Counter.
+        void Decode(const Address, DecodedInstruction&);
+
+        // Stops RunCycles() once the instruction in flight completes, so a device whose
+        // next event moved earlier can be serviced on time.
+        void EndTimeslice();
+
+        // RunCycles() fast-forwards loops in PRG-ROM that only read memory or stable
+        // device registers and come back to the same state every pass, such as
+        // JMP * or LDA $2002 / BPL. Whole passes are skipped up to the end of the
+        // timeslice, which the System sets at the next device event. Off by default,
+        // since a bare CPU's timeslice ends wherever the caller asked.
+        void SetIdleLoopSkipping(const bool isSkipping) { IsIdleLoopSkipping = isSkipping; }
+        uint64_t GetIdleCyclesSkipped() const { return IdleCyclesSkipped; }
+
+        uint64_t GetTotalCycles() const { return TotalCycles; }
+        bool IsInterruptDisabled() const { return StatusRegister & StatusRegisterFlags::I; }
+
+        // Cycle on which the instruction in flight touches the bus. Reads and writes
+        // land on the last cycle of an instruction, which is accurate for loads, stores
+        // and the write-back of read-modify-write instructions.
+        uint64_t GetAccessCycle() const { return TotalCycles + (CyclesLeft != 0 ? CyclesLeft - 1 : 0); }
+
+        // Folds the lazily kept N/Z/C/V flags into a full status byte and back.
+        Byte GetStatusRegister() const;
+        void SetStatusRegister(const Byte);
+
+        void CaptureState(CPUState&) const;
+        void RestoreState(const CPUState&);
+
     private:
 
         Byte FetchByteFromMemory(const Address);
         Byte FetchDataForOperation();
         void WriteByteToMemory(const Address, const Byte);
 
-        // TODO: Change the return types to use std::optional<Byte> rather than Byte!
-        // Addressing Modes
+        // Addressing Modes: each returns true when indexing crossed a page boundary
         bool ImplicitMode();
         bool AccumulatorMode();
         bool ImmediateMode();
@@ -38,86 +95,187 @@ class CPU
         bool RelativeMode();
 
         // Opcode Functions
-        bool ADC(); // Add with Carry
-        bool AND(); // And with Accumulator
-        bool ASL(); // Arithmetic Shift Left
-        bool BCC(); // Branch on Carry Clear
-        bool BCS(); // Branch on Carry Set
-        bool BEQ(); // Branch on Equal
-        bool BIT(); // Bit Test
-        bool BMI(); // Branch on Minus
-        bool BNE(); // Branch on Not Equal
-        bool BPL(); // Branch on Plus
-        bool BRK(); // Force Break
-        bool BVC(); // Branch on Overflow Clear
-        bool BVS(); // Branch on Overflow Set
-        bool CLC(); // Clear Carry Flag
-        bool CLD(); // Clear Decimal Mode
-        bool CLI(); // Clear Interrupt Disable
-        bool CLV(); // Clear Overflow Flag
-        bool CMP(); // Compare Accumulator
-        bool CPX(); // Compare X Register
-        bool CPY(); // Compare Y Register
-        bool DEC(); // Decrement Memory
-        bool DEX(); // Decrement X Register
-        bool DEY(); // Decrement Y Register
-        bool EOR(); // Exclusive Or with Accumulator
-        bool INC(); // Increment Memory
-        bool INX(); // Increment X Register
-        bool INY(); // Increment Y Register
-        bool JMP(); // Jump to Address
-        bool JSR(); // Jump to Subroutine
-        bool LDA(); // Load Accumulator
-        bool LDX(); // Load X Register
-        bool LDY(); // Load Y Register
-        bool LSR(); // Logical Shift Right
-        bool NOP(); // No Operation
-        bool ORA(); // Or with Accumulator
-        bool PHA(); // Push Accumulator
-        bool PHP(); // Push Processor Status
-        bool PLA(); // Pull Accumulator
-        bool PLP(); // Pull Processor Status
-        bool ROL(); // Rotate Left
-        bool ROR(); // Rotate Right
-        bool RTI(); // Return from Interrupt
-        bool RTS(); // Return from Subroutine
-        bool SBC(); // Subtract with Carry
-        bool SEC(); // Set Carry Flag
-        bool SED(); // Set Decimal Mode
-        bool SEI(); // Set Interrupt Disable
-        bool STA(); // Store Accumulator
-        bool STX(); // Store X Register
-        bool STY(); // Store Y Register
-        bool TAX(); // Transfer Accumulator to X
-        bool TAY(); // Transfer Accumulator to Y
-        bool TSX(); // Transfer Stack Pointer to X
-        bool TXA(); // Transfer X to Accumulator
-        bool TXS(); // Transfer X to Stack Pointer
-        bool TYA(); // Transfer Y to Accumulator
-        bool XXX(); // Catches all illegal Instructions!
+        void ADC(); // Add with Carry
+        void AND(); // And with Accumulator
+        void ASL(); // Arithmetic Shift Left
+        void BCC(); // Branch on Carry Clear
+        void BCS(); // Branch on Carry Set
+        void BEQ(); // Branch on Equal
+        void BIT(); // Bit Test
+        void BMI(); // Branch on Minus
+        void BNE(); // Branch on Not Equal
+        void BPL(); // Branch on Plus
+        void BRK(); // Force Break
+        void BVC(); // Branch on Overflow Clear
+        void BVS(); // Branch on Overflow Set
+        void CLC(); // Clear Carry Flag
+        void CLD(); // Clear Decimal Mode
+        void CLI(); // Clear Interrupt Disable
+        void CLV(); // Clear Overflow Flag
+        void CMP(); // Compare Accumulator
+        void CPX(); // Compare X Register
+        void CPY(); // Compare Y Register
+        void DEC(); // Decrement Memory
+        void DEX(); // Decrement X Register
+        void DEY(); // Decrement Y Register
+        void EOR(); // Exclusive Or with Accumulator
+        void INC(); // Increment Memory
+        void INX(); // Increment X Register
+        void INY(); // Increment Y Register
+        void JMP(); // Jump to Address
+        void JSR(); // Jump to Subroutine
+        void LDA(); // Load Accumulator
+        void LDX(); // Load X Register
+        void LDY(); // Load Y Register
+        void LSR(); // Logical Shift Right
+        void NOP(); // No Operation
+        void ORA(); // Or with Accumulator
+        void PHA(); // Push Accumulator
+        void PHP(); // Push Processor Status
+        void PLA(); // Pull Accumulator
+        void PLP(); // Pull Processor Status
+        void ROL(); // Rotate Left
+        void ROR(); // Rotate Right
+        void RTI(); // Return from Interrupt
+        void RTS(); // Return from Subroutine
+        void SBC(); // Subtract with Carry
+        void SEC(); // Set Carry Flag
+        void SED(); // Set Decimal Mode
+        void SEI(); // Set Interrupt Disable
+        void STA(); // Store Accumulator
+        void STX(); // Store X Register
+        void STY(); // Store Y Register
+        void TAX(); // Transfer Accumulator to X
+        void TAY(); // Transfer Accumulator to Y
+        void TSX(); // Transfer Stack Pointer to X
+        void TXA(); // Transfer X to Accumulator
+        void TXS(); // Transfer X to Stack Pointer
+        void TYA(); // Transfer Y to Accumulator
+        void XXX(); // Catches all illegal Instructions!
+
+        void EnterInterrupt(const Address);
+
+        // Dispatch
+        template <typename Profiler> uint8_t ExecuteInstructionWith(Profiler&);
+        uint8_t ExecuteDecoded(const DecodedInstruction&);
+        uint64_t RunDecodedBlock();
+        bool RunCompiledBlock();
+        bool ExecuteAddressingMode(const AddressingModes::Mode);
+        void ExecuteOperation(const Operations::Operation);
+
+        // Idle loops
+        void SkipIdleLoop();
+        bool IsIdleLoopCode(const Address, const Address);
+        uint64_t GetIdleLoopStableCycle(const Address, const Address);
 
         // Utility Functions
-        inline uint8_t GetNumberOfBaseClockCyclesForOperation(const Opcode);
+        inline bool IsAccumulatorOperand() const;
         inline bool GetFlagFromStatusRegister(const StatusRegisterFlags::Flags);
         inline void SetFlagInStatusRegister(const StatusRegisterFlags::Flags, const bool);
+        inline void SetZeroAndNegativeFlags(const Byte);
+        inline void TakeBranch();
+        inline void NoteBackwardJump();
 
     private:
-        Register Accumulator;
-        Register X;
-        Register Y;
-        Register StackPointer;
-        Register StatusRegister;
-        LargeRegister ProgramCounter;
+        Bus* ConnectedBus = nullptr;
+        DecodeCache* ConnectedDecodeCache = nullptr;
+        JitCompiler* ConnectedJit = nullptr;
+
+        Register Accumulator = 0x00;
+        Register X = 0x00;
+        Register Y = 0x00;
+        Register StackPointer = 0x00;
+        Register StatusRegister = 0x00; // Holds I, D, B and U; N/Z/C/V are kept lazily below
+
+        // Z is set when ZeroResult is zero, N is bit 7 of NegativeResult. Most ALU
+        // operations store the same result byte into both instead of rewriting flags.
+        Byte ZeroResult = 0x01;
+        Byte NegativeResult = 0x00;
+        bool CarryFlag = false;
+        bool OverflowFlag = false;
+        LargeRegister ProgramCounter = 0x0000;
     
-        Byte FetchedData;
-        Address AbsoluteAddress;
-        Address RelativeAddress;
-        Opcode CurrentOpcode;
-        uint8_t CyclesLeft;
+        Byte FetchedData = 0x00;
+        uint16_t Operand = 0x0000;
+        Address AbsoluteAddress = 0x0000;
+        Address RelativeAddress = 0x0000;
+        Opcode CurrentOpcode = 0x00;
+        uint8_t CyclesLeft = 0;
+        uint64_t TotalCycles = 0;
+        uint64_t TimesliceEnd = 0;
+
+        uint16_t TemporaryStorage = 0x0000;
 
-        uint16_t TemporaryStorage;
+        // The last jump back to an earlier address, noted by the branch handlers and
+        // JMP, and the loop it closed when last checked
+        struct IdleLoop {
+            Address start;
+            Address end; // Just past the jump
+            uint32_t firstPageGeneration;
+            uint32_t lastPageGeneration;
+            bool isIdleCode;
+        };
 
-        std::array<Instruction, NUMBER_OF_LEGAL_INSTRUCTIONS> OpcodeTable;
+        Address BackwardJumpTarget = 0x0000;
+        Address BackwardJumpEnd = 0x0000;
+        bool HasJumpedBack = false;
+        bool IsIdleLoopSkipping = false;
+        IdleLoop LastIdleLoop{};
+        uint64_t IdleCyclesSkipped = 0;
 };
 
+template <typename Profiler>
+void
+CPU::ClockWith(Profiler& profiler)
+{
+    if (CyclesLeft == 0) {
+        // If we have entered here, it means that the previous instruction has completed
+        // its cycle count and we can move on to the next instruction.
+        CyclesLeft = ExecuteInstructionWith(profiler);
+    }
+
+    --CyclesLeft;
+    ++TotalCycles;
+}
+
+template <typename Profiler>
+uint32_t
+CPU::StepWith(Profiler& profiler)
+{
+    // Finish an instruction that Clock() has already started before running a new one.
+    uint32_t cyclesConsumed = CyclesLeft;
+    if (cyclesConsumed == 0) {
+        cyclesConsumed = ExecuteInstructionWith(profiler);
+    }
+
+    CyclesLeft = 0;
+    TotalCycles += cyclesConsumed;
+    return cyclesConsumed;
+}
+
+template <typename Profiler>
+uint8_t
+CPU::ExecuteInstructionWith(Profiler& profiler)
+{
+    DecodedInstruction decoded;
+    const Address programCounter = ProgramCounter;
+    Decode(programCounter, decoded);
+    profiler.BeginInstruction(*this, decoded);
+    const uint8_t cyclesConsumed = ExecuteDecoded(decoded);
+    profiler.RecordInstruction(programCounter, decoded.opcode, cyclesConsumed);
+    return cyclesConsumed;
+}
+
+template <typename Profiler>
+uint64_t
+CPU::RunCyclesWith(const uint64_t cycles, Profiler& profiler)
+{
+    const uint64_t startCycle = TotalCycles;
+    TimesliceEnd = TotalCycles + cycles;
+    while (TotalCycles < TimesliceEnd) {
+        StepWith(profiler);
+    }
+    return TotalCycles - startCycle;
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,82 @@
+#ifndef CARTRIDGE_HPP
+#define CARTRIDGE_HPP
+
+#include <cstddef>
+
+#include "PPU.hpp"
+#include "Typedefs.hpp"
+
+constexpr uint32_t INES_MAGIC = 0x1A53454E; // "NES\x1A" in little-endian byte order
+constexpr size_t INES_HEADER_SIZE = 16;
+constexpr size_t INES_TRAINER_SIZE = 512;
+constexpr size_t PRG_ROM_UNIT_SIZE = 0x4000;
+constexpr size_t CHR_ROM_UNIT_SIZE = 0x2000;
+constexpr size_t PRG_RAM_UNIT_SIZE = 0x2000;
+
+constexpr std::pair<uint16_t, uint16_t> PRG_RAM_UNIT = { 0x6000, 0x7FFF };
+constexpr std::pair<uint16_t, uint16_t> PRG_ROM_UNIT = { 0x8000, 0xFFFF };
+constexpr Address TRAINER_ADDRESS = 0x7000;
+
+// An iNES or NES 2.0 image. The file is mapped read-only and shared, so PRG and CHR
+// are views straight into the page cache: loading copies nothing, and every
+// instance running the same ROM shares one physical copy of it. Only RAM the game
+// can write (PRG-RAM, CHR-RAM) is allocated per instance, by whoever inserts it.
+class Cartridge
+{
+    public:
+        Cartridge() = default;
+        ~Cartridge();
+
+        Cartridge(const Cartridge&) = delete;
+        Cartridge& operator=(const Cartridge&) = delete;
+
+        bool Load(const char*);
+
+        // Parses an image the caller keeps alive, e.g. one embedded in the binary.
+        bool LoadFromData(const Byte*, const size_t);
+        void Unload();
+
+        bool IsLoaded() const { return PrgRom != nullptr; }
+        bool IsNes20() const { return Nes20; }
+
+        const Byte* GetPrgRom() const { return PrgRom; }
+        size_t GetPrgRomSize() const { return PrgRomSize; }
+        const Byte* GetChrRom() const { return ChrRom; }
+        size_t GetChrRomSize() const { return ChrRomSize; }
+        const Byte* GetTrainer() const { return Trainer; }
+
+        size_t GetPrgRamSize() const { return PrgRamSize; }
+        size_t GetChrRamSize() const { return ChrRamSize; }
+
+        uint16_t GetMapperNumber() const { return MapperNumber; }
+        uint8_t GetSubmapperNumber() const { return SubmapperNumber; }
+        NametableMirroring::Mode GetMirroring() const { return Mirroring; }
+        bool IsFourScreen() const { return FourScreen; }
+        bool HasBattery() const { return Battery; }
+
+    private:
+        bool ParseImage(const Byte*, const size_t);
+
+    private:
+        // The whole file as mapped; null when parsing a caller-owned image
+        void* Mapping = nullptr;
+        size_t MappingSize = 0;
+
+        const Byte* PrgRom = nullptr;
+        size_t PrgRomSize = 0;
+        const Byte* ChrRom = nullptr;
+        size_t ChrRomSize = 0;
+        const Byte* Trainer = nullptr;
+
+        size_t PrgRamSize = 0;
+        size_t ChrRamSize = 0;
+
+        uint16_t MapperNumber = 0;
+        uint8_t SubmapperNumber = 0;
+        NametableMirroring::Mode Mirroring = NametableMirroring::Horizontal;
+        bool FourScreen = false;
+        bool Battery = false;
+        bool Nes20 = false;
+};
+
+#endif
@@ -2,29 +2,46 @@
 #define CONSTANTS_HPP
 
 #include <cstdint>
-#include <pair>
+#include <utility>
 
-constexpr std::pair<uint8_t, uint8_t> MEMORY_UNIT = { 0x0000, 0x07FF };
-constexpr uint8_t MEMORY_SIZE = MEMORY_UNIT.second - MEMORY_UNIT.first + 1;
+constexpr std::pair<uint16_t, uint16_t> MEMORY_UNIT = { 0x0000, 0x07FF };
+constexpr uint16_t MEMORY_SIZE = MEMORY_UNIT.second - MEMORY_UNIT.first + 1;
 
-constexpr std::pair<uint8_t, uint8_t> APU_UNIT = { 0x4000, 0x4017 };
-constexpr uint8_t APU_SIZE = APU_UNIT.second - APU_UNIT.first + 1;
+// The 2 KB of RAM repeats four times over $0000-$1FFF
+constexpr std::pair<uint16_t, uint16_t> MEMORY_MIRRORED_UNIT = { 0x0000, 0x1FFF };
 
-constexpr std::pair<uint8_t, uint8_t> PPU_UNIT = { 0x2000, 0x2007 };
-constexpr uint8_t PPU_SIZE = PPU_UNIT.second - PPU_UNIT.first + 1;
+constexpr std::pair<uint16_t, uint16_t> APU_UNIT = { 0x4000, 0x4017 };
+constexpr uint16_t APU_SIZE = APU_UNIT.second - APU_UNIT.first + 1;
 
-constexpr std::pair<uint8_t, uint8_t> CARTRIDGE_UNIT = { 0x4020, 0xFFFF };
-constexpr uint8_t CARTRIDGE_SIZE = CARTRIDGE_UNIT.second - CARTRIDGE_UNIT.first + 1;
+// APU, OAM DMA and controller ports, plus the test-mode registers up to $401F
+constexpr std::pair<uint16_t, uint16_t> IO_UNIT = { 0x4000, 0x401F };
 
-constexpr std::pair<uint8_t, uint8_t> PPU_GRAPHICS_MEMORY = { 0x0000, 0x0FFF };
-constexpr uint8_t PPU_GRAPHICS_SIZE = PPU_GRAPHICS_MEMORY.second - PPU_GRAPHICS_MEMORY.first + 1;
+constexpr std::pair<uint16_t, uint16_t> PPU_UNIT = { 0x2000, 0x2007 };
+constexpr uint16_t PPU_SIZE = PPU_UNIT.second - PPU_UNIT.first + 1;
 
-constexpr std::pair<uint8_t, uint8_t> PPU_VRAM_UNIT = { 0x2000, 0x27FF };
-constexpr uint8_t PPU_VRAM_SIZE = PPU_VRAM_UNIT.second - PPU_VRAM_UNIT.first + 1;
+// The eight PPU registers repeat every 8 bytes over $2000-$3FFF
+constexpr std::pair<uint16_t, uint16_t> PPU_MIRRORED_UNIT = { 0x2000, 0x3FFF };
 
-constexpr std::pair<uint8_t, uint8_t> PPU_PALLETES_UNIT = { 0x3F00, 0x3FFF };
-constexpr uint8_t PPU_PALLETES_SIZE = PPU_PALLETES_UNIT.second - PPU_PALLETES_UNIT.first + 1;
+constexpr std::pair<uint16_t, uint16_t> CARTRIDGE_UNIT = { 0x4020, 0xFFFF };
+constexpr uint16_t CARTRIDGE_SIZE = CARTRIDGE_UNIT.second - CARTRIDGE_UNIT.first + 1;
+
+constexpr std::pair<uint16_t, uint16_t> PPU_GRAPHICS_MEMORY = { 0x0000, 0x0FFF };
+constexpr uint16_t PPU_GRAPHICS_SIZE = PPU_GRAPHICS_MEMORY.second - PPU_GRAPHICS_MEMORY.first + 1;
+
+constexpr std::pair<uint16_t, uint16_t> PPU_VRAM_UNIT = { 0x2000, 0x27FF };
+constexpr uint16_t PPU_VRAM_SIZE = PPU_VRAM_UNIT.second - PPU_VRAM_UNIT.first + 1;
+
+constexpr std::pair<uint16_t, uint16_t> PPU_PALLETES_UNIT = { 0x3F00, 0x3FFF };
+constexpr uint16_t PPU_PALLETES_SIZE = PPU_PALLETES_UNIT.second - PPU_PALLETES_UNIT.first + 1;
 
 constexpr uint8_t NUMBER_OF_LEGAL_INSTRUCTIONS = 56;
+constexpr uint16_t NUMBER_OF_OPCODES = 256;
+
+// The CPU address space is split into 256 pages of 256 bytes for the Bus page table
+constexpr uint16_t BUS_PAGE_SIZE = 0x100;
+constexpr uint16_t NUMBER_OF_BUS_PAGES = 0x100;
+
+// Cycle value for "no event scheduled"
+constexpr uint64_t NO_PENDING_EVENT = UINT64_MAX;
 
-#endif
\ No newline at end of file
+#endif
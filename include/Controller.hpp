@@ -0,0 +1,44 @@
+#ifndef CONTROLLER_HPP
+#define CONTROLLER_HPP
+
+#include <cstddef>
+
+#include "Typedefs.hpp"
+
+constexpr Address CONTROLLER_PORT_1 = 0x4016;
+constexpr Address CONTROLLER_PORT_2 = 0x4017;
+constexpr size_t NUMBER_OF_CONTROLLERS = 2;
+
+// Bit order of the shift register, which is also the order the buttons are read in
+namespace ControllerButtons {
+    enum Button : Byte {
+        A = 1 << 0,
+        B = 1 << 1,
+        Select = 1 << 2,
+        Start = 1 << 3,
+        Up = 1 << 4,
+        Down = 1 << 5,
+        Left = 1 << 6,
+        Right = 1 << 7,
+    };
+}
+
+// Standard controller: the buttons are latched into an 8-bit shift register while
+// the strobe bit of $4016 is high, and each read shifts one out on bit 0. After the
+// eighth read the register returns 1s.
+class Controller
+{
+    public:
+        void SetButtons(const Byte buttons) { Buttons = buttons; }
+        Byte GetButtons() const { return Buttons; }
+
+        void Strobe(const Byte);
+        Byte Read();
+
+    private:
+        Byte Buttons = 0x00;
+        Byte ShiftRegister = 0x00;
+        bool IsStrobing = false;
+};
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef DECODE_CACHE_HPP
+#define DECODE_CACHE_HPP
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include "Typedefs.hpp"
+
+class Bus;
+
+constexpr size_t MAXIMUM_DECODED_BLOCK_LENGTH = 16;
+constexpr size_t DEFAULT_DECODE_CACHE_BLOCKS = 1024;
+
+// A straight run of instructions ending at the first one that can change the
+// Program Counter other than by falling through.
+struct DecodedBlock {
+    Address start;
+    uint8_t count;
+    uint8_t firstPage;
+    uint8_t lastPage;
+    bool isValid;
+    uint32_t firstPageGeneration;
+    uint32_t lastPageGeneration;
+    std::array<DecodedInstruction, MAXIMUM_DECODED_BLOCK_LENGTH> instructions;
+};
+
+// Direct-mapped cache of decoded blocks keyed by start address. Only code in
+// memory pages is cached. A block is stale once either page it was read from has
+// a new generation on the Bus, which happens on bank switches and on writes to
+// RAM pages that hold cached code.
+class DecodeCache
+{
+    public:
+        explicit DecodeCache(Bus&, const size_t numberOfBlocks = DEFAULT_DECODE_CACHE_BLOCKS);
+        ~DecodeCache() = default;
+
+        // Returns nullptr when the address is not in a memory page.
+        const DecodedBlock* Lookup(CPU&, const Address);
+        bool IsCurrent(const DecodedBlock&) const;
+        void Invalidate();
+
+    private:
+        bool Build(CPU&, const Address, DecodedBlock&);
+
+    private:
+        Bus& ConnectedBus;
+        std::vector<DecodedBlock> Blocks;
+        size_t IndexMask;
+};
+
+#endif
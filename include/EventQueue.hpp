@@ -0,0 +1,48 @@
+#ifndef EVENT_QUEUE_HPP
+#define EVENT_QUEUE_HPP
+
+#include <array>
+
+#include "Constants.hpp"
+#include "Typedefs.hpp"
+
+constexpr uint8_t EVENT_QUEUE_CAPACITY = 32;
+
+struct ScheduledEvent {
+    uint64_t cycle;
+    EventTypes::Type type;
+    uint8_t source; // Device index for interrupts
+    Byte data;      // Source page for DMA
+};
+
+// Fixed-capacity binary min-heap keyed on cycle. The run loop only needs the earliest
+// deadline, so peeking is O(1) and nothing is allocated once constructed.
+class EventQueue
+{
+    public:
+        EventQueue() = default;
+        ~EventQueue() = default;
+
+        bool Push(const ScheduledEvent&);
+        bool Pop(ScheduledEvent&);
+
+        // Replaces any pending event of this type from this source; NO_PENDING_EVENT
+        // just removes it.
+        bool Reschedule(const EventTypes::Type, const uint8_t, const uint64_t);
+
+        uint64_t GetNextCycle() const { return Count != 0 ? Events[0].cycle : NO_PENDING_EVENT; }
+        bool IsEmpty() const { return Count == 0; }
+        uint8_t GetCount() const { return Count; }
+        void Clear() { Count = 0; }
+
+    private:
+        void RemoveAt(const uint8_t);
+        void SiftUp(uint8_t);
+        void SiftDown(uint8_t);
+
+    private:
+        std::array<ScheduledEvent, EVENT_QUEUE_CAPACITY> Events{};
+        uint8_t Count = 0;
+};
+
+#endif
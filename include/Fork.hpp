@@ -0,0 +1,79 @@
+#ifndef FORK_HPP
+#define FORK_HPP
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "Constants.hpp"
+#include "SaveState.hpp"
+#include "Typedefs.hpp"
+
+class Bus;
+class CPU;
+
+using ForkPage = std::array<Byte, BUS_PAGE_SIZE>;
+
+// A branch point for a search: the CPU registers plus every writable Bus page, which
+// covers the 2 KB of RAM and any PRG-RAM. Pages are immutable and reference counted,
+// so forks taken along the same line of play share every page neither side has
+// written since. Copying a StateFork only copies the page pointers.
+class StateFork
+{
+    friend class ForkTracker;
+
+    public:
+        bool IsEmpty() const { return Layout == nullptr; }
+        size_t GetPageCount() const { return Pages.size(); }
+
+    private:
+        CPUState Cpu{};
+
+        // Bus page each entry was taken from; mirrors of a page are left out
+        std::shared_ptr<const std::vector<uint8_t>> Layout;
+        std::vector<std::shared_ptr<const ForkPage>> Pages;
+};
+
+// Takes and restores forks of one CPU and Bus with copy-on-write pages. After a fork
+// or a restore every page is clean and off the Bus fast path; the first write to a
+// page puts it back and marks it dirty. Only dirty pages are copied by the next
+// Fork(), and Restore() only copies pages that are dirty or hold something other than
+// the fork does, so the cost of either follows the pages actually written.
+//
+// Any fork can be restored into any instance with the same memory mapped. Like a
+// SaveState, a fork holds no PPU, APU or mapper state.
+class ForkTracker
+{
+    public:
+        ForkTracker(CPU&, Bus&);
+        ~ForkTracker() = default;
+
+        ForkTracker(const ForkTracker&) = delete;
+        ForkTracker& operator=(const ForkTracker&) = delete;
+
+        StateFork Fork();
+        bool Restore(const StateFork&); // Fails on an empty fork or a different layout
+
+        uint64_t GetPagesCopied() const { return PagesCopied; }
+        uint64_t GetPagesRestored() const { return PagesRestored; }
+
+    private:
+        void UpdateLayout();
+
+    private:
+        CPU& ConnectedCPU;
+        Bus& ConnectedBus;
+
+        // Writable memory behind each Bus page when the layout was last built
+        std::array<Byte*, NUMBER_OF_BUS_PAGES> MappedMemory{};
+        std::shared_ptr<const std::vector<uint8_t>> Layout;
+
+        // The page each layout entry held when it was last cleaned
+        std::vector<std::shared_ptr<const ForkPage>> Pages;
+
+        uint64_t PagesCopied = 0;
+        uint64_t PagesRestored = 0;
+};
+
+#endif
@@ -0,0 +1,125 @@
+#ifndef JIT_HPP
+#define JIT_HPP
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include "Constants.hpp"
+#include "Typedefs.hpp"
+
+class Bus;
+class CPU;
+
+constexpr size_t DEFAULT_JIT_CACHE_BLOCKS = 4096;
+constexpr size_t DEFAULT_JIT_CODE_SIZE = 4 << 20;
+constexpr size_t MAXIMUM_COMPILED_BLOCK_LENGTH = 64;
+
+// Times a block start has to be reached before it is worth compiling
+constexpr uint32_t JIT_HOT_THRESHOLD = 16;
+
+// Guest state as compiled code sees it. The CPU copies itself in before a block
+// runs and back out afterwards; in between A, X, Y and the Stack Pointer live in
+// host registers and everything else is addressed off this struct.
+struct JitRegisters {
+    uint64_t totalCycles;
+    uint64_t timesliceEnd;
+    Address programCounter;
+    Register accumulator;
+    Register x;
+    Register y;
+    Register stackPointer;
+    Byte zeroResult;
+    Byte negativeResult;
+    bool carryFlag;
+    bool overflowFlag;
+};
+
+using CompiledFunction = void (*)(JitRegisters*);
+
+struct CompiledBlock {
+    Address start;
+    uint8_t firstPage;
+    uint8_t lastPage;
+    bool isRejected;
+    uint32_t firstPageGeneration;
+    uint32_t lastPageGeneration;
+    uint32_t executions;
+
+    // Upper bound on the cycles one pass through the block can take
+    uint32_t maximumCycles;
+    CompiledFunction function;
+
+    // Past the prologue, where other blocks jump in when they chain to this one
+    const Byte* chainEntry;
+};
+
+// Translates hot runs of PRG-ROM code into x86-64. Only code in read-only memory
+// pages is compiled, so self-modifying RAM code always stays on the interpreter.
+//
+// Compiled code reaches memory through the Bus page tables. Any access that would
+// take the Bus slow path (device registers, watched pages, ROM writes) leaves the
+// block before the instruction has done anything, and the interpreter runs it with
+// exact timing. Loops inside a block run natively for as long as another full pass
+// is sure to end before the timeslice does, which keeps instruction boundaries
+// where RunCycles() would put them.
+//
+// A block whose exit lands on an already compiled block jumps straight into it,
+// under the same budget check and only while the target's pages are current.
+//
+// On other hosts nothing is ever compiled and Lookup() always returns nullptr.
+class JitCompiler
+{
+    public:
+        explicit JitCompiler(Bus&, const size_t numberOfBlocks = DEFAULT_JIT_CACHE_BLOCKS, const size_t codeSize = DEFAULT_JIT_CODE_SIZE);
+        ~JitCompiler();
+
+        JitCompiler(const JitCompiler&) = delete;
+        JitCompiler& operator=(const JitCompiler&) = delete;
+
+        static bool IsSupported();
+
+        // Returns nullptr until the address is hot, and for code that cannot be compiled.
+        const CompiledBlock* Lookup(CPU&, const Address);
+
+        // Whether a start has already failed to compile and its page is unchanged since.
+        // A bit test the CPU makes before Lookup(), so code the JIT cannot compile
+        // costs no more than without it.
+        bool IsRejected(const Address address) const
+        {
+            const size_t page = address >> 8;
+            return ((RejectedStarts[address >> 6] >> (address & 63)) & 1) != 0
+                && RejectedGenerations[page] == PageGenerations[page];
+        }
+        bool IsCurrent(const CompiledBlock&) const;
+        void Invalidate();
+
+        // The compiled block starting at the address, if there is a current one.
+        const CompiledBlock* FindCompiled(const Address) const;
+
+        uint64_t GetBlocksCompiled() const { return BlocksCompiled; }
+        size_t GetCodeBytesUsed() const { return CodeUsed; }
+
+    private:
+        bool Compile(CPU&, const Address, CompiledBlock&);
+        size_t GetBlockIndex(const Address) const;
+        bool IsReadOnlyPage(const size_t) const;
+        void MarkRejected(const Address);
+
+    private:
+        Bus& ConnectedBus;
+        const uint32_t* PageGenerations;
+        std::vector<CompiledBlock> Blocks;
+
+        // One bit per address, valid while the page generation matches
+        std::array<uint64_t, (NUMBER_OF_BUS_PAGES * BUS_PAGE_SIZE) / 64> RejectedStarts{};
+        std::array<uint32_t, NUMBER_OF_BUS_PAGES> RejectedGenerations{};
+        size_t IndexMask;
+
+        Byte* Code = nullptr;
+        size_t CodeCapacity = 0;
+        size_t CodeUsed = 0;
+        uint64_t BlocksCompiled = 0;
+};
+
+#endif
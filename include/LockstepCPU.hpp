@@ -0,0 +1,134 @@
+#ifndef LOCKSTEP_CPU_HPP
+#define LOCKSTEP_CPU_HPP
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include "Constants.hpp"
+#include "SaveState.hpp"
+#include "Typedefs.hpp"
+
+class Bus;
+
+// PRG space shared by every lane; code outside it is fetched per lane
+constexpr std::pair<uint16_t, uint16_t> LOCKSTEP_PROGRAM_UNIT = { 0x8000, 0xFFFF };
+constexpr size_t LOCKSTEP_PROGRAM_SIZE = LOCKSTEP_PROGRAM_UNIT.second - LOCKSTEP_PROGRAM_UNIT.first + 1;
+
+// Runs many instances of one program side by side, with every register and every
+// byte of RAM stored as an array across lanes. On each step the lane furthest behind
+// picks the Program Counter, and every lane sitting on the same address executes
+// that instruction together: it is decoded once, and the registers, flags and RAM
+// rows of all those lanes are updated with masked, fixed-width loops that compile to
+// AVX2/AVX-512 code under ARCH_FLAGS. Lanes that diverge simply wait until the
+// leader reaches their address, so they regroup as soon as control flow merges.
+//
+// Each lane ends a run exactly where CPU::RunCycles() would, with the same state.
+// The program is fixed; accesses outside RAM and the program go to the lane's own
+// Bus, if one is connected, so a lane can still have its own PPU, APU or mapper
+// ports. PRG bank switching is not modelled.
+template <size_t Lanes>
+class LockstepCPU
+{
+    static_assert(Lanes == 8 || Lanes == 16 || Lanes == 32, "LockstepCPU runs 8, 16 or 32 lanes");
+
+    public:
+        using LaneMask = uint32_t;
+
+        LockstepCPU();
+        ~LockstepCPU() = default;
+
+        LockstepCPU(const LockstepCPU&) = delete;
+        LockstepCPU& operator=(const LockstepCPU&) = delete;
+
+        // Mirrored over LOCKSTEP_PROGRAM_UNIT the way Bus::MapReadOnlyMemory() would.
+        void MapProgram(const Byte*, const size_t);
+        void ConnectLaneBus(const size_t lane, Bus* bus) { LaneBuses[lane] = bus; }
+
+        // Resets and enables every lane. As with CPU::Step(), the 7 cycles of the
+        // reset and interrupt sequences are spent straight away.
+        void Reset();
+        void InterruptRequest(const size_t);
+        void NonMaskableInterrupt(const size_t);
+
+        // Every enabled lane runs at least the given number of cycles.
+        void RunCycles(const uint64_t);
+
+        // Moves one instance in or out. Loading a lane also enables it.
+        bool LoadLane(const size_t, const SaveState&);
+        void StoreLane(const size_t, SaveState&) const;
+        void SetLaneEnabled(const size_t lane, const bool isEnabled) { Enabled[lane] = isEnabled ? 0xFF : 0x00; }
+
+        uint64_t GetTotalCycles(const size_t lane) const { return TotalCycles[lane]; }
+        Address GetProgramCounter(const size_t lane) const { return ProgramCounter[lane]; }
+        Byte GetRamByte(const size_t lane, const Address address) const { return Ram[address & (MEMORY_SIZE - 1)][lane]; }
+
+        // Lane instructions over groups tells how well the lanes stay together.
+        uint64_t GetGroupsExecuted() const { return GroupsExecuted; }
+        uint64_t GetLaneInstructionsExecuted() const { return LaneInstructionsExecuted; }
+
+    private:
+        template <typename T> using LaneArray = std::array<T, Lanes>;
+        using LaneBytes = LaneArray<Byte>;
+
+        // How an instruction reaches its operand: the same address in every lane, or
+        // one address per lane.
+        enum class OperandKind { None, Accumulator, Immediate, Uniform, PerLane };
+
+        struct Operand {
+            OperandKind kind;
+            Address address;
+            alignas(64) LaneArray<Address> addresses;
+            alignas(32) LaneBytes hasPageChanged;
+        };
+
+        void ExecuteGroup(const Address, const LaneBytes&, const LaneMask);
+        void ResolveOperand(const AddressingModes::Mode, const uint16_t, const LaneMask, Operand&);
+        void ReadOperand(const Operand&, const LaneMask, LaneBytes&);
+        void WriteOperand(const Operand&, const LaneBytes&, const LaneBytes&, const LaneMask);
+        void SetZeroAndNegativeFlags(const LaneBytes&, const LaneBytes&);
+
+        Byte ReadLane(const size_t, const Address);
+        void WriteLane(const size_t, const Address, const Byte);
+        void Push(const size_t lane, const Byte data) { Ram[0x0100 | StackPointer[lane]][lane] = data; --StackPointer[lane]; }
+        Byte Pull(const size_t lane) { ++StackPointer[lane]; return Ram[0x0100 | StackPointer[lane]][lane]; }
+        Byte GetStatusRegister(const size_t) const;
+        void SetStatusRegister(const size_t, const Byte);
+        void EnterInterrupt(const size_t, const Address);
+
+        static LaneMask ToLaneMask(const LaneBytes&);
+
+    private:
+        alignas(32) LaneBytes Accumulator{};
+        alignas(32) LaneBytes X{};
+        alignas(32) LaneBytes Y{};
+        alignas(32) LaneBytes StackPointer{};
+        alignas(32) LaneBytes StatusRegister{}; // I, D, B and U, as in CPU
+
+        // The lazily kept N/Z/C/V flags, with the same meaning as in CPU
+        alignas(32) LaneBytes ZeroResult{};
+        alignas(32) LaneBytes NegativeResult{};
+        alignas(32) LaneBytes CarryFlag{};
+        alignas(32) LaneBytes OverflowFlag{};
+
+        alignas(64) LaneArray<Address> ProgramCounter{};
+        alignas(64) LaneArray<uint64_t> TotalCycles{};
+
+        // Cycles each lane has left of the current pass through RunCycles()
+        alignas(64) LaneArray<int32_t> Budget{};
+        alignas(32) LaneBytes Enabled{};
+
+        // One row per RAM address, holding that byte for every lane
+        std::vector<LaneBytes> Ram;
+        std::vector<Byte> Program;
+        LaneArray<Bus*> LaneBuses{};
+
+        uint64_t GroupsExecuted = 0;
+        uint64_t LaneInstructionsExecuted = 0;
+};
+
+extern template class LockstepCPU<8>;
+extern template class LockstepCPU<16>;
+extern template class LockstepCPU<32>;
+
+#endif
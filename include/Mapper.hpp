@@ -0,0 +1,64 @@
+#ifndef MAPPER_HPP
+#define MAPPER_HPP
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "Bus.hpp"
+#include "Cartridge.hpp"
+#include "PPU.hpp"
+#include "Typedefs.hpp"
+
+constexpr size_t CHR_BANK_UNIT_SIZE = PPU_PATTERN_BANK_SIZE;
+
+// Cartridge board logic. Bank switching only repoints pages: PRG banks become read
+// pointers in the bus page table and CHR banks become PPU pattern slots, so no
+// access ever does bank arithmetic. The mapper stays the device behind its PRG pages,
+// which is where register writes to the read-only ROM land.
+//
+// Mappers are synchronized devices. Catching up runs the PPU first, so a CHR or
+// mirroring switch never affects pixels that were due before the write.
+class Mapper : public BusDevice, public SynchronizedDevice
+{
+    public:
+        Mapper(const Cartridge&, Bus&, PPU&);
+        ~Mapper() override = default;
+
+        Mapper(const Mapper&) = delete;
+        Mapper& operator=(const Mapper&) = delete;
+
+        // Returns nullptr for boards that are not supported.
+        static std::unique_ptr<Mapper> Create(const Cartridge&, Bus&, PPU&);
+
+        // Maps PRG-RAM and the power-on banks. Call after the mapper owns $8000-$FFFF.
+        virtual void Reset();
+
+        Byte Read(const Address) override { return 0x00; }
+        void Write(const Address, const Byte) override {}
+
+        void CatchUp(const uint64_t cycle) override { ConnectedPPU.CatchUp(cycle); }
+        uint64_t GetNextEventCycle() const override { return NO_PENDING_EVENT; }
+        EventTypes::Type GetEventType() const override { return EventTypes::InterruptRequest; }
+
+        Byte* GetPrgRam() { return PrgRam.data(); }
+        size_t GetPrgRamSize() const { return PrgRam.size(); }
+        size_t GetChrRamSize() const { return ChrRam.size(); }
+
+    protected:
+        // Bank numbers wrap around the ROM size; negative ones count from the end.
+        void MapPrgBank(const Address, const size_t, const int);
+        void MapChrBank(const size_t, const size_t, const int);
+        void SetMirroring(const NametableMirroring::Mode);
+
+    protected:
+        const Cartridge& ConnectedCartridge;
+        Bus& ConnectedBus;
+        PPU& ConnectedPPU;
+
+        std::vector<Byte> PrgRam;
+        std::vector<Byte> ChrRam;
+        std::array<Byte, PPU_NAMETABLE_SIZE * NUMBER_OF_NAMETABLES> FourScreenVram{};
+};
+
+#endif
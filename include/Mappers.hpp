@@ -0,0 +1,92 @@
+#ifndef MAPPERS_HPP
+#define MAPPERS_HPP
+
+#include <array>
+
+#include "Mapper.hpp"
+#include "PPU.hpp"
+
+constexpr size_t PRG_BANK_8K = 0x2000;
+constexpr size_t PRG_BANK_16K = 0x4000;
+constexpr size_t PRG_BANK_32K = 0x8000;
+constexpr size_t CHR_BANK_1K = 0x0400;
+constexpr size_t CHR_BANK_2K = 0x0800;
+constexpr size_t CHR_BANK_4K = 0x1000;
+constexpr size_t CHR_BANK_8K = 0x2000;
+
+// Mapper 0: fixed 16/32 KB PRG and 8 KB CHR.
+class NROM : public Mapper
+{
+    public:
+        using Mapper::Mapper;
+};
+
+// Mapper 1: registers loaded one bit at a time through a 5-bit shift register.
+class MMC1 : public Mapper
+{
+    public:
+        using Mapper::Mapper;
+
+        void Reset() override;
+        void Write(const Address, const Byte) override;
+
+    private:
+        void UpdateBanks();
+
+    private:
+        Byte ShiftRegister = 0x10; // The marker bit reaches bit 0 after the fifth write
+        Byte ControlRegister = 0x0C;
+        Byte ChrBank0 = 0x00;
+        Byte ChrBank1 = 0x00;
+        Byte PrgBank = 0x00;
+};
+
+// Mapper 2: switchable 16 KB at $8000, last bank fixed at $C000, CHR-RAM.
+class UxROM : public Mapper
+{
+    public:
+        using Mapper::Mapper;
+
+        void Reset() override;
+        void Write(const Address, const Byte) override;
+};
+
+// Mapper 3: fixed PRG, switchable 8 KB CHR.
+class CNROM : public Mapper
+{
+    public:
+        using Mapper::Mapper;
+
+        void Write(const Address, const Byte) override;
+};
+
+// Mapper 4: 8 KB PRG and 1/2 KB CHR banking plus a scanline IRQ. The counter is
+// clocked by the PPU, and its next expiry is predicted from the PPU position so the
+// scheduler can run the CPU straight up to it.
+class MMC3 : public Mapper, public ScanlineCounter
+{
+    public:
+        using Mapper::Mapper;
+
+        void Reset() override;
+        void Write(const Address, const Byte) override;
+
+        void ClockScanline() override;
+        uint64_t GetNextEventCycle() const override;
+        bool IsInterruptRequested() const override { return IrqAsserted; }
+
+    private:
+        void UpdateBanks();
+
+    private:
+        Byte BankSelect = 0x00;
+        std::array<Byte, 8> BankRegisters{};
+
+        Byte IrqLatch = 0x00;
+        Byte IrqCounter = 0x00;
+        bool IrqReload = false;
+        bool IrqEnabled = false;
+        bool IrqAsserted = false;
+};
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef MOVIE_HPP
+#define MOVIE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdio>
+#include <type_traits>
+
+#include "Controller.hpp"
+#include "Typedefs.hpp"
+
+class System;
+
+constexpr uint32_t MOVIE_FILE_MAGIC = 0x4D53454E; // "NESM" in little-endian byte order
+constexpr uint16_t MOVIE_FILE_VERSION = 1;
+
+// Frames with the same input are stored as one run of at most this many
+constexpr size_t MAXIMUM_MOVIE_RUN = 256;
+
+// The frame count is only known once recording ends, so it is written last.
+struct MovieFileHeader {
+    uint64_t frameCount;
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t initialStateHash;
+    uint32_t reserved2;
+};
+
+static_assert(sizeof(MovieFileHeader) == 24, "MovieFileHeader layout must stay fixed");
+static_assert(std::is_trivially_copyable<MovieFileHeader>::value, "MovieFileHeader must be a flat record");
+
+namespace MovieStatus {
+    enum Status {
+        Running,
+        Finished,
+        Diverged,
+        Failed, // Unreadable, truncated or not a movie
+    };
+}
+
+// FNV-1a over the CPU registers, RAM and PRG-RAM: everything a game's logic keeps.
+uint32_t HashSystemState(System&);
+
+// Movie file layout: the header, then runs of frames that share the same input. A run
+// is one byte holding its length minus one and one button byte per port, followed by
+// the state hash after each of its frames. Held buttons cost 4 bytes a frame, nearly
+// all of it the hash.
+//
+// Both recording and playback start from the state the system is in when the movie
+// is opened, which should be a reset with the same cartridge; the header keeps the
+// hash of that state to tell. Only the open run is buffered, so a movie of any length
+// records and plays back in constant memory.
+class MovieRecorder
+{
+    public:
+        explicit MovieRecorder(System& system) : ConnectedSystem(system) {}
+        ~MovieRecorder() { Close(); }
+
+        MovieRecorder(const MovieRecorder&) = delete;
+        MovieRecorder& operator=(const MovieRecorder&) = delete;
+
+        bool Open(const char*);
+        bool Close(); // Writes out the last run and the frame count
+
+        // Runs one frame with the given buttons held and logs it.
+        bool RunFrame(const Byte, const Byte);
+
+        uint64_t GetFrameCount() const { return FrameCount; }
+
+    private:
+        bool WriteRun();
+
+    private:
+        System& ConnectedSystem;
+        std::FILE* File = nullptr;
+        bool IsWritten = false;
+        uint32_t InitialStateHash = 0;
+
+        std::array<Byte, NUMBER_OF_CONTROLLERS> RunButtons{};
+        std::array<uint32_t, MAXIMUM_MOVIE_RUN> RunHashes{};
+        size_t RunLength = 0;
+        uint64_t FrameCount = 0;
+};
+
+// Plays a movie back as fast as the emulation runs: there is no throttling, and Play()
+// skips drawing frames since nobody watches them. Each frame's state hash is checked
+// against the recording, so playback stops on the first frame that came out different.
+class MoviePlayer
+{
+    public:
+        explicit MoviePlayer(System& system) : ConnectedSystem(system) {}
+        ~MoviePlayer() { Close(); }
+
+        MoviePlayer(const MoviePlayer&) = delete;
+        MoviePlayer& operator=(const MoviePlayer&) = delete;
+
+        // Fails if the system is not in the state the recording started from.
+        bool Open(const char*);
+        void Close();
+
+        MovieStatus::Status RunFrame();
+        MovieStatus::Status Play();
+
+        // Frames played so far; after a divergence, the last one is where it showed.
+        uint64_t GetFrameCount() const { return FrameCount; }
+        uint64_t GetMovieLength() const { return Header.frameCount; }
+
+    private:
+        System& ConnectedSystem;
+        std::FILE* File = nullptr;
+        MovieFileHeader Header{};
+
+        std::array<Byte, NUMBER_OF_CONTROLLERS> RunButtons{};
+        size_t RunFramesLeft = 0;
+        uint64_t FrameCount = 0;
+};
+
+#endif
@@ -0,0 +1,306 @@
+#ifndef OPCODE_TABLE_HPP
+#define OPCODE_TABLE_HPP
+
+#include <array>
+
+#include "Constants.hpp"
+#include "Typedefs.hpp"
+
+// Every one of the 256 opcodes has an entry, so the table can be indexed with a raw
+// opcode byte without a bounds check. Illegal opcodes keep their real addressing mode
+// and cycle count so the Program Counter and timing stay in step with hardware; the
+// unofficial NOPs and the duplicate SBC ($EB) execute as their official twins, every
+// other illegal opcode executes as XXX.
+constexpr std::array<Instruction, NUMBER_OF_OPCODES> OPCODE_TABLE = {{
+    /* 0x00 */ { Operations::BRK, AddressingModes::Implicit, 7, false, true },
+    /* 0x01 */ { Operations::ORA, AddressingModes::IndirectX, 6, false, true },
+    /* 0x02 */ { Operations::XXX, AddressingModes::Implicit, 2, false, false },
+    /* 0x03 */ { Operations::XXX, AddressingModes::IndirectX, 8, false, false },
+    /* 0x04 */ { Operations::NOP, AddressingModes::ZeroPage, 3, false, false },
+    /* 0x05 */ { Operations::ORA, AddressingModes::ZeroPage, 3, false, true },
+    /* 0x06 */ { Operations::ASL, AddressingModes::ZeroPage, 5, false, true },
+    /* 0x07 */ { Operations::XXX, AddressingModes::ZeroPage, 5, false, false },
+    /* 0x08 */ { Operations::PHP, AddressingModes::Implicit, 3, false, true },
+    /* 0x09 */ { Operations::ORA, AddressingModes::Immediate, 2, false, true },
+    /* 0x0A */ { Operations::ASL, AddressingModes::Accumulator, 2, false, true },
+    /* 0x0B */ { Operations::XXX, AddressingModes::Immediate, 2, false, false },
+    /* 0x0C */ { Operations::NOP, AddressingModes::Absolute, 4, false, false },
+    /* 0x0D */ { Operations::ORA, AddressingModes::Absolute, 4, false, true },
+    /* 0x0E */ { Operations::ASL, AddressingModes::Absolute, 6, false, true },
+    /* 0x0F */ { Operations::XXX, AddressingModes::Absolute, 6, false, false },
+    /* 0x10 */ { Operations::BPL, AddressingModes::Relative, 2, false, true },
+    /* 0x11 */ { Operations::ORA, AddressingModes::IndirectY, 5, true, true },
+    /* 0x12 */ { Operations::XXX, AddressingModes::Implicit, 2, false, false },
+    /* 0x13 */ { Operations::XXX, AddressingModes::IndirectY, 8, false, false },
+    /* 0x14 */ { Operations::NOP, AddressingModes::ZeroPageX, 4, false, false },
+    /* 0x15 */ { Operations::ORA, AddressingModes::ZeroPageX, 4, false, true },
+    /* 0x16 */ { Operations::ASL, AddressingModes::ZeroPageX, 6, false, true },
+    /* 0x17 */ { Operations::XXX, AddressingModes::ZeroPageX, 6, false, false },
+    /* 0x18 */ { Operations::CLC, AddressingModes::Implicit, 2, false, true },
+    /* 0x19 */ { Operations::ORA, AddressingModes::AbsoluteY, 4, true, true },
+    /* 0x1A */ { Operations::NOP, AddressingModes::Implicit, 2, false, false },
+    /* 0x1B */ { Operations::XXX, AddressingModes::AbsoluteY, 7, false, false },
+    /* 0x1C */ { Operations::NOP, AddressingModes::AbsoluteX, 4, true, false },
+    /* 0x1D */ { Operations::ORA, AddressingModes::AbsoluteX, 4, true, true },
+    /* 0x1E */ { Operations::ASL, AddressingModes::AbsoluteX, 7, false, true },
+    /* 0x1F */ { Operations::XXX, AddressingModes::AbsoluteX, 7, false, false },
+    /* 0x20 */ { Operations::JSR, AddressingModes::Absolute, 6, false, true },
+    /* 0x21 */ { Operations::AND, AddressingModes::IndirectX, 6, false, true },
+    /* 0x22 */ { Operations::XXX, AddressingModes::Implicit, 2, false, false },
+    /* 0x23 */ { Operations::XXX, AddressingModes::IndirectX, 8, false, false },
+    /* 0x24 */ { Operations::BIT, AddressingModes::ZeroPage, 3, false, true },
+    /* 0x25 */ { Operations::AND, AddressingModes::ZeroPage, 3, false, true },
+    /* 0x26 */ { Operations::ROL, AddressingModes::ZeroPage, 5, false, true },
+    /* 0x27 */ { Operations::XXX, AddressingModes::ZeroPage, 5, false, false },
+    /* 0x28 */ { Operations::PLP, AddressingModes::Implicit, 4, false, true },
+    /* 0x29 */ { Operations::AND, AddressingModes::Immediate, 2, false, true },
+    /* 0x2A */ { Operations::ROL, AddressingModes::Accumulator, 2, false, true },
+    /* 0x2B */ { Operations::XXX, AddressingModes::Immediate, 2, false, false },
+    /* 0x2C */ { Operations::BIT, AddressingModes::Absolute, 4, false, true },
+    /* 0x2D */ { Operations::AND, AddressingModes::Absolute, 4, false, true },
+    /* 0x2E */ { Operations::ROL, AddressingModes::Absolute, 6, false, true },
+    /* 0x2F */ { Operations::XXX, AddressingModes::Absolute, 6, false, false },
+    /* 0x30 */ { Operations::BMI, AddressingModes::Relative, 2, false, true },
+    /* 0x31 */ { Operations::AND, AddressingModes::IndirectY, 5, true, true },
+    /* 0x32 */ { Operations::XXX, AddressingModes::Implicit, 2, false, false },
+    /* 0x33 */ { Operations::XXX, AddressingModes::IndirectY, 8, false, false },
+    /* 0x34 */ { Operations::NOP, AddressingModes::ZeroPageX, 4, false, false },
+    /* 0x35 */ { Operations::AND, AddressingModes::ZeroPageX, 4, false, true },
+    /* 0x36 */ { Operations::ROL, AddressingModes::ZeroPageX, 6, false, true },
+    /* 0x37 */ { Operations::XXX, AddressingModes::ZeroPageX, 6, false, false },
+    /* 0x38 */ { Operations::SEC, AddressingModes::Implicit, 2, false, true },
+    /* 0x39 */ { Operations::AND, AddressingModes::AbsoluteY, 4, true, true },
+    /* 0x3A */ { Operations::NOP, AddressingModes::Implicit, 2, false, false },
+    /* 0x3B */ { Operations::XXX, AddressingModes::AbsoluteY, 7, false, false },
+    /* 0x3C */ { Operations::NOP, AddressingModes::AbsoluteX, 4, true, false },
+    /* 0x3D */ { Operations::AND, AddressingModes::AbsoluteX, 4, true, true },
+    /* 0x3E */ { Operations::ROL, AddressingModes::AbsoluteX, 7, false, true },
+    /* 0x3F */ { Operations::XXX, AddressingModes::AbsoluteX, 7, false, false },
+    /* 0x40 */ { Operations::RTI, AddressingModes::Implicit, 6, false, true },
+    /* 0x41 */ { Operations::EOR, AddressingModes::IndirectX, 6, false, true },
+    /* 0x42 */ { Operations::XXX, AddressingModes::Implicit, 2, false, false },
+    /* 0x43 */ { Operations::XXX, AddressingModes::IndirectX, 8, false, false },
+    /* 0x44 */ { Operations::NOP, AddressingModes::ZeroPage, 3, false, false },
+    /* 0x45 */ { Operations::EOR, AddressingModes::ZeroPage, 3, false, true },
+    /* 0x46 */ { Operations::LSR, AddressingModes::ZeroPage, 5, false, true },
+    /* 0x47 */ { Operations::XXX, AddressingModes::ZeroPage, 5, false, false },
+    /* 0x48 */ { Operations::PHA, AddressingModes::Implicit, 3, false, true },
+    /* 0x49 */ { Operations::EOR, AddressingModes::Immediate, 2, false, true },
+    /* 0x4A */ { Operations::LSR, AddressingModes::Accumulator, 2, false, true },
+    /* 0x4B */ { Operations::XXX, AddressingModes::Immediate, 2, false, false },
+    /* 0x4C */ { Operations::JMP, AddressingModes::Absolute, 3, false, true },
+    /* 0x4D */ { Operations::EOR, AddressingModes::Absolute, 4, false, true },
+    /* 0x4E */ { Operations::LSR, AddressingModes::Absolute, 6, false, true },
+    /* 0x4F */ { Operations::XXX, AddressingModes::Absolute, 6, false, false },
+    /* 0x50 */ { Operations::BVC, AddressingModes::Relative, 2, false, true },
+    /* 0x51 */ { Operations::EOR, AddressingModes::IndirectY, 5, true, true },
+    /* 0x52 */ { Operations::XXX, AddressingModes::Implicit, 2, false, false },
+    /* 0x53 */ { Operations::XXX, AddressingModes::IndirectY, 8, false, false },
+    /* 0x54 */ { Operations::NOP, AddressingModes::ZeroPageX, 4, false, false },
+    /* 0x55 */ { Operations::EOR, AddressingModes::ZeroPageX, 4, false, true },
+    /* 0x56 */ { Operations::LSR, AddressingModes::ZeroPageX, 6, false, true },
+    /* 0x57 */ { Operations::XXX, AddressingModes::ZeroPageX, 6, false, false },
+    /* 0x58 */ { Operations::CLI, AddressingModes::Implicit, 2, false, true },
+    /* 0x59 */ { Operations::EOR, AddressingModes::AbsoluteY, 4, true, true },
+    /* 0x5A */ { Operations::NOP, AddressingModes::Implicit, 2, false, false },
+    /* 0x5B */ { Operations::XXX, AddressingModes::AbsoluteY, 7, false, false },
+    /* 0x5C */ { Operations::NOP, AddressingModes::AbsoluteX, 4, true, false },
+    /* 0x5D */ { Operations::EOR, AddressingModes::AbsoluteX, 4, true, true },
+    /* 0x5E */ { Operations::LSR, AddressingModes::AbsoluteX, 7, false, true },
+    /* 0x5F */ { Operations::XXX, AddressingModes::AbsoluteX, 7, false, false },
+    /* 0x60 */ { Operations::RTS, AddressingModes::Implicit, 6, false, true },
+    /* 0x61 */ { Operations::ADC, AddressingModes::IndirectX, 6, false, true },
+    /* 0x62 */ { Operations::XXX, AddressingModes::Implicit, 2, false, false },
+    /* 0x63 */ { Operations::XXX, AddressingModes::IndirectX, 8, false, false },
+    /* 0x64 */ { Operations::NOP, AddressingModes::ZeroPage, 3, false, false },
+    /* 0x65 */ { Operations::ADC, AddressingModes::ZeroPage, 3, false, true },
+    /* 0x66 */ { Operations::ROR, AddressingModes::ZeroPage, 5, false, true },
+    /* 0x67 */ { Operations::XXX, AddressingModes::ZeroPage, 5, false, false },
+    /* 0x68 */ { Operations::PLA, AddressingModes::Implicit, 4, false, true },
+    /* 0x69 */ { Operations::ADC, AddressingModes::Immediate, 2, false, true },
+    /* 0x6A */ { Operations::ROR, AddressingModes::Accumulator, 2, false, true },
+    /* 0x6B */ { Operations::XXX, AddressingModes::Immediate, 2, false, false },
+    /* 0x6C */ { Operations::JMP, AddressingModes::Indirect, 5, false, true },
+    /* 0x6D */ { Operations::ADC, AddressingModes::Absolute, 4, false, true },
+    /* 0x6E */ { Operations::ROR, AddressingModes::Absolute, 6, false, true },
+    /* 0x6F */ { Operations::XXX, AddressingModes::Absolute, 6, false, false },
+    /* 0x70 */ { Operations::BVS, AddressingModes::Relative, 2, false, true },
+    /* 0x71 */ { Operations::ADC, AddressingModes::IndirectY, 5, true, true },
+    /* 0x72 */ { Operations::XXX, AddressingModes::Implicit, 2, false, false },
+    /* 0x73 */ { Operations::XXX, AddressingModes::IndirectY, 8, false, false },
+    /* 0x74 */ { Operations::NOP, AddressingModes::ZeroPageX, 4, false, false },
+    /* 0x75 */ { Operations::ADC, AddressingModes::ZeroPageX, 4, false, true },
+    /* 0x76 */ { Operations::ROR, AddressingModes::ZeroPageX, 6, false, true },
+    /* 0x77 */ { Operations::XXX, AddressingModes::ZeroPageX, 6, false, false },
+    /* 0x78 */ { Operations::SEI, AddressingModes::Implicit, 2, false, true },
+    /* 0x79 */ { Operations::ADC, AddressingModes::AbsoluteY, 4, true, true },
+    /* 0x7A */ { Operations::NOP, AddressingModes::Implicit, 2, false, false },
+    /* 0x7B */ { Operations::XXX, AddressingModes::AbsoluteY, 7, false, false },
+    /* 0x7C */ { Operations::NOP, AddressingModes::AbsoluteX, 4, true, false },
+    /* 0x7D */ { Operations::ADC, AddressingModes::AbsoluteX, 4, true, true },
+    /* 0x7E */ { Operations::ROR, AddressingModes::AbsoluteX, 7, false, true },
+    /* 0x7F */ { Operations::XXX, AddressingModes::AbsoluteX, 7, false, false },
+    /* 0x80 */ { Operations::NOP, AddressingModes::Immediate, 2, false, false },
+    /* 0x81 */ { Operations::STA, AddressingModes::IndirectX, 6, false, true },
+    /* 0x82 */ { Operations::NOP, AddressingModes::Immediate, 2, false, false },
+    /* 0x83 */ { Operations::XXX, AddressingModes::IndirectX, 6, false, false },
+    /* 0x84 */ { Operations::STY, AddressingModes::ZeroPage, 3, false, true },
+    /* 0x85 */ { Operations::STA, AddressingModes::ZeroPage, 3, false, true },
+    /* 0x86 */ { Operations::STX, AddressingModes::ZeroPage, 3, false, true },
+    /* 0x87 */ { Operations::XXX, AddressingModes::ZeroPage, 3, false, false },
+    /* 0x88 */ { Operations::DEY, AddressingModes::Implicit, 2, false, true },
+    /* 0x89 */ { Operations::NOP, AddressingModes::Immediate, 2, false, false },
+    /* 0x8A */ { Operations::TXA, AddressingModes::Implicit, 2, false, true },
+    /* 0x8B */ { Operations::XXX, AddressingModes::Immediate, 2, false, false },
+    /* 0x8C */ { Operations::STY, AddressingModes::Absolute, 4, false, true },
+    /* 0x8D */ { Operations::STA, AddressingModes::Absolute, 4, false, true },
+    /* 0x8E */ { Operations::STX, AddressingModes::Absolute, 4, false, true },
+    /* 0x8F */ { Operations::XXX, AddressingModes::Absolute, 4, false, false },
+    /* 0x90 */ { Operations::BCC, AddressingModes::Relative, 2, false, true },
+    /* 0x91 */ { Operations::STA, AddressingModes::IndirectY, 6, false, true },
+    /* 0x92 */ { Operations::XXX, AddressingModes::Implicit, 2, false, false },
+    /* 0x93 */ { Operations::XXX, AddressingModes::IndirectY, 6, false, false },
+    /* 0x94 */ { Operations::STY, AddressingModes::ZeroPageX, 4, false, true },
+    /* 0x95 */ { Operations::STA, AddressingModes::ZeroPageX, 4, false, true },
+    /* 0x96 */ { Operations::STX, AddressingModes::ZeroPageY, 4, false, true },
+    /* 0x97 */ { Operations::XXX, AddressingModes::ZeroPageY, 4, false, false },
+    /* 0x98 */ { Operations::TYA, AddressingModes::Implicit, 2, false, true },
+    /* 0x99 */ { Operations::STA, AddressingModes::AbsoluteY, 5, false, true },
+    /* 0x9A */ { Operations::TXS, AddressingModes::Implicit, 2, false, true },
+    /* 0x9B */ { Operations::XXX, AddressingModes::AbsoluteY, 5, false, false },
+    /* 0x9C */ { Operations::XXX, AddressingModes::AbsoluteX, 5, false, false },
+    /* 0x9D */ { Operations::STA, AddressingModes::AbsoluteX, 5, false, true },
+    /* 0x9E */ { Operations::XXX, AddressingModes::AbsoluteY, 5, false, false },
+    /* 0x9F */ { Operations::XXX, AddressingModes::AbsoluteY, 5, false, false },
+    /* 0xA0 */ { Operations::LDY, AddressingModes::Immediate, 2, false, true },
+    /* 0xA1 */ { Operations::LDA, AddressingModes::IndirectX, 6, false, true },
+    /* 0xA2 */ { Operations::LDX, AddressingModes::Immediate, 2, false, true },
+    /* 0xA3 */ { Operations::XXX, AddressingModes::IndirectX, 6, false, false },
+    /* 0xA4 */ { Operations::LDY, AddressingModes::ZeroPage, 3, false, true },
+    /* 0xA5 */ { Operations::LDA, AddressingModes::ZeroPage, 3, false, true },
+    /* 0xA6 */ { Operations::LDX, AddressingModes::ZeroPage, 3, false, true },
+    /* 0xA7 */ { Operations::XXX, AddressingModes::ZeroPage, 3, false, false },
+    /* 0xA8 */ { Operations::TAY, AddressingModes::Implicit, 2, false, true },
+    /* 0xA9 */ { Operations::LDA, AddressingModes::Immediate, 2, false, true },
+    /* 0xAA */ { Operations::TAX, AddressingModes::Implicit, 2, false, true },
+    /* 0xAB */ { Operations::XXX, AddressingModes::Immediate, 2, false, false },
+    /* 0xAC */ { Operations::LDY, AddressingModes::Absolute, 4, false, true },
+    /* 0xAD */ { Operations::LDA, AddressingModes::Absolute, 4, false, true },
+    /* 0xAE */ { Operations::LDX, AddressingModes::Absolute, 4, false, true },
+    /* 0xAF */ { Operations::XXX, AddressingModes::Absolute, 4, false, false },
+    /* 0xB0 */ { Operations::BCS, AddressingModes::Relative, 2, false, true },
+    /* 0xB1 */ { Operations::LDA, AddressingModes::IndirectY, 5, true, true },
+    /* 0xB2 */ { Operations::XXX, AddressingModes::Implicit, 2, false, false },
+    /* 0xB3 */ { Operations::XXX, AddressingModes::IndirectY, 5, true, false },
+    /* 0xB4 */ { Operations::LDY, AddressingModes::ZeroPageX, 4, false, true },
+    /* 0xB5 */ { Operations::LDA, AddressingModes::ZeroPageX, 4, false, true },
+    /* 0xB6 */ { Operations::LDX, AddressingModes::ZeroPageY, 4, false, true },
+    /* 0xB7 */ { Operations::XXX, AddressingModes::ZeroPageY, 4, false, false },
+    /* 0xB8 */ { Operations::CLV, AddressingModes::Implicit, 2, false, true },
+    /* 0xB9 */ { Operations::LDA, AddressingModes::AbsoluteY, 4, true, true },
+    /* 0xBA */ { Operations::TSX, AddressingModes::Implicit, 2, false, true },
+    /* 0xBB */ { Operations::XXX, AddressingModes::AbsoluteY, 4, true, false },
+    /* 0xBC */ { Operations::LDY, AddressingModes::AbsoluteX, 4, true, true },
+    /* 0xBD */ { Operations::LDA, AddressingModes::AbsoluteX, 4, true, true },
+    /* 0xBE */ { Operations::LDX, AddressingModes::AbsoluteY, 4, true, true },
+    /* 0xBF */ { Operations::XXX, AddressingModes::AbsoluteY, 4, true, false },
+    /* 0xC0 */ { Operations::CPY, AddressingModes::Immediate, 2, false, true },
+    /* 0xC1 */ { Operations::CMP, AddressingModes::IndirectX, 6, false, true },
+    /* 0xC2 */ { Operations::NOP, AddressingModes::Immediate, 2, false, false },
+    /* 0xC3 */ { Operations::XXX, AddressingModes::IndirectX, 8, false, false },
+    /* 0xC4 */ { Operations::CPY, AddressingModes::ZeroPage, 3, false, true },
+    /* 0xC5 */ { Operations::CMP, AddressingModes::ZeroPage, 3, false, true },
+    /* 0xC6 */ { Operations::DEC, AddressingModes::ZeroPage, 5, false, true },
+    /* 0xC7 */ { Operations::XXX, AddressingModes::ZeroPage, 5, false, false },
+    /* 0xC8 */ { Operations::INY, AddressingModes::Implicit, 2, false, true },
+    /* 0xC9 */ { Operations::CMP, AddressingModes::Immediate, 2, false, true },
+    /* 0xCA */ { Operations::DEX, AddressingModes::Implicit, 2, false, true },
+    /* 0xCB */ { Operations::XXX, AddressingModes::Immediate, 2, false, false },
+    /* 0xCC */ { Operations::CPY, AddressingModes::Absolute, 4, false, true },
+    /* 0xCD */ { Operations::CMP, AddressingModes::Absolute, 4, false, true },
+    /* 0xCE */ { Operations::DEC, AddressingModes::Absolute, 6, false, true },
+    /* 0xCF */ { Operations::XXX, AddressingModes::Absolute, 6, false, false },
+    /* 0xD0 */ { Operations::BNE, AddressingModes::Relative, 2, false, true },
+    /* 0xD1 */ { Operations::CMP, AddressingModes::IndirectY, 5, true, true },
+    /* 0xD2 */ { Operations::XXX, AddressingModes::Implicit, 2, false, false },
+    /* 0xD3 */ { Operations::XXX, AddressingModes::IndirectY, 8, false, false },
+    /* 0xD4 */ { Operations::NOP, AddressingModes::ZeroPageX, 4, false, false },
+    /* 0xD5 */ { Operations::CMP, AddressingModes::ZeroPageX, 4, false, true },
+    /* 0xD6 */ { Operations::DEC, AddressingModes::ZeroPageX, 6, false, true },
+    /* 0xD7 */ { Operations::XXX, AddressingModes::ZeroPageX, 6, false, false },
+    /* 0xD8 */ { Operations::CLD, AddressingModes::Implicit, 2, false, true },
+    /* 0xD9 */ { Operations::CMP, AddressingModes::AbsoluteY, 4, true, true },
+    /* 0xDA */ { Operations::NOP, AddressingModes::Implicit, 2, false, false },
+    /* 0xDB */ { Operations::XXX, AddressingModes::AbsoluteY, 7, false, false },
+    /* 0xDC */ { Operations::NOP, AddressingModes::AbsoluteX, 4, true, false },
+    /* 0xDD */ { Operations::CMP, AddressingModes::AbsoluteX, 4, true, true },
+    /* 0xDE */ { Operations::DEC, AddressingModes::AbsoluteX, 7, false, true },
+    /* 0xDF */ { Operations::XXX, AddressingModes::AbsoluteX, 7, false, false },
+    /* 0xE0 */ { Operations::CPX, AddressingModes::Immediate, 2, false, true },
+    /* 0xE1 */ { Operations::SBC, AddressingModes::IndirectX, 6, false, true },
+    /* 0xE2 */ { Operations::NOP, AddressingModes::Immediate, 2, false, false },
+    /* 0xE3 */ { Operations::XXX, AddressingModes::IndirectX, 8, false, false },
+    /* 0xE4 */ { Operations::CPX, AddressingModes::ZeroPage, 3, false, true },
+    /* 0xE5 */ { Operations::SBC, AddressingModes::ZeroPage, 3, false, true },
+    /* 0xE6 */ { Operations::INC, AddressingModes::ZeroPage, 5, false, true },
+    /* 0xE7 */ { Operations::XXX, AddressingModes::ZeroPage, 5, false, false },
+    /* 0xE8 */ { Operations::INX, AddressingModes::Implicit, 2, false, true },
+    /* 0xE9 */ { Operations::SBC, AddressingModes::Immediate, 2, false, true },
+    /* 0xEA */ { Operations::NOP, AddressingModes::Implicit, 2, false, true },
+    /* 0xEB */ { Operations::SBC, AddressingModes::Immediate, 2, false, false },
+    /* 0xEC */ { Operations::CPX, AddressingModes::Absolute, 4, false, true },
+    /* 0xED */ { Operations::SBC, AddressingModes::Absolute, 4, false, true },
+    /* 0xEE */ { Operations::INC, AddressingModes::Absolute, 6, false, true },
+    /* 0xEF */ { Operations::XXX, AddressingModes::Absolute, 6, false, false },
+    /* 0xF0 */ { Operations::BEQ, AddressingModes::Relative, 2, false, true },
+    /* 0xF1 */ { Operations::SBC, AddressingModes::IndirectY, 5, true, true },
+    /* 0xF2 */ { Operations::XXX, AddressingModes::Implicit, 2, false, false },
+    /* 0xF3 */ { Operations::XXX, AddressingModes::IndirectY, 8, false, false },
+    /* 0xF4 */ { Operations::NOP, AddressingModes::ZeroPageX, 4, false, false },
+    /* 0xF5 */ { Operations::SBC, AddressingModes::ZeroPageX, 4, false, true },
+    /* 0xF6 */ { Operations::INC, AddressingModes::ZeroPageX, 6, false, true },
+    /* 0xF7 */ { Operations::XXX, AddressingModes::ZeroPageX, 6, false, false },
+    /* 0xF8 */ { Operations::SED, AddressingModes::Implicit, 2, false, true },
+    /* 0xF9 */ { Operations::SBC, AddressingModes::AbsoluteY, 4, true, true },
+    /* 0xFA */ { Operations::NOP, AddressingModes::Implicit, 2, false, false },
+    /* 0xFB */ { Operations::XXX, AddressingModes::AbsoluteY, 7, false, false },
+    /* 0xFC */ { Operations::NOP, AddressingModes::AbsoluteX, 4, true, false },
+    /* 0xFD */ { Operations::SBC, AddressingModes::AbsoluteX, 4, true, true },
+    /* 0xFE */ { Operations::INC, AddressingModes::AbsoluteX, 7, false, true },
+    /* 0xFF */ { Operations::XXX, AddressingModes::AbsoluteX, 7, false, false }
+}};
+
+// Indexed by Operations::Operation and AddressingModes::Mode respectively
+constexpr std::array<const char*, Operations::XXX + 1> OPERATION_NAMES = {{
+    "ADC", "AND", "ASL", "BCC", "BCS", "BEQ", "BIT", "BMI",
+    "BNE", "BPL", "BRK", "BVC", "BVS", "CLC", "CLD", "CLI",
+    "CLV", "CMP", "CPX", "CPY", "DEC", "DEX", "DEY", "EOR",
+    "INC", "INX", "INY", "JMP", "JSR", "LDA", "LDX", "LDY",
+    "LSR", "NOP", "ORA", "PHA", "PHP", "PLA", "PLP", "ROL",
+    "ROR", "RTI", "RTS", "SBC", "SEC", "SED", "SEI", "STA",
+    "STX", "STY", "TAX", "TAY", "TSX", "TXA", "TXS", "TYA",
+    "XXX"
+}};
+
+constexpr std::array<const char*, AddressingModes::Relative + 1> ADDRESSING_MODE_NAMES = {{
+    "Implicit", "Accumulator", "Immediate", "ZeroPage", "ZeroPageX", "ZeroPageY", "Absolute",
+    "AbsoluteX", "AbsoluteY", "Indirect", "IndirectX", "IndirectY", "Relative"
+}};
+
+constexpr uint8_t GetOperandLength(const AddressingModes::Mode mode)
+{
+    switch (mode) {
+        case AddressingModes::Implicit:
+        case AddressingModes::Accumulator:
+            return 0;
+        case AddressingModes::Absolute:
+        case AddressingModes::AbsoluteX:
+        case AddressingModes::AbsoluteY:
+        case AddressingModes::Indirect:
+            return 2;
+        default:
+            return 1;
+    }
+}
+
+#endif
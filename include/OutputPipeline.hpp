@@ -0,0 +1,91 @@
+#ifndef OUTPUT_PIPELINE_HPP
+#define OUTPUT_PIPELINE_HPP
+
+#include <array>
+#include <atomic>
+
+#include "APU.hpp"
+#include "PPU.hpp"
+#include "RingBuffer.hpp"
+#include "Typedefs.hpp"
+
+constexpr size_t FRAME_SIZE = SCREEN_WIDTH * SCREEN_HEIGHT;
+constexpr uint8_t NUMBER_OF_FRAME_BUFFERS = 3;
+
+// About 170 ms at 48 kHz, enough for a consumer that runs a few frames behind
+constexpr size_t AUDIO_RING_CAPACITY = 8192;
+
+using AudioRingBuffer = SpscRingBuffer<int16_t, AUDIO_RING_CAPACITY>;
+
+struct OutputStatistics {
+    uint64_t framesPublished;
+    uint64_t framesPresented;
+    uint64_t framesDropped; // Overwritten before the consumer took them
+    uint64_t framesLate; // Consumer asked and no new frame was ready
+    uint64_t samplesWritten;
+    uint64_t samplesDropped; // Did not fit in the ring
+    uint64_t audioUnderruns; // Reads that came back short
+};
+
+// Hands video and audio from the emulation thread to one consumer thread.
+//
+// Frames are triple-buffered: the PPU draws into the back buffer, publishing swaps
+// it with the shared middle slot, and the consumer swaps the middle slot with its
+// front buffer when a fresh frame is there. Each swap is one atomic exchange of a
+// slot index, so no frame is ever copied and neither side waits. A frame the
+// consumer has not taken by the next publish is dropped in favour of the newer one.
+//
+// Audio goes through an SPSC ring; samples that do not fit are dropped.
+//
+// Producer calls (the sink overrides) belong to the emulation thread, consumer
+// calls to the presentation thread. Statistics can be read from either.
+class OutputPipeline : public FrameSink, public AudioSink
+{
+    public:
+        OutputPipeline() = default;
+        ~OutputPipeline() override = default;
+
+        OutputPipeline(const OutputPipeline&) = delete;
+        OutputPipeline& operator=(const OutputPipeline&) = delete;
+
+        // Producer side
+        Byte* GetBackBuffer() override { return Frames[BackIndex].data(); }
+        Byte* PublishFrame() override;
+        void WriteSamples(const int16_t*, const size_t) override;
+
+        // Consumer side. Returns false and keeps the current front buffer when no new
+        // frame has been published since the last call.
+        bool AcquireFrame();
+        const Byte* GetFrontBuffer() const { return Frames[FrontIndex].data(); }
+        uint64_t GetFrontFrameNumber() const { return FrameNumbers[FrontIndex]; }
+        size_t ReadSamples(int16_t*, const size_t);
+        size_t GetSamplesAvailable() const { return Audio.GetSize(); }
+
+        OutputStatistics GetStatistics() const;
+
+    private:
+        // The middle slot index, with this bit set while it holds an unread frame
+        static constexpr uint8_t FRESH_FRAME = 0x80;
+
+        alignas(64) std::array<std::array<Byte, FRAME_SIZE>, NUMBER_OF_FRAME_BUFFERS> Frames{};
+        std::array<uint64_t, NUMBER_OF_FRAME_BUFFERS> FrameNumbers{};
+
+        // Producer-owned
+        alignas(64) uint8_t BackIndex = 0;
+        std::atomic<uint64_t> FramesPublished{ 0 };
+        std::atomic<uint64_t> FramesDropped{ 0 };
+        std::atomic<uint64_t> SamplesWritten{ 0 };
+        std::atomic<uint64_t> SamplesDropped{ 0 };
+
+        alignas(64) std::atomic<uint8_t> MiddleSlot{ 1 };
+
+        // Consumer-owned
+        alignas(64) uint8_t FrontIndex = 2;
+        std::atomic<uint64_t> FramesPresented{ 0 };
+        std::atomic<uint64_t> FramesLate{ 0 };
+        std::atomic<uint64_t> AudioUnderruns{ 0 };
+
+        AudioRingBuffer Audio;
+};
+
+#endif
@@ -0,0 +1,220 @@
+#ifndef PPU_HPP
+#define PPU_HPP
+
+#include <array>
+#include <cstddef>
+
+#include "Bus.hpp"
+#include "Constants.hpp"
+#include "Typedefs.hpp"
+
+constexpr uint16_t SCREEN_WIDTH = 256;
+constexpr uint16_t SCREEN_HEIGHT = 240;
+
+constexpr uint16_t PPU_DOTS_PER_SCANLINE = 341;
+constexpr uint16_t PPU_SCANLINES_PER_FRAME = 262;
+constexpr uint16_t PPU_VBLANK_SCANLINE = 241;
+constexpr uint16_t PPU_PRERENDER_SCANLINE = 261;
+constexpr uint8_t PPU_DOTS_PER_CPU_CYCLE = 3;
+
+constexpr uint16_t PPU_PATTERN_BANK_SIZE = 0x0400;
+constexpr uint8_t NUMBER_OF_PATTERN_BANKS = 8;
+constexpr uint16_t PPU_NAMETABLE_SIZE = 0x0400;
+constexpr uint8_t NUMBER_OF_NAMETABLES = 4;
+constexpr uint16_t OAM_SIZE = 256;
+constexpr uint8_t MAXIMUM_SPRITES_PER_SCANLINE = 8;
+
+// With the usual pattern table split (background at $0000, sprites at $1000) A12
+// rises once per rendered line, during the sprite fetches around this dot.
+constexpr uint16_t PPU_SCANLINE_COUNTER_DOT = 260;
+
+namespace NametableMirroring {
+    enum Mode {
+        Horizontal,
+        Vertical,
+        SingleScreenLow,
+        SingleScreenHigh
+    };
+}
+
+namespace PPURegisters {
+    enum Register {
+        Control = 0,
+        Mask = 1,
+        Status = 2,
+        OamAddress = 3,
+        OamData = 4,
+        Scroll = 5,
+        Address = 6,
+        Data = 7
+    };
+}
+
+// Cartridge hardware that counts scanlines by watching the PPU address bus (MMC3).
+class ScanlineCounter
+{
+    public:
+        virtual ~ScanlineCounter() = default;
+
+        virtual void ClockScanline() = 0;
+};
+
+// Takes each finished frame where it was drawn and returns the buffer to draw the
+// next one into, so frames leave the PPU without being copied.
+class FrameSink
+{
+    public:
+        virtual ~FrameSink() = default;
+
+        virtual Byte* GetBackBuffer() = 0;
+        virtual Byte* PublishFrame() = 0;
+};
+
+// Renders in spans rather than dots. The PPU jumps between the few dots of a
+// scanline where something happens (vblank, end of the visible pixels, the scroll
+// copies) and draws each visible line in one pass when it reaches dot 256. A CPU
+// access to $2000-$2007 first draws the pixels up to the current dot, so a
+// mid-scanline register write splits the line at exactly that dot.
+//
+// The frame buffer holds NES palette indices (0-63), one byte per pixel.
+class PPU : public BusDevice, public SynchronizedDevice
+{
+    public:
+        PPU();
+        ~PPU() override = default;
+
+        // CPU-visible registers, mapped over $2000-$3FFF
+        Byte Read(const Address) override;
+        void Write(const Address, const Byte) override;
+        uint64_t GetStableReadCycle(const Address) override;
+
+        void Clock();
+        void RunDots(uint64_t);
+        void Reset();
+
+        // Catch-up scheduling: the PPU runs three dots per CPU cycle and predicts the
+        // vblank NMI so the CPU can run freely until then.
+        void CatchUp(const uint64_t) override;
+        uint64_t GetNextEventCycle() const override;
+        EventTypes::Type GetEventType() const override { return EventTypes::NonMaskableInterrupt; }
+        uint64_t GetFrameEndCycle() const;
+
+        // OAM DMA through $4014 writes here one byte at a time
+        void WriteOamDma(const Byte);
+
+        // Pattern tables are eight 1 KB slots and the nametables four 1 KB slots so
+        // mappers can bank-switch by repointing them.
+        void SetPatternBank(const size_t, const Byte*);
+        void SetWritablePatternBank(const size_t, Byte*);
+        void SetNametableBank(const size_t, Byte*);
+        void SetMirroring(const NametableMirroring::Mode);
+        void ConnectScanlineCounter(ScanlineCounter* counter) { ConnectedScanlineCounter = counter; }
+
+        // Without a sink the PPU keeps drawing into its own single buffer.
+        void ConnectFrameSink(FrameSink*);
+
+        // Headless runs that only look at some frames can skip drawing the rest. A
+        // skipped frame has no pixel output or palette lookups, but vblank, NMI, sprite
+        // 0 hit, sprite overflow and the VRAM address advance exactly as when drawn.
+        // The setting is taken up when the next frame starts drawing, and skipped
+        // frames are not published to the sink.
+        void SetFrameSkipping(const bool isSkipping) { IsSkipRequested = isSkipping; }
+        bool IsFrameSkippingEnabled() const { return IsSkipRequested; }
+        bool IsSkippingFrame() const { return IsFrameSkipped; }
+
+        // Cycle by which the counter will have been clocked the given number of times,
+        // if rendering stays as it is now.
+        uint64_t GetScanlineClockCycle(uint32_t) const;
+
+        bool PollNonMaskableInterrupt();
+        bool PollFrameComplete();
+
+        // The buffer being drawn into; with a sink connected, finished frames are
+        // read from the sink instead.
+        const Byte* GetFrameBuffer() const { return FrameTarget; }
+        uint16_t GetScanline() const { return Scanline; }
+        uint16_t GetDot() const { return Dot; }
+        uint64_t GetFrameCount() const { return FrameCount; }
+        Byte GetStatusRegister() const { return StatusRegister; }
+        uint16_t GetVramAddress() const { return VramAddress; }
+        bool IsRenderingEnabled() const { return (MaskRegister & 0x18) != 0; }
+
+    private:
+        Byte ReadMemory(const Address);
+        void WriteMemory(const Address, const Byte);
+
+        uint16_t GetLineLength() const;
+        uint16_t GetNextEventDot() const;
+        uint64_t GetDotsUntil(const uint16_t, const uint16_t) const;
+        uint64_t GetCycleAfterDots(const uint64_t) const;
+        void ProcessDot();
+        void StartNextLine();
+
+        void CatchUpRendering();
+        void RenderPixels(const uint16_t);
+        void SkipPixels(const uint16_t);
+        void DetectSpriteZeroHit(const uint16_t, const uint16_t);
+        void FetchBackground(const uint16_t, const uint16_t);
+        void BuildSpriteLine();
+        void EvaluateSprites();
+        void ComposePixels(const uint16_t, const uint16_t);
+
+        void IncrementCoarseX();
+        void IncrementY();
+
+    private:
+        // Registers
+        Byte ControlRegister = 0x00;
+        Byte MaskRegister = 0x00;
+        Byte StatusRegister = 0x00;
+        Byte OamAddressRegister = 0x00;
+        Byte DataBuffer = 0x00;
+
+        // Loopy scroll registers: current/temporary VRAM address, fine X, write toggle
+        uint16_t VramAddress = 0x0000;
+        uint16_t TemporaryVramAddress = 0x0000;
+        Byte FineX = 0;
+        bool WriteToggle = false;
+
+        // Timing
+        uint64_t SynchronizedCycle = 0;
+        uint16_t Scanline = 0;
+        uint16_t Dot = 0;
+        uint64_t FrameCount = 0;
+        bool OddFrame = false;
+        bool NmiOccurred = false;
+        bool FrameComplete = false;
+        bool IsSkipRequested = false;
+        bool IsFrameSkipped = false;
+
+        // Line renderer state
+        uint16_t RenderedX = 0;
+        Byte TileOffset = 0;
+        bool SpriteLineReady = false;
+        std::array<Byte, MAXIMUM_SPRITES_PER_SCANLINE> LineSprites{};
+        uint8_t LineSpriteCount = 0;
+
+        alignas(32) std::array<Byte, SCREEN_WIDTH> BackgroundLine{};
+        alignas(32) std::array<Byte, SCREEN_WIDTH> SpriteColors{};
+        alignas(32) std::array<Byte, SCREEN_WIDTH> SpriteBehind{};
+        alignas(32) std::array<Byte, SCREEN_WIDTH> SpriteZero{};
+
+        ScanlineCounter* ConnectedScanlineCounter = nullptr;
+        FrameSink* ConnectedFrameSink = nullptr;
+
+        // Memory
+        // CHR-ROM banks have no write pointer, so writes to them are dropped
+        std::array<const Byte*, NUMBER_OF_PATTERN_BANKS> PatternBanks{};
+        std::array<Byte*, NUMBER_OF_PATTERN_BANKS> WritablePatternBanks{};
+        std::array<Byte*, NUMBER_OF_NAMETABLES> NametableBanks{};
+
+        std::array<Byte, PPU_VRAM_SIZE> Vram{};
+        std::array<Byte, PPU_GRAPHICS_SIZE * 2> ChrRam{};
+        alignas(32) std::array<Byte, 32> PaletteRam{};
+        std::array<Byte, OAM_SIZE> Oam{};
+
+        alignas(32) std::array<Byte, SCREEN_WIDTH * SCREEN_HEIGHT> FrameBuffer{};
+        Byte* FrameTarget = FrameBuffer.data();
+};
+
+#endif
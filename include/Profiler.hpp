@@ -0,0 +1,111 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include "Constants.hpp"
+#include "OpcodeTable.hpp"
+#include "Typedefs.hpp"
+
+class CPU;
+
+constexpr uint8_t NUMBER_OF_ADDRESSING_MODES = AddressingModes::Relative + 1;
+constexpr uint32_t NUMBER_OF_PROGRAM_COUNTERS = 0x10000;
+
+// Instructions are binned by cycles taken; the longest real instruction takes 8
+constexpr uint8_t PROFILER_HISTOGRAM_BINS = 9;
+
+// Profiling policies for CPU::StepWith() and friends. A policy is called twice per
+// instruction: BeginInstruction() once it is decoded, with the CPU still in its
+// pre-instruction state, and RecordInstruction() after it ran, with the address it
+// was fetched from, its opcode and the cycles it took. The default policy does
+// nothing and compiles away, so the plain Clock()/Step() paths pay nothing.
+struct NullProfiler {
+    void BeginInstruction(const CPU&, const DecodedInstruction&) {}
+    void RecordInstruction(const Address, const Opcode, const uint8_t) {}
+};
+
+struct ProfileCounter {
+    uint64_t executions;
+    uint64_t cycles;
+};
+
+struct OpcodeProfile {
+    uint64_t executions;
+    uint64_t cycles;
+    uint64_t pageCrossPenalties;
+    uint64_t branchesTaken;
+};
+
+struct HotSpot {
+    Address programCounter;
+    ProfileCounter counter;
+};
+
+// Counts executions and cycles per opcode, per addressing mode and per Program
+// Counter, plus page-cross penalties (AbsoluteX, AbsoluteY and IndirectY reads),
+// taken branches and a histogram of instruction lengths in cycles.
+//
+// Extra cycles over the table's base count tell the cases apart: on a branch one
+// extra cycle means taken and two mean taken across a page, on anything else one
+// extra cycle is the page-cross penalty.
+class ExecutionProfiler
+{
+    public:
+        ExecutionProfiler();
+        ~ExecutionProfiler() = default;
+
+        void BeginInstruction(const CPU&, const DecodedInstruction&) {}
+        void RecordInstruction(const Address programCounter, const Opcode opcode, const uint8_t cycles)
+        {
+            const Instruction& instruction = OPCODE_TABLE[opcode];
+            const uint8_t extraCycles = cycles - instruction.cyclesCount;
+
+            OpcodeProfile& opcodeProfile = Opcodes[opcode];
+            ++opcodeProfile.executions;
+            opcodeProfile.cycles += cycles;
+            if (instruction.addressingMode == AddressingModes::Relative) {
+                opcodeProfile.branchesTaken += extraCycles != 0 ? 1 : 0;
+                opcodeProfile.pageCrossPenalties += extraCycles == 2 ? 1 : 0;
+            } else {
+                opcodeProfile.pageCrossPenalties += extraCycles;
+            }
+
+            ProfileCounter& modeCounter = Modes[instruction.addressingMode];
+            ++modeCounter.executions;
+            modeCounter.cycles += cycles;
+
+            ProfileCounter& programCounterCounter = ProgramCounters[programCounter];
+            ++programCounterCounter.executions;
+            programCounterCounter.cycles += cycles;
+
+            ++CycleHistogram[cycles < PROFILER_HISTOGRAM_BINS ? cycles : PROFILER_HISTOGRAM_BINS - 1];
+        }
+
+        void Reset();
+
+        const OpcodeProfile& GetOpcodeProfile(const Opcode opcode) const { return Opcodes[opcode]; }
+        const ProfileCounter& GetModeProfile(const AddressingModes::Mode mode) const { return Modes[mode]; }
+        const ProfileCounter& GetProgramCounterProfile(const Address address) const { return ProgramCounters[address]; }
+        uint64_t GetHistogramBin(const uint8_t cycles) const { return CycleHistogram[cycles]; }
+
+        uint64_t GetTotalInstructions() const;
+        uint64_t GetTotalCycles() const;
+        uint64_t GetTotalPageCrossPenalties() const;
+        uint64_t GetTotalBranchesTaken() const;
+
+        // The addresses that spent the most cycles, hottest first.
+        std::vector<HotSpot> GetHotSpots(const size_t) const;
+
+    private:
+        std::array<OpcodeProfile, NUMBER_OF_OPCODES> Opcodes{};
+        std::array<ProfileCounter, NUMBER_OF_ADDRESSING_MODES> Modes{};
+        std::array<uint64_t, PROFILER_HISTOGRAM_BINS> CycleHistogram{};
+
+        // 1 MB, so it lives on the heap
+        std::vector<ProfileCounter> ProgramCounters;
+};
+
+#endif
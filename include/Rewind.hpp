@@ -0,0 +1,54 @@
+#ifndef REWIND_HPP
+#define REWIND_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "SaveState.hpp"
+#include "Typedefs.hpp"
+
+// Keeps recent frames in a fixed-size byte arena. Every KeyframeInterval frames a
+// full SaveState is stored; the frames in between are stored as the XOR against
+// that keyframe, run-length encoded, so unchanged bytes cost almost nothing.
+// When the arena or the frame ring is full the oldest keyframe group is dropped.
+class RewindBuffer
+{
+    public:
+        RewindBuffer(const size_t maximumFrames, const size_t arenaSize, const size_t keyframeInterval);
+        ~RewindBuffer() = default;
+
+        void Push(const SaveState&);
+        bool Pop(SaveState&); // Removes the newest frame and returns its state
+        void Clear();
+
+        size_t GetFrameCount() const { return Count; }
+        size_t GetMemoryUsage() const;
+
+    private:
+        struct Frame {
+            size_t offset;
+            size_t size;
+            size_t keyframe; // Frame slot of the keyframe a delta is encoded against
+            bool isKeyframe;
+        };
+
+        size_t GetOldestSlot() const;
+        size_t GetNewestSlot() const;
+        size_t Reserve(const size_t);
+        void DropOldestGroup();
+
+        static size_t EncodeDelta(const Byte*, const Byte*, Byte*); // Returns 0 if larger than a keyframe
+        static void DecodeDelta(const Byte*, const size_t, Byte*);
+
+    private:
+        std::vector<Byte> Arena;
+        std::vector<Frame> Frames;
+        size_t KeyframeInterval;
+
+        size_t Head = 0; // Slot the next frame is written to
+        size_t Count = 0;
+        size_t WriteOffset = 0;
+        size_t FramesSinceKeyframe = 0;
+};
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef RING_BUFFER_HPP
+#define RING_BUFFER_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// Single-producer single-consumer ring. Each side owns one index and only reads the
+// other's; the two indices sit on separate cache lines so the threads do not
+// false-share. Neither side ever blocks: a full ring drops what does not fit, and
+// an empty one returns nothing.
+template <typename T, size_t Capacity>
+class SpscRingBuffer
+{
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    public:
+        SpscRingBuffer() = default;
+
+        SpscRingBuffer(const SpscRingBuffer&) = delete;
+        SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+        // Producer side. Returns how many items were accepted.
+        size_t Write(const T* items, const size_t count)
+        {
+            const size_t tail = Tail.load(std::memory_order_relaxed);
+            const size_t head = Head.load(std::memory_order_acquire);
+            const size_t accepted = std::min(count, Capacity - (tail - head));
+            for (size_t index = 0; index < accepted; ++index) {
+                Items[(tail + index) & (Capacity - 1)] = items[index];
+            }
+            Tail.store(tail + accepted, std::memory_order_release);
+            return accepted;
+        }
+
+        // Consumer side. Returns how many items were copied out.
+        size_t Read(T* items, const size_t count)
+        {
+            const size_t head = Head.load(std::memory_order_relaxed);
+            const size_t tail = Tail.load(std::memory_order_acquire);
+            const size_t available = std::min(count, tail - head);
+            for (size_t index = 0; index < available; ++index) {
+                items[index] = Items[(head + index) & (Capacity - 1)];
+            }
+            Head.store(head + available, std::memory_order_release);
+            return available;
+        }
+
+        size_t GetSize() const { return Tail.load(std::memory_order_acquire) - Head.load(std::memory_order_acquire); }
+        static constexpr size_t GetCapacity() { return Capacity; }
+
+    private:
+        alignas(64) std::atomic<size_t> Head{ 0 };
+        alignas(64) std::atomic<size_t> Tail{ 0 };
+        alignas(64) std::array<T, Capacity> Items{};
+};
+
+#endif
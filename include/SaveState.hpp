@@ -0,0 +1,56 @@
+#ifndef SAVE_STATE_HPP
+#define SAVE_STATE_HPP
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+
+#include "Constants.hpp"
+#include "Typedefs.hpp"
+
+class Bus;
+class CPU;
+
+constexpr uint32_t SAVE_STATE_MAGIC = 0x5453454E; // "NEST" in little-endian byte order
+constexpr uint16_t SAVE_STATE_VERSION = 1;
+
+// Fields are ordered widest first so the layout has no padding and is identical
+// on every compiler; the blob is the little-endian in-memory image.
+struct CPUState {
+    uint64_t totalCycles;
+    LargeRegister programCounter;
+    Address absoluteAddress;
+    Address relativeAddress;
+    uint16_t temporaryStorage;
+    Register accumulator;
+    Register x;
+    Register y;
+    Register stackPointer;
+    Register statusRegister;
+    Byte fetchedData;
+    Opcode currentOpcode;
+    uint8_t cyclesLeft;
+};
+
+struct SaveState {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;
+    CPUState cpu;
+    std::array<Byte, MEMORY_SIZE> ram;
+
+    // Neither call allocates; a snapshot is one fixed-size copy of registers and RAM.
+    void Capture(const CPU&, const Bus&);
+    bool Restore(CPU&, Bus&) const;
+
+    const Byte* GetData() const { return reinterpret_cast<const Byte*>(this); }
+    static constexpr size_t GetSize() { return sizeof(SaveState); }
+
+    bool IsValid() const;
+    bool LoadFromData(const Byte*, const size_t);
+};
+
+static_assert(sizeof(CPUState) == 24, "CPUState layout must stay fixed");
+static_assert(std::is_trivially_copyable<SaveState>::value, "SaveState must be a flat blob");
+
+#endif
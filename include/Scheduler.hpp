@@ -0,0 +1,77 @@
+#ifndef SCHEDULER_HPP
+#define SCHEDULER_HPP
+
+#include <array>
+
+#include "Bus.hpp"
+#include "CPU.hpp"
+#include "EventQueue.hpp"
+#include "Typedefs.hpp"
+
+constexpr uint8_t MAXIMUM_SYNCHRONIZED_ROUTES = 8;
+constexpr uint8_t MAXIMUM_SYNCHRONIZED_DEVICES = 4;
+
+struct SynchronizedRoute {
+    Address first;
+    Address last;
+    BusDevice* device;
+    SynchronizedDevice* synchronizedDevice; // Null for ports that need no catch-up
+};
+
+// Sits on the bus in front of the PPU/APU registers. Every access first brings the
+// owning device up to the cycle the CPU touches it, so the device sees exactly the
+// state it would have had running in lockstep. Each device's predicted interrupt is
+// kept in an event queue; if an access moves one earlier, the CPU's timeslice is cut
+// so the caller can service it.
+class Scheduler : public BusDevice
+{
+    public:
+        Scheduler(CPU&, Bus&);
+        ~Scheduler() override = default;
+
+        Scheduler(const Scheduler&) = delete;
+        Scheduler& operator=(const Scheduler&) = delete;
+
+        Byte Read(const Address) override;
+        void Write(const Address, const Byte) override;
+        uint64_t GetStableReadCycle(const Address) override;
+
+        // Ranges need not be page aligned; the pages they touch are routed here and
+        // addresses no range claims read as open bus.
+        bool MapDevice(const Address, const Address, BusDevice*, SynchronizedDevice*);
+
+        void CatchUpAll(const uint64_t);
+
+        // Requeues every device's prediction after the caller has serviced them.
+        // Returns true if any moved earlier.
+        bool RefreshPredictions();
+
+        // Events that are not device predictions, such as DMA requests.
+        bool ScheduleEvent(const ScheduledEvent&);
+        bool PopDueEvent(const uint64_t, ScheduledEvent&);
+        uint64_t GetNextEventCycle() const { return Events.GetNextCycle(); }
+
+        // The CPU's IRQ input is the wired-OR of every device's line.
+        bool IsInterruptRequested() const;
+
+    private:
+        const SynchronizedRoute* FindRoute(const Address) const;
+        bool AddDevice(SynchronizedDevice*);
+        bool RefreshDevice(const uint8_t);
+
+    private:
+        CPU& ConnectedCPU;
+        Bus& ConnectedBus;
+
+        std::array<SynchronizedRoute, MAXIMUM_SYNCHRONIZED_ROUTES> Routes{};
+        uint8_t RouteCount = 0;
+
+        std::array<SynchronizedDevice*, MAXIMUM_SYNCHRONIZED_DEVICES> Devices{};
+        uint8_t DeviceCount = 0;
+
+        // Last prediction queued per device, so unchanged ones are not requeued
+        std::array<uint64_t, MAXIMUM_SYNCHRONIZED_DEVICES> Predictions{};
+        EventQueue Events;
+};
+
+#endif
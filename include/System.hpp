@@ -0,0 +1,79 @@
+#ifndef SYSTEM_HPP
+#define SYSTEM_HPP
+
+#include <array>
+#include <memory>
+
+#include "APU.hpp"
+#include "Bus.hpp"
+#include "CPU.hpp"
+#include "Cartridge.hpp"
+#include "Controller.hpp"
+#include "Mapper.hpp"
+#include "OutputPipeline.hpp"
+#include "PPU.hpp"
+#include "Scheduler.hpp"
+#include "Typedefs.hpp"
+
+constexpr Address OAM_DMA_REGISTER = 0x4014;
+constexpr uint32_t OAM_DMA_CYCLES = 513;
+
+// The whole console. The CPU runs uninterrupted up to the next queued event (a
+// predicted NMI or IRQ, or a DMA request); the PPU and APU are only caught up when
+// the CPU touches them or an event falls due.
+//
+// The console itself answers the I/O ports that belong to no chip: $4014 and the
+// controller ports. Writes to $4017 go on to the APU frame counter.
+class System : public BusDevice
+{
+    public:
+        System();
+        ~System() override = default;
+
+        System(const System&) = delete;
+        System& operator=(const System&) = delete;
+
+        // The cartridge must outlive the system; its ROM is used in place. One
+        // cartridge per system. Call Reset() afterwards to start the game.
+        bool InsertCartridge(const Cartridge&);
+
+        void Reset();
+        uint64_t RunCycles(const uint64_t);
+        uint64_t RunFrame();
+
+        Byte Read(const Address) override;
+        void Write(const Address, const Byte) override;
+
+        CPU& GetCPU() { return SystemCPU; }
+        Bus& GetBus() { return SystemBus; }
+        PPU& GetPPU() { return SystemPPU; }
+        APU& GetAPU() { return SystemAPU; }
+        Scheduler& GetScheduler() { return SystemScheduler; }
+        Mapper* GetMapper() { return CartridgeMapper.get(); }
+        Controller& GetController(const size_t port) { return Controllers[port]; }
+
+        // Frames are published as the PPU finishes them and audio at the end of every
+        // frame; a presentation thread consumes both from here.
+        OutputPipeline& GetOutput() { return Output; }
+
+    private:
+        void ServiceEvents();
+        void RunOamDma(const Byte);
+
+    private:
+        Bus SystemBus;
+        CPU SystemCPU;
+        PPU SystemPPU;
+        APU SystemAPU;
+        Scheduler SystemScheduler;
+        OutputPipeline Output;
+
+        std::unique_ptr<Mapper> CartridgeMapper;
+        std::array<Controller, NUMBER_OF_CONTROLLERS> Controllers;
+
+        // Set while a device holds IRQ low but the CPU has interrupts disabled; the
+        // line is then sampled after every instruction until the CPU takes it.
+        bool IsPollingInterrupt = false;
+};
+
+#endif
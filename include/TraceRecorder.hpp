@@ -0,0 +1,88 @@
+#ifndef TRACE_RECORDER_HPP
+#define TRACE_RECORDER_HPP
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include "CPU.hpp"
+#include "SaveState.hpp"
+#include "Typedefs.hpp"
+
+constexpr uint32_t TRACE_FILE_MAGIC = 0x4352544E; // "NTRC" in little-endian byte order
+constexpr size_t DEFAULT_TRACE_CAPACITY = 1 << 20;
+constexpr size_t NESTEST_LINE_SIZE = 128;
+
+// One instruction as it was about to execute. Widest fields first, with the padding
+// spelled out so the binary dump has the same layout everywhere.
+struct TraceRecord {
+    uint64_t cycle;
+    Address programCounter;
+    uint16_t operand;
+    Opcode opcode;
+    Register accumulator;
+    Register x;
+    Register y;
+    Register statusRegister;
+    Register stackPointer;
+    Byte reserved[6];
+};
+
+static_assert(sizeof(TraceRecord) == 24, "TraceRecord layout must stay fixed");
+static_assert(std::is_trivially_copyable<TraceRecord>::value, "TraceRecord must be a flat record");
+
+// Execution trace as a profiling policy for CPU::StepWith() and friends. Recording
+// is one fixed-size store into a preallocated ring; nothing is formatted or
+// allocated until the trace is dumped. Once the ring is full the oldest records
+// are overwritten, so it always holds the run-up to the point of interest.
+//
+// A binary dump can be turned into a nestest.log-style listing later, on another
+// machine if need be.
+class TraceRecorder
+{
+    public:
+        // The capacity is rounded up to a power of two.
+        explicit TraceRecorder(const size_t = DEFAULT_TRACE_CAPACITY);
+        ~TraceRecorder() = default;
+
+        void BeginInstruction(const CPU& cpu, const DecodedInstruction& decoded)
+        {
+            CPUState state;
+            cpu.CaptureState(state);
+
+            TraceRecord& record = Records[RecordCount & IndexMask];
+            record.cycle = state.totalCycles;
+            record.programCounter = state.programCounter;
+            record.operand = decoded.operand;
+            record.opcode = decoded.opcode;
+            record.accumulator = state.accumulator;
+            record.x = state.x;
+            record.y = state.y;
+            record.statusRegister = state.statusRegister;
+            record.stackPointer = state.stackPointer;
+            ++RecordCount;
+        }
+        void RecordInstruction(const Address, const Opcode, const uint8_t) {}
+
+        void Clear() { RecordCount = 0; }
+
+        // Records still held, oldest first.
+        size_t GetCount() const;
+        const TraceRecord& GetRecord(const size_t) const;
+        uint64_t GetTotalRecorded() const { return RecordCount; }
+
+        bool SaveBinary(const char*) const;
+        bool LoadBinary(const char*);
+        bool WriteNestestLog(const char*) const;
+
+        // Writes one line without the trailing newline and returns its length. The
+        // buffer needs NESTEST_LINE_SIZE bytes.
+        static size_t FormatNestestLine(const TraceRecord&, char*);
+
+    private:
+        std::vector<TraceRecord> Records;
+        size_t IndexMask;
+        uint64_t RecordCount = 0;
+};
+
+#endif
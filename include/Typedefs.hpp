@@ -1,6 +1,8 @@
 #ifndef TYPEDEFS_HPP
 #define TYPEDEFS_HPP
 
+#include <cstdint>
+
 class CPU;
 
 typedef uint8_t Byte;
@@ -21,16 +23,63 @@ namespace StatusRegisterFlags {
         U = (1 << 5), // Unused
         V = (1 << 6), // Overflow
         N = (1 << 7) // Negative
-    }
+    };
 }
 
-typedef (bool)(CPU::*AddressingMode)();
-typedef (bool)(CPU::*OperationFunction)();
+namespace AddressingModes {
+    enum Mode : uint8_t {
+        Implicit,
+        Accumulator,
+        Immediate,
+        ZeroPage,
+        ZeroPageX,
+        ZeroPageY,
+        Absolute,
+        AbsoluteX,
+        AbsoluteY,
+        Indirect,
+        IndirectX,
+        IndirectY,
+        Relative
+    };
+}
 
-struct Instruction {
-    const AddressingMode addressingMode;
-    const OperationFunction operation;
-    const uint8_t cyclesCount;
+namespace Operations {
+    enum Operation : uint8_t {
+        ADC, AND, ASL, BCC, BCS, BEQ, BIT, BMI,
+        BNE, BPL, BRK, BVC, BVS, CLC, CLD, CLI,
+        CLV, CMP, CPX, CPY, DEC, DEX, DEY, EOR,
+        INC, INX, INY, JMP, JSR, LDA, LDX, LDY,
+        LSR, NOP, ORA, PHA, PHP, PLA, PLP, ROL,
+        ROR, RTI, RTS, SBC, SEC, SED, SEI, STA,
+        STX, STY, TAX, TAY, TSX, TXA, TXS, TYA,
+        XXX // Catches all illegal Instructions!
+    };
+}
+
+namespace EventTypes {
+    enum Type : uint8_t {
+        NonMaskableInterrupt,
+        InterruptRequest,
+        DirectMemoryAccess
+    };
 }
 
-#endif
\ No newline at end of file
+struct Instruction {
+    Operations::Operation operation;
+    AddressingModes::Mode addressingMode;
+    uint8_t cyclesCount;
+    bool hasPageCrossPenalty; // One extra cycle when the addressing mode crosses a page
+    bool isLegal;
+};
+
+// An opcode with its operand bytes already read, ready to execute without
+// touching the bus for decoding.
+struct DecodedInstruction {
+    const Instruction* instruction;
+    uint16_t operand;
+    Opcode opcode;
+    uint8_t length; // Opcode plus operand bytes
+};
+
+#endif
@@ -0,0 +1,528 @@
+#include "../include/APU.hpp"
+
+#include <algorithm>
+
+namespace {
+    constexpr std::array<Byte, 32> LENGTH_TABLE = {
+        10, 254, 20, 2, 40, 4, 80, 6, 160, 8, 60, 10, 14, 12, 26, 14,
+        12, 16, 24, 18, 48, 20, 96, 22, 192, 24, 72, 26, 16, 28, 32, 30
+    };
+
+    // Read with a sequencer that counts down, as the hardware does
+    constexpr std::array<std::array<Byte, 8>, 4> DUTY_TABLE = { {
+        { 0, 1, 0, 0, 0, 0, 0, 0 },
+        { 0, 1, 1, 0, 0, 0, 0, 0 },
+        { 0, 1, 1, 1, 1, 0, 0, 0 },
+        { 1, 0, 0, 1, 1, 1, 1, 1 }
+    } };
+
+    constexpr std::array<Byte, 32> TRIANGLE_TABLE = {
+        15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+        0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15
+    };
+
+    // NTSC timer periods in CPU cycles
+    constexpr std::array<uint16_t, 16> NOISE_PERIODS = {
+        4, 8, 16, 32, 64, 96, 128, 160, 202, 254, 380, 508, 762, 1016, 2034, 4068
+    };
+    constexpr std::array<uint16_t, 16> DMC_PERIODS = {
+        428, 380, 340, 320, 286, 254, 226, 214, 190, 160, 142, 128, 106, 84, 72, 54
+    };
+
+    // Slopes of the hardware's nonlinear mixer around its operating point. Mixing
+    // linearly lets every channel feed the blip buffer on its own.
+    constexpr float PULSE_MIX_WEIGHT = 0.00752f;
+    constexpr float TRIANGLE_MIX_WEIGHT = 0.00851f;
+    constexpr float NOISE_MIX_WEIGHT = 0.00494f;
+    constexpr float DMC_MIX_WEIGHT = 0.00335f;
+
+    void WriteEnvelope(Envelope& envelope, const Byte data)
+    {
+        envelope.loop = data & 0x20;
+        envelope.constantVolume = data & 0x10;
+        envelope.period = data & 0x0F;
+    }
+
+    void ClockEnvelope(Envelope& envelope)
+    {
+        if (envelope.start) {
+            envelope.start = false;
+            envelope.decay = 15;
+            envelope.divider = envelope.period;
+        } else if (envelope.divider == 0) {
+            envelope.divider = envelope.period;
+            if (envelope.decay > 0) {
+                --envelope.decay;
+            } else if (envelope.loop) {
+                envelope.decay = 15;
+            }
+        } else {
+            --envelope.divider;
+        }
+    }
+
+    int GetVolume(const Envelope& envelope)
+    {
+        return envelope.constantVolume ? envelope.period : envelope.decay;
+    }
+
+    int GetSweepTarget(const PulseChannel& pulse)
+    {
+        const int change = pulse.timer >> pulse.sweepShift;
+        if (pulse.sweepNegate) {
+            return pulse.timer - change - (pulse.isFirstChannel ? 1 : 0);
+        }
+        return pulse.timer + change;
+    }
+
+    // The sweep unit mutes the channel whenever its target is out of range, even
+    // with the sweep disabled
+    bool IsPulseSilent(const PulseChannel& pulse)
+    {
+        return pulse.lengthCounter == 0 || pulse.timer < 8 || GetSweepTarget(pulse) > 0x7FF || GetVolume(pulse.envelope) == 0;
+    }
+
+    int GetPulseLevel(const PulseChannel& pulse)
+    {
+        if (IsPulseSilent(pulse) || !DUTY_TABLE[pulse.duty][pulse.step]) {
+            return 0;
+        }
+        return GetVolume(pulse.envelope);
+    }
+
+    int GetNoiseLevel(const NoiseChannel& noise)
+    {
+        if (noise.lengthCounter == 0 || (noise.shiftRegister & 0x01)) {
+            return 0;
+        }
+        return GetVolume(noise.envelope);
+    }
+
+    void ClockSweep(PulseChannel& pulse)
+    {
+        const int target = GetSweepTarget(pulse);
+        if (pulse.sweepDivider == 0 && pulse.sweepEnabled && pulse.sweepShift > 0 && pulse.timer >= 8 && target >= 0 && target <= 0x7FF) {
+            pulse.timer = static_cast<uint16_t>(target);
+        }
+        if (pulse.sweepDivider == 0 || pulse.sweepReload) {
+            pulse.sweepDivider = pulse.sweepPeriod;
+            pulse.sweepReload = false;
+        } else {
+            --pulse.sweepDivider;
+        }
+    }
+
+    // Moves a timer that produces no output past the end of the span in one step and
+    // returns how many expiries were skipped.
+    uint64_t SkipClocks(uint64_t& nextClock, const uint64_t period, const uint64_t end)
+    {
+        if (nextClock >= end) {
+            return 0;
+        }
+        const uint64_t clocks = (end - nextClock + period - 1) / period;
+        nextClock += clocks * period;
+        return clocks;
+    }
+}
+
+APU::APU(Bus& bus, const uint32_t sampleRate)
+    : ConnectedBus(bus), Blip(NTSC_CPU_CLOCK_RATE, sampleRate, AUDIO_BLOCK_CYCLES)
+{
+    Pulse1.isFirstChannel = true;
+}
+
+void
+APU::Reset()
+{
+    Write(0x4015, 0x00);
+    FrameIrq = false;
+    RestartFrameCounter(SynchronizedCycle);
+}
+
+Byte
+APU::Read(const Address address)
+{
+    if (address != 0x4015) {
+        return 0x00; // Everything else is write-only
+    }
+
+    Byte status = 0x00;
+    status |= Pulse1.lengthCounter > 0 ? 0x01 : 0x00;
+    status |= Pulse2.lengthCounter > 0 ? 0x02 : 0x00;
+    status |= Triangle.lengthCounter > 0 ? 0x04 : 0x00;
+    status |= Noise.lengthCounter > 0 ? 0x08 : 0x00;
+    status |= Dmc.bytesRemaining > 0 ? 0x10 : 0x00;
+    status |= FrameIrq ? 0x40 : 0x00;
+    status |= DmcIrq ? 0x80 : 0x00;
+    FrameIrq = false;
+    return status;
+}
+
+void
+APU::Write(const Address address, const Byte data)
+{
+    if (address <= 0x4007) {
+        PulseChannel& pulse = (address & 0x04) ? Pulse2 : Pulse1;
+        switch (address & 0x03) {
+            case 0:
+                pulse.duty = data >> 6;
+                WriteEnvelope(pulse.envelope, data);
+                break;
+            case 1:
+                pulse.sweepEnabled = data & 0x80;
+                pulse.sweepPeriod = (data >> 4) & 0x07;
+                pulse.sweepNegate = data & 0x08;
+                pulse.sweepShift = data & 0x07;
+                pulse.sweepReload = true;
+                break;
+            case 2:
+                pulse.timer = (pulse.timer & 0x0700) | data;
+                break;
+            case 3:
+                pulse.timer = (pulse.timer & 0x00FF) | ((data & 0x07) << 8);
+                if (EnabledChannels & ((address & 0x04) ? 0x02 : 0x01)) {
+                    pulse.lengthCounter = LENGTH_TABLE[data >> 3];
+                }
+                pulse.step = 0;
+                pulse.envelope.start = true;
+                break;
+        }
+        UpdateOutputs(SynchronizedCycle);
+        return;
+    }
+
+    switch (address) {
+        case 0x4008:
+            Triangle.control = data & 0x80;
+            Triangle.linearReload = data & 0x7F;
+            break;
+        case 0x400A:
+            Triangle.timer = (Triangle.timer & 0x0700) | data;
+            break;
+        case 0x400B:
+            Triangle.timer = (Triangle.timer & 0x00FF) | ((data & 0x07) << 8);
+            if (EnabledChannels & 0x04) {
+                Triangle.lengthCounter = LENGTH_TABLE[data >> 3];
+            }
+            Triangle.linearReloadFlag = true;
+            break;
+        case 0x400C:
+            WriteEnvelope(Noise.envelope, data);
+            break;
+        case 0x400E:
+            Noise.shortMode = data & 0x80;
+            Noise.periodIndex = data & 0x0F;
+            break;
+        case 0x400F:
+            if (EnabledChannels & 0x08) {
+                Noise.lengthCounter = LENGTH_TABLE[data >> 3];
+            }
+            Noise.envelope.start = true;
+            break;
+        case 0x4010:
+            Dmc.irqEnabled = data & 0x80;
+            Dmc.loop = data & 0x40;
+            Dmc.rateIndex = data & 0x0F;
+            if (!Dmc.irqEnabled) {
+                DmcIrq = false;
+            }
+            break;
+        case 0x4011:
+            SetOutput(Dmc.output, data & 0x7F, DMC_MIX_WEIGHT, SynchronizedCycle);
+            break;
+        case 0x4012:
+            Dmc.sampleAddress = 0xC000 + (data << 6);
+            break;
+        case 0x4013:
+            Dmc.sampleLength = (data << 4) + 1;
+            break;
+        case 0x4015:
+            EnabledChannels = data & 0x1F;
+            Pulse1.lengthCounter = (data & 0x01) ? Pulse1.lengthCounter : 0;
+            Pulse2.lengthCounter = (data & 0x02) ? Pulse2.lengthCounter : 0;
+            Triangle.lengthCounter = (data & 0x04) ? Triangle.lengthCounter : 0;
+            Noise.lengthCounter = (data & 0x08) ? Noise.lengthCounter : 0;
+            DmcIrq = false;
+            if (!(data & 0x10)) {
+                Dmc.bytesRemaining = 0;
+            } else if (Dmc.bytesRemaining == 0) {
+                Dmc.currentAddress = Dmc.sampleAddress;
+                Dmc.bytesRemaining = Dmc.sampleLength;
+                FetchSample();
+            }
+            break;
+        case 0x4017:
+            IsFiveStepMode = data & 0x80;
+            IsFrameIrqInhibited = data & 0x40;
+            if (IsFrameIrqInhibited) {
+                FrameIrq = false;
+            }
+            // The new sequence starts 3 or 4 cycles later depending on the APU clock phase
+            RestartFrameCounter(SynchronizedCycle + ((SynchronizedCycle & 1) ? 4 : 3));
+            break;
+    }
+    UpdateOutputs(SynchronizedCycle);
+}
+
+void
+APU::CatchUp(const uint64_t cycle)
+{
+    // Spans end at frame sequencer steps and audio block boundaries; between them
+    // every channel just runs its timer
+    while (SynchronizedCycle < cycle) {
+        const uint64_t stepCycle = FrameCounterStart + APU_FRAME_STEP_CYCLES[FrameStep];
+        const uint64_t blockEndCycle = BlockStartCycle + AUDIO_BLOCK_CYCLES;
+        const uint64_t spanEnd = std::min({ cycle, stepCycle, blockEndCycle });
+
+        RunPulse(Pulse1, spanEnd);
+        RunPulse(Pulse2, spanEnd);
+        RunTriangle(spanEnd);
+        RunNoise(spanEnd);
+        RunDmc(spanEnd);
+        SynchronizedCycle = spanEnd;
+
+        if (SynchronizedCycle == blockEndCycle) {
+            EndBlock(AUDIO_BLOCK_CYCLES);
+        }
+        if (SynchronizedCycle == stepCycle) {
+            ClockFrameStep();
+            UpdateOutputs(SynchronizedCycle);
+        }
+    }
+}
+
+uint64_t
+APU::GetNextEventCycle() const
+{
+    uint64_t eventCycle = NO_PENDING_EVENT;
+    if (!FrameIrq && !IsFiveStepMode && !IsFrameIrqInhibited) {
+        eventCycle = FrameCounterStart + APU_FRAME_STEP_CYCLES[3];
+    }
+
+    // With a sample playing the buffer is always full, so the last byte is fetched
+    // when the current shift register empties plus one byte time per byte left
+    if (!DmcIrq && Dmc.irqEnabled && !Dmc.loop && Dmc.bytesRemaining > 0) {
+        const uint64_t period = DMC_PERIODS[Dmc.rateIndex];
+        const uint64_t lastFetchCycle = Dmc.nextClock + (Dmc.bitsRemaining - 1) * period + (Dmc.bytesRemaining - 1) * 8 * period;
+        eventCycle = std::min(eventCycle, lastFetchCycle + 1);
+    }
+    return eventCycle;
+}
+
+void
+APU::FlushAudio()
+{
+    if (SynchronizedCycle > BlockStartCycle) {
+        EndBlock(static_cast<uint32_t>(SynchronizedCycle - BlockStartCycle));
+    }
+}
+
+void
+APU::RunPulse(PulseChannel& pulse, const uint64_t end)
+{
+    const uint64_t period = (static_cast<uint64_t>(pulse.timer) + 1) * 2;
+    if (IsPulseSilent(pulse)) {
+        const uint64_t clocks = SkipClocks(pulse.nextClock, period, end);
+        pulse.step = static_cast<Byte>((pulse.step - clocks) & 0x07);
+        return;
+    }
+
+    while (pulse.nextClock < end) {
+        pulse.step = (pulse.step - 1) & 0x07;
+        SetOutput(pulse.output, GetPulseLevel(pulse), PULSE_MIX_WEIGHT, pulse.nextClock);
+        pulse.nextClock += period;
+    }
+}
+
+void
+APU::RunTriangle(const uint64_t end)
+{
+    // Periods below 2 are ultrasonic; holding the step avoids the aliasing pop
+    const uint64_t period = static_cast<uint64_t>(Triangle.timer) + 1;
+    if (Triangle.lengthCounter == 0 || Triangle.linearCounter == 0 || Triangle.timer < 2) {
+        SkipClocks(Triangle.nextClock, period, end);
+        return;
+    }
+
+    while (Triangle.nextClock < end) {
+        Triangle.step = (Triangle.step + 1) & 0x1F;
+        SetOutput(Triangle.output, TRIANGLE_TABLE[Triangle.step], TRIANGLE_MIX_WEIGHT, Triangle.nextClock);
+        Triangle.nextClock += period;
+    }
+}
+
+void
+APU::RunNoise(const uint64_t end)
+{
+    const uint64_t period = NOISE_PERIODS[Noise.periodIndex];
+    const uint8_t tap = Noise.shortMode ? 6 : 1;
+    while (Noise.nextClock < end) {
+        const uint16_t feedback = (Noise.shiftRegister ^ (Noise.shiftRegister >> tap)) & 0x01;
+        Noise.shiftRegister = (Noise.shiftRegister >> 1) | (feedback << 14);
+        SetOutput(Noise.output, GetNoiseLevel(Noise), NOISE_MIX_WEIGHT, Noise.nextClock);
+        Noise.nextClock += period;
+    }
+}
+
+void
+APU::RunDmc(const uint64_t end)
+{
+    const uint64_t period = DMC_PERIODS[Dmc.rateIndex];
+    while (Dmc.nextClock < end) {
+        if (!Dmc.isSilent) {
+            int level = Dmc.output;
+            if (Dmc.shiftRegister & 0x01) {
+                level += level <= 125 ? 2 : 0;
+            } else {
+                level -= level >= 2 ? 2 : 0;
+            }
+            SetOutput(Dmc.output, level, DMC_MIX_WEIGHT, Dmc.nextClock);
+        }
+        Dmc.shiftRegister >>= 1;
+
+        if (--Dmc.bitsRemaining == 0) {
+            Dmc.bitsRemaining = 8;
+            Dmc.isSilent = Dmc.isBufferEmpty;
+            if (!Dmc.isBufferEmpty) {
+                Dmc.shiftRegister = Dmc.sampleBuffer;
+                Dmc.isBufferEmpty = true;
+                FetchSample();
+            }
+        }
+        Dmc.nextClock += period;
+    }
+}
+
+void
+APU::FetchSample()
+{
+    // The CPU stall of the fetch is not modelled
+    if (!Dmc.isBufferEmpty || Dmc.bytesRemaining == 0) {
+        return;
+    }
+
+    Dmc.sampleBuffer = ConnectedBus.Read(Dmc.currentAddress);
+    Dmc.isBufferEmpty = false;
+    Dmc.currentAddress = Dmc.currentAddress == 0xFFFF ? 0x8000 : Dmc.currentAddress + 1;
+    if (--Dmc.bytesRemaining > 0) {
+        return;
+    }
+
+    if (Dmc.loop) {
+        Dmc.currentAddress = Dmc.sampleAddress;
+        Dmc.bytesRemaining = Dmc.sampleLength;
+    } else if (Dmc.irqEnabled) {
+        DmcIrq = true;
+    }
+}
+
+void
+APU::ClockFrameStep()
+{
+    if (IsFiveStepMode) {
+        switch (FrameStep) {
+            case 0: case 2: ClockQuarterFrame(); break;
+            case 1: case 4: ClockQuarterFrame(); ClockHalfFrame(); break;
+            default: break;
+        }
+    } else {
+        switch (FrameStep) {
+            case 0: case 2: ClockQuarterFrame(); break;
+            case 1: ClockQuarterFrame(); ClockHalfFrame(); break;
+            case 3:
+                ClockQuarterFrame();
+                ClockHalfFrame();
+                FrameIrq |= !IsFrameIrqInhibited;
+                break;
+        }
+    }
+
+    const uint8_t lastStep = IsFiveStepMode ? 4 : 3;
+    if (FrameStep == lastStep) {
+        FrameCounterStart += IsFiveStepMode ? APU_FIVE_STEP_PERIOD : APU_FOUR_STEP_PERIOD;
+        FrameStep = 0;
+    } else {
+        ++FrameStep;
+    }
+}
+
+void
+APU::ClockQuarterFrame()
+{
+    ClockEnvelope(Pulse1.envelope);
+    ClockEnvelope(Pulse2.envelope);
+    ClockEnvelope(Noise.envelope);
+
+    if (Triangle.linearReloadFlag) {
+        Triangle.linearCounter = Triangle.linearReload;
+    } else if (Triangle.linearCounter > 0) {
+        --Triangle.linearCounter;
+    }
+    if (!Triangle.control) {
+        Triangle.linearReloadFlag = false;
+    }
+}
+
+void
+APU::ClockHalfFrame()
+{
+    if (!Pulse1.envelope.loop && Pulse1.lengthCounter > 0) {
+        --Pulse1.lengthCounter;
+    }
+    if (!Pulse2.envelope.loop && Pulse2.lengthCounter > 0) {
+        --Pulse2.lengthCounter;
+    }
+    if (!Triangle.control && Triangle.lengthCounter > 0) {
+        --Triangle.lengthCounter;
+    }
+    if (!Noise.envelope.loop && Noise.lengthCounter > 0) {
+        --Noise.lengthCounter;
+    }
+    ClockSweep(Pulse1);
+    ClockSweep(Pulse2);
+}
+
+void
+APU::RestartFrameCounter(const uint64_t cycle)
+{
+    FrameCounterStart = cycle;
+    FrameStep = 0;
+    if (IsFiveStepMode) {
+        ClockQuarterFrame();
+        ClockHalfFrame();
+    }
+}
+
+void
+APU::UpdateOutputs(const uint64_t cycle)
+{
+    // The triangle and DMC levels only move when their timers do
+    SetOutput(Pulse1.output, GetPulseLevel(Pulse1), PULSE_MIX_WEIGHT, cycle);
+    SetOutput(Pulse2.output, GetPulseLevel(Pulse2), PULSE_MIX_WEIGHT, cycle);
+    SetOutput(Noise.output, GetNoiseLevel(Noise), NOISE_MIX_WEIGHT, cycle);
+}
+
+void
+APU::SetOutput(int& output, const int level, const float weight, const uint64_t cycle)
+{
+    if (level == output) {
+        return;
+    }
+    Blip.AddDelta(static_cast<uint32_t>(cycle - BlockStartCycle), static_cast<float>(level - output) * weight);
+    output = level;
+}
+
+void
+APU::EndBlock(const uint32_t clocks)
+{
+    Blip.EndFrame(clocks);
+    BlockStartCycle += clocks;
+
+    std::array<int16_t, 512> samples;
+    size_t count;
+    while ((count = Blip.ReadSamples(samples.data(), samples.size())) > 0) {
+        if (ConnectedAudioSink != nullptr) {
+            ConnectedAudioSink->WriteSamples(samples.data(), count);
+        }
+    }
+}
@@ -0,0 +1,101 @@
+#include "../include/BatchRunner.hpp"
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include "../include/Bus.hpp"
+#include "../include/CPU.hpp"
+
+BatchRunner::BatchRunner(const size_t threadCount)
+    : ThreadCount(threadCount)
+{
+    if (ThreadCount == 0) {
+        ThreadCount = std::thread::hardware_concurrency();
+    }
+    if (ThreadCount == 0) {
+        ThreadCount = 1;
+    }
+}
+
+BatchReport
+BatchRunner::Run(const std::vector<BatchJob>& jobs)
+{
+    BatchReport report{};
+    report.results.resize(jobs.size());
+
+    std::vector<WorkQueue> queues(ThreadCount);
+    for (size_t job = 0; job < jobs.size(); ++job) {
+        queues[job % ThreadCount].jobs.push_back(job);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> workers;
+    workers.reserve(ThreadCount);
+    for (size_t worker = 0; worker < ThreadCount; ++worker) {
+        workers.emplace_back(&BatchRunner::RunWorker, this, std::ref(queues), worker, std::cref(jobs), std::ref(report.results));
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    report.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    for (const BatchResult& result : report.results) {
+        report.totalCycles += result.cyclesExecuted;
+    }
+    report.cyclesPerSecond = report.wallSeconds > 0.0 ? report.totalCycles / report.wallSeconds : 0.0;
+    return report;
+}
+
+bool
+BatchRunner::TakeJob(std::vector<WorkQueue>& queues, const size_t worker, size_t& job)
+{
+    {
+        WorkQueue& own = queues[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.jobs.empty()) {
+            job = own.jobs.back();
+            own.jobs.pop_back();
+            return true;
+        }
+    }
+
+    for (size_t offset = 1; offset < queues.size(); ++offset) {
+        WorkQueue& victim = queues[(worker + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.jobs.empty()) {
+            job = victim.jobs.front();
+            victim.jobs.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void
+BatchRunner::RunWorker(std::vector<WorkQueue>& queues, const size_t worker, const std::vector<BatchJob>& jobs, std::vector<BatchResult>& results)
+{
+    size_t job;
+    while (TakeJob(queues, worker, job)) {
+        // Every job gets a fresh instance, so nothing mutable is shared between threads.
+        std::unique_ptr<Bus> bus = std::make_unique<Bus>();
+        std::unique_ptr<CPU> cpu = std::make_unique<CPU>();
+        cpu->ConnectBus(bus.get());
+        if (jobs[job].setup) {
+            jobs[job].setup(*cpu, *bus);
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        const uint64_t cycles = cpu->RunCycles(jobs[job].cycles);
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (jobs[job].finish) {
+            jobs[job].finish(*cpu, *bus);
+        }
+
+        // Each job writes only its own slot.
+        results[job] = { cycles, seconds };
+    }
+}
@@ -0,0 +1,98 @@
+#include "../include/BlipBuffer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+    constexpr double PI = 3.14159265358979323846;
+
+    // Fraction of the output Nyquist frequency the kernel passes
+    constexpr double KERNEL_CUTOFF = 0.9;
+
+    // The console's own output stage is AC-coupled; this removes the DC offset the
+    // unipolar channel levels would otherwise leave in the samples
+    constexpr float HIGH_PASS_FEEDBACK = 0.995f;
+    constexpr float OUTPUT_GAIN = 30000.0f;
+}
+
+BlipBuffer::BlipBuffer(const double clockRate, const uint32_t sampleRate, const uint32_t maximumClocks)
+    : Factor(static_cast<uint64_t>(std::ldexp(sampleRate / clockRate, 32)))
+{
+    // Samples left unread from one frame carry over, so leave room for two frames
+    const size_t maximumSamples = static_cast<size_t>(std::ceil(maximumClocks * (sampleRate / clockRate))) + 1;
+    Deltas.assign(maximumSamples * 2 + BLIP_KERNEL_WIDTH, 0.0f);
+
+    // One windowed-sinc impulse per sub-sample phase, each normalised to unit area so
+    // the integrated step lands exactly on the new level
+    const double halfWidth = BLIP_KERNEL_WIDTH / 2.0;
+    for (size_t phase = 0; phase < BLIP_PHASES; ++phase) {
+        const double fraction = static_cast<double>(phase) / BLIP_PHASES;
+        double sum = 0.0;
+        std::array<double, BLIP_KERNEL_WIDTH> taps{};
+        for (size_t tap = 0; tap < BLIP_KERNEL_WIDTH; ++tap) {
+            const double x = static_cast<double>(tap) - (halfWidth - 1.0) - fraction;
+            const double sinc = x == 0.0 ? 1.0 : std::sin(PI * KERNEL_CUTOFF * x) / (PI * KERNEL_CUTOFF * x);
+            const double window = 0.42 + 0.5 * std::cos(PI * x / halfWidth) + 0.08 * std::cos(2.0 * PI * x / halfWidth);
+            taps[tap] = KERNEL_CUTOFF * sinc * window;
+            sum += taps[tap];
+        }
+        for (size_t tap = 0; tap < BLIP_KERNEL_WIDTH; ++tap) {
+            Kernel[phase][tap] = static_cast<float>(taps[tap] / sum);
+        }
+    }
+}
+
+void
+BlipBuffer::AddDelta(const uint32_t clock, const float delta)
+{
+    const uint64_t position = Offset + clock * Factor;
+    const size_t sample = static_cast<size_t>(position >> 32);
+    if (sample + BLIP_KERNEL_WIDTH > Deltas.size()) {
+        return;
+    }
+
+    const std::array<float, BLIP_KERNEL_WIDTH>& kernel = Kernel[(position >> (32 - BLIP_PHASE_BITS)) & (BLIP_PHASES - 1)];
+    float* output = Deltas.data() + sample;
+    for (size_t tap = 0; tap < BLIP_KERNEL_WIDTH; ++tap) {
+        output[tap] += delta * kernel[tap];
+    }
+}
+
+void
+BlipBuffer::EndFrame(const uint32_t clocks)
+{
+    Offset += clocks * Factor;
+}
+
+size_t
+BlipBuffer::ReadSamples(int16_t* samples, const size_t count)
+{
+    const size_t available = GetSamplesAvailable();
+    const size_t samplesRead = std::min(count, available);
+
+    for (size_t index = 0; index < samplesRead; ++index) {
+        Integrator += Deltas[index];
+        HighPassOutput = Integrator - HighPassInput + HIGH_PASS_FEEDBACK * HighPassOutput;
+        HighPassInput = Integrator;
+        const float sample = std::clamp(HighPassOutput * OUTPUT_GAIN, -32768.0f, 32767.0f);
+        samples[index] = static_cast<int16_t>(sample);
+    }
+
+    // Slide the unread samples and the tails of pending impulses to the front
+    const size_t remaining = available - samplesRead + BLIP_KERNEL_WIDTH;
+    std::memmove(Deltas.data(), Deltas.data() + samplesRead, remaining * sizeof(float));
+    std::fill(Deltas.begin() + remaining, Deltas.begin() + std::min(Deltas.size(), remaining + samplesRead), 0.0f);
+    Offset -= static_cast<uint64_t>(samplesRead) << 32;
+    return samplesRead;
+}
+
+void
+BlipBuffer::Clear()
+{
+    std::fill(Deltas.begin(), Deltas.end(), 0.0f);
+    Offset = 0;
+    Integrator = 0.0f;
+    HighPassInput = 0.0f;
+    HighPassOutput = 0.0f;
+}
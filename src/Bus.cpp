@@ -0,0 +1,187 @@
+#include "../include/Bus.hpp"
+
+Bus::Bus()
+{
+    for (size_t page = 0; page < NUMBER_OF_BUS_PAGES; ++page) {
+        NextAlias[page] = static_cast<uint8_t>(page);
+    }
+    DirtyPages.fill(true);
+    MapMemory(MEMORY_MIRRORED_UNIT.first, MEMORY_MIRRORED_UNIT.second, Ram.data(), Ram.size());
+}
+
+void
+Bus::MapMemory(const Address first, const Address last, Byte* memory, const size_t size)
+{
+    for (size_t page = first >> 8; page <= static_cast<size_t>(last >> 8); ++page) {
+        Byte* pageMemory = memory + (((page - (first >> 8)) * BUS_PAGE_SIZE) % size);
+        RemapPage(page);
+        ReadPages[page] = pageMemory;
+        WritePages[page] = pageMemory;
+        MemoryPages[page] = pageMemory;
+        LinkAliases(page);
+    }
+}
+
+void
+Bus::MapReadOnlyMemory(const Address first, const Address last, const Byte* memory, const size_t size)
+{
+    // Writes to read-only pages fall through to whichever device owns the page,
+    // which is how mapper registers living under PRG-ROM are reached.
+    for (size_t page = first >> 8; page <= static_cast<size_t>(last >> 8); ++page) {
+        // Mappers rewrite every bank register often, mostly with the same value;
+        // leaving unchanged pages alone keeps decoded code on them valid.
+        const Byte* pageMemory = memory + (((page - (first >> 8)) * BUS_PAGE_SIZE) % size);
+        if (ReadPages[page] == pageMemory && MemoryPages[page] == nullptr) {
+            continue;
+        }
+        RemapPage(page);
+        ReadPages[page] = pageMemory;
+        WritePages[page] = nullptr;
+        MemoryPages[page] = nullptr;
+    }
+}
+
+void
+Bus::MapDevice(const Address first, const Address last, BusDevice* device)
+{
+    for (size_t page = first >> 8; page <= static_cast<size_t>(last >> 8); ++page) {
+        RemapPage(page);
+        ReadPages[page] = nullptr;
+        WritePages[page] = nullptr;
+        MemoryPages[page] = nullptr;
+        Devices[page] = device;
+    }
+}
+
+void
+Bus::Unmap(const Address first, const Address last)
+{
+    MapDevice(first, last, nullptr);
+}
+
+Byte
+Bus::ReadFromDevice(const Address address)
+{
+    BusDevice* device = Devices[address >> 8];
+    if (device == nullptr) {
+        return 0x00; // Open bus
+    }
+    return device->Read(address);
+}
+
+uint64_t
+Bus::GetStableReadCycle(const Address address)
+{
+    BusDevice* device = Devices[address >> 8];
+    if (ReadPages[address >> 8] != nullptr || device == nullptr) {
+        return NO_PENDING_EVENT;
+    }
+    return device->GetStableReadCycle(address);
+}
+
+void
+Bus::WatchPage(const size_t page)
+{
+    // Mirrors of the page share its storage, so they must be watched too or a write
+    // through a mirror would slip past on the fast path.
+    if (MemoryPages[page] == nullptr) {
+        return;
+    }
+    ForEachAlias(page, [this](const size_t alias) {
+        WatchedPages[alias] = true;
+        WritePages[alias] = nullptr;
+    });
+}
+
+void
+Bus::CleanPage(const size_t page)
+{
+    if (MemoryPages[page] == nullptr) {
+        return;
+    }
+    ForEachAlias(page, [this](const size_t alias) {
+        DirtyPages[alias] = false;
+        WritePages[alias] = nullptr;
+    });
+}
+
+void
+Bus::MarkDirty(const Address first, const Address last)
+{
+    // The memory changed behind the Bus's back, so code decoded from watched pages
+    // has to be treated as stale as well.
+    for (size_t page = first >> 8; page <= static_cast<size_t>(last >> 8); ++page) {
+        if (MemoryPages[page] == nullptr) {
+            continue;
+        }
+        MarkPageDirty(page);
+        ForEachAlias(page, [this](const size_t alias) {
+            if (WatchedPages[alias]) {
+                ++PageGenerations[alias];
+            }
+        });
+    }
+}
+
+void
+Bus::MarkPageDirty(const size_t page)
+{
+    Byte* memory = MemoryPages[page];
+    ForEachAlias(page, [this, memory](const size_t alias) {
+        DirtyPages[alias] = true;
+        WritePages[alias] = WatchedPages[alias] ? nullptr : memory;
+    });
+}
+
+void
+Bus::RemapPage(const size_t page)
+{
+    ++PageGenerations[page];
+    WatchedPages[page] = false;
+    DirtyPages[page] = true;
+
+    // Leaves the ring of pages it shared memory with
+    size_t previous = page;
+    while (NextAlias[previous] != page) {
+        previous = NextAlias[previous];
+    }
+    NextAlias[previous] = NextAlias[page];
+    NextAlias[page] = static_cast<uint8_t>(page);
+}
+
+void
+Bus::LinkAliases(const size_t page)
+{
+    // Mapping is rare next to writes, so the one search for mirrors happens here
+    for (size_t alias = 0; alias < NUMBER_OF_BUS_PAGES; ++alias) {
+        if (alias != page && MemoryPages[alias] == MemoryPages[page]) {
+            NextAlias[page] = NextAlias[alias];
+            NextAlias[alias] = static_cast<uint8_t>(page);
+            return;
+        }
+    }
+}
+
+void
+Bus::WriteToDevice(const Address address, const Byte data)
+{
+    const size_t page = address >> 8;
+    if (!DirtyPages[page]) {
+        MarkPageDirty(page);
+        if (!WatchedPages[page]) {
+            MemoryPages[page][address & 0x00FF] = data;
+            return;
+        }
+    }
+
+    if (WatchedPages[page]) {
+        MemoryPages[page][address & 0x00FF] = data;
+        ForEachAlias(page, [this](const size_t alias) { ++PageGenerations[alias]; });
+        return;
+    }
+
+    BusDevice* device = Devices[address >> 8];
+    if (device != nullptr) {
+        device->Write(address, data);
+    }
+}
@@ -1,135 +1,571 @@
 #include "../include/CPU.hpp"
 #include "../include/Typedefs.hpp"
 
-CPU::CPU()
+#include <algorithm>
+
+void
+CPU::Clock()
 {
-    // Empty Constructor
+    NullProfiler profiler;
+    ClockWith(profiler);
 }
 
-CPU::~CPU()
+uint32_t
+CPU::Step()
 {
-    // Empty Destructor
+    NullProfiler profiler;
+    return StepWith(profiler);
+}
+
+uint64_t
+CPU::RunCycles(const uint64_t cycles)
+{
+    // Runs until at least the requested number of cycles has elapsed; the last
+    // instruction may overshoot, and the overshoot is included in the result.
+    // EndTimeslice() can cut the run short after the current instruction.
+    const uint64_t startCycle = TotalCycles;
+    TimesliceEnd = TotalCycles + cycles;
+    if (CyclesLeft != 0) {
+        Step();
+    }
+
+    while (TotalCycles < TimesliceEnd) {
+        if (ConnectedJit != nullptr && !ConnectedJit->IsRejected(ProgramCounter) && RunCompiledBlock()) {
+            continue;
+        }
+        if (ConnectedDecodeCache != nullptr) {
+            RunDecodedBlock();
+        } else {
+            Step();
+        }
+        if (HasJumpedBack) {
+            HasJumpedBack = false;
+            if (IsIdleLoopSkipping) {
+                SkipIdleLoop();
+            }
+        }
+    }
+    return TotalCycles - startCycle;
 }
 
 void
-CPU::Clock()
+CPU::Reset()
+{
+    // Reset runs the interrupt sequence with writes suppressed: the stack pointer
+    // still drops by three, but nothing is pushed.
+    ProgramCounter = (uint16_t)FetchByteFromMemory(0xFFFC) | ((uint16_t)FetchByteFromMemory(0xFFFD) << 8);
+    StackPointer -= 3;
+    SetFlagInStatusRegister(StatusRegisterFlags::I, 1);
+    SetFlagInStatusRegister(StatusRegisterFlags::U, 1);
+    CyclesLeft = 7;
+}
+
+void
+CPU::InterruptRequest()
+{
+    if (GetFlagFromStatusRegister(StatusRegisterFlags::I)) {
+        return;
+    }
+    EnterInterrupt(0xFFFE);
+}
+
+void
+CPU::NonMaskableInterrupt()
+{
+    EnterInterrupt(0xFFFA);
+}
+
+void
+CPU::EnterInterrupt(const Address vector)
+{
+    WriteByteToMemory(0x0100 + StackPointer, (ProgramCounter >> 8) & 0x00FF);
+    StackPointer--;
+    WriteByteToMemory(0x0100 + StackPointer, ProgramCounter & 0x00FF);
+    StackPointer--;
+    // Hardware interrupts push B clear, which is how handlers tell them from BRK
+    WriteByteToMemory(0x0100 + StackPointer, (GetStatusRegister() & ~StatusRegisterFlags::B) | StatusRegisterFlags::U);
+    StackPointer--;
+    SetFlagInStatusRegister(StatusRegisterFlags::I, 1);
+    ProgramCounter = (uint16_t)FetchByteFromMemory(vector) | ((uint16_t)FetchByteFromMemory(vector + 1) << 8);
+    CyclesLeft = 7;
+}
+
+void
+CPU::Stall(const uint32_t cycles)
 {
-    if (CyclesLeftLeft == 0) {
-        // If we have entered here, it means that the previous instruction has completed
-        // its cycle count and we can move on to the next instruction.
+    TotalCycles += cycles;
+}
 
-        Opcode Opcode = FetchByteFromMemory(ProgramCounter);
-        ++ProgramCounter;
-        CyclesLeftLeft = GetNumberOfBaseClockCyclesLeftForOperation(Opcode);
-        
-        AddressingMode = OpcodeTable[Opcode].addressingMode;
-        OperationFunction = OpcodeTable[Opcode].operation;
+void
+CPU::EndTimeslice()
+{
+    TimesliceEnd = TotalCycles;
+}
 
-        CyclesLeftLeft +=  (this->*AddressingMode)() & (this->*OperationFunction)() ? 1 : 0;
+uint64_t
+CPU::RunDecodedBlock()
+{
+    const DecodedBlock* block = ConnectedDecodeCache->Lookup(*this, ProgramCounter);
+    if (block == nullptr) {
+        return Step();
     }
 
-    --CyclesLeftLeft;
+    // Runs the block until control leaves it, the budget is spent, or a write
+    // lands on the code it was decoded from.
+    uint64_t cyclesConsumed = 0;
+    for (uint8_t index = 0; index < block->count; ++index) {
+        const DecodedInstruction& decoded = block->instructions[index];
+        const Address expectedProgramCounter = ProgramCounter + decoded.length;
+
+        const uint8_t instructionCycles = ExecuteDecoded(decoded);
+        CyclesLeft = 0;
+        TotalCycles += instructionCycles;
+        cyclesConsumed += instructionCycles;
+
+        if (ProgramCounter != expectedProgramCounter || TotalCycles >= TimesliceEnd || !ConnectedDecodeCache->IsCurrent(*block)) {
+            break;
+        }
+    }
+    return cyclesConsumed;
+}
+
+bool
+CPU::RunCompiledBlock()
+{
+    // Compiled code only checks the budget between passes, so a block may only start
+    // when a whole pass is sure to end before the timeslice does.
+    const CompiledBlock* block = ConnectedJit->Lookup(*this, ProgramCounter);
+    if (block == nullptr || TotalCycles + block->maximumCycles >= TimesliceEnd) {
+        return false;
+    }
+
+    JitRegisters registers;
+    registers.totalCycles = TotalCycles;
+    registers.timesliceEnd = TimesliceEnd;
+    registers.programCounter = ProgramCounter;
+    registers.accumulator = Accumulator;
+    registers.x = X;
+    registers.y = Y;
+    registers.stackPointer = StackPointer;
+    registers.zeroResult = ZeroResult;
+    registers.negativeResult = NegativeResult;
+    registers.carryFlag = CarryFlag;
+    registers.overflowFlag = OverflowFlag;
+    block->function(&registers);
+
+    // A block that left before its first instruction hands that one to the interpreter
+    const bool hasProgressed = registers.totalCycles != TotalCycles;
+    TotalCycles = registers.totalCycles;
+    ProgramCounter = registers.programCounter;
+    Accumulator = registers.accumulator;
+    X = registers.x;
+    Y = registers.y;
+    StackPointer = registers.stackPointer;
+    ZeroResult = registers.zeroResult;
+    NegativeResult = registers.negativeResult;
+    CarryFlag = registers.carryFlag;
+    OverflowFlag = registers.overflowFlag;
+    return hasProgressed;
+}
+
+void
+CPU::Decode(const Address address, DecodedInstruction& decoded)
+{
+    decoded.opcode = FetchByteFromMemory(address);
+    decoded.instruction = &OPCODE_TABLE[decoded.opcode];
+    decoded.length = 1 + GetOperandLength(decoded.instruction->addressingMode);
+    decoded.operand = 0;
+    if (decoded.length > 1) {
+        decoded.operand = FetchByteFromMemory(address + 1);
+    }
+    if (decoded.length > 2) {
+        decoded.operand |= FetchByteFromMemory(address + 2) << 8;
+    }
+}
+
+uint8_t
+CPU::ExecuteDecoded(const DecodedInstruction& decoded)
+{
+    CurrentOpcode = decoded.opcode;
+    Operand = decoded.operand;
+    ++ProgramCounter;
+
+    const Instruction& instruction = *decoded.instruction;
+    CyclesLeft = instruction.cyclesCount;
+
+    // The penalty is added before the operation runs so that GetAccessCycle() sees the
+    // final length. Branch handlers add their own taken/page-cross cycles onto CyclesLeft.
+    bool hasPageChanged = ExecuteAddressingMode(instruction.addressingMode);
+    CyclesLeft += (hasPageChanged && instruction.hasPageCrossPenalty) ? 1 : 0;
+    ExecuteOperation(instruction.operation);
+    return CyclesLeft;
+}
+
+void
+CPU::SkipIdleLoop()
+{
+    // Called with the jump that closes the loop just completed. Only loops whose code
+    // was never seen to do anything but read are worth the check below.
+    const Address start = BackwardJumpTarget;
+    const Address end = BackwardJumpEnd;
+    if (ProgramCounter != start || end - start > MAXIMUM_IDLE_LOOP_LENGTH) {
+        return;
+    }
+    IdleLoop& loop = LastIdleLoop;
+    if (loop.start != start || loop.end != end
+        || ConnectedBus->GetPageGeneration(start >> 8) != loop.firstPageGeneration
+        || ConnectedBus->GetPageGeneration((end - 1) >> 8) != loop.lastPageGeneration) {
+        loop.start = start;
+        loop.end = end;
+        loop.firstPageGeneration = ConnectedBus->GetPageGeneration(start >> 8);
+        loop.lastPageGeneration = ConnectedBus->GetPageGeneration((end - 1) >> 8);
+        loop.isIdleCode = IsIdleLoopCode(start, end);
+    }
+    if (!loop.isIdleCode) {
+        return;
+    }
+
+    // Reads before the stable cycle see what a read now would, so that is as far as
+    // passes can be skipped.
+    const uint64_t stableCycle = GetIdleLoopStableCycle(start, end);
+    if (stableCycle <= TotalCycles) {
+        return;
+    }
+
+    // Run one pass for real. It has to stay inside the loop and come back to exactly
+    // the registers and flags it started with; then every further pass is the same.
+    const Register accumulator = Accumulator;
+    const Register x = X;
+    const Register y = Y;
+    const Register stackPointer = StackPointer;
+    const Byte status = GetStatusRegister();
+    const uint64_t passStart = TotalCycles;
+
+    HasJumpedBack = false;
+    while (!HasJumpedBack) {
+        if (TotalCycles >= TimesliceEnd) {
+            return;
+        }
+        Step();
+        if (ProgramCounter < start || ProgramCounter >= end) {
+            return;
+        }
+    }
+    HasJumpedBack = false;
+    if (ProgramCounter != start || BackwardJumpEnd != end || Accumulator != accumulator || X != x || Y != y
+        || StackPointer != stackPointer || GetStatusRegister() != status) {
+        return;
+    }
+
+    // Skipped passes must end before the timeslice does, as the remaining one runs
+    // normally, and before anything the loop reads may change.
+    if (TimesliceEnd <= TotalCycles) {
+        return;
+    }
+    const uint64_t period = TotalCycles - passStart;
+    const uint64_t lastCycle = std::min(TimesliceEnd - 1, stableCycle);
+    if (lastCycle < TotalCycles + period) {
+        return;
+    }
+    const uint64_t skipped = (lastCycle - TotalCycles) / period * period;
+    TotalCycles += skipped;
+    IdleCyclesSkipped += skipped;
+}
+
+bool
+CPU::IsIdleLoopCode(const Address start, const Address end)
+{
+    // The code must sit in PRG-ROM and only read: loads, compares, BIT, logic and flag
+    // operations, and jumps that stay inside the loop. Anything that could reach a
+    // device register through a pointer rules the loop out.
+    const size_t firstPage = start >> 8;
+    const size_t lastPage = (end - 1) >> 8;
+    if (!ConnectedBus->IsMemoryPage(firstPage) || ConnectedBus->IsWritablePage(firstPage)
+        || !ConnectedBus->IsMemoryPage(lastPage) || ConnectedBus->IsWritablePage(lastPage)) {
+        return false;
+    }
+
+    Address address = start;
+    while (address < end) {
+        DecodedInstruction decoded;
+        Decode(address, decoded);
+        const Instruction& instruction = *decoded.instruction;
+        if (!instruction.isLegal) {
+            return false;
+        }
+
+        switch (instruction.operation) {
+            case Operations::LDA: case Operations::LDX: case Operations::LDY: case Operations::CMP:
+            case Operations::CPX: case Operations::CPY: case Operations::BIT: case Operations::AND:
+            case Operations::ORA: case Operations::EOR: case Operations::NOP: case Operations::CLC:
+            case Operations::SEC: case Operations::CLV: case Operations::TAX: case Operations::TAY:
+            case Operations::TXA: case Operations::TYA:
+                break;
+            case Operations::BCC: case Operations::BCS: case Operations::BEQ: case Operations::BMI:
+            case Operations::BNE: case Operations::BPL: case Operations::BVC: case Operations::BVS: {
+                const Address target = address + decoded.length + static_cast<int8_t>(decoded.operand & 0x00FF);
+                if (target < start || target > end) {
+                    return false;
+                }
+                break;
+            }
+            case Operations::JMP:
+                if (instruction.addressingMode != AddressingModes::Absolute || decoded.operand < start || decoded.operand > end) {
+                    return false;
+                }
+                break;
+            default:
+                return false;
+        }
+
+        switch (instruction.addressingMode) {
+            case AddressingModes::AbsoluteX:
+            case AddressingModes::AbsoluteY:
+                if (!ConnectedBus->IsMemoryPage(decoded.operand >> 8) || !ConnectedBus->IsMemoryPage(((decoded.operand + 0x00FF) & 0xFFFF) >> 8)) {
+                    return false;
+                }
+                break;
+            case AddressingModes::ZeroPage:
+            case AddressingModes::ZeroPageX:
+            case AddressingModes::ZeroPageY:
+                if (!ConnectedBus->IsMemoryPage(0)) {
+                    return false;
+                }
+                break;
+            case AddressingModes::Indirect:
+            case AddressingModes::IndirectX:
+            case AddressingModes::IndirectY:
+                return false;
+            default:
+                break;
+        }
+        address += decoded.length;
+    }
+    return address == end;
+}
+
+uint64_t
+CPU::GetIdleLoopStableCycle(const Address start, const Address end)
+{
+    // Zero page and indexed operands were checked to be memory; absolute operands
+    // may be device registers that only stay put for a while.
+    uint64_t stableCycle = NO_PENDING_EVENT;
+    for (Address address = start; address < end;) {
+        DecodedInstruction decoded;
+        Decode(address, decoded);
+        if (decoded.instruction->addressingMode == AddressingModes::Absolute && decoded.instruction->operation != Operations::JMP) {
+            stableCycle = std::min(stableCycle, ConnectedBus->GetStableReadCycle(decoded.operand));
+        }
+        address += decoded.length;
+    }
+    return stableCycle;
+}
+
+void
+CPU::CaptureState(CPUState& state) const
+{
+    state.totalCycles = TotalCycles;
+    state.programCounter = ProgramCounter;
+    state.absoluteAddress = AbsoluteAddress;
+    state.relativeAddress = RelativeAddress;
+    state.temporaryStorage = TemporaryStorage;
+    state.accumulator = Accumulator;
+    state.x = X;
+    state.y = Y;
+    state.stackPointer = StackPointer;
+    state.statusRegister = GetStatusRegister();
+    state.fetchedData = FetchedData;
+    state.currentOpcode = CurrentOpcode;
+    state.cyclesLeft = CyclesLeft;
+}
+
+void
+CPU::RestoreState(const CPUState& state)
+{
+    TotalCycles = state.totalCycles;
+    ProgramCounter = state.programCounter;
+    AbsoluteAddress = state.absoluteAddress;
+    RelativeAddress = state.relativeAddress;
+    TemporaryStorage = state.temporaryStorage;
+    Accumulator = state.accumulator;
+    X = state.x;
+    Y = state.y;
+    StackPointer = state.stackPointer;
+    SetStatusRegister(state.statusRegister);
+    FetchedData = state.fetchedData;
+    CurrentOpcode = state.currentOpcode;
+    CyclesLeft = state.cyclesLeft;
+}
+
+bool
+CPU::ExecuteAddressingMode(const AddressingModes::Mode mode)
+{
+    switch (mode) {
+        case AddressingModes::Implicit:    return ImplicitMode();
+        case AddressingModes::Accumulator: return AccumulatorMode();
+        case AddressingModes::Immediate:   return ImmediateMode();
+        case AddressingModes::ZeroPage:    return ZeroPageMode();
+        case AddressingModes::ZeroPageX:   return ZeroPageXMode();
+        case AddressingModes::ZeroPageY:   return ZeroPageYMode();
+        case AddressingModes::Absolute:    return AbsoluteMode();
+        case AddressingModes::AbsoluteX:   return AbsoluteXMode();
+        case AddressingModes::AbsoluteY:   return AbsoluteYMode();
+        case AddressingModes::Indirect:    return IndirectMode();
+        case AddressingModes::IndirectX:   return IndirectXMode();
+        case AddressingModes::IndirectY:   return IndirectYMode();
+        case AddressingModes::Relative:    return RelativeMode();
+    }
+    return false;
+}
+
+void
+CPU::ExecuteOperation(const Operations::Operation operation)
+{
+    switch (operation) {
+        case Operations::ADC: ADC(); break;
+        case Operations::AND: AND(); break;
+        case Operations::ASL: ASL(); break;
+        case Operations::BCC: BCC(); break;
+        case Operations::BCS: BCS(); break;
+        case Operations::BEQ: BEQ(); break;
+        case Operations::BIT: BIT(); break;
+        case Operations::BMI: BMI(); break;
+        case Operations::BNE: BNE(); break;
+        case Operations::BPL: BPL(); break;
+        case Operations::BRK: BRK(); break;
+        case Operations::BVC: BVC(); break;
+        case Operations::BVS: BVS(); break;
+        case Operations::CLC: CLC(); break;
+        case Operations::CLD: CLD(); break;
+        case Operations::CLI: CLI(); break;
+        case Operations::CLV: CLV(); break;
+        case Operations::CMP: CMP(); break;
+        case Operations::CPX: CPX(); break;
+        case Operations::CPY: CPY(); break;
+        case Operations::DEC: DEC(); break;
+        case Operations::DEX: DEX(); break;
+        case Operations::DEY: DEY(); break;
+        case Operations::EOR: EOR(); break;
+        case Operations::INC: INC(); break;
+        case Operations::INX: INX(); break;
+        case Operations::INY: INY(); break;
+        case Operations::JMP: JMP(); break;
+        case Operations::JSR: JSR(); break;
+        case Operations::LDA: LDA(); break;
+        case Operations::LDX: LDX(); break;
+        case Operations::LDY: LDY(); break;
+        case Operations::LSR: LSR(); break;
+        case Operations::NOP: NOP(); break;
+        case Operations::ORA: ORA(); break;
+        case Operations::PHA: PHA(); break;
+        case Operations::PHP: PHP(); break;
+        case Operations::PLA: PLA(); break;
+        case Operations::PLP: PLP(); break;
+        case Operations::ROL: ROL(); break;
+        case Operations::ROR: ROR(); break;
+        case Operations::RTI: RTI(); break;
+        case Operations::RTS: RTS(); break;
+        case Operations::SBC: SBC(); break;
+        case Operations::SEC: SEC(); break;
+        case Operations::SED: SED(); break;
+        case Operations::SEI: SEI(); break;
+        case Operations::STA: STA(); break;
+        case Operations::STX: STX(); break;
+        case Operations::STY: STY(); break;
+        case Operations::TAX: TAX(); break;
+        case Operations::TAY: TAY(); break;
+        case Operations::TSX: TSX(); break;
+        case Operations::TXA: TXA(); break;
+        case Operations::TXS: TXS(); break;
+        case Operations::TYA: TYA(); break;
+        case Operations::XXX: XXX(); break;
+    }
 }
 
 bool
 CPU::ImplicitMode()
 {
-    FetchedDataData = Accumulator; // Reset the Byte;
+    FetchedData = Accumulator; // Reset the Byte;
     return false;
 }
 
 bool
 CPU::ImmediateMode()
 {
-    AbsoluteAddress = ProgramCounter++;
+    // The byte was read when the instruction was decoded; reading it again would
+    // cost a Bus access and touch a device twice when code runs from one
+    FetchedData = Operand & 0x00FF;
+    ++ProgramCounter;
     return false;
 }
 
 bool
 CPU::AccumulatorMode()
 {
-    FetchedDataData = Accumulator;
+    FetchedData = Accumulator;
     return false;
 }
 
+// The operand bytes were read while decoding; the modes below only step the
+// Program Counter past them.
 bool
 CPU::ZeroPageMode()
 {
-    AbsoluteAddress = FetchByteFromMemory(ProgramCounter);
+    AbsoluteAddress = Operand & 0x00FF;
     ++ProgramCounter;
-    AbsoluteAddress &= 0x00FF;
     return false;
 }
 
 bool
 CPU::ZeroPageXMode()
 {
-    AbsoluteAddress = FetchByteFromMemory(ProgramCounter);
+    AbsoluteAddress = (Operand + X) & 0x00FF;
     ++ProgramCounter;
-    AbsoluteAddress += X;
-    AbsoluteAddress &= 0x00FF;
     return false;
 }
 
 bool
 CPU::ZeroPageYMode()
 {
-    AbsoluteAddress = FetchByteFromMemory(ProgramCounter);
+    AbsoluteAddress = (Operand + Y) & 0x00FF;
     ++ProgramCounter;
-    AbsoluteAddress += Y;
-    AbsoluteAddress &= 0x00FF;
     return false;
 }
 
 bool
 CPU::AbsoluteMode()
 {
-    Byte lowByte = FetchByteFromMemory(ProgramCounter);
-    ++ProgramCounter;
-    Byte highByte = FetchByteFromMemory(ProgramCounter);
-    ++ProgramCounter;
-    AbsoluteAddress = (highByte << 8) | lowByte;
+    AbsoluteAddress = Operand;
+    ProgramCounter += 2;
     return false;
 }
 
 bool
 CPU::AbsoluteXMode()
 {
-    Byte lowByte = FetchByteFromMemory(ProgramCounter);
-    ++ProgramCounter;
-    Byte highByte = FetchByteFromMemory(ProgramCounter);
-    ++ProgramCounter;
-    AbsoluteAddress = (highByte << 8) | lowByte;
-    AbsoluteAddress += X;
-    
-    bool hasPageChanged = (AbsoluteAddress & 0xFF00) != (highByte << 8);
+    AbsoluteAddress = Operand + X;
+    ProgramCounter += 2;
+
+    bool hasPageChanged = (AbsoluteAddress & 0xFF00) != (Operand & 0xFF00);
     return hasPageChanged;
 }
 
 bool
 CPU::AbsoluteYMode()
 {
-    Byte lowByte = FetchByteFromMemory(ProgramCounter);
-    ++ProgramCounter;
-    Byte highByte = FetchByteFromMemory(ProgramCounter);
-    ++ProgramCounter;
-    AbsoluteAddress = (highByte << 8) | lowByte;
-    AbsoluteAddress += Y;
-    
-    bool hasPageChanged = (AbsoluteAddress & 0xFF00) != (highByte << 8);
+    AbsoluteAddress = Operand + Y;
+    ProgramCounter += 2;
+
+    bool hasPageChanged = (AbsoluteAddress & 0xFF00) != (Operand & 0xFF00);
     return hasPageChanged;
 }
 
 bool
 CPU::IndirectMode()
 {
-    Byte lowByte = FetchByteFromMemory(ProgramCounter);
-    ++ProgramCounter;
-    Byte highByte = FetchByteFromMemory(ProgramCounter);
-    ++ProgramCounter;
-    
-    Address indirectAddress = (highByte << 8) | lowByte;
-    
+    Address indirectAddress = Operand;
+    ProgramCounter += 2;
+
     Byte indirectAddressLowByte = FetchByteFromMemory(indirectAddress);
     Byte indirectAddressHighByte = FetchByteFromMemory(indirectAddress + 1);
     AbsoluteAddress = (indirectAddressHighByte << 8) | indirectAddressLowByte;
@@ -140,7 +576,7 @@ CPU::IndirectMode()
 bool
 CPU::IndirectXMode()
 {
-    Byte zeroPageBaseAddress = FetchByteFromMemory(ProgramCounter);
+    Byte zeroPageBaseAddress = Operand & 0x00FF;
     ++ProgramCounter;
 
     Address indirectAddressForLowByte = static_cast<Address>(zeroPageBaseAddress) + static_cast<Address>(X);
@@ -157,7 +593,7 @@ CPU::IndirectXMode()
 bool
 CPU::IndirectYMode()
 {
-    Byte zeroPageBaseAddress = FetchByteFromMemory(ProgramCounter);
+    Byte zeroPageBaseAddress = Operand & 0x00FF;
     ++ProgramCounter;
 
     Byte lowByte = FetchByteFromMemory(zeroPageBaseAddress & 0x00FF);
@@ -172,7 +608,7 @@ CPU::IndirectYMode()
 bool
 CPU::RelativeMode()
 {
-    RelativeAddress = FetchByteFromMemory(ProgramCounter);
+    RelativeAddress = Operand & 0x00FF;
     ++ProgramCounter;
     
     if (RelativeAddress & 0x80) {
@@ -182,151 +618,197 @@ CPU::RelativeMode()
     return false;
 }
 
+Byte
+CPU::FetchByteFromMemory(const Address address)
+{
+    return ConnectedBus->Read(address);
+}
+
+void
+CPU::WriteByteToMemory(const Address address, const Byte data)
+{
+    ConnectedBus->Write(address, data);
+}
+
 Byte
 CPU::FetchDataForOperation()
 {
-    if (OpcodeTable.at(CurrentOpcode).addressingMode != &CPU::ImplicitMode && OpcodeTable.at(CurrentOpcode).addressingMode != &CPU::AccumulatorMode) {
-        FetchedData = FetchDataForOperation(ProgramCounter);
+    if (!IsAccumulatorOperand() && OPCODE_TABLE[CurrentOpcode].addressingMode != AddressingModes::Immediate) {
+        FetchedData = FetchByteFromMemory(AbsoluteAddress);
     }
     return FetchedData;
 }
 
+inline bool
+CPU::IsAccumulatorOperand() const
+{
+    const AddressingModes::Mode mode = OPCODE_TABLE[CurrentOpcode].addressingMode;
+    return mode == AddressingModes::Implicit || mode == AddressingModes::Accumulator;
+}
+
+// N, Z, C and V live outside StatusRegister and are only folded into a status byte
+// when something reads the whole register (PHP, BRK, interrupts, snapshots).
 inline bool
 CPU::GetFlagFromStatusRegister(const StatusRegisterFlags::Flags flag)
 {
-    return (StatusRegister & flag) != 0;
+    switch (flag) {
+        case StatusRegisterFlags::C: return CarryFlag;
+        case StatusRegisterFlags::Z: return ZeroResult == 0;
+        case StatusRegisterFlags::V: return OverflowFlag;
+        case StatusRegisterFlags::N: return (NegativeResult & 0x80) != 0;
+        default: return (StatusRegister & flag) != 0;
+    }
 }
 
 inline void
 CPU::SetFlagInStatusRegister(const StatusRegisterFlags::Flags flag, const bool toSet)
 {
-    if (toSet) {
-        StatusRegister |= flag;
-    } else {
-        StatusRegister &= ~flag;
+    switch (flag) {
+        case StatusRegisterFlags::C: CarryFlag = toSet; break;
+        case StatusRegisterFlags::Z: ZeroResult = toSet ? 0x00 : 0x01; break;
+        case StatusRegisterFlags::V: OverflowFlag = toSet; break;
+        case StatusRegisterFlags::N: NegativeResult = toSet ? 0x80 : 0x00; break;
+        default:
+            if (toSet) {
+                StatusRegister |= flag;
+            } else {
+                StatusRegister &= ~flag;
+            }
+            break;
+    }
+}
+
+inline void
+CPU::SetZeroAndNegativeFlags(const Byte result)
+{
+    ZeroResult = result;
+    NegativeResult = result;
+}
+
+inline void
+CPU::TakeBranch()
+{
+    CyclesLeft++;
+    AbsoluteAddress = ProgramCounter + RelativeAddress;
+    if ((AbsoluteAddress & 0xFF00) != (ProgramCounter & 0xFF00)) {
+        CyclesLeft++;
     }
+    if (AbsoluteAddress < ProgramCounter) {
+        NoteBackwardJump();
+    }
+    ProgramCounter = AbsoluteAddress;
 }
 
-bool CPU::ADC() {
+inline void
+CPU::NoteBackwardJump()
+{
+    BackwardJumpTarget = AbsoluteAddress;
+    BackwardJumpEnd = ProgramCounter;
+    HasJumpedBack = true;
+}
+
+Byte
+CPU::GetStatusRegister() const
+{
+    constexpr Byte storedFlags = StatusRegisterFlags::I | StatusRegisterFlags::D | StatusRegisterFlags::B | StatusRegisterFlags::U;
+    return (StatusRegister & storedFlags)
+        | (CarryFlag ? StatusRegisterFlags::C : 0)
+        | (ZeroResult == 0 ? StatusRegisterFlags::Z : 0)
+        | (OverflowFlag ? StatusRegisterFlags::V : 0)
+        | (NegativeResult & StatusRegisterFlags::N);
+}
+
+void
+CPU::SetStatusRegister(const Byte status)
+{
+    StatusRegister = status;
+    CarryFlag = (status & StatusRegisterFlags::C) != 0;
+    ZeroResult = (status & StatusRegisterFlags::Z) ? 0x00 : 0x01;
+    OverflowFlag = (status & StatusRegisterFlags::V) != 0;
+    NegativeResult = status;
+}
+
+void CPU::ADC() {
     FetchDataForOperation();
     TemporaryStorage = (uint16_t)Accumulator + (uint16_t)FetchedData + (uint16_t)GetFlagFromStatusRegister(StatusRegisterFlags::C);
-    SetFlagInStatusRegister(StatusRegisterFlags::C, TemporaryStorage > 255);
-    SetFlagInStatusRegister(StatusRegisterFlags::Z, (TemporaryStorage & 0x00FF) == 0);
-    SetFlagInStatusRegister(StatusRegisterFlags::V, (~((uint16_t)Accumulator ^ (uint16_t)FetchedData) & ((uint16_t)Accumulator ^ (uint16_t)TemporaryStorage)) & 0x0080);
-    SetFlagInStatusRegister(StatusRegisterFlags::N, TemporaryStorage & 0x80);
+    CarryFlag = TemporaryStorage > 255;
+    OverflowFlag = (~((uint16_t)Accumulator ^ (uint16_t)FetchedData) & ((uint16_t)Accumulator ^ (uint16_t)TemporaryStorage)) & 0x0080;
+    SetZeroAndNegativeFlags(TemporaryStorage & 0x00FF);
     Accumulator = TemporaryStorage & 0x00FF;
-    return 1;
 }
 
-bool CPU::SBC() {
+void CPU::SBC() {
     FetchDataForOperation();
     uint16_t value = ((uint16_t)FetchedData) ^ 0x00FF;
     TemporaryStorage = (uint16_t)Accumulator + value + (uint16_t)GetFlagFromStatusRegister(StatusRegisterFlags::C);
-    SetFlagInStatusRegister(StatusRegisterFlags::C, TemporaryStorage & 0xFF00);
-    SetFlagInStatusRegister(StatusRegisterFlags::Z, ((TemporaryStorage & 0x00FF) == 0));
-    SetFlagInStatusRegister(StatusRegisterFlags::V, (TemporaryStorage ^ (uint16_t)Accumulator) & (TemporaryStorage ^ value) & 0x0080);
-    SetFlagInStatusRegister(StatusRegisterFlags::N, TemporaryStorage & 0x0080);
+    CarryFlag = (TemporaryStorage & 0xFF00) != 0;
+    OverflowFlag = (TemporaryStorage ^ (uint16_t)Accumulator) & (TemporaryStorage ^ value) & 0x0080;
+    SetZeroAndNegativeFlags(TemporaryStorage & 0x00FF);
     Accumulator = TemporaryStorage & 0x00FF;
-    return 1;
 }
 
-bool CPU::AND() {
+void CPU::AND() {
     FetchDataForOperation();
     Accumulator = Accumulator & FetchedData;
-    SetFlagInStatusRegister(StatusRegisterFlags::Z, Accumulator == 0x00);
-    SetFlagInStatusRegister(StatusRegisterFlags::N, Accumulator & 0x80);
-    return 1;
+    SetZeroAndNegativeFlags(Accumulator);
 }
 
-bool CPU::ASL() {
+void CPU::ASL() {
     FetchDataForOperation();
     TemporaryStorage = (uint16_t)FetchedData << 1;
-    SetFlagInStatusRegister(StatusRegisterFlags::C, (TemporaryStorage & 0xFF00) > 0);
-    SetFlagInStatusRegister(StatusRegisterFlags::Z, (TemporaryStorage & 0x00FF) == 0x00);
-    SetFlagInStatusRegister(StatusRegisterFlags::N, TemporaryStorage & 0x80);
-    if (OpcodeTable.at(CurrentOpcode).addressingMode == &CPU::ImplicitMode || OpcodeTable.at(CurrentOpcode).addressingMode == &CPU::AccumulatorMode)
+    CarryFlag = (TemporaryStorage & 0xFF00) > 0;
+    SetZeroAndNegativeFlags(TemporaryStorage & 0x00FF);
+    if (IsAccumulatorOperand())
         Accumulator = TemporaryStorage & 0x00FF;
     else
         WriteByteToMemory(AbsoluteAddress, TemporaryStorage & 0x00FF);
-    return 0;
 }
 
-bool CPU::BCC() {
+void CPU::BCC() {
     if (GetFlagFromStatusRegister(StatusRegisterFlags::C) == 0) {
-        CyclesLeft++;
-        AbsoluteAddress = ProgramCounter + RelativeAddress;
-        if((AbsoluteAddress & 0xFF00) != (ProgramCounter & 0xFF00))
-            CyclesLeft++;
-        ProgramCounter = AbsoluteAddress;
+        TakeBranch();
     }
-    return 0;
 }
 
-bool CPU::BCS() {
+void CPU::BCS() {
     if (GetFlagFromStatusRegister(StatusRegisterFlags::C) == 1) {
-        CyclesLeft++;
-        AbsoluteAddress = ProgramCounter + RelativeAddress;
-        if ((AbsoluteAddress & 0xFF00) != (ProgramCounter & 0xFF00))
-            CyclesLeft++;
-        ProgramCounter = AbsoluteAddress;
+        TakeBranch();
     }
-    return 0;
 }
 
-bool CPU::BEQ() {
+void CPU::BEQ() {
     if (GetFlagFromStatusRegister(StatusRegisterFlags::Z) == 1) {
-        CyclesLeft++;
-        AbsoluteAddress = ProgramCounter + RelativeAddress;
-        if ((AbsoluteAddress & 0xFF00) != (ProgramCounter & 0xFF00))
-            CyclesLeft++;
-        ProgramCounter = AbsoluteAddress;
+        TakeBranch();
     }
-    return 0;
 }
 
-bool CPU::BIT() {
+void CPU::BIT() {
     FetchDataForOperation();
     TemporaryStorage = Accumulator & FetchedData;
-    SetFlagInStatusRegister(StatusRegisterFlags::Z, (TemporaryStorage & 0x00FF) == 0x00);
-    SetFlagInStatusRegister(StatusRegisterFlags::N, FetchedData & (1 << 7));
-    SetFlagInStatusRegister(StatusRegisterFlags::V, FetchedData & (1 << 6));
-    return 0;
+    ZeroResult = TemporaryStorage & 0x00FF;
+    NegativeResult = FetchedData;
+    OverflowFlag = FetchedData & (1 << 6);
 }
 
-bool CPU::BMI() {
+void CPU::BMI() {
     if (GetFlagFromStatusRegister(StatusRegisterFlags::N) == 1) {
-        CyclesLeft++;
-        AbsoluteAddress = ProgramCounter + RelativeAddress;
-        if ((AbsoluteAddress & 0xFF00) != (ProgramCounter & 0xFF00))
-            CyclesLeft++;
-        ProgramCounter = AbsoluteAddress;
+        TakeBranch();
     }
-    return 0;
 }
 
-bool CPU::BNE() {
+void CPU::BNE() {
     if (GetFlagFromStatusRegister(StatusRegisterFlags::Z) == 0) {
-        CyclesLeft++;
-        AbsoluteAddress = ProgramCounter + RelativeAddress;
-        if ((AbsoluteAddress & 0xFF00) != (ProgramCounter & 0xFF00))
-            CyclesLeft++;
-        ProgramCounter = AbsoluteAddress;
+        TakeBranch();
     }
-    return 0;
 }
 
-bool CPU::BPL() {
+void CPU::BPL() {
     if (GetFlagFromStatusRegister(StatusRegisterFlags::N) == 0) {
-        CyclesLeft++;
-        AbsoluteAddress = ProgramCounter + RelativeAddress;
-        if ((AbsoluteAddress & 0xFF00) != (ProgramCounter & 0xFF00))
-            CyclesLeft++;
-        ProgramCounter = AbsoluteAddress;
+        TakeBranch();
     }
-    return 0;
 }
 
-bool CPU::BRK() {
+void CPU::BRK() {
     ProgramCounter++;
     SetFlagInStatusRegister(StatusRegisterFlags::I, 1);
     WriteByteToMemory(0x0100 + StackPointer, (ProgramCounter >> 8) & 0x00FF);
@@ -334,347 +816,275 @@ bool CPU::BRK() {
     WriteByteToMemory(0x0100 + StackPointer, ProgramCounter & 0x00FF);
     StackPointer--;
     SetFlagInStatusRegister(StatusRegisterFlags::B, 1);
-    WriteByteToMemory(0x0100 + StackPointer, status);
+    WriteByteToMemory(0x0100 + StackPointer, GetStatusRegister());
     StackPointer--;
     SetFlagInStatusRegister(StatusRegisterFlags::B, 0);
     ProgramCounter = (uint16_t)FetchByteFromMemory(0xFFFE) | ((uint16_t)FetchByteFromMemory(0xFFFF) << 8);
-    return 0;
 }
 
-bool CPU::BVC() {
+void CPU::BVC() {
     if (GetFlagFromStatusRegister(StatusRegisterFlags::V) == 0) {
-        CyclesLeft++;
-        AbsoluteAddress = ProgramCounter + RelativeAddress;
-        if ((AbsoluteAddress & 0xFF00) != (ProgramCounter & 0xFF00))
-            CyclesLeft++;
-        ProgramCounter = AbsoluteAddress;
+        TakeBranch();
     }
-    return 0;
 }
 
-bool CPU::BVS() {
+void CPU::BVS() {
     if (GetFlagFromStatusRegister(StatusRegisterFlags::V) == 1) {
-        CyclesLeft++;
-        AbsoluteAddress = ProgramCounter + RelativeAddress;
-        if ((AbsoluteAddress & 0xFF00) != (ProgramCounter & 0xFF00))
-            CyclesLeft++;
-        ProgramCounter = AbsoluteAddress;
+        TakeBranch();
     }
-    return 0;
 }
 
-bool CPU::CLC() {
+void CPU::CLC() {
     SetFlagInStatusRegister(StatusRegisterFlags::C, false);
-    return 0;
 }
 
-bool CPU::CLD() {
+void CPU::CLD() {
     SetFlagInStatusRegister(StatusRegisterFlags::D, false);
-    return 0;
 }
 
-bool CPU::CLI() {
+void CPU::CLI() {
     SetFlagInStatusRegister(StatusRegisterFlags::I, false);
-    return 0;
 }
 
-bool CPU::CLV() {
+void CPU::CLV() {
     SetFlagInStatusRegister(StatusRegisterFlags::V, false);
-    return 0;
 }
 
-bool CPU::CMP() {
+void CPU::CMP() {
     FetchDataForOperation();
-    TemporaryStorage = (uint16_t)a - (uint16_t)FetchedData;
-    SetFlagInStatusRegister(StatusRegisterFlags::C, Accumulator >= FetchedData);
-    SetFlagInStatusRegister(StatusRegisterFlags::Z, (TemporaryStorage & 0x00FF) == 0x0000);
-    SetFlagInStatusRegister(StatusRegisterFlags::N, TemporaryStorage & 0x0080);
-    return 1;
+    TemporaryStorage = (uint16_t)Accumulator - (uint16_t)FetchedData;
+    CarryFlag = Accumulator >= FetchedData;
+    SetZeroAndNegativeFlags(TemporaryStorage & 0x00FF);
 }
 
-bool CPU::CPX() {
+void CPU::CPX() {
     FetchDataForOperation();
-    TemporaryStorage = (uint16_t)x - (uint16_t)FetchedData;
-    SetFlagInStatusRegister(StatusRegisterFlags::C, X >= FetchedData);
-    SetFlagInStatusRegister(StatusRegisterFlags::Z, (TemporaryStorage & 0x00FF) == 0x0000);
-    SetFlagInStatusRegister(StatusRegisterFlags::N, TemporaryStorage & 0x0080);
-    return 0;
+    TemporaryStorage = (uint16_t)X - (uint16_t)FetchedData;
+    CarryFlag = X >= FetchedData;
+    SetZeroAndNegativeFlags(TemporaryStorage & 0x00FF);
 }
 
-bool CPU::CPY() {
+void CPU::CPY() {
     FetchDataForOperation();
-    TemporaryStorage = (uint16_t)y - (uint16_t)FetchedData;
-    SetFlagInStatusRegister(StatusRegisterFlags::C, Y >= FetchedData);
-    SetFlagInStatusRegister(StatusRegisterFlags::Z, (TemporaryStorage & 0x00FF) == 0x0000);
-    SetFlagInStatusRegister(StatusRegisterFlags::N, TemporaryStorage & 0x0080);
-    return 0;
+    TemporaryStorage = (uint16_t)Y - (uint16_t)FetchedData;
+    CarryFlag = Y >= FetchedData;
+    SetZeroAndNegativeFlags(TemporaryStorage & 0x00FF);
 }
 
-bool CPU::DEC() {
+void CPU::DEC() {
     FetchDataForOperation();
     TemporaryStorage = FetchedData - 1;
     WriteByteToMemory(AbsoluteAddress, TemporaryStorage & 0x00FF);
-    SetFlagInStatusRegister(StatusRegisterFlags::Z, (TemporaryStorage & 0x00FF) == 0x0000);
-    SetFlagInStatusRegister(StatusRegisterFlags::N, TemporaryStorage & 0x0080);
-    return 0;
+    SetZeroAndNegativeFlags(TemporaryStorage & 0x00FF);
 }
 
-bool CPU::DEX() {
-    x--;
-    SetFlagInStatusRegister(StatusRegisterFlags::Z, X == 0x00);
-    SetFlagInStatusRegister(StatusRegisterFlags::N, X & 0x80);
-    return 0;
+void CPU::DEX() {
+    X--;
+    SetZeroAndNegativeFlags(X);
 }
 
-bool CPU::DEY() {
-    y--;
-    SetFlagInStatusRegister(StatusRegisterFlags::Z, Y == 0x00);
-    SetFlagInStatusRegister(StatusRegisterFlags::N, Y & 0x80);
-    return 0;
+void CPU::DEY() {
+    Y--;
+    SetZeroAndNegativeFlags(Y);
 }
 
-bool CPU::EOR() {
+void CPU::EOR() {
     FetchDataForOperation();
     Accumulator = Accumulator ^ FetchedData;
-    SetFlagInStatusRegister(StatusRegisterFlags::Z, Accumulator == 0x00);
-    SetFlagInStatusRegister(StatusRegisterFlags::N, Accumulator & 0x80);
-    return 1;
+    SetZeroAndNegativeFlags(Accumulator);
 }
 
-bool CPU::INC() {
+void CPU::INC() {
     FetchDataForOperation();
     TemporaryStorage = FetchedData + 1;
     WriteByteToMemory(AbsoluteAddress, TemporaryStorage & 0x00FF);
-    SetFlagInStatusRegister(StatusRegisterFlags::Z, (TemporaryStorage & 0x00FF) == 0x0000);
-    SetFlagInStatusRegister(StatusRegisterFlags::N, TemporaryStorage & 0x0080);
-    return 0;
+    SetZeroAndNegativeFlags(TemporaryStorage & 0x00FF);
 }
 
-bool CPU::INX() {
-    x++;
-    SetFlagInStatusRegister(StatusRegisterFlags::Z, X == 0x00);
-    SetFlagInStatusRegister(StatusRegisterFlags::N, X & 0x80);
-    return 0;
+void CPU::INX() {
+    X++;
+    SetZeroAndNegativeFlags(X);
 }
 
-bool CPU::INY() {
-    y++;
-    SetFlagInStatusRegister(StatusRegisterFlags::Z, Y == 0x00);
-    SetFlagInStatusRegister(StatusRegisterFlags::N, Y & 0x80);
-    return 0;
+void CPU::INY() {
+    Y++;
+    SetZeroAndNegativeFlags(Y);
 }
 
-bool CPU::JMP() {
+void CPU::JMP() {
+    if (OPCODE_TABLE[CurrentOpcode].addressingMode == AddressingModes::Absolute && AbsoluteAddress < ProgramCounter) {
+        NoteBackwardJump();
+    }
     ProgramCounter = AbsoluteAddress;
-    return 0;
 }
 
-bool CPU::JSR() {
+void CPU::JSR() {
     ProgramCounter--;
     WriteByteToMemory(0x0100 + StackPointer, (ProgramCounter >> 8) & 0x00FF);
     StackPointer--;
     WriteByteToMemory(0x0100 + StackPointer, ProgramCounter & 0x00FF);
     StackPointer--;
     ProgramCounter = AbsoluteAddress;
-    return 0;
 }
 
-bool CPU::LDA() {
+void CPU::LDA() {
     FetchDataForOperation();
     Accumulator = FetchedData;
-    SetFlagInStatusRegister(StatusRegisterFlags::Z, Accumulator == 0x00);
-    SetFlagInStatusRegister(StatusRegisterFlags::N, Accumulator & 0x80);
-    return 1;
+    SetZeroAndNegativeFlags(Accumulator);
 }
 
-bool CPU::LDX() {
+void CPU::LDX() {
     FetchDataForOperation();
     X = FetchedData;
-    SetFlagInStatusRegister(StatusRegisterFlags::Z, X == 0x00);
-    SetFlagInStatusRegister(StatusRegisterFlags::N, X & 0x80);
-    return 1;
+    SetZeroAndNegativeFlags(X);
 }
 
-bool CPU::LDY() {
+void CPU::LDY() {
     FetchDataForOperation();
     Y = FetchedData;
-    SetFlagInStatusRegister(StatusRegisterFlags::Z, Y == 0x00);
-    SetFlagInStatusRegister(StatusRegisterFlags::N, Y & 0x80);
-    return 1;
+    SetZeroAndNegativeFlags(Y);
 }
 
-bool CPU::LSR() {
+void CPU::LSR() {
     FetchDataForOperation();
-    SetFlagInStatusRegister(StatusRegisterFlags::C, FetchedData & 0x0001);
+    CarryFlag = FetchedData & 0x01;
     TemporaryStorage = FetchedData >> 1;
-    SetFlagInStatusRegister(StatusRegisterFlags::Z, (TemporaryStorage & 0x00FF) == 0x0000);
-    SetFlagInStatusRegister(StatusRegisterFlags::N, TemporaryStorage & 0x0080);
-    if (OpcodeTable.at(CurrentOpcode).addressingMode == &CPU::ImplicitMode || OpcodeTable.at(CurrentOpcode).addressingMode == &CPU::AccumulatorMode)
+    SetZeroAndNegativeFlags(TemporaryStorage & 0x00FF);
+    if (IsAccumulatorOperand())
         Accumulator = TemporaryStorage & 0x00FF;
     else
         WriteByteToMemory(AbsoluteAddress, TemporaryStorage & 0x00FF);
-    return 0;
 }
 
-bool CPU::NOP() {
-    return 0;
+void CPU::NOP() {
+    // Intentionally does nothing
 }
 
-bool CPU::ORA() {
+void CPU::ORA() {
     FetchDataForOperation();
     Accumulator = Accumulator | FetchedData;
-    SetFlagInStatusRegister(StatusRegisterFlags::Z, Accumulator == 0x00);
-    SetFlagInStatusRegister(StatusRegisterFlags::N, Accumulator & 0x80);
-    return 1;
+    SetZeroAndNegativeFlags(Accumulator);
 }
 
-bool CPU::PHA() {
+void CPU::PHA() {
     WriteByteToMemory(0x0100 + StackPointer, Accumulator);
     StackPointer--;
-    return 0;
 }
 
-bool CPU::PHP() {
-    WriteByteToMemory(0x0100 + StackPointer, StatusRegister | B | U);
+void CPU::PHP() {
+    WriteByteToMemory(0x0100 + StackPointer, GetStatusRegister() | StatusRegisterFlags::B | StatusRegisterFlags::U);
     SetFlagInStatusRegister(StatusRegisterFlags::B, 0);
     SetFlagInStatusRegister(StatusRegisterFlags::U, 0);
     StackPointer--;
-    return 0;
 }
 
-bool CPU::PLA() {
+void CPU::PLA() {
     StackPointer++;
     Accumulator = FetchByteFromMemory(0x0100 + StackPointer);
-    SetFlagInStatusRegister(StatusRegisterFlags::Z, Accumulator == 0x00);
-    SetFlagInStatusRegister(StatusRegisterFlags::N, Accumulator & 0x80);
-    return 0;
+    SetZeroAndNegativeFlags(Accumulator);
 }
 
-bool CPU::PLP() {
+void CPU::PLP() {
     StackPointer++;
-    StatusRegister = FetchByteFromMemory(0x0100 + StackPointer);
+    SetStatusRegister(FetchByteFromMemory(0x0100 + StackPointer));
     SetFlagInStatusRegister(StatusRegisterFlags::U, 1);
-    return 0;
 }
 
-bool CPU::ROL() {
+void CPU::ROL() {
     FetchDataForOperation();
     TemporaryStorage = (uint16_t)(FetchedData << 1) | GetFlagFromStatusRegister(StatusRegisterFlags::C);
-    SetFlagInStatusRegister(StatusRegisterFlags::C, TemporaryStorage & 0xFF00);
-    SetFlagInStatusRegister(StatusRegisterFlags::Z, (TemporaryStorage & 0x00FF) == 0x0000);
-    SetFlagInStatusRegister(StatusRegisterFlags::N, TemporaryStorage & 0x0080);
-    if (OpcodeTable.at(CurrentOpcode).addressingMode == &CPU::ImplicitMode || OpcodeTable.at(CurrentOpcode).addressingMode == &CPU::AccumulatorMode)
+    CarryFlag = (TemporaryStorage & 0xFF00) != 0;
+    SetZeroAndNegativeFlags(TemporaryStorage & 0x00FF);
+    if (IsAccumulatorOperand())
         Accumulator = TemporaryStorage & 0x00FF;
     else
         WriteByteToMemory(AbsoluteAddress, TemporaryStorage & 0x00FF);
-    return 0;
 }
 
-bool CPU::ROR() {
+void CPU::ROR() {
     FetchDataForOperation();
     TemporaryStorage = (uint16_t)(GetFlagFromStatusRegister(StatusRegisterFlags::C) << 7) | (FetchedData >> 1);
-    SetFlagInStatusRegister(StatusRegisterFlags::C, FetchedData & 0x01);
-    SetFlagInStatusRegister(StatusRegisterFlags::Z, (TemporaryStorage & 0x00FF) == 0x00);
-    SetFlagInStatusRegister(StatusRegisterFlags::N, TemporaryStorage & 0x0080);
-    if (OpcodeTable.at(CurrentOpcode).addressingMode == &CPU::ImplicitMode || OpcodeTable.at(CurrentOpcode).addressingMode == &CPU::AccumulatorMode)
+    CarryFlag = FetchedData & 0x01;
+    SetZeroAndNegativeFlags(TemporaryStorage & 0x00FF);
+    if (IsAccumulatorOperand())
         Accumulator = TemporaryStorage & 0x00FF;
     else
         WriteByteToMemory(AbsoluteAddress, TemporaryStorage & 0x00FF);
-    return 0;
 }
 
-bool CPU::RTI() {
+void CPU::RTI() {
     StackPointer++;
-    StatusRegister = FetchByteFromMemory(0x0100 + StackPointer);
-    StatusRegister &= ~B;
-    StatusRegister &= ~U;
+    SetStatusRegister(FetchByteFromMemory(0x0100 + StackPointer));
+    StatusRegister &= ~StatusRegisterFlags::B;
+    StatusRegister &= ~StatusRegisterFlags::U;
 
     StackPointer++;
     ProgramCounter = (uint16_t)FetchByteFromMemory(0x0100 + StackPointer);
     StackPointer++;
     ProgramCounter |= (uint16_t)FetchByteFromMemory(0x0100 + StackPointer) << 8;
-    return 0;
 }
 
-bool CPU::RTS() {
+void CPU::RTS() {
     StackPointer++;
     ProgramCounter = (uint16_t)FetchByteFromMemory(0x0100 + StackPointer);
     StackPointer++;
     ProgramCounter |= (uint16_t)FetchByteFromMemory(0x0100 + StackPointer) << 8;
     ProgramCounter++;
-    return 0;
 }
 
-bool CPU::SEC() {
+void CPU::SEC() {
     SetFlagInStatusRegister(StatusRegisterFlags::C, true);
-    return 0;
 }
 
-bool CPU::SED() {
+void CPU::SED() {
     SetFlagInStatusRegister(StatusRegisterFlags::D, true);
-    return 0;
 }
 
-bool CPU::SEI() {
+void CPU::SEI() {
     SetFlagInStatusRegister(StatusRegisterFlags::I, true);
-    return 0;
 }
 
-bool CPU::STA() {
+void CPU::STA() {
     WriteByteToMemory(AbsoluteAddress, Accumulator);
-    return 0;
 }
 
-bool CPU::STX() {
+void CPU::STX() {
     WriteByteToMemory(AbsoluteAddress, X);
-    return 0;
 }
 
-bool CPU::STY() {
+void CPU::STY() {
     WriteByteToMemory(AbsoluteAddress, Y);
-    return 0;
 }
 
-bool CPU::TAX() {
+void CPU::TAX() {
     X = Accumulator;
-    SetFlagInStatusRegister(StatusRegisterFlags::Z, X == 0x00);
-    SetFlagInStatusRegister(StatusRegisterFlags::N, X & 0x80);
-    return 0;
+    SetZeroAndNegativeFlags(X);
 }
 
-bool CPU::TAY() {
+void CPU::TAY() {
     Y = Accumulator;
-    SetFlagInStatusRegister(StatusRegisterFlags::Z, Y == 0x00);
-    SetFlagInStatusRegister(StatusRegisterFlags::N, Y & 0x80);
-    return 0;
+    SetZeroAndNegativeFlags(Y);
 }
 
-bool CPU::TSX() {
+void CPU::TSX() {
     X = StackPointer;
-    SetFlagInStatusRegister(StatusRegisterFlags::Z, X == 0x00);
-    SetFlagInStatusRegister(StatusRegisterFlags::N, X & 0x80);
-    return 0;
+    SetZeroAndNegativeFlags(X);
 }
 
-bool CPU::TXA() {
+void CPU::TXA() {
     Accumulator = X;
-    SetFlagInStatusRegister(StatusRegisterFlags::Z, Accumulator == 0x00);
-    SetFlagInStatusRegister(StatusRegisterFlags::N, Accumulator & 0x80);
-    return 0;
+    SetZeroAndNegativeFlags(Accumulator);
 }
 
-bool CPU::TXS() {
+void CPU::TXS() {
     StackPointer = X;
-    return 0;
 }
 
-bool CPU::TYA() {
+void CPU::TYA() {
     Accumulator = Y;
-    SetFlagInStatusRegister(StatusRegisterFlags::Z, Accumulator == 0x00);
-    SetFlagInStatusRegister(StatusRegisterFlags::N, Accumulator & 0x80);
-    return 0;
+    SetZeroAndNegativeFlags(Accumulator);
 }
 
-bool CPU::XXX() {
-    return 0;
+void CPU::XXX() {
+    // Illegal opcodes only pay for their addressing mode and cycles
 }
\ No newline at end of file
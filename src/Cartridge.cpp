@@ -0,0 +1,159 @@
+#include "../include/Cartridge.hpp"
+
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    // NES 2.0 ROM sizes: a 12-bit unit count, or when the top nibble is all ones,
+    // 2^exponent * (multiplier * 2 + 1) bytes packed into the low byte.
+    size_t DecodeNes20RomSize(const Byte lowByte, const Byte highNibble, const size_t unitSize)
+    {
+        if (highNibble == 0x0F) {
+            const size_t exponent = lowByte >> 2;
+            const size_t multiplier = (lowByte & 0x03) * 2 + 1;
+            return exponent < 48 ? (static_cast<size_t>(1) << exponent) * multiplier : 0;
+        }
+        return ((static_cast<size_t>(highNibble) << 8) | lowByte) * unitSize;
+    }
+
+    // NES 2.0 RAM sizes are shift counts: 64 << shift bytes, zero meaning none.
+    size_t DecodeNes20RamSize(const Byte shift)
+    {
+        return shift == 0 ? 0 : static_cast<size_t>(64) << shift;
+    }
+}
+
+Cartridge::~Cartridge()
+{
+    Unload();
+}
+
+bool
+Cartridge::Load(const char* path)
+{
+    Unload();
+
+    const int file = open(path, O_RDONLY | O_CLOEXEC);
+    if (file < 0) {
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(file, &status) != 0 || status.st_size < static_cast<off_t>(INES_HEADER_SIZE)) {
+        close(file);
+        return false;
+    }
+
+    // MAP_SHARED on a read-only descriptor: every process mapping this ROM is served
+    // from the same page-cache pages, and nothing is read until it is touched.
+    const size_t size = static_cast<size_t>(status.st_size);
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, file, 0);
+    close(file);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+
+    Mapping = mapping;
+    MappingSize = size;
+    if (!ParseImage(static_cast<const Byte*>(mapping), size)) {
+        Unload();
+        return false;
+    }
+    return true;
+}
+
+bool
+Cartridge::LoadFromData(const Byte* data, const size_t size)
+{
+    Unload();
+    if (!ParseImage(data, size)) {
+        Unload();
+        return false;
+    }
+    return true;
+}
+
+void
+Cartridge::Unload()
+{
+    if (Mapping != nullptr) {
+        munmap(Mapping, MappingSize);
+    }
+    Mapping = nullptr;
+    MappingSize = 0;
+    PrgRom = nullptr;
+    PrgRomSize = 0;
+    ChrRom = nullptr;
+    ChrRomSize = 0;
+    Trainer = nullptr;
+    PrgRamSize = 0;
+    ChrRamSize = 0;
+    MapperNumber = 0;
+    SubmapperNumber = 0;
+    Mirroring = NametableMirroring::Horizontal;
+    FourScreen = false;
+    Battery = false;
+    Nes20 = false;
+}
+
+bool
+Cartridge::ParseImage(const Byte* data, const size_t size)
+{
+    if (data == nullptr || size < INES_HEADER_SIZE) {
+        return false;
+    }
+
+    uint32_t magic;
+    std::memcpy(&magic, data, sizeof(magic));
+    if (magic != INES_MAGIC) {
+        return false;
+    }
+
+    const Byte* header = data;
+    Mirroring = (header[6] & 0x01) ? NametableMirroring::Vertical : NametableMirroring::Horizontal;
+    Battery = header[6] & 0x02;
+    FourScreen = header[6] & 0x08;
+    Nes20 = (header[7] & 0x0C) == 0x08;
+
+    if (Nes20) {
+        MapperNumber = static_cast<uint16_t>((header[6] >> 4) | (header[7] & 0xF0) | ((header[8] & 0x0F) << 8));
+        SubmapperNumber = header[8] >> 4;
+        PrgRomSize = DecodeNes20RomSize(header[4], header[9] & 0x0F, PRG_ROM_UNIT_SIZE);
+        ChrRomSize = DecodeNes20RomSize(header[5], header[9] >> 4, CHR_ROM_UNIT_SIZE);
+        PrgRamSize = DecodeNes20RamSize(header[10] & 0x0F) + DecodeNes20RamSize(header[10] >> 4);
+        ChrRamSize = DecodeNes20RamSize(header[11] & 0x0F) + DecodeNes20RamSize(header[11] >> 4);
+    } else {
+        // Old dumps often carry junk such as "DiskDude!" in bytes 7-15; the upper
+        // mapper nibble is only trusted when the padding is clean.
+        const bool hasCleanPadding = header[12] == 0 && header[13] == 0 && header[14] == 0 && header[15] == 0;
+        MapperNumber = static_cast<uint16_t>((header[6] >> 4) | (hasCleanPadding ? (header[7] & 0xF0) : 0));
+        SubmapperNumber = 0;
+        PrgRomSize = header[4] * PRG_ROM_UNIT_SIZE;
+        ChrRomSize = header[5] * CHR_ROM_UNIT_SIZE;
+        PrgRamSize = (header[8] != 0 ? header[8] : 1) * PRG_RAM_UNIT_SIZE;
+        ChrRamSize = ChrRomSize == 0 ? CHR_ROM_UNIT_SIZE : 0;
+    }
+
+    size_t offset = INES_HEADER_SIZE;
+    if (header[6] & 0x04) {
+        Trainer = data + offset;
+        offset += INES_TRAINER_SIZE;
+    }
+
+    if (PrgRomSize == 0 || offset + PrgRomSize + ChrRomSize > size) {
+        return false;
+    }
+
+    // ROM is banked in whole Bus pages and pattern slots and cannot be padded like
+    // RAM, so the odd exponent-multiplier sizes NES 2.0 allows are refused.
+    if (PrgRomSize % BUS_PAGE_SIZE != 0 || ChrRomSize % PPU_PATTERN_BANK_SIZE != 0) {
+        return false;
+    }
+    PrgRom = data + offset;
+    ChrRom = ChrRomSize != 0 ? data + offset + PrgRomSize : nullptr;
+    return true;
+}
@@ -0,0 +1,27 @@
+#include "../include/Controller.hpp"
+
+// Only bit 0 is driven; the rest of the byte is open bus, which is the $40 of the
+// high address byte on every real read of these ports.
+constexpr Byte CONTROLLER_OPEN_BUS = 0x40;
+
+void
+Controller::Strobe(const Byte data)
+{
+    // The latch follows the buttons for as long as the strobe stays high, so the
+    // register holds whatever they were when it falls
+    if (IsStrobing || (data & 0x01)) {
+        ShiftRegister = Buttons;
+    }
+    IsStrobing = data & 0x01;
+}
+
+Byte
+Controller::Read()
+{
+    if (IsStrobing) {
+        return CONTROLLER_OPEN_BUS | (Buttons & 0x01);
+    }
+    const Byte bit = ShiftRegister & 0x01;
+    ShiftRegister = static_cast<Byte>(0x80 | (ShiftRegister >> 1));
+    return CONTROLLER_OPEN_BUS | bit;
+}
@@ -0,0 +1,116 @@
+#include "../include/DecodeCache.hpp"
+
+#include "../include/Bus.hpp"
+#include "../include/CPU.hpp"
+
+namespace {
+    bool EndsBlock(const Operations::Operation operation)
+    {
+        switch (operation) {
+            case Operations::BCC: case Operations::BCS: case Operations::BEQ: case Operations::BMI:
+            case Operations::BNE: case Operations::BPL: case Operations::BVC: case Operations::BVS:
+            case Operations::BRK: case Operations::JMP: case Operations::JSR: case Operations::RTI:
+            case Operations::RTS:
+                return true;
+            default:
+                return false;
+        }
+    }
+}
+
+DecodeCache::DecodeCache(Bus& bus, const size_t numberOfBlocks)
+    : ConnectedBus(bus)
+{
+    size_t size = 1;
+    while (size < numberOfBlocks) {
+        size <<= 1;
+    }
+    Blocks.resize(size);
+    IndexMask = size - 1;
+    Invalidate();
+}
+
+const DecodedBlock*
+DecodeCache::Lookup(CPU& cpu, const Address address)
+{
+    DecodedBlock& block = Blocks[address & IndexMask];
+    if (block.isValid && block.start == address && IsCurrent(block)) {
+        return &block;
+    }
+
+    if (!Build(cpu, address, block)) {
+        block.isValid = false;
+        return nullptr;
+    }
+    return &block;
+}
+
+bool
+DecodeCache::IsCurrent(const DecodedBlock& block) const
+{
+    return ConnectedBus.GetPageGeneration(block.firstPage) == block.firstPageGeneration
+        && ConnectedBus.GetPageGeneration(block.lastPage) == block.lastPageGeneration;
+}
+
+void
+DecodeCache::Invalidate()
+{
+    for (DecodedBlock& block : Blocks) {
+        block.isValid = false;
+    }
+}
+
+bool
+DecodeCache::Build(CPU& cpu, const Address address, DecodedBlock& block)
+{
+    const uint8_t firstPage = address >> 8;
+    const uint8_t nextPage = firstPage + 1;
+    if (!ConnectedBus.IsMemoryPage(firstPage)) {
+        return false;
+    }
+
+    block.start = address;
+    block.count = 0;
+    block.firstPage = firstPage;
+    block.lastPage = firstPage;
+
+    Address position = address;
+    while (block.count < MAXIMUM_DECODED_BLOCK_LENGTH) {
+        // Never read operands out of a device page; decoding must stay side-effect free.
+        const uint8_t lastByteEnd = static_cast<uint8_t>((position + 2) >> 8);
+        if ((lastByteEnd != firstPage && lastByteEnd != nextPage) || !ConnectedBus.IsMemoryPage(lastByteEnd)) {
+            break;
+        }
+
+        DecodedInstruction& decoded = block.instructions[block.count];
+        cpu.Decode(position, decoded);
+        ++block.count;
+
+        const uint8_t lastByte = static_cast<uint8_t>((position + decoded.length - 1) >> 8);
+        if (lastByte != firstPage) {
+            block.lastPage = nextPage;
+        }
+
+        position += decoded.length;
+        if (EndsBlock(decoded.instruction->operation) || (position >> 8) != firstPage) {
+            break;
+        }
+    }
+
+    if (block.count == 0) {
+        return false;
+    }
+
+    // RAM-resident code must see writes, so its pages leave the fast write path.
+    if (ConnectedBus.IsWritablePage(block.firstPage)) {
+        ConnectedBus.WatchPage(block.firstPage);
+    }
+    if (ConnectedBus.IsWritablePage(block.lastPage)) {
+        ConnectedBus.WatchPage(block.lastPage);
+    }
+
+    block.firstPageGeneration = ConnectedBus.GetPageGeneration(block.firstPage);
+    block.lastPageGeneration = ConnectedBus.GetPageGeneration(block.lastPage);
+    block.isValid = true;
+    return true;
+}
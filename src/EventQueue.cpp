@@ -0,0 +1,85 @@
+#include "../include/EventQueue.hpp"
+
+#include <utility>
+
+bool
+EventQueue::Push(const ScheduledEvent& event)
+{
+    if (Count == Events.size()) {
+        return false;
+    }
+    Events[Count] = event;
+    SiftUp(Count++);
+    return true;
+}
+
+bool
+EventQueue::Pop(ScheduledEvent& event)
+{
+    if (Count == 0) {
+        return false;
+    }
+    event = Events[0];
+    RemoveAt(0);
+    return true;
+}
+
+bool
+EventQueue::Reschedule(const EventTypes::Type type, const uint8_t source, const uint64_t cycle)
+{
+    for (uint8_t index = 0; index < Count; ++index) {
+        if (Events[index].type == type && Events[index].source == source) {
+            RemoveAt(index);
+            break;
+        }
+    }
+    if (cycle == NO_PENDING_EVENT) {
+        return true;
+    }
+    return Push({ cycle, type, source, 0x00 });
+}
+
+void
+EventQueue::RemoveAt(const uint8_t index)
+{
+    Events[index] = Events[--Count];
+    if (index == Count) {
+        return;
+    }
+    SiftDown(index);
+    SiftUp(index);
+}
+
+void
+EventQueue::SiftUp(uint8_t index)
+{
+    while (index > 0) {
+        const uint8_t parent = (index - 1) / 2;
+        if (Events[parent].cycle <= Events[index].cycle) {
+            break;
+        }
+        std::swap(Events[parent], Events[index]);
+        index = parent;
+    }
+}
+
+void
+EventQueue::SiftDown(uint8_t index)
+{
+    while (true) {
+        const uint8_t left = index * 2 + 1;
+        const uint8_t right = left + 1;
+        uint8_t smallest = index;
+        if (left < Count && Events[left].cycle < Events[smallest].cycle) {
+            smallest = left;
+        }
+        if (right < Count && Events[right].cycle < Events[smallest].cycle) {
+            smallest = right;
+        }
+        if (smallest == index) {
+            break;
+        }
+        std::swap(Events[smallest], Events[index]);
+        index = smallest;
+    }
+}
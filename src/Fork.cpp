@@ -0,0 +1,97 @@
+#include "../include/Fork.hpp"
+
+#include <cstring>
+
+#include "../include/Bus.hpp"
+#include "../include/CPU.hpp"
+
+ForkTracker::ForkTracker(CPU& cpu, Bus& bus)
+    : ConnectedCPU(cpu), ConnectedBus(bus)
+{
+}
+
+StateFork
+ForkTracker::Fork()
+{
+    UpdateLayout();
+
+    const std::vector<uint8_t>& layout = *Layout;
+    for (size_t entry = 0; entry < layout.size(); ++entry) {
+        const size_t page = layout[entry];
+        if (Pages[entry] != nullptr && !ConnectedBus.IsDirtyPage(page)) {
+            continue;
+        }
+        std::shared_ptr<ForkPage> copy = std::make_shared<ForkPage>();
+        std::memcpy(copy->data(), ConnectedBus.GetWritablePageMemory(page), BUS_PAGE_SIZE);
+        Pages[entry] = std::move(copy);
+        ConnectedBus.CleanPage(page);
+        ++PagesCopied;
+    }
+
+    StateFork fork;
+    ConnectedCPU.CaptureState(fork.Cpu);
+    fork.Layout = Layout;
+    fork.Pages = Pages;
+    return fork;
+}
+
+bool
+ForkTracker::Restore(const StateFork& fork)
+{
+    if (fork.IsEmpty()) {
+        return false;
+    }
+    UpdateLayout();
+    if (fork.Layout != Layout && *fork.Layout != *Layout) {
+        return false;
+    }
+
+    const std::vector<uint8_t>& layout = *Layout;
+    for (size_t entry = 0; entry < layout.size(); ++entry) {
+        const size_t page = layout[entry];
+        if (Pages[entry] == fork.Pages[entry] && !ConnectedBus.IsDirtyPage(page)) {
+            continue;
+        }
+        std::memcpy(ConnectedBus.GetWritablePageMemory(page), fork.Pages[entry]->data(), BUS_PAGE_SIZE);
+        ConnectedBus.MarkDirty(static_cast<Address>(page << 8), static_cast<Address>(page << 8 | 0x00FF));
+        ConnectedBus.CleanPage(page);
+        Pages[entry] = fork.Pages[entry];
+        ++PagesRestored;
+    }
+
+    ConnectedCPU.RestoreState(fork.Cpu);
+    return true;
+}
+
+void
+ForkTracker::UpdateLayout()
+{
+    bool isCurrent = Layout != nullptr;
+    for (size_t page = 0; page < NUMBER_OF_BUS_PAGES && isCurrent; ++page) {
+        isCurrent = MappedMemory[page] == ConnectedBus.GetWritablePageMemory(page);
+    }
+    if (isCurrent) {
+        return;
+    }
+
+    // Mirrors share storage with the first page that maps it, so only that one is kept
+    std::vector<uint8_t> layout;
+    for (size_t page = 0; page < NUMBER_OF_BUS_PAGES; ++page) {
+        Byte* memory = ConnectedBus.GetWritablePageMemory(page);
+        MappedMemory[page] = memory;
+        if (memory == nullptr) {
+            continue;
+        }
+        bool isMirror = false;
+        for (const uint8_t earlier : layout) {
+            isMirror = isMirror || MappedMemory[earlier] == memory;
+        }
+        if (!isMirror) {
+            layout.push_back(static_cast<uint8_t>(page));
+        }
+    }
+
+    // Nothing is known about the new pages, so the next Fork() copies all of them
+    Layout = std::make_shared<const std::vector<uint8_t>>(std::move(layout));
+    Pages.assign(Layout->size(), nullptr);
+}
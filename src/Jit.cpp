@@ -0,0 +1,1165 @@
+#include "../include/Jit.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <type_traits>
+
+#if defined(__x86_64__)
+#include <sys/mman.h>
+#endif
+
+#include "../include/Bus.hpp"
+#include "../include/CPU.hpp"
+
+static_assert(std::is_standard_layout<JitRegisters>::value, "Compiled code addresses JitRegisters by offset");
+
+namespace {
+    enum HostRegister : uint8_t {
+        RAX = 0, RCX = 1, RDX = 2, RBX = 3, RSP = 4, RBP = 5, RSI = 6, RDI = 7,
+        R8 = 8, R9 = 9, R10 = 10, R11 = 11, R12 = 12, R13 = 13, R14 = 14, R15 = 15
+    };
+
+    // The whole guest register file lives in host registers for the length of a
+    // block. Registers hold their byte zero-extended, except the N and Z results,
+    // of which only the low byte means anything. RAX carries the operand, RCX the
+    // effective address, RDX the page pointer and RDI the offset into it; RSI is
+    // scratch. Compiled code makes no calls, so caller-saved registers are as good
+    // as any.
+    constexpr HostRegister ACCUMULATOR = RBX;
+    constexpr HostRegister INDEX_X = R12;
+    constexpr HostRegister INDEX_Y = R13;
+    constexpr HostRegister STACK_POINTER = R14;
+    constexpr HostRegister ZERO_RESULT = R9;
+    constexpr HostRegister NEGATIVE_RESULT = R10;
+    constexpr HostRegister CARRY_FLAG = R11;
+    constexpr HostRegister OVERFLOW_FLAG = RBP;
+    constexpr HostRegister TOTAL_CYCLES = R8;
+    constexpr HostRegister CONTEXT = R15;
+
+    enum Condition : uint8_t { OVERFLOW = 0x0, BELOW = 0x2, ABOVE_OR_EQUAL = 0x3, EQUAL = 0x4, NOT_EQUAL = 0x5 };
+
+    // The /digit of the 0x80/0x81 groups; the register forms are digit * 8 (+ 1)
+    enum AluOperation : uint8_t { ADD = 0, OR = 1, ADC = 2, SBB = 3, AND = 4, SUB = 5, XOR = 6, CMP = 7 };
+    enum ShiftOperation : uint8_t { RCL = 2, RCR = 3, SHL = 4, SHR = 5 };
+
+    struct MemoryOperand {
+        HostRegister base;
+        HostRegister index;
+        bool hasIndex;
+        uint8_t scale; // As a shift count
+        int32_t displacement;
+    };
+
+    MemoryOperand Based(const HostRegister base, const int32_t displacement)
+    {
+        return { base, RSP, false, 0, displacement };
+    }
+
+    MemoryOperand Indexed(const HostRegister base, const HostRegister index, const uint8_t scale = 0)
+    {
+        return { base, index, true, scale, 0 };
+    }
+
+    MemoryOperand Field(const size_t offset)
+    {
+        return Based(CONTEXT, static_cast<int32_t>(offset));
+    }
+
+    const MemoryOperand TOTAL_CYCLES_FIELD = Field(offsetof(JitRegisters, totalCycles));
+    const MemoryOperand TIMESLICE_END = Field(offsetof(JitRegisters, timesliceEnd));
+    const MemoryOperand PROGRAM_COUNTER = Field(offsetof(JitRegisters, programCounter));
+
+    struct PinnedField {
+        HostRegister reg;
+        size_t offset;
+    };
+
+    // Loaded on entry to a block and stored back on the way out
+    const PinnedField PINNED_FIELDS[] = {
+        { ACCUMULATOR, offsetof(JitRegisters, accumulator) },
+        { INDEX_X, offsetof(JitRegisters, x) },
+        { INDEX_Y, offsetof(JitRegisters, y) },
+        { STACK_POINTER, offsetof(JitRegisters, stackPointer) },
+        { ZERO_RESULT, offsetof(JitRegisters, zeroResult) },
+        { NEGATIVE_RESULT, offsetof(JitRegisters, negativeResult) },
+        { CARRY_FLAG, offsetof(JitRegisters, carryFlag) },
+        { OVERFLOW_FLAG, offsetof(JitRegisters, overflowFlag) },
+    };
+
+    // Just enough of the x86-64 encoding for the translator. Every operation is on
+    // 32-bit registers unless it says otherwise.
+    class CodeEmitter
+    {
+        public:
+            size_t GetPosition() const { return Bytes.size(); }
+            const std::vector<Byte>& GetBytes() const { return Bytes; }
+
+            void Mov(const HostRegister destination, const HostRegister source) { EmitRegister({ 0x89 }, source, destination, false, false); }
+            void MovPointer(const HostRegister destination, const HostRegister source) { EmitRegister({ 0x89 }, source, destination, true, false); }
+            void AddPointer(const HostRegister destination, const HostRegister source) { EmitRegister({ 0x01 }, source, destination, true, false); }
+            void Alu(const AluOperation operation, const HostRegister destination, const HostRegister source)
+            {
+                EmitRegister({ static_cast<Byte>(operation * 8 + 1) }, source, destination, false, false);
+            }
+            void AluImmediate(const AluOperation operation, const HostRegister destination, const uint32_t immediate)
+            {
+                EmitRegister({ 0x81 }, operation, destination, false, false);
+                Emit32(immediate);
+            }
+            void Shift(const ShiftOperation operation, const HostRegister destination, const uint8_t count)
+            {
+                EmitRegister({ 0xC1 }, operation, destination, false, false);
+                Emit8(count);
+            }
+            void Test(const HostRegister source) { EmitRegister({ 0x85 }, source, source, false, false); }
+            void BitTest(const HostRegister source, const uint8_t bit)
+            {
+                EmitRegister({ 0x0F, 0xBA }, 4, source, false, false);
+                Emit8(bit);
+            }
+            void ComplementCarry() { Emit8(0xF5); }
+
+            // Byte forms leave the upper bits of the register alone
+            void AluByte(const AluOperation operation, const HostRegister destination, const HostRegister source)
+            {
+                EmitRegister({ static_cast<Byte>(operation * 8) }, source, destination, false, true);
+            }
+            void TestByte(const HostRegister source) { EmitRegister({ 0x84 }, source, source, false, true); }
+            void TestByteImmediate(const HostRegister source, const uint8_t immediate)
+            {
+                EmitRegister({ 0xF6 }, 0, source, false, true);
+                Emit8(immediate);
+            }
+            void IncrementByte(const HostRegister destination) { EmitRegister({ 0xFE }, 0, destination, false, true); }
+            void DecrementByte(const HostRegister destination) { EmitRegister({ 0xFE }, 1, destination, false, true); }
+            void ShiftByteOnce(const ShiftOperation operation, const HostRegister destination) { EmitRegister({ 0xD0 }, operation, destination, false, true); }
+            void TestPointer(const HostRegister source) { EmitRegister({ 0x85 }, source, source, true, false); }
+            void SetIf(const Condition condition, const HostRegister destination)
+            {
+                EmitRegister({ 0x0F, static_cast<Byte>(0x90 | condition) }, 0, destination, false, true);
+            }
+            void ZeroExtendByte(const HostRegister destination, const HostRegister source) { EmitRegister({ 0x0F, 0xB6 }, destination, source, false, true); }
+            void ZeroExtendWord(const HostRegister destination, const HostRegister source) { EmitRegister({ 0x0F, 0xB7 }, destination, source, false, false); }
+
+            void MovImmediate(const HostRegister destination, const uint32_t immediate)
+            {
+                EmitRex(false, 0, 0, destination, false);
+                Emit8(0xB8 + (destination & 7));
+                Emit32(immediate);
+            }
+            void MovImmediate64(const HostRegister destination, const uint64_t immediate)
+            {
+                EmitRex(true, 0, 0, destination, false);
+                Emit8(0xB8 + (destination & 7));
+                Emit64(immediate);
+            }
+            void AddImmediate64(const HostRegister destination, const uint32_t immediate)
+            {
+                EmitRegister({ 0x81 }, ADD, destination, true, false);
+                Emit32(immediate);
+            }
+
+            void Lea(const HostRegister destination, const MemoryOperand& memory) { EmitMemory({ 0x8D }, destination, memory, false, false); }
+            void LoadByte(const HostRegister destination, const MemoryOperand& memory) { EmitMemory({ 0x0F, 0xB6 }, destination, memory, false, false); }
+            void StoreByte(const MemoryOperand& memory, const HostRegister source) { EmitMemory({ 0x88 }, source, memory, false, true); }
+            void StoreByteImmediate(const MemoryOperand& memory, const uint8_t immediate)
+            {
+                EmitMemory({ 0xC6 }, 0, memory, false, false);
+                Emit8(immediate);
+            }
+            void StoreWord(const MemoryOperand& memory, const HostRegister source)
+            {
+                Emit8(0x66);
+                EmitMemory({ 0x89 }, source, memory, false, false);
+            }
+            void StoreWordImmediate(const MemoryOperand& memory, const uint16_t immediate)
+            {
+                Emit8(0x66);
+                EmitMemory({ 0xC7 }, 0, memory, false, false);
+                Emit16(immediate);
+            }
+            void LoadPointer(const HostRegister destination, const MemoryOperand& memory) { EmitMemory({ 0x8B }, destination, memory, true, false); }
+            void StorePointer(const MemoryOperand& memory, const HostRegister source) { EmitMemory({ 0x89 }, source, memory, true, false); }
+            void ComparePointer(const HostRegister source, const MemoryOperand& memory) { EmitMemory({ 0x3B }, source, memory, true, false); }
+            void CompareDwordImmediate(const MemoryOperand& memory, const uint32_t immediate)
+            {
+                EmitMemory({ 0x81 }, CMP, memory, false, false);
+                Emit32(immediate);
+            }
+
+            void Push(const HostRegister source)
+            {
+                EmitRex(false, 0, 0, source, false);
+                Emit8(0x50 + (source & 7));
+            }
+            void Pop(const HostRegister destination)
+            {
+                EmitRex(false, 0, 0, destination, false);
+                Emit8(0x58 + (destination & 7));
+            }
+            void Return() { Emit8(0xC3); }
+
+            // Forward jumps return the position of their displacement for Patch()
+            size_t Jump()
+            {
+                Emit8(0xE9);
+                Emit32(0);
+                return Bytes.size() - 4;
+            }
+            size_t JumpIf(const Condition condition)
+            {
+                Emit8(0x0F);
+                Emit8(0x80 | condition);
+                Emit32(0);
+                return Bytes.size() - 4;
+            }
+            void JumpTo(const size_t target) { Patch(Jump(), target); }
+            void JumpToRegister(const HostRegister target) { EmitRegister({ 0xFF }, 4, target, false, false); }
+            void JumpIfTo(const Condition condition, const size_t target) { Patch(JumpIf(condition), target); }
+
+            void Patch(const size_t displacement, const size_t target)
+            {
+                const int32_t relative = static_cast<int32_t>(static_cast<int64_t>(target) - static_cast<int64_t>(displacement + 4));
+                std::memcpy(&Bytes[displacement], &relative, sizeof(relative));
+            }
+
+        private:
+            void Emit8(const uint8_t value) { Bytes.push_back(value); }
+            void Emit16(const uint16_t value) { EmitLittleEndian(value, 2); }
+            void Emit32(const uint32_t value) { EmitLittleEndian(value, 4); }
+            void Emit64(const uint64_t value) { EmitLittleEndian(value, 8); }
+            void EmitLittleEndian(const uint64_t value, const size_t size)
+            {
+                for (size_t index = 0; index < size; ++index) {
+                    Bytes.push_back(static_cast<Byte>(value >> (8 * index)));
+                }
+            }
+
+            // Byte operands always get a REX prefix so that SIL/DIL are reachable
+            void EmitRex(const bool isWide, const uint8_t reg, const uint8_t index, const uint8_t base, const bool isByte)
+            {
+                const Byte rex = 0x40 | (isWide ? 0x08 : 0) | ((reg >> 3) << 2) | ((index >> 3) << 1) | (base >> 3);
+                if (rex != 0x40 || isByte) {
+                    Emit8(rex);
+                }
+            }
+
+            void EmitRegister(std::initializer_list<Byte> opcode, const uint8_t reg, const HostRegister rm, const bool isWide, const bool isByte)
+            {
+                EmitRex(isWide, reg, 0, rm, isByte);
+                for (const Byte value : opcode) {
+                    Emit8(value);
+                }
+                Emit8(0xC0 | ((reg & 7) << 3) | (rm & 7));
+            }
+
+            void EmitMemory(std::initializer_list<Byte> opcode, const uint8_t reg, const MemoryOperand& memory, const bool isWide, const bool isByte)
+            {
+                EmitRex(isWide, reg, memory.hasIndex ? memory.index : 0, memory.base, isByte);
+                for (const Byte value : opcode) {
+                    Emit8(value);
+                }
+
+                // RBP and R13 as a base cannot go without a displacement
+                const bool hasDisplacement = memory.displacement != 0 || (memory.base & 7) == RBP;
+                const Byte mod = hasDisplacement ? 0x80 : 0x00;
+                if (memory.hasIndex || (memory.base & 7) == RSP) {
+                    Emit8(mod | ((reg & 7) << 3) | RSP);
+                    Emit8((memory.scale << 6) | (((memory.hasIndex ? memory.index : RSP) & 7) << 3) | (memory.base & 7));
+                } else {
+                    Emit8(mod | ((reg & 7) << 3) | (memory.base & 7));
+                }
+                if (hasDisplacement) {
+                    Emit32(static_cast<uint32_t>(memory.displacement));
+                }
+            }
+
+        private:
+            std::vector<Byte> Bytes;
+    };
+
+    struct GuestInstruction {
+        Address address;
+        DecodedInstruction decoded;
+    };
+
+    enum class AccessType { None, Read, Write, ReadModifyWrite };
+
+    bool IsAccumulatorMode(const AddressingModes::Mode mode)
+    {
+        return mode == AddressingModes::Implicit || mode == AddressingModes::Accumulator;
+    }
+
+    bool IsBranch(const Operations::Operation operation)
+    {
+        switch (operation) {
+            case Operations::BCC: case Operations::BCS: case Operations::BEQ: case Operations::BMI:
+            case Operations::BNE: case Operations::BPL: case Operations::BVC: case Operations::BVS:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    bool EndsBlock(const Operations::Operation operation)
+    {
+        return operation == Operations::JMP || operation == Operations::JSR || operation == Operations::RTS;
+    }
+
+    // Which instructions the translator handles, and how they touch memory. Anything
+    // it does not handle ends the block and runs on the interpreter.
+    bool Classify(const Instruction& instruction, AccessType& access)
+    {
+        const AddressingModes::Mode mode = instruction.addressingMode;
+        if (!instruction.isLegal && instruction.operation != Operations::NOP) {
+            return false;
+        }
+
+        switch (instruction.operation) {
+            case Operations::LDA: case Operations::LDX: case Operations::LDY:
+            case Operations::AND: case Operations::ORA: case Operations::EOR:
+            case Operations::ADC: case Operations::SBC: case Operations::BIT:
+            case Operations::CMP: case Operations::CPX: case Operations::CPY:
+                access = mode == AddressingModes::Immediate ? AccessType::None : AccessType::Read;
+                return true;
+            case Operations::STA: case Operations::STX: case Operations::STY:
+                access = AccessType::Write;
+                return true;
+            case Operations::INC: case Operations::DEC:
+            case Operations::ASL: case Operations::LSR: case Operations::ROL: case Operations::ROR:
+                access = IsAccumulatorMode(mode) ? AccessType::None : AccessType::ReadModifyWrite;
+                return true;
+            case Operations::INX: case Operations::INY: case Operations::DEX: case Operations::DEY:
+            case Operations::TAX: case Operations::TAY: case Operations::TXA: case Operations::TYA:
+            case Operations::TSX: case Operations::TXS:
+            case Operations::CLC: case Operations::SEC: case Operations::CLV:
+            case Operations::NOP:
+            case Operations::PHA: case Operations::PLA: case Operations::RTS:
+            case Operations::BCC: case Operations::BCS: case Operations::BEQ: case Operations::BMI:
+            case Operations::BNE: case Operations::BPL: case Operations::BVC: case Operations::BVS:
+            case Operations::JSR:
+                access = AccessType::None;
+                return true;
+            case Operations::JMP:
+                access = AccessType::None;
+                return mode == AddressingModes::Absolute;
+            default:
+                return false;
+        }
+    }
+
+    bool HasPageCrossPenalty(const Instruction& instruction)
+    {
+        const AddressingModes::Mode mode = instruction.addressingMode;
+        return instruction.hasPageCrossPenalty
+            && (mode == AddressingModes::AbsoluteX || mode == AddressingModes::AbsoluteY || mode == AddressingModes::IndirectY);
+    }
+
+    uint32_t GetMaximumCycles(const Instruction& instruction)
+    {
+        return instruction.cyclesCount + (HasPageCrossPenalty(instruction) ? 1 : 0) + (IsBranch(instruction.operation) ? 2 : 0);
+    }
+
+    Address GetBranchTarget(const GuestInstruction& guest)
+    {
+        return guest.address + guest.decoded.length + static_cast<int8_t>(guest.decoded.operand & 0x00FF);
+    }
+
+    class BlockTranslator
+    {
+        public:
+            BlockTranslator(const JitCompiler& compiler, const Bus& bus, const std::vector<GuestInstruction>& instructions, const uint32_t maximumCycles)
+                : Compiler(compiler)
+                , ReadTable(reinterpret_cast<uintptr_t>(bus.GetReadPageTable()))
+                , WriteTable(reinterpret_cast<uintptr_t>(bus.GetWritePageTable()))
+                , GenerationTable(reinterpret_cast<uintptr_t>(bus.GetPageGenerationTable()))
+                , Instructions(instructions)
+                , MaximumCycles(maximumCycles)
+                , Labels(instructions.size(), 0)
+                , IsJumpTarget(instructions.size(), false)
+                , ForwardJumps(instructions.size())
+            {
+            }
+
+            const std::vector<Byte>& Translate();
+            size_t GetChainEntryOffset() const { return ChainEntryOffset; }
+
+        private:
+            struct SideExit {
+                size_t jump;
+                Address programCounter;
+                uint32_t cycles;
+            };
+
+            int FindInstruction(const Address) const;
+            void EmitInstruction(const size_t);
+            void EmitReadOperation(const Operations::Operation);
+            void EmitModifyOperation(const Operations::Operation, const HostRegister);
+            void EmitBranch(const size_t);
+            void EmitStack(const size_t, const Operations::Operation);
+
+            MemoryOperand EmitEffectiveAddress(const size_t, const uintptr_t);
+            void EmitConstantPage(const size_t, const uintptr_t, const uint8_t);
+            void EmitDynamicPage(const size_t, const uintptr_t);
+            void EmitSideExitIfNull(const size_t);
+
+            void EmitTransfer(const size_t, const Address, const uint32_t);
+            void EmitExit(const Address, const uint32_t);
+            void EmitChain(const CompiledBlock&);
+            void EmitGenerationCheck(const uint8_t, const uint32_t, std::vector<size_t>&);
+            void EmitAddCycles(const uint32_t);
+            void EmitSetZeroAndNegative(const HostRegister);
+
+        private:
+            CodeEmitter Emitter;
+            const JitCompiler& Compiler;
+            const uintptr_t ReadTable;
+            const uintptr_t WriteTable;
+            const uintptr_t GenerationTable;
+            const std::vector<GuestInstruction>& Instructions;
+            const uint32_t MaximumCycles;
+
+            // Cycles of instructions emitted since the cycle count was last brought
+            // up to date. Jump targets start from zero.
+            uint32_t PendingCycles = 0;
+
+            std::vector<size_t> Labels;
+            std::vector<bool> IsJumpTarget;
+            std::vector<std::vector<size_t>> ForwardJumps;
+            std::vector<size_t> EpilogueJumps;
+            std::vector<SideExit> SideExits;
+            size_t ChainEntryOffset = 0;
+    };
+
+    const std::vector<Byte>&
+    BlockTranslator::Translate()
+    {
+        for (const GuestInstruction& guest : Instructions) {
+            const Operations::Operation operation = guest.decoded.instruction->operation;
+            int target = -1;
+            if (IsBranch(operation)) {
+                target = FindInstruction(GetBranchTarget(guest));
+            } else if (operation == Operations::JMP) {
+                target = FindInstruction(guest.decoded.operand);
+            }
+            if (target >= 0) {
+                IsJumpTarget[target] = true;
+            }
+        }
+
+        const HostRegister saved[] = { RBX, RBP, R12, R13, R14, R15 };
+        for (const HostRegister reg : saved) {
+            Emitter.Push(reg);
+        }
+        Emitter.MovPointer(CONTEXT, RDI);
+        Emitter.LoadPointer(TOTAL_CYCLES, TOTAL_CYCLES_FIELD);
+        for (const PinnedField& pinned : PINNED_FIELDS) {
+            Emitter.LoadByte(pinned.reg, Field(pinned.offset));
+        }
+        ChainEntryOffset = Emitter.GetPosition();
+
+        for (size_t index = 0; index < Instructions.size(); ++index) {
+            if (IsJumpTarget[index]) {
+                EmitAddCycles(PendingCycles);
+                PendingCycles = 0;
+                for (const size_t jump : ForwardJumps[index]) {
+                    Emitter.Patch(jump, Emitter.GetPosition());
+                }
+            }
+            Labels[index] = Emitter.GetPosition();
+            EmitInstruction(index);
+        }
+
+        const GuestInstruction& last = Instructions.back();
+        if (!EndsBlock(last.decoded.instruction->operation)) {
+            EmitExit(last.address + last.decoded.length, PendingCycles);
+        }
+
+        const size_t epilogue = Emitter.GetPosition();
+        for (const size_t jump : EpilogueJumps) {
+            Emitter.Patch(jump, epilogue);
+        }
+        Emitter.StorePointer(TOTAL_CYCLES_FIELD, TOTAL_CYCLES);
+        for (const PinnedField& pinned : PINNED_FIELDS) {
+            Emitter.StoreByte(Field(pinned.offset), pinned.reg);
+        }
+        for (size_t index = sizeof(saved) / sizeof(saved[0]); index-- > 0;) {
+            Emitter.Pop(saved[index]);
+        }
+        Emitter.Return();
+
+        // Side exits are out of line so the common path falls straight through
+        for (const SideExit& sideExit : SideExits) {
+            Emitter.Patch(sideExit.jump, Emitter.GetPosition());
+            EmitAddCycles(sideExit.cycles);
+            Emitter.StoreWordImmediate(PROGRAM_COUNTER, sideExit.programCounter);
+            Emitter.JumpTo(epilogue);
+        }
+        return Emitter.GetBytes();
+    }
+
+    int
+    BlockTranslator::FindInstruction(const Address address) const
+    {
+        for (size_t index = 0; index < Instructions.size(); ++index) {
+            if (Instructions[index].address == address) {
+                return static_cast<int>(index);
+            }
+        }
+        return -1;
+    }
+
+    void
+    BlockTranslator::EmitInstruction(const size_t index)
+    {
+        const GuestInstruction& guest = Instructions[index];
+        const Instruction& instruction = *guest.decoded.instruction;
+        const Operations::Operation operation = instruction.operation;
+        const uint16_t operand = guest.decoded.operand;
+
+        AccessType access = AccessType::None;
+        Classify(instruction, access);
+
+        switch (operation) {
+            case Operations::LDA: case Operations::LDX: case Operations::LDY:
+            case Operations::AND: case Operations::ORA: case Operations::EOR:
+            case Operations::ADC: case Operations::SBC: case Operations::BIT:
+            case Operations::CMP: case Operations::CPX: case Operations::CPY:
+                if (access == AccessType::None) {
+                    Emitter.MovImmediate(RAX, operand & 0x00FF);
+                } else {
+                    Emitter.LoadByte(RAX, EmitEffectiveAddress(index, ReadTable));
+                }
+                EmitReadOperation(operation);
+                break;
+
+            case Operations::STA: case Operations::STX: case Operations::STY:
+                Emitter.StoreByte(EmitEffectiveAddress(index, WriteTable),
+                    operation == Operations::STA ? ACCUMULATOR : operation == Operations::STX ? INDEX_X : INDEX_Y);
+                break;
+
+            case Operations::INC: case Operations::DEC:
+            case Operations::ASL: case Operations::LSR: case Operations::ROL: case Operations::ROR:
+                if (access == AccessType::None) {
+                    EmitModifyOperation(operation, ACCUMULATOR);
+                } else {
+                    // The page must be writable, so the write table serves the read as well
+                    const MemoryOperand location = EmitEffectiveAddress(index, WriteTable);
+                    Emitter.LoadByte(RAX, location);
+                    EmitModifyOperation(operation, RAX);
+                    Emitter.StoreByte(location, RAX);
+                }
+                break;
+
+            case Operations::INX: EmitModifyOperation(Operations::INC, INDEX_X); break;
+            case Operations::INY: EmitModifyOperation(Operations::INC, INDEX_Y); break;
+            case Operations::DEX: EmitModifyOperation(Operations::DEC, INDEX_X); break;
+            case Operations::DEY: EmitModifyOperation(Operations::DEC, INDEX_Y); break;
+
+            case Operations::TAX: Emitter.Mov(INDEX_X, ACCUMULATOR); EmitSetZeroAndNegative(INDEX_X); break;
+            case Operations::TAY: Emitter.Mov(INDEX_Y, ACCUMULATOR); EmitSetZeroAndNegative(INDEX_Y); break;
+            case Operations::TXA: Emitter.Mov(ACCUMULATOR, INDEX_X); EmitSetZeroAndNegative(ACCUMULATOR); break;
+            case Operations::TYA: Emitter.Mov(ACCUMULATOR, INDEX_Y); EmitSetZeroAndNegative(ACCUMULATOR); break;
+            case Operations::TSX: Emitter.Mov(INDEX_X, STACK_POINTER); EmitSetZeroAndNegative(INDEX_X); break;
+            case Operations::TXS: Emitter.Mov(STACK_POINTER, INDEX_X); break;
+            case Operations::CLC: Emitter.Alu(XOR, CARRY_FLAG, CARRY_FLAG); break;
+            case Operations::SEC: Emitter.MovImmediate(CARRY_FLAG, 1); break;
+            case Operations::CLV: Emitter.Alu(XOR, OVERFLOW_FLAG, OVERFLOW_FLAG); break;
+
+            case Operations::NOP:
+                // Unofficial NOPs do not read, but the AbsoluteX ones still pay for a page cross
+                if (HasPageCrossPenalty(instruction)) {
+                    Emitter.Lea(RAX, Based(INDEX_X, operand & 0x00FF));
+                    Emitter.Shift(SHR, RAX, 8);
+                    Emitter.AddPointer(TOTAL_CYCLES, RAX);
+                }
+                break;
+
+            case Operations::PHA: case Operations::PLA: case Operations::JSR: case Operations::RTS:
+                EmitStack(index, operation);
+                return;
+
+            case Operations::JMP:
+                EmitTransfer(index, operand, PendingCycles + instruction.cyclesCount);
+                return;
+
+            default:
+                EmitBranch(index);
+                return;
+        }
+        PendingCycles += instruction.cyclesCount;
+    }
+
+    void
+    BlockTranslator::EmitReadOperation(const Operations::Operation operation)
+    {
+        // The operand is in RAX. ADC and SBC use the host's own carry and overflow,
+        // which match the 6502's in binary mode.
+        switch (operation) {
+            case Operations::LDA: Emitter.Mov(ACCUMULATOR, RAX); EmitSetZeroAndNegative(ACCUMULATOR); break;
+            case Operations::LDX: Emitter.Mov(INDEX_X, RAX); EmitSetZeroAndNegative(INDEX_X); break;
+            case Operations::LDY: Emitter.Mov(INDEX_Y, RAX); EmitSetZeroAndNegative(INDEX_Y); break;
+            case Operations::AND: Emitter.Alu(AND, ACCUMULATOR, RAX); EmitSetZeroAndNegative(ACCUMULATOR); break;
+            case Operations::ORA: Emitter.Alu(OR, ACCUMULATOR, RAX); EmitSetZeroAndNegative(ACCUMULATOR); break;
+            case Operations::EOR: Emitter.Alu(XOR, ACCUMULATOR, RAX); EmitSetZeroAndNegative(ACCUMULATOR); break;
+
+            case Operations::ADC:
+                Emitter.BitTest(CARRY_FLAG, 0);
+                Emitter.AluByte(ADC, ACCUMULATOR, RAX);
+                Emitter.SetIf(BELOW, CARRY_FLAG);
+                Emitter.SetIf(OVERFLOW, OVERFLOW_FLAG);
+                EmitSetZeroAndNegative(ACCUMULATOR);
+                break;
+
+            case Operations::SBC:
+                // The 6502 carry is an inverted borrow
+                Emitter.BitTest(CARRY_FLAG, 0);
+                Emitter.ComplementCarry();
+                Emitter.AluByte(SBB, ACCUMULATOR, RAX);
+                Emitter.SetIf(ABOVE_OR_EQUAL, CARRY_FLAG);
+                Emitter.SetIf(OVERFLOW, OVERFLOW_FLAG);
+                EmitSetZeroAndNegative(ACCUMULATOR);
+                break;
+
+            case Operations::CMP: case Operations::CPX: case Operations::CPY:
+                Emitter.Mov(RCX, operation == Operations::CMP ? ACCUMULATOR : operation == Operations::CPX ? INDEX_X : INDEX_Y);
+                Emitter.Alu(SUB, RCX, RAX);
+                Emitter.SetIf(ABOVE_OR_EQUAL, CARRY_FLAG);
+                EmitSetZeroAndNegative(RCX);
+                break;
+
+            case Operations::BIT:
+                Emitter.Mov(NEGATIVE_RESULT, RAX);
+                Emitter.Mov(OVERFLOW_FLAG, RAX);
+                Emitter.Shift(SHR, OVERFLOW_FLAG, 6);
+                Emitter.AluImmediate(AND, OVERFLOW_FLAG, 1);
+                Emitter.Mov(ZERO_RESULT, RAX);
+                Emitter.Alu(AND, ZERO_RESULT, ACCUMULATOR);
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    void
+    BlockTranslator::EmitModifyOperation(const Operations::Operation operation, const HostRegister value)
+    {
+        // Byte-sized, so the rest of the register stays clear for address arithmetic
+        switch (operation) {
+            case Operations::INC: Emitter.IncrementByte(value); break;
+            case Operations::DEC: Emitter.DecrementByte(value); break;
+            case Operations::ASL: Emitter.AluByte(ADD, value, value); Emitter.SetIf(BELOW, CARRY_FLAG); break;
+            case Operations::LSR: Emitter.ShiftByteOnce(SHR, value); Emitter.SetIf(BELOW, CARRY_FLAG); break;
+            case Operations::ROL:
+                Emitter.BitTest(CARRY_FLAG, 0);
+                Emitter.ShiftByteOnce(RCL, value);
+                Emitter.SetIf(BELOW, CARRY_FLAG);
+                break;
+            case Operations::ROR:
+                Emitter.BitTest(CARRY_FLAG, 0);
+                Emitter.ShiftByteOnce(RCR, value);
+                Emitter.SetIf(BELOW, CARRY_FLAG);
+                break;
+            default:
+                break;
+        }
+        EmitSetZeroAndNegative(value);
+    }
+
+    void
+    BlockTranslator::EmitBranch(const size_t index)
+    {
+        const GuestInstruction& guest = Instructions[index];
+        const Instruction& instruction = *guest.decoded.instruction;
+        const Address nextAddress = guest.address + guest.decoded.length;
+        const Address target = GetBranchTarget(guest);
+
+        // Each test leaves ZF clear when the flag is set. Z is set when the zero
+        // result is zero, so BNE is the branch that is taken on a clear ZF there.
+        bool isTakenWhenClear = false;
+        switch (instruction.operation) {
+            case Operations::BCC: Emitter.Test(CARRY_FLAG); isTakenWhenClear = false; break;
+            case Operations::BCS: Emitter.Test(CARRY_FLAG); isTakenWhenClear = true; break;
+            case Operations::BVC: Emitter.Test(OVERFLOW_FLAG); isTakenWhenClear = false; break;
+            case Operations::BVS: Emitter.Test(OVERFLOW_FLAG); isTakenWhenClear = true; break;
+            case Operations::BNE: Emitter.TestByte(ZERO_RESULT); isTakenWhenClear = true; break;
+            case Operations::BEQ: Emitter.TestByte(ZERO_RESULT); isTakenWhenClear = false; break;
+            case Operations::BPL: Emitter.TestByteImmediate(NEGATIVE_RESULT, 0x80); isTakenWhenClear = false; break;
+            case Operations::BMI: Emitter.TestByteImmediate(NEGATIVE_RESULT, 0x80); isTakenWhenClear = true; break;
+            default: break;
+        }
+        const size_t notTaken = Emitter.JumpIf(isTakenWhenClear ? EQUAL : NOT_EQUAL);
+
+        const uint32_t takenCycles = instruction.cyclesCount + 1 + ((target & 0xFF00) != (nextAddress & 0xFF00) ? 1 : 0);
+        EmitTransfer(index, target, PendingCycles + takenCycles);
+
+        Emitter.Patch(notTaken, Emitter.GetPosition());
+        PendingCycles += instruction.cyclesCount;
+    }
+
+    void
+    BlockTranslator::EmitStack(const size_t index, const Operations::Operation operation)
+    {
+        const GuestInstruction& guest = Instructions[index];
+        const uint32_t cycles = PendingCycles + guest.decoded.instruction->cyclesCount;
+        const bool isPush = operation == Operations::PHA || operation == Operations::JSR;
+        EmitConstantPage(index, isPush ? WriteTable : ReadTable, 0x01);
+        const MemoryOperand top = Indexed(RDX, STACK_POINTER);
+
+        switch (operation) {
+            case Operations::PHA:
+                Emitter.StoreByte(top, ACCUMULATOR);
+                Emitter.DecrementByte(STACK_POINTER);
+                PendingCycles = cycles;
+                break;
+
+            case Operations::PLA:
+                Emitter.IncrementByte(STACK_POINTER);
+                Emitter.LoadByte(ACCUMULATOR, top);
+                EmitSetZeroAndNegative(ACCUMULATOR);
+                PendingCycles = cycles;
+                break;
+
+            case Operations::JSR: {
+                const Address returnAddress = guest.address + 2;
+                Emitter.StoreByteImmediate(top, returnAddress >> 8);
+                Emitter.DecrementByte(STACK_POINTER);
+                Emitter.StoreByteImmediate(top, returnAddress & 0x00FF);
+                Emitter.DecrementByte(STACK_POINTER);
+                EmitExit(guest.decoded.operand, cycles);
+                break;
+            }
+
+            case Operations::RTS:
+                Emitter.IncrementByte(STACK_POINTER);
+                Emitter.LoadByte(RAX, top);
+                Emitter.IncrementByte(STACK_POINTER);
+                Emitter.LoadByte(RCX, top);
+                Emitter.Shift(SHL, RCX, 8);
+                Emitter.Alu(OR, RAX, RCX);
+                Emitter.AluImmediate(ADD, RAX, 1);
+                Emitter.StoreWord(PROGRAM_COUNTER, RAX);
+                EmitAddCycles(cycles);
+                EpilogueJumps.push_back(Emitter.Jump());
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    MemoryOperand
+    BlockTranslator::EmitEffectiveAddress(const size_t index, const uintptr_t table)
+    {
+        // Returns where the operand lives, off the page pointer in RDX. Nothing
+        // guest-visible changes until the page is known to be memory.
+        const DecodedInstruction& decoded = Instructions[index].decoded;
+        const uint16_t operand = decoded.operand;
+        const bool hasPenalty = HasPageCrossPenalty(*decoded.instruction);
+
+        switch (decoded.instruction->addressingMode) {
+            case AddressingModes::ZeroPage:
+                EmitConstantPage(index, table, 0x00);
+                return Based(RDX, operand & 0x00FF);
+
+            case AddressingModes::Absolute:
+                EmitConstantPage(index, table, operand >> 8);
+                return Based(RDX, operand & 0x00FF);
+
+            case AddressingModes::ZeroPageX:
+            case AddressingModes::ZeroPageY:
+                EmitConstantPage(index, table, 0x00);
+                Emitter.Lea(RDI, Based(decoded.instruction->addressingMode == AddressingModes::ZeroPageX ? INDEX_X : INDEX_Y, operand & 0x00FF));
+                Emitter.ZeroExtendByte(RDI, RDI);
+                return Indexed(RDX, RDI);
+
+            case AddressingModes::AbsoluteX:
+            case AddressingModes::AbsoluteY: {
+                const HostRegister indexRegister = decoded.instruction->addressingMode == AddressingModes::AbsoluteX ? INDEX_X : INDEX_Y;
+                Emitter.Lea(RCX, Based(indexRegister, operand));
+                Emitter.ZeroExtendWord(RCX, RCX);
+                EmitDynamicPage(index, table);
+                if (hasPenalty) {
+                    Emitter.Lea(RAX, Based(indexRegister, operand & 0x00FF));
+                    Emitter.Shift(SHR, RAX, 8);
+                    Emitter.AddPointer(TOTAL_CYCLES, RAX);
+                }
+                return Indexed(RDX, RDI);
+            }
+
+            case AddressingModes::IndirectX:
+                EmitConstantPage(index, ReadTable, 0x00);
+                Emitter.Lea(RDI, Based(INDEX_X, operand & 0x00FF));
+                Emitter.ZeroExtendByte(RDI, RDI);
+                Emitter.LoadByte(RAX, Indexed(RDX, RDI));
+                Emitter.IncrementByte(RDI);
+                Emitter.LoadByte(RCX, Indexed(RDX, RDI));
+                Emitter.Shift(SHL, RCX, 8);
+                Emitter.Alu(OR, RCX, RAX);
+                EmitDynamicPage(index, table);
+                return Indexed(RDX, RDI);
+
+            case AddressingModes::IndirectY:
+                EmitConstantPage(index, ReadTable, 0x00);
+                Emitter.LoadByte(RAX, Based(RDX, operand & 0x00FF));
+                Emitter.LoadByte(RCX, Based(RDX, (operand + 1) & 0x00FF));
+                Emitter.Shift(SHL, RCX, 8);
+                Emitter.Alu(OR, RCX, RAX);
+                Emitter.Alu(ADD, RCX, INDEX_Y);
+                Emitter.ZeroExtendWord(RCX, RCX);
+                EmitDynamicPage(index, table);
+                if (hasPenalty) {
+                    // RAX still holds the pointer's low byte
+                    Emitter.Alu(ADD, RAX, INDEX_Y);
+                    Emitter.Shift(SHR, RAX, 8);
+                    Emitter.AddPointer(TOTAL_CYCLES, RAX);
+                }
+                return Indexed(RDX, RDI);
+
+            default:
+                return Indexed(RDX, RDI);
+        }
+    }
+
+    void
+    BlockTranslator::EmitConstantPage(const size_t index, const uintptr_t table, const uint8_t page)
+    {
+        Emitter.MovImmediate64(RDX, table + page * sizeof(Byte*));
+        Emitter.LoadPointer(RDX, Based(RDX, 0));
+        EmitSideExitIfNull(index);
+    }
+
+    void
+    BlockTranslator::EmitDynamicPage(const size_t index, const uintptr_t table)
+    {
+        // The address is in RCX; its low byte ends up in RDI
+        Emitter.Mov(RSI, RCX);
+        Emitter.Shift(SHR, RSI, 8);
+        Emitter.MovImmediate64(RDX, table);
+        Emitter.LoadPointer(RDX, Indexed(RDX, RSI, 3));
+        EmitSideExitIfNull(index);
+        Emitter.ZeroExtendByte(RDI, RCX);
+    }
+
+    void
+    BlockTranslator::EmitSideExitIfNull(const size_t index)
+    {
+        // A null page means the Bus slow path: hand the instruction to the interpreter
+        Emitter.TestPointer(RDX);
+        SideExits.push_back({ Emitter.JumpIf(EQUAL), Instructions[index].address, PendingCycles });
+    }
+
+    void
+    BlockTranslator::EmitTransfer(const size_t index, const Address target, const uint32_t cycles)
+    {
+        // Control moves to target with the given cycles still to be counted
+        EmitAddCycles(cycles);
+        const int targetIndex = FindInstruction(target);
+        if (targetIndex >= 0 && static_cast<size_t>(targetIndex) > index) {
+            ForwardJumps[targetIndex].push_back(Emitter.Jump());
+            return;
+        }
+        if (targetIndex >= 0) {
+            // Loop again only if a full pass is sure to end inside the timeslice
+            Emitter.MovPointer(RAX, TOTAL_CYCLES);
+            Emitter.AddImmediate64(RAX, MaximumCycles);
+            Emitter.ComparePointer(RAX, TIMESLICE_END);
+            Emitter.JumpIfTo(BELOW, Labels[targetIndex]);
+        }
+        EmitExit(target, 0);
+    }
+
+    void
+    BlockTranslator::EmitExit(const Address programCounter, const uint32_t cycles)
+    {
+        EmitAddCycles(cycles);
+        const CompiledBlock* target = Compiler.FindCompiled(programCounter);
+        if (target != nullptr) {
+            EmitChain(*target);
+        }
+        Emitter.StoreWordImmediate(PROGRAM_COUNTER, programCounter);
+        EpilogueJumps.push_back(Emitter.Jump());
+    }
+
+    void
+    BlockTranslator::EmitChain(const CompiledBlock& target)
+    {
+        // Jumps into the target under the checks CPU::RunCompiledBlock() and
+        // JitCompiler::Lookup() would make, and falls through to a plain exit otherwise
+        std::vector<size_t> failedChecks;
+        Emitter.MovPointer(RAX, TOTAL_CYCLES);
+        Emitter.AddImmediate64(RAX, target.maximumCycles);
+        Emitter.ComparePointer(RAX, TIMESLICE_END);
+        failedChecks.push_back(Emitter.JumpIf(ABOVE_OR_EQUAL));
+        EmitGenerationCheck(target.firstPage, target.firstPageGeneration, failedChecks);
+        if (target.lastPage != target.firstPage) {
+            EmitGenerationCheck(target.lastPage, target.lastPageGeneration, failedChecks);
+        }
+        Emitter.MovImmediate64(RAX, reinterpret_cast<uintptr_t>(target.chainEntry));
+        Emitter.JumpToRegister(RAX);
+
+        for (const size_t jump : failedChecks) {
+            Emitter.Patch(jump, Emitter.GetPosition());
+        }
+    }
+
+    void
+    BlockTranslator::EmitGenerationCheck(const uint8_t page, const uint32_t generation, std::vector<size_t>& failedChecks)
+    {
+        Emitter.MovImmediate64(RDX, GenerationTable + page * sizeof(uint32_t));
+        Emitter.CompareDwordImmediate(Based(RDX, 0), generation);
+        failedChecks.push_back(Emitter.JumpIf(NOT_EQUAL));
+    }
+
+    void
+    BlockTranslator::EmitAddCycles(const uint32_t cycles)
+    {
+        if (cycles != 0) {
+            Emitter.AddImmediate64(TOTAL_CYCLES, cycles);
+        }
+    }
+
+    void
+    BlockTranslator::EmitSetZeroAndNegative(const HostRegister result)
+    {
+        Emitter.Mov(ZERO_RESULT, result);
+        Emitter.Mov(NEGATIVE_RESULT, result);
+    }
+}
+
+JitCompiler::JitCompiler(Bus& bus, const size_t numberOfBlocks, const size_t codeSize)
+    : ConnectedBus(bus), PageGenerations(bus.GetPageGenerationTable())
+{
+    size_t size = 1;
+    while (size < numberOfBlocks) {
+        size <<= 1;
+    }
+    Blocks.resize(size);
+    IndexMask = size - 1;
+    Invalidate();
+
+#if defined(__x86_64__)
+    // Kept read-only and executable, and only made writable while a block is copied in
+    void* memory = mmap(nullptr, codeSize, PROT_READ | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory != MAP_FAILED) {
+        Code = static_cast<Byte*>(memory);
+        CodeCapacity = codeSize;
+    }
+#else
+    (void)codeSize;
+#endif
+}
+
+JitCompiler::~JitCompiler()
+{
+#if defined(__x86_64__)
+    if (Code != nullptr) {
+        munmap(Code, CodeCapacity);
+    }
+#endif
+}
+
+bool
+JitCompiler::IsSupported()
+{
+#if defined(__x86_64__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+const CompiledBlock*
+JitCompiler::Lookup(CPU& cpu, const Address address)
+{
+    CompiledBlock& block = Blocks[GetBlockIndex(address)];
+    if (block.start != address || !IsCurrent(block)) {
+        block.start = address;
+        block.firstPage = address >> 8;
+        block.lastPage = block.firstPage;
+        block.firstPageGeneration = ConnectedBus.GetPageGeneration(block.firstPage);
+        block.lastPageGeneration = block.firstPageGeneration;
+        block.isRejected = false;
+        block.executions = 0;
+        block.function = nullptr;
+    }
+
+    if (block.function != nullptr) {
+        return &block;
+    }
+    if (block.isRejected || Code == nullptr || ++block.executions < JIT_HOT_THRESHOLD) {
+        return nullptr;
+    }
+
+    if (!Compile(cpu, address, block)) {
+        block.isRejected = true;
+        MarkRejected(address);
+        return nullptr;
+    }
+    return &block;
+}
+
+const CompiledBlock*
+JitCompiler::FindCompiled(const Address address) const
+{
+    const CompiledBlock& block = Blocks[GetBlockIndex(address)];
+    if (block.function == nullptr || block.start != address || !IsCurrent(block)) {
+        return nullptr;
+    }
+    return &block;
+}
+
+bool
+JitCompiler::IsCurrent(const CompiledBlock& block) const
+{
+    return ConnectedBus.GetPageGeneration(block.firstPage) == block.firstPageGeneration
+        && ConnectedBus.GetPageGeneration(block.lastPage) == block.lastPageGeneration;
+}
+
+void
+JitCompiler::Invalidate()
+{
+    for (CompiledBlock& block : Blocks) {
+        block.start = 0;
+        block.firstPage = 0;
+        block.lastPage = 0;
+        block.isRejected = false;
+        block.firstPageGeneration = ConnectedBus.GetPageGeneration(0);
+        block.lastPageGeneration = block.firstPageGeneration;
+        block.executions = 0;
+        block.maximumCycles = 0;
+        block.function = nullptr;
+        block.chainEntry = nullptr;
+    }
+    RejectedStarts.fill(0);
+}
+
+size_t
+JitCompiler::GetBlockIndex(const Address address) const
+{
+    // Fibonacci hashing: a plain mask would put every call site in one bank on
+    // the same slots as the routines it calls in the next (JSR $9000 from $8000)
+    return (static_cast<uint32_t>(address) * 0x9E3779B1u >> 16) & IndexMask;
+}
+
+bool
+JitCompiler::IsReadOnlyPage(const size_t page) const
+{
+    return ConnectedBus.IsMemoryPage(page) && !ConnectedBus.IsWritablePage(page);
+}
+
+void
+JitCompiler::MarkRejected(const Address address)
+{
+    // Bits left from an earlier mapping of the page no longer hold
+    const size_t page = address >> 8;
+    if (RejectedGenerations[page] != PageGenerations[page]) {
+        const size_t firstWord = page * BUS_PAGE_SIZE / 64;
+        std::fill(RejectedStarts.begin() + firstWord, RejectedStarts.begin() + firstWord + BUS_PAGE_SIZE / 64, 0);
+        RejectedGenerations[page] = PageGenerations[page];
+    }
+    RejectedStarts[address >> 6] |= uint64_t(1) << (address & 63);
+}
+
+bool
+JitCompiler::Compile(CPU& cpu, const Address address, CompiledBlock& block)
+{
+    const uint8_t firstPage = address >> 8;
+    const uint8_t nextPage = firstPage + 1;
+    if (!IsReadOnlyPage(firstPage)) {
+        return false;
+    }
+
+    std::vector<GuestInstruction> instructions;
+    uint8_t lastPage = firstPage;
+    uint32_t maximumCycles = 0;
+    Address position = address;
+    while (instructions.size() < MAXIMUM_COMPILED_BLOCK_LENGTH) {
+        const uint8_t lastByteEnd = static_cast<uint8_t>((position + 2) >> 8);
+        if ((lastByteEnd != firstPage && lastByteEnd != nextPage) || !IsReadOnlyPage(lastByteEnd)) {
+            break;
+        }
+
+        GuestInstruction guest;
+        guest.address = position;
+        cpu.Decode(position, guest.decoded);
+        const Instruction& instruction = *guest.decoded.instruction;
+
+        AccessType access = AccessType::None;
+        if (!Classify(instruction, access)) {
+            break;
+        }
+
+        // Fixed addresses outside memory would always leave the block, so stop short of them
+        const AddressingModes::Mode mode = instruction.addressingMode;
+        const bool isFixedPage = mode == AddressingModes::Absolute || mode == AddressingModes::AbsoluteX || mode == AddressingModes::AbsoluteY;
+        const uint8_t page = isFixedPage ? guest.decoded.operand >> 8 : 0x00;
+        if (access == AccessType::Read && !ConnectedBus.IsMemoryPage(page)) {
+            break;
+        }
+        if ((access == AccessType::Write || access == AccessType::ReadModifyWrite) && !ConnectedBus.IsWritablePage(page)) {
+            break;
+        }
+
+        instructions.push_back(guest);
+        maximumCycles += GetMaximumCycles(instruction);
+        if (static_cast<uint8_t>((position + guest.decoded.length - 1) >> 8) != firstPage) {
+            lastPage = nextPage;
+        }
+
+        position += guest.decoded.length;
+        const uint8_t positionPage = position >> 8;
+        if (EndsBlock(instruction.operation) || (positionPage != firstPage && positionPage != nextPage)) {
+            break;
+        }
+    }
+
+    if (instructions.empty()) {
+        return false;
+    }
+
+    BlockTranslator translator(*this, ConnectedBus, instructions, maximumCycles);
+    std::vector<Byte> code = translator.Translate();
+
+#if defined(__x86_64__)
+    if (code.size() > CodeCapacity) {
+        return false;
+    }
+    if (CodeUsed + code.size() > CodeCapacity) {
+        // Out of room: start over, and let hot blocks compile again. The block is
+        // translated again since it may chain into code that is now gone.
+        Invalidate();
+        CodeUsed = 0;
+        BlockTranslator unchained(*this, ConnectedBus, instructions, maximumCycles);
+        code = unchained.Translate();
+    }
+
+    if (mprotect(Code, CodeCapacity, PROT_READ | PROT_WRITE) != 0) {
+        return false;
+    }
+    std::memcpy(Code + CodeUsed, code.data(), code.size());
+    if (mprotect(Code, CodeCapacity, PROT_READ | PROT_EXEC) != 0) {
+        return false;
+    }
+
+    block.function = reinterpret_cast<CompiledFunction>(Code + CodeUsed);
+    block.chainEntry = Code + CodeUsed + translator.GetChainEntryOffset();
+    CodeUsed += (code.size() + 15) & ~static_cast<size_t>(15);
+#else
+    return false;
+#endif
+
+    block.start = address;
+    block.firstPage = firstPage;
+    block.lastPage = lastPage;
+    block.isRejected = false;
+    block.firstPageGeneration = ConnectedBus.GetPageGeneration(firstPage);
+    block.lastPageGeneration = ConnectedBus.GetPageGeneration(lastPage);
+    block.maximumCycles = maximumCycles;
+    ++BlocksCompiled;
+    return true;
+}
@@ -0,0 +1,740 @@
+#include "../include/LockstepCPU.hpp"
+
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "../include/Bus.hpp"
+#include "../include/OpcodeTable.hpp"
+
+namespace {
+    // Budgets are 32-bit, so longer runs are split into passes of at most this many cycles
+    constexpr uint64_t MAXIMUM_PASS_CYCLES = 1 << 30;
+
+    template <typename T, size_t Lanes>
+    inline void Commit(std::array<T, Lanes>& destination, const std::array<T, Lanes>& value, const std::array<Byte, Lanes>& select)
+    {
+        for (size_t lane = 0; lane < Lanes; ++lane) {
+            destination[lane] = select[lane] ? value[lane] : destination[lane];
+        }
+    }
+
+    template <size_t Lanes>
+    inline uint32_t MoveMaskLoop(const std::array<Byte, Lanes>& bytes)
+    {
+        uint32_t mask = 0;
+        for (size_t lane = 0; lane < Lanes; ++lane) {
+            mask |= static_cast<uint32_t>(bytes[lane] >> 7) << lane;
+        }
+        return mask;
+    }
+
+    // Top bit of every lane byte, lane 0 in bit 0
+    inline uint32_t MoveMask(const std::array<Byte, 8>& bytes)
+    {
+#if defined(__SSE2__)
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(bytes.data())))) & 0xFF;
+#else
+        return MoveMaskLoop(bytes);
+#endif
+    }
+
+    inline uint32_t MoveMask(const std::array<Byte, 16>& bytes)
+    {
+#if defined(__SSE2__)
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes.data()))));
+#else
+        return MoveMaskLoop(bytes);
+#endif
+    }
+
+    inline uint32_t MoveMask(const std::array<Byte, 32>& bytes)
+    {
+#if defined(__AVX2__)
+        return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes.data()))));
+#elif defined(__SSE2__)
+        const uint32_t low = static_cast<uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes.data()))));
+        const uint32_t high = static_cast<uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes.data() + 16))));
+        return low | (high << 16);
+#else
+        return MoveMaskLoop(bytes);
+#endif
+    }
+
+    inline size_t FirstLane(const uint32_t mask)
+    {
+        return static_cast<size_t>(__builtin_ctz(mask));
+    }
+
+    inline bool IsRamAddress(const Address address)
+    {
+        return address <= MEMORY_MIRRORED_UNIT.second;
+    }
+
+    inline bool IsProgramAddress(const Address address)
+    {
+        return address >= LOCKSTEP_PROGRAM_UNIT.first;
+    }
+
+    // The operations that fetch their operand, matching CPU::FetchDataForOperation()
+    bool ReadsOperand(const Operations::Operation operation)
+    {
+        switch (operation) {
+            case Operations::ADC: case Operations::AND: case Operations::ASL: case Operations::BIT:
+            case Operations::CMP: case Operations::CPX: case Operations::CPY: case Operations::DEC:
+            case Operations::EOR: case Operations::INC: case Operations::LDA: case Operations::LDX:
+            case Operations::LDY: case Operations::LSR: case Operations::ORA: case Operations::ROL:
+            case Operations::ROR: case Operations::SBC:
+                return true;
+            default:
+                return false;
+        }
+    }
+}
+
+template <size_t Lanes>
+LockstepCPU<Lanes>::LockstepCPU()
+    : Ram(MEMORY_SIZE, LaneBytes{})
+    , Program(LOCKSTEP_PROGRAM_SIZE, 0x00)
+{
+    ZeroResult.fill(0x01);
+}
+
+template <size_t Lanes>
+void
+LockstepCPU<Lanes>::MapProgram(const Byte* memory, const size_t size)
+{
+    for (size_t offset = 0; offset < Program.size(); ++offset) {
+        Program[offset] = memory[offset % size];
+    }
+}
+
+template <size_t Lanes>
+void
+LockstepCPU<Lanes>::Reset()
+{
+    const Address resetVector = 0xFFFC - LOCKSTEP_PROGRAM_UNIT.first;
+    for (size_t lane = 0; lane < Lanes; ++lane) {
+        ProgramCounter[lane] = Program[resetVector] | (Program[resetVector + 1] << 8);
+        StackPointer[lane] -= 3;
+        StatusRegister[lane] |= StatusRegisterFlags::I | StatusRegisterFlags::U;
+        TotalCycles[lane] += 7;
+        Enabled[lane] = 0xFF;
+    }
+}
+
+template <size_t Lanes>
+void
+LockstepCPU<Lanes>::InterruptRequest(const size_t lane)
+{
+    if (StatusRegister[lane] & StatusRegisterFlags::I) {
+        return;
+    }
+    EnterInterrupt(lane, 0xFFFE);
+}
+
+template <size_t Lanes>
+void
+LockstepCPU<Lanes>::NonMaskableInterrupt(const size_t lane)
+{
+    EnterInterrupt(lane, 0xFFFA);
+}
+
+template <size_t Lanes>
+void
+LockstepCPU<Lanes>::EnterInterrupt(const size_t lane, const Address vector)
+{
+    Push(lane, ProgramCounter[lane] >> 8);
+    Push(lane, ProgramCounter[lane] & 0x00FF);
+    Push(lane, (GetStatusRegister(lane) & ~StatusRegisterFlags::B) | StatusRegisterFlags::U);
+    StatusRegister[lane] |= StatusRegisterFlags::I;
+    const Byte low = ReadLane(lane, vector);
+    ProgramCounter[lane] = low | (ReadLane(lane, vector + 1) << 8);
+    TotalCycles[lane] += 7;
+}
+
+template <size_t Lanes>
+bool
+LockstepCPU<Lanes>::LoadLane(const size_t lane, const SaveState& state)
+{
+    if (!state.IsValid()) {
+        return false;
+    }
+
+    // An instruction Clock() left in flight is finished first, as Step() would
+    TotalCycles[lane] = state.cpu.totalCycles + state.cpu.cyclesLeft;
+    ProgramCounter[lane] = state.cpu.programCounter;
+    Accumulator[lane] = state.cpu.accumulator;
+    X[lane] = state.cpu.x;
+    Y[lane] = state.cpu.y;
+    StackPointer[lane] = state.cpu.stackPointer;
+    SetStatusRegister(lane, state.cpu.statusRegister);
+    for (size_t address = 0; address < MEMORY_SIZE; ++address) {
+        Ram[address][lane] = state.ram[address];
+    }
+    Enabled[lane] = 0xFF;
+    return true;
+}
+
+template <size_t Lanes>
+void
+LockstepCPU<Lanes>::StoreLane(const size_t lane, SaveState& state) const
+{
+    state.magic = SAVE_STATE_MAGIC;
+    state.version = SAVE_STATE_VERSION;
+    state.size = static_cast<uint16_t>(sizeof(SaveState));
+    state.cpu = CPUState{};
+    state.cpu.totalCycles = TotalCycles[lane];
+    state.cpu.programCounter = ProgramCounter[lane];
+    state.cpu.accumulator = Accumulator[lane];
+    state.cpu.x = X[lane];
+    state.cpu.y = Y[lane];
+    state.cpu.stackPointer = StackPointer[lane];
+    state.cpu.statusRegister = GetStatusRegister(lane);
+    for (size_t address = 0; address < MEMORY_SIZE; ++address) {
+        state.ram[address] = Ram[address][lane];
+    }
+}
+
+template <size_t Lanes>
+void
+LockstepCPU<Lanes>::RunCycles(const uint64_t cycles)
+{
+    LaneArray<uint64_t> timesliceEnd;
+    for (size_t lane = 0; lane < Lanes; ++lane) {
+        timesliceEnd[lane] = TotalCycles[lane] + cycles;
+    }
+
+    while (true) {
+        alignas(64) LaneArray<int32_t> passCycles;
+        bool isFinished = true;
+        for (size_t lane = 0; lane < Lanes; ++lane) {
+            const bool isRunning = Enabled[lane] && TotalCycles[lane] < timesliceEnd[lane];
+            passCycles[lane] = isRunning ? static_cast<int32_t>(std::min(timesliceEnd[lane] - TotalCycles[lane], MAXIMUM_PASS_CYCLES)) : 0;
+            isFinished &= !isRunning;
+        }
+        if (isFinished) {
+            break;
+        }
+        Budget = passCycles;
+
+        while (true) {
+            // The lane with the most cycles left leads, so no lane falls behind for long
+            int32_t mostCyclesLeft = 0;
+            for (size_t lane = 0; lane < Lanes; ++lane) {
+                mostCyclesLeft = std::max(mostCyclesLeft, Budget[lane]);
+            }
+            if (mostCyclesLeft <= 0) {
+                break;
+            }
+
+            alignas(32) LaneBytes isLeading;
+            for (size_t lane = 0; lane < Lanes; ++lane) {
+                isLeading[lane] = Budget[lane] == mostCyclesLeft ? 0xFF : 0x00;
+            }
+            const size_t leader = FirstLane(ToLaneMask(isLeading));
+            const Address programCounter = ProgramCounter[leader];
+
+            // Code in the shared program is the same in every lane; anywhere else it
+            // has to be fetched per lane, so the leader runs alone.
+            alignas(32) LaneBytes select{};
+            if (IsProgramAddress(programCounter) && programCounter <= LOCKSTEP_PROGRAM_UNIT.second - 2) {
+                for (size_t lane = 0; lane < Lanes; ++lane) {
+                    select[lane] = (ProgramCounter[lane] == programCounter && Budget[lane] > 0) ? 0xFF : 0x00;
+                }
+            } else {
+                select[leader] = 0xFF;
+            }
+            ExecuteGroup(programCounter, select, ToLaneMask(select));
+        }
+
+        for (size_t lane = 0; lane < Lanes; ++lane) {
+            TotalCycles[lane] += static_cast<uint64_t>(passCycles[lane] - Budget[lane]);
+        }
+    }
+}
+
+template <size_t Lanes>
+void
+LockstepCPU<Lanes>::ExecuteGroup(const Address programCounter, const LaneBytes& select, const LaneMask lanes)
+{
+    const size_t firstLane = FirstLane(lanes);
+    const Opcode opcode = ReadLane(firstLane, programCounter);
+    const Instruction& instruction = OPCODE_TABLE[opcode];
+    const uint8_t length = 1 + GetOperandLength(instruction.addressingMode);
+    uint16_t operandValue = 0;
+    if (length > 1) {
+        operandValue = ReadLane(firstLane, programCounter + 1);
+    }
+    if (length > 2) {
+        operandValue |= ReadLane(firstLane, programCounter + 2) << 8;
+    }
+    const Address nextProgramCounter = programCounter + length;
+
+    alignas(64) LaneArray<Address> nextProgramCounters;
+    nextProgramCounters.fill(nextProgramCounter);
+    alignas(32) LaneBytes cycles;
+    cycles.fill(instruction.cyclesCount);
+
+    Operand operand;
+    ResolveOperand(instruction.addressingMode, operandValue, lanes, operand);
+    if (instruction.hasPageCrossPenalty) {
+        for (size_t lane = 0; lane < Lanes; ++lane) {
+            cycles[lane] += operand.hasPageChanged[lane];
+        }
+    }
+
+    alignas(32) LaneBytes value{};
+    if (ReadsOperand(instruction.operation)) {
+        ReadOperand(operand, lanes, value);
+    }
+
+    alignas(32) LaneBytes result;
+    alignas(32) LaneBytes flag;
+    alignas(32) LaneBytes isTaken{};
+    switch (instruction.operation) {
+        case Operations::ADC:
+        case Operations::SBC: {
+            // SBC is ADC of the complement, which gives the same carry and overflow as CPU::SBC()
+            alignas(32) LaneBytes overflow;
+            const Byte complement = instruction.operation == Operations::SBC ? 0xFF : 0x00;
+            for (size_t lane = 0; lane < Lanes; ++lane) {
+                const Byte addend = value[lane] ^ complement;
+                const uint16_t sum = Accumulator[lane] + addend + CarryFlag[lane];
+                result[lane] = static_cast<Byte>(sum);
+                flag[lane] = static_cast<Byte>(sum >> 8);
+                overflow[lane] = static_cast<Byte>((~(Accumulator[lane] ^ addend) & (Accumulator[lane] ^ sum) & 0x80) >> 7);
+            }
+            Commit(Accumulator, result, select);
+            Commit(CarryFlag, flag, select);
+            Commit(OverflowFlag, overflow, select);
+            SetZeroAndNegativeFlags(result, select);
+            break;
+        }
+        case Operations::AND:
+        case Operations::EOR:
+        case Operations::ORA:
+            for (size_t lane = 0; lane < Lanes; ++lane) {
+                const Byte accumulator = Accumulator[lane];
+                result[lane] = instruction.operation == Operations::AND ? accumulator & value[lane]
+                    : instruction.operation == Operations::EOR ? accumulator ^ value[lane] : accumulator | value[lane];
+            }
+            Commit(Accumulator, result, select);
+            SetZeroAndNegativeFlags(result, select);
+            break;
+        case Operations::ASL:
+        case Operations::LSR:
+        case Operations::ROL:
+        case Operations::ROR: {
+            const bool isLeft = instruction.operation == Operations::ASL || instruction.operation == Operations::ROL;
+            const bool isRotate = instruction.operation == Operations::ROL || instruction.operation == Operations::ROR;
+            for (size_t lane = 0; lane < Lanes; ++lane) {
+                const Byte carryIn = isRotate ? CarryFlag[lane] : 0;
+                result[lane] = isLeft ? static_cast<Byte>((value[lane] << 1) | carryIn) : static_cast<Byte>((carryIn << 7) | (value[lane] >> 1));
+                flag[lane] = isLeft ? value[lane] >> 7 : value[lane] & 0x01;
+            }
+            Commit(CarryFlag, flag, select);
+            SetZeroAndNegativeFlags(result, select);
+            WriteOperand(operand, result, select, lanes);
+            break;
+        }
+        case Operations::BIT:
+            for (size_t lane = 0; lane < Lanes; ++lane) {
+                result[lane] = Accumulator[lane] & value[lane];
+                flag[lane] = (value[lane] >> 6) & 0x01;
+            }
+            Commit(ZeroResult, result, select);
+            Commit(NegativeResult, value, select);
+            Commit(OverflowFlag, flag, select);
+            break;
+        case Operations::CMP:
+        case Operations::CPX:
+        case Operations::CPY: {
+            const LaneBytes& compared = instruction.operation == Operations::CMP ? Accumulator
+                : instruction.operation == Operations::CPX ? X : Y;
+            for (size_t lane = 0; lane < Lanes; ++lane) {
+                result[lane] = static_cast<Byte>(compared[lane] - value[lane]);
+                flag[lane] = compared[lane] >= value[lane] ? 1 : 0;
+            }
+            Commit(CarryFlag, flag, select);
+            SetZeroAndNegativeFlags(result, select);
+            break;
+        }
+        case Operations::DEC:
+        case Operations::INC: {
+            const Byte step = instruction.operation == Operations::INC ? 0x01 : 0xFF;
+            for (size_t lane = 0; lane < Lanes; ++lane) {
+                result[lane] = static_cast<Byte>(value[lane] + step);
+            }
+            WriteOperand(operand, result, select, lanes);
+            SetZeroAndNegativeFlags(result, select);
+            break;
+        }
+        case Operations::DEX:
+        case Operations::DEY:
+        case Operations::INX:
+        case Operations::INY: {
+            LaneBytes& target = (instruction.operation == Operations::DEX || instruction.operation == Operations::INX) ? X : Y;
+            const Byte step = (instruction.operation == Operations::INX || instruction.operation == Operations::INY) ? 0x01 : 0xFF;
+            for (size_t lane = 0; lane < Lanes; ++lane) {
+                result[lane] = static_cast<Byte>(target[lane] + step);
+            }
+            Commit(target, result, select);
+            SetZeroAndNegativeFlags(result, select);
+            break;
+        }
+        case Operations::LDA:
+        case Operations::LDX:
+        case Operations::LDY: {
+            LaneBytes& target = instruction.operation == Operations::LDA ? Accumulator
+                : instruction.operation == Operations::LDX ? X : Y;
+            Commit(target, value, select);
+            SetZeroAndNegativeFlags(value, select);
+            break;
+        }
+        case Operations::STA: WriteOperand(operand, Accumulator, select, lanes); break;
+        case Operations::STX: WriteOperand(operand, X, select, lanes); break;
+        case Operations::STY: WriteOperand(operand, Y, select, lanes); break;
+        case Operations::TAX: Commit(X, Accumulator, select); SetZeroAndNegativeFlags(Accumulator, select); break;
+        case Operations::TAY: Commit(Y, Accumulator, select); SetZeroAndNegativeFlags(Accumulator, select); break;
+        case Operations::TSX: Commit(X, StackPointer, select); SetZeroAndNegativeFlags(StackPointer, select); break;
+        case Operations::TXA: Commit(Accumulator, X, select); SetZeroAndNegativeFlags(X, select); break;
+        case Operations::TXS: Commit(StackPointer, X, select); break;
+        case Operations::TYA: Commit(Accumulator, Y, select); SetZeroAndNegativeFlags(Y, select); break;
+        case Operations::CLC:
+        case Operations::SEC:
+            flag.fill(instruction.operation == Operations::SEC ? 1 : 0);
+            Commit(CarryFlag, flag, select);
+            break;
+        case Operations::CLV:
+            flag.fill(0);
+            Commit(OverflowFlag, flag, select);
+            break;
+        case Operations::CLD:
+        case Operations::CLI:
+        case Operations::SED:
+        case Operations::SEI: {
+            const Byte bit = (instruction.operation == Operations::CLD || instruction.operation == Operations::SED) ? StatusRegisterFlags::D : StatusRegisterFlags::I;
+            const bool isSet = instruction.operation == Operations::SED || instruction.operation == Operations::SEI;
+            for (size_t lane = 0; lane < Lanes; ++lane) {
+                result[lane] = isSet ? StatusRegister[lane] | bit : StatusRegister[lane] & ~bit;
+            }
+            Commit(StatusRegister, result, select);
+            break;
+        }
+        case Operations::BCC: for (size_t lane = 0; lane < Lanes; ++lane) { isTaken[lane] = CarryFlag[lane] == 0; } break;
+        case Operations::BCS: for (size_t lane = 0; lane < Lanes; ++lane) { isTaken[lane] = CarryFlag[lane] != 0; } break;
+        case Operations::BEQ: for (size_t lane = 0; lane < Lanes; ++lane) { isTaken[lane] = ZeroResult[lane] == 0; } break;
+        case Operations::BNE: for (size_t lane = 0; lane < Lanes; ++lane) { isTaken[lane] = ZeroResult[lane] != 0; } break;
+        case Operations::BMI: for (size_t lane = 0; lane < Lanes; ++lane) { isTaken[lane] = NegativeResult[lane] >> 7; } break;
+        case Operations::BPL: for (size_t lane = 0; lane < Lanes; ++lane) { isTaken[lane] = (NegativeResult[lane] >> 7) ^ 1; } break;
+        case Operations::BVC: for (size_t lane = 0; lane < Lanes; ++lane) { isTaken[lane] = OverflowFlag[lane] == 0; } break;
+        case Operations::BVS: for (size_t lane = 0; lane < Lanes; ++lane) { isTaken[lane] = OverflowFlag[lane] != 0; } break;
+        case Operations::JMP:
+            if (operand.kind == OperandKind::PerLane) {
+                nextProgramCounters = operand.addresses;
+            } else {
+                nextProgramCounters.fill(operandValue);
+            }
+            break;
+        case Operations::JSR:
+            for (LaneMask remaining = lanes; remaining != 0; remaining &= remaining - 1) {
+                const size_t lane = FirstLane(remaining);
+                const Address returnAddress = nextProgramCounter - 1;
+                Push(lane, returnAddress >> 8);
+                Push(lane, returnAddress & 0x00FF);
+            }
+            nextProgramCounters.fill(operandValue);
+            break;
+        case Operations::RTS:
+            for (LaneMask remaining = lanes; remaining != 0; remaining &= remaining - 1) {
+                const size_t lane = FirstLane(remaining);
+                const Byte low = Pull(lane);
+                nextProgramCounters[lane] = ((Pull(lane) << 8) | low) + 1;
+            }
+            break;
+        case Operations::RTI:
+            for (LaneMask remaining = lanes; remaining != 0; remaining &= remaining - 1) {
+                const size_t lane = FirstLane(remaining);
+                SetStatusRegister(lane, Pull(lane));
+                StatusRegister[lane] &= ~(StatusRegisterFlags::B | StatusRegisterFlags::U);
+                const Byte low = Pull(lane);
+                nextProgramCounters[lane] = (Pull(lane) << 8) | low;
+            }
+            break;
+        case Operations::BRK:
+            for (LaneMask remaining = lanes; remaining != 0; remaining &= remaining - 1) {
+                const size_t lane = FirstLane(remaining);
+                const Address returnAddress = nextProgramCounter + 1;
+                StatusRegister[lane] |= StatusRegisterFlags::I;
+                Push(lane, returnAddress >> 8);
+                Push(lane, returnAddress & 0x00FF);
+                StatusRegister[lane] |= StatusRegisterFlags::B;
+                Push(lane, GetStatusRegister(lane));
+                StatusRegister[lane] &= ~StatusRegisterFlags::B;
+                const Byte low = ReadLane(lane, 0xFFFE);
+                nextProgramCounters[lane] = low | (ReadLane(lane, 0xFFFF) << 8);
+            }
+            break;
+        case Operations::PHA:
+            for (LaneMask remaining = lanes; remaining != 0; remaining &= remaining - 1) {
+                const size_t lane = FirstLane(remaining);
+                Push(lane, Accumulator[lane]);
+            }
+            break;
+        case Operations::PHP:
+            for (LaneMask remaining = lanes; remaining != 0; remaining &= remaining - 1) {
+                const size_t lane = FirstLane(remaining);
+                Push(lane, GetStatusRegister(lane) | StatusRegisterFlags::B | StatusRegisterFlags::U);
+                StatusRegister[lane] &= ~(StatusRegisterFlags::B | StatusRegisterFlags::U);
+            }
+            break;
+        case Operations::PLA:
+            for (LaneMask remaining = lanes; remaining != 0; remaining &= remaining - 1) {
+                const size_t lane = FirstLane(remaining);
+                Accumulator[lane] = Pull(lane);
+                ZeroResult[lane] = Accumulator[lane];
+                NegativeResult[lane] = Accumulator[lane];
+            }
+            break;
+        case Operations::PLP:
+            for (LaneMask remaining = lanes; remaining != 0; remaining &= remaining - 1) {
+                const size_t lane = FirstLane(remaining);
+                SetStatusRegister(lane, Pull(lane));
+                StatusRegister[lane] |= StatusRegisterFlags::U;
+            }
+            break;
+        case Operations::NOP:
+        case Operations::XXX:
+            break;
+    }
+
+    if (instruction.addressingMode == AddressingModes::Relative) {
+        // Every lane in the group branches from the same address to the same target
+        const Address target = nextProgramCounter + static_cast<int8_t>(operandValue & 0x00FF);
+        const Byte takenCycles = ((target & 0xFF00) != (nextProgramCounter & 0xFF00)) ? 2 : 1;
+        for (size_t lane = 0; lane < Lanes; ++lane) {
+            nextProgramCounters[lane] = isTaken[lane] ? target : nextProgramCounter;
+            cycles[lane] += isTaken[lane] ? takenCycles : 0;
+        }
+    }
+
+    Commit(ProgramCounter, nextProgramCounters, select);
+    for (size_t lane = 0; lane < Lanes; ++lane) {
+        Budget[lane] -= select[lane] ? cycles[lane] : 0;
+    }
+    ++GroupsExecuted;
+    LaneInstructionsExecuted += static_cast<uint64_t>(__builtin_popcount(lanes));
+}
+
+template <size_t Lanes>
+void
+LockstepCPU<Lanes>::ResolveOperand(const AddressingModes::Mode mode, const uint16_t operandValue, const LaneMask lanes, Operand& operand)
+{
+    const Byte zeroPage = operandValue & 0x00FF;
+    operand.kind = OperandKind::Uniform;
+    operand.address = operandValue;
+    operand.hasPageChanged.fill(0);
+
+    switch (mode) {
+        case AddressingModes::Implicit:
+        case AddressingModes::Accumulator:
+            operand.kind = OperandKind::Accumulator;
+            break;
+        case AddressingModes::Immediate:
+            // The byte read with the opcode, as CPU::ImmediateMode() uses it
+            operand.kind = OperandKind::Immediate;
+            break;
+        case AddressingModes::Relative:
+            operand.kind = OperandKind::None;
+            break;
+        case AddressingModes::ZeroPage:
+            operand.address = zeroPage;
+            break;
+        case AddressingModes::Absolute:
+            break;
+        case AddressingModes::ZeroPageX:
+        case AddressingModes::ZeroPageY: {
+            const LaneBytes& index = mode == AddressingModes::ZeroPageX ? X : Y;
+            operand.kind = OperandKind::PerLane;
+            for (size_t lane = 0; lane < Lanes; ++lane) {
+                operand.addresses[lane] = (zeroPage + index[lane]) & 0x00FF;
+            }
+            break;
+        }
+        case AddressingModes::AbsoluteX:
+        case AddressingModes::AbsoluteY: {
+            const LaneBytes& index = mode == AddressingModes::AbsoluteX ? X : Y;
+            operand.kind = OperandKind::PerLane;
+            for (size_t lane = 0; lane < Lanes; ++lane) {
+                operand.addresses[lane] = operandValue + index[lane];
+                operand.hasPageChanged[lane] = (operand.addresses[lane] & 0xFF00) != (operandValue & 0xFF00);
+            }
+            break;
+        }
+        case AddressingModes::Indirect:
+            operand.kind = OperandKind::PerLane;
+            for (LaneMask remaining = lanes; remaining != 0; remaining &= remaining - 1) {
+                const size_t lane = FirstLane(remaining);
+                // Low byte first: the pointer may sit on a device that counts reads
+                const Byte low = ReadLane(lane, operandValue);
+                operand.addresses[lane] = low | (ReadLane(lane, operandValue + 1) << 8);
+            }
+            break;
+        case AddressingModes::IndirectX:
+            operand.kind = OperandKind::PerLane;
+            for (size_t lane = 0; lane < Lanes; ++lane) {
+                const Byte pointer = static_cast<Byte>(zeroPage + X[lane]);
+                operand.addresses[lane] = Ram[pointer][lane] | (Ram[static_cast<Byte>(pointer + 1)][lane] << 8);
+            }
+            break;
+        case AddressingModes::IndirectY: {
+            // The pointer sits at the same zero-page address in every lane
+            const LaneBytes& low = Ram[zeroPage];
+            const LaneBytes& high = Ram[static_cast<Byte>(zeroPage + 1)];
+            operand.kind = OperandKind::PerLane;
+            for (size_t lane = 0; lane < Lanes; ++lane) {
+                operand.addresses[lane] = ((high[lane] << 8) | low[lane]) + Y[lane];
+                operand.hasPageChanged[lane] = (operand.addresses[lane] & 0xFF00) != (high[lane] << 8);
+            }
+            break;
+        }
+    }
+}
+
+template <size_t Lanes>
+void
+LockstepCPU<Lanes>::ReadOperand(const Operand& operand, const LaneMask lanes, LaneBytes& value)
+{
+    switch (operand.kind) {
+        case OperandKind::None:
+            break;
+        case OperandKind::Accumulator:
+            value = Accumulator;
+            break;
+        case OperandKind::Immediate:
+            value.fill(static_cast<Byte>(operand.address));
+            break;
+        case OperandKind::Uniform:
+            if (IsRamAddress(operand.address)) {
+                value = Ram[operand.address & (MEMORY_SIZE - 1)];
+            } else if (IsProgramAddress(operand.address)) {
+                value.fill(Program[operand.address - LOCKSTEP_PROGRAM_UNIT.first]);
+            } else {
+                for (LaneMask remaining = lanes; remaining != 0; remaining &= remaining - 1) {
+                    const size_t lane = FirstLane(remaining);
+                    value[lane] = ReadLane(lane, operand.address);
+                }
+            }
+            break;
+        case OperandKind::PerLane:
+            for (LaneMask remaining = lanes; remaining != 0; remaining &= remaining - 1) {
+                const size_t lane = FirstLane(remaining);
+                value[lane] = ReadLane(lane, operand.addresses[lane]);
+            }
+            break;
+    }
+}
+
+template <size_t Lanes>
+void
+LockstepCPU<Lanes>::WriteOperand(const Operand& operand, const LaneBytes& value, const LaneBytes& select, const LaneMask lanes)
+{
+    switch (operand.kind) {
+        case OperandKind::None:
+        case OperandKind::Immediate:
+            break;
+        case OperandKind::Accumulator:
+            Commit(Accumulator, value, select);
+            break;
+        case OperandKind::Uniform:
+            if (IsRamAddress(operand.address)) {
+                Commit(Ram[operand.address & (MEMORY_SIZE - 1)], value, select);
+            } else {
+                for (LaneMask remaining = lanes; remaining != 0; remaining &= remaining - 1) {
+                    const size_t lane = FirstLane(remaining);
+                    WriteLane(lane, operand.address, value[lane]);
+                }
+            }
+            break;
+        case OperandKind::PerLane:
+            for (LaneMask remaining = lanes; remaining != 0; remaining &= remaining - 1) {
+                const size_t lane = FirstLane(remaining);
+                WriteLane(lane, operand.addresses[lane], value[lane]);
+            }
+            break;
+    }
+}
+
+template <size_t Lanes>
+void
+LockstepCPU<Lanes>::SetZeroAndNegativeFlags(const LaneBytes& result, const LaneBytes& select)
+{
+    Commit(ZeroResult, result, select);
+    Commit(NegativeResult, result, select);
+}
+
+template <size_t Lanes>
+Byte
+LockstepCPU<Lanes>::ReadLane(const size_t lane, const Address address)
+{
+    if (IsRamAddress(address)) {
+        return Ram[address & (MEMORY_SIZE - 1)][lane];
+    }
+    if (IsProgramAddress(address)) {
+        return Program[address - LOCKSTEP_PROGRAM_UNIT.first];
+    }
+    Bus* bus = LaneBuses[lane];
+    return bus != nullptr ? bus->Read(address) : 0x00; // Open bus
+}
+
+template <size_t Lanes>
+void
+LockstepCPU<Lanes>::WriteLane(const size_t lane, const Address address, const Byte data)
+{
+    if (IsRamAddress(address)) {
+        Ram[address & (MEMORY_SIZE - 1)][lane] = data;
+        return;
+    }
+    // Writes into the program space still reach the lane's mapper ports
+    Bus* bus = LaneBuses[lane];
+    if (bus != nullptr) {
+        bus->Write(address, data);
+    }
+}
+
+template <size_t Lanes>
+Byte
+LockstepCPU<Lanes>::GetStatusRegister(const size_t lane) const
+{
+    constexpr Byte storedFlags = StatusRegisterFlags::I | StatusRegisterFlags::D | StatusRegisterFlags::B | StatusRegisterFlags::U;
+    return (StatusRegister[lane] & storedFlags)
+        | (CarryFlag[lane] ? StatusRegisterFlags::C : 0)
+        | (ZeroResult[lane] == 0 ? StatusRegisterFlags::Z : 0)
+        | (OverflowFlag[lane] ? StatusRegisterFlags::V : 0)
+        | (NegativeResult[lane] & StatusRegisterFlags::N);
+}
+
+template <size_t Lanes>
+void
+LockstepCPU<Lanes>::SetStatusRegister(const size_t lane, const Byte status)
+{
+    StatusRegister[lane] = status;
+    CarryFlag[lane] = (status & StatusRegisterFlags::C) ? 1 : 0;
+    ZeroResult[lane] = (status & StatusRegisterFlags::Z) ? 0x00 : 0x01;
+    OverflowFlag[lane] = (status & StatusRegisterFlags::V) ? 1 : 0;
+    NegativeResult[lane] = status;
+}
+
+template <size_t Lanes>
+typename LockstepCPU<Lanes>::LaneMask
+LockstepCPU<Lanes>::ToLaneMask(const LaneBytes& bytes)
+{
+    return MoveMask(bytes);
+}
+
+template class LockstepCPU<8>;
+template class LockstepCPU<16>;
+template class LockstepCPU<32>;
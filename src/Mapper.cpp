@@ -0,0 +1,107 @@
+#include "../include/Mapper.hpp"
+
+#include <cstring>
+
+#include "../include/Mappers.hpp"
+
+namespace {
+    size_t WrapBank(const int bank, const size_t numberOfBanks)
+    {
+        const int count = static_cast<int>(numberOfBanks);
+        return static_cast<size_t>(((bank % count) + count) % count);
+    }
+
+    // The Bus hands out RAM a 256-byte page at a time and the PPU a 1 KB pattern slot
+    // at a time, so NES 2.0 sizes like 128 bytes are rounded up to whole windows.
+    size_t RoundUpToWindow(const size_t size, const size_t windowSize)
+    {
+        return (size + windowSize - 1) / windowSize * windowSize;
+    }
+}
+
+Mapper::Mapper(const Cartridge& cartridge, Bus& bus, PPU& ppu)
+    : ConnectedCartridge(cartridge), ConnectedBus(bus), ConnectedPPU(ppu)
+{
+    PrgRam.assign(RoundUpToWindow(cartridge.GetPrgRamSize(), BUS_PAGE_SIZE), 0x00);
+    if (cartridge.GetChrRomSize() == 0) {
+        const size_t chrRamSize = cartridge.GetChrRamSize() != 0 ? cartridge.GetChrRamSize() : CHR_ROM_UNIT_SIZE;
+        ChrRam.assign(RoundUpToWindow(chrRamSize, CHR_BANK_UNIT_SIZE), 0x00);
+    }
+}
+
+std::unique_ptr<Mapper>
+Mapper::Create(const Cartridge& cartridge, Bus& bus, PPU& ppu)
+{
+    if (!cartridge.IsLoaded()) {
+        return nullptr;
+    }
+
+    switch (cartridge.GetMapperNumber()) {
+        case 0: return std::make_unique<NROM>(cartridge, bus, ppu);
+        case 1: return std::make_unique<MMC1>(cartridge, bus, ppu);
+        case 2: return std::make_unique<UxROM>(cartridge, bus, ppu);
+        case 3: return std::make_unique<CNROM>(cartridge, bus, ppu);
+        case 4: return std::make_unique<MMC3>(cartridge, bus, ppu);
+        default: return nullptr;
+    }
+}
+
+void
+Mapper::Reset()
+{
+    if (!PrgRam.empty()) {
+        ConnectedBus.MapMemory(PRG_RAM_UNIT.first, PRG_RAM_UNIT.second, PrgRam.data(), PrgRam.size());
+        if (ConnectedCartridge.GetTrainer() != nullptr && PrgRam.size() >= PRG_RAM_UNIT_SIZE) {
+            std::memcpy(PrgRam.data() + (TRAINER_ADDRESS - PRG_RAM_UNIT.first), ConnectedCartridge.GetTrainer(), INES_TRAINER_SIZE);
+        }
+    }
+
+    MapPrgBank(PRG_ROM_UNIT.first, PRG_ROM_UNIT.second - PRG_ROM_UNIT.first + 1, 0);
+    MapChrBank(0, PPU_GRAPHICS_SIZE * 2, 0);
+
+    if (ConnectedCartridge.IsFourScreen()) {
+        for (size_t slot = 0; slot < NUMBER_OF_NAMETABLES; ++slot) {
+            ConnectedPPU.SetNametableBank(slot, FourScreenVram.data() + slot * PPU_NAMETABLE_SIZE);
+        }
+    } else {
+        ConnectedPPU.SetMirroring(ConnectedCartridge.GetMirroring());
+    }
+}
+
+void
+Mapper::MapPrgBank(const Address first, const size_t size, const int bank)
+{
+    // ROMs smaller than the window are mirrored across it by the bus
+    const size_t romSize = ConnectedCartridge.GetPrgRomSize();
+    const size_t numberOfBanks = romSize >= size ? romSize / size : 1;
+    const size_t index = WrapBank(bank, numberOfBanks);
+    const size_t bankSize = romSize >= size ? size : romSize;
+    ConnectedBus.MapReadOnlyMemory(first, static_cast<Address>(first + size - 1), ConnectedCartridge.GetPrgRom() + index * bankSize, bankSize);
+}
+
+void
+Mapper::MapChrBank(const size_t slot, const size_t size, const int bank)
+{
+    const bool hasChrRom = ConnectedCartridge.GetChrRomSize() != 0;
+    const size_t chrSize = hasChrRom ? ConnectedCartridge.GetChrRomSize() : ChrRam.size();
+    const size_t numberOfBanks = chrSize >= size ? chrSize / size : 1;
+    const size_t index = WrapBank(bank, numberOfBanks);
+
+    for (size_t offset = 0; offset < size; offset += CHR_BANK_UNIT_SIZE) {
+        const size_t chrOffset = (index * size + offset) % chrSize;
+        const size_t patternSlot = slot + offset / CHR_BANK_UNIT_SIZE;
+        if (hasChrRom) {
+            ConnectedPPU.SetPatternBank(patternSlot, ConnectedCartridge.GetChrRom() + chrOffset);
+        } else {
+            ConnectedPPU.SetWritablePatternBank(patternSlot, ChrRam.data() + chrOffset);
+        }
+    }
+}
+
+void
+Mapper::SetMirroring(const NametableMirroring::Mode mode)
+{
+    if (!ConnectedCartridge.IsFourScreen()) {
+        ConnectedPPU.SetMirroring(mode);
+    }
+}
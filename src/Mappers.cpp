@@ -0,0 +1,197 @@
+#include "../include/Mappers.hpp"
+
+void
+MMC1::Reset()
+{
+    Mapper::Reset();
+    ShiftRegister = 0x10;
+    ControlRegister = 0x0C;
+    ChrBank0 = 0x00;
+    ChrBank1 = 0x00;
+    PrgBank = 0x00;
+    UpdateBanks();
+}
+
+void
+MMC1::Write(const Address address, const Byte data)
+{
+    if (data & 0x80) {
+        ShiftRegister = 0x10;
+        ControlRegister |= 0x0C;
+        UpdateBanks();
+        return;
+    }
+
+    const bool isComplete = ShiftRegister & 0x01;
+    ShiftRegister = (ShiftRegister >> 1) | ((data & 0x01) << 4);
+    if (!isComplete) {
+        return;
+    }
+
+    switch ((address >> 13) & 0x03) {
+        case 0: ControlRegister = ShiftRegister; break;
+        case 1: ChrBank0 = ShiftRegister; break;
+        case 2: ChrBank1 = ShiftRegister; break;
+        case 3: PrgBank = ShiftRegister; break;
+    }
+    ShiftRegister = 0x10;
+    UpdateBanks();
+}
+
+void
+MMC1::UpdateBanks()
+{
+    switch (ControlRegister & 0x03) {
+        case 0: SetMirroring(NametableMirroring::SingleScreenLow); break;
+        case 1: SetMirroring(NametableMirroring::SingleScreenHigh); break;
+        case 2: SetMirroring(NametableMirroring::Vertical); break;
+        case 3: SetMirroring(NametableMirroring::Horizontal); break;
+    }
+
+    // 512 KB boards (SUROM) pick the 256 KB half with bit 4 of the CHR register
+    const int outerBank = (ConnectedCartridge.GetPrgRomSize() > 0x40000) ? (ChrBank0 & 0x10) : 0;
+    const int lastBank = outerBank | 0x0F;
+    switch ((ControlRegister >> 2) & 0x03) {
+        case 0:
+        case 1:
+            MapPrgBank(PRG_ROM_UNIT.first, PRG_BANK_32K, (outerBank | (PrgBank & 0x0E)) >> 1);
+            break;
+        case 2:
+            MapPrgBank(0x8000, PRG_BANK_16K, outerBank);
+            MapPrgBank(0xC000, PRG_BANK_16K, outerBank | (PrgBank & 0x0F));
+            break;
+        case 3:
+            MapPrgBank(0x8000, PRG_BANK_16K, outerBank | (PrgBank & 0x0F));
+            MapPrgBank(0xC000, PRG_BANK_16K, lastBank);
+            break;
+    }
+
+    if (ControlRegister & 0x10) {
+        MapChrBank(0, CHR_BANK_4K, ChrBank0);
+        MapChrBank(4, CHR_BANK_4K, ChrBank1);
+    } else {
+        MapChrBank(0, CHR_BANK_8K, ChrBank0 >> 1);
+    }
+}
+
+void
+UxROM::Reset()
+{
+    Mapper::Reset();
+    MapPrgBank(0x8000, PRG_BANK_16K, 0);
+    MapPrgBank(0xC000, PRG_BANK_16K, -1);
+}
+
+void
+UxROM::Write(const Address, const Byte data)
+{
+    MapPrgBank(0x8000, PRG_BANK_16K, data);
+}
+
+void
+CNROM::Write(const Address, const Byte data)
+{
+    MapChrBank(0, CHR_BANK_8K, data);
+}
+
+void
+MMC3::Reset()
+{
+    Mapper::Reset();
+    BankSelect = 0x00;
+    BankRegisters = { 0, 2, 4, 5, 6, 7, 0, 1 };
+    IrqLatch = 0x00;
+    IrqCounter = 0x00;
+    IrqReload = false;
+    IrqEnabled = false;
+    IrqAsserted = false;
+    ConnectedPPU.ConnectScanlineCounter(this);
+    UpdateBanks();
+}
+
+void
+MMC3::Write(const Address address, const Byte data)
+{
+    switch (address & 0xE001) {
+        case 0x8000:
+            BankSelect = data;
+            UpdateBanks();
+            break;
+        case 0x8001:
+            BankRegisters[BankSelect & 0x07] = data;
+            UpdateBanks();
+            break;
+        case 0xA000:
+            SetMirroring((data & 0x01) ? NametableMirroring::Horizontal : NametableMirroring::Vertical);
+            break;
+        case 0xA001:
+            break; // PRG-RAM protect; left writable like most emulators
+        case 0xC000:
+            IrqLatch = data;
+            break;
+        case 0xC001:
+            IrqCounter = 0x00;
+            IrqReload = true;
+            break;
+        case 0xE000:
+            IrqEnabled = false;
+            IrqAsserted = false; // Disabling also acknowledges
+            break;
+        case 0xE001:
+            IrqEnabled = true;
+            break;
+    }
+}
+
+void
+MMC3::ClockScanline()
+{
+    if (IrqCounter == 0 || IrqReload) {
+        IrqCounter = IrqLatch;
+        IrqReload = false;
+    } else {
+        --IrqCounter;
+    }
+
+    if (IrqCounter == 0 && IrqEnabled) {
+        IrqAsserted = true;
+    }
+}
+
+uint64_t
+MMC3::GetNextEventCycle() const
+{
+    if (!IrqEnabled || IrqAsserted) {
+        return NO_PENDING_EVENT;
+    }
+
+    // Scanlines until the counter next lands on zero: a reload costs one clock first
+    uint32_t clocks = IrqCounter;
+    if (IrqCounter == 0 || IrqReload) {
+        clocks = IrqLatch == 0 ? 1 : IrqLatch + 1;
+    }
+    return ConnectedPPU.GetScanlineClockCycle(clocks);
+}
+
+void
+MMC3::UpdateBanks()
+{
+    if (BankSelect & 0x40) {
+        MapPrgBank(0x8000, PRG_BANK_8K, -2);
+        MapPrgBank(0xC000, PRG_BANK_8K, BankRegisters[6] & 0x3F);
+    } else {
+        MapPrgBank(0x8000, PRG_BANK_8K, BankRegisters[6] & 0x3F);
+        MapPrgBank(0xC000, PRG_BANK_8K, -2);
+    }
+    MapPrgBank(0xA000, PRG_BANK_8K, BankRegisters[7] & 0x3F);
+    MapPrgBank(0xE000, PRG_BANK_8K, -1);
+
+    // Bit 7 swaps the 2 KB and 1 KB halves of the pattern tables
+    const size_t twoKilobyteSlot = (BankSelect & 0x80) ? 4 : 0;
+    const size_t oneKilobyteSlot = (BankSelect & 0x80) ? 0 : 4;
+    MapChrBank(twoKilobyteSlot, CHR_BANK_2K, BankRegisters[0] >> 1);
+    MapChrBank(twoKilobyteSlot + 2, CHR_BANK_2K, BankRegisters[1] >> 1);
+    for (size_t index = 0; index < 4; ++index) {
+        MapChrBank(oneKilobyteSlot + index, CHR_BANK_1K, BankRegisters[2 + index]);
+    }
+}
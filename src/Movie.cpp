@@ -0,0 +1,180 @@
+#include "../include/Movie.hpp"
+
+#include "../include/SaveState.hpp"
+#include "../include/System.hpp"
+
+namespace {
+    constexpr uint32_t FNV_OFFSET_BASIS = 2166136261u;
+    constexpr uint32_t FNV_PRIME = 16777619u;
+
+    uint32_t HashBytes(uint32_t hash, const Byte* data, const size_t size)
+    {
+        for (size_t index = 0; index < size; ++index) {
+            hash = (hash ^ data[index]) * FNV_PRIME;
+        }
+        return hash;
+    }
+}
+
+uint32_t
+HashSystemState(System& system)
+{
+    SaveState state;
+    state.Capture(system.GetCPU(), system.GetBus());
+
+    // Scratch left over from the last instruction depends on how it was run (the
+    // interpreter, the JIT or a skipped idle loop), not on where the game is
+    state.cpu.absoluteAddress = 0x0000;
+    state.cpu.relativeAddress = 0x0000;
+    state.cpu.temporaryStorage = 0x0000;
+    state.cpu.fetchedData = 0x00;
+    state.cpu.currentOpcode = 0x00;
+    uint32_t hash = HashBytes(FNV_OFFSET_BASIS, state.GetData(), SaveState::GetSize());
+
+    if (Mapper* mapper = system.GetMapper()) {
+        hash = HashBytes(hash, mapper->GetPrgRam(), mapper->GetPrgRamSize());
+    }
+    return hash;
+}
+
+bool
+MovieRecorder::Open(const char* path)
+{
+    Close();
+    File = std::fopen(path, "wb");
+    if (File == nullptr) {
+        return false;
+    }
+
+    InitialStateHash = HashSystemState(ConnectedSystem);
+    const MovieFileHeader header = { 0, MOVIE_FILE_MAGIC, MOVIE_FILE_VERSION, 0, InitialStateHash, 0 };
+    IsWritten = std::fwrite(&header, sizeof(header), 1, File) == 1;
+    RunLength = 0;
+    FrameCount = 0;
+    return IsWritten;
+}
+
+bool
+MovieRecorder::Close()
+{
+    if (File == nullptr) {
+        return false;
+    }
+    if (RunLength > 0) {
+        WriteRun();
+    }
+
+    const MovieFileHeader header = { FrameCount, MOVIE_FILE_MAGIC, MOVIE_FILE_VERSION, 0, InitialStateHash, 0 };
+    IsWritten = IsWritten && std::fseek(File, 0, SEEK_SET) == 0
+        && std::fwrite(&header, sizeof(header), 1, File) == 1;
+    const bool isClosed = std::fclose(File) == 0;
+    File = nullptr;
+    return isClosed && IsWritten;
+}
+
+bool
+MovieRecorder::RunFrame(const Byte port1, const Byte port2)
+{
+    if (File == nullptr) {
+        return false;
+    }
+
+    ConnectedSystem.GetController(0).SetButtons(port1);
+    ConnectedSystem.GetController(1).SetButtons(port2);
+    ConnectedSystem.RunFrame();
+
+    if (RunLength > 0 && (RunLength == MAXIMUM_MOVIE_RUN || port1 != RunButtons[0] || port2 != RunButtons[1])) {
+        WriteRun();
+    }
+    RunButtons = { port1, port2 };
+    RunHashes[RunLength++] = HashSystemState(ConnectedSystem);
+    ++FrameCount;
+    return IsWritten;
+}
+
+bool
+MovieRecorder::WriteRun()
+{
+    const Byte run[] = { static_cast<Byte>(RunLength - 1), RunButtons[0], RunButtons[1] };
+    IsWritten = IsWritten && std::fwrite(run, sizeof(run), 1, File) == 1
+        && std::fwrite(RunHashes.data(), sizeof(uint32_t), RunLength, File) == RunLength;
+    RunLength = 0;
+    return IsWritten;
+}
+
+bool
+MoviePlayer::Open(const char* path)
+{
+    Close();
+    File = std::fopen(path, "rb");
+    if (File == nullptr) {
+        return false;
+    }
+
+    const bool isOpened = std::fread(&Header, sizeof(Header), 1, File) == 1
+        && Header.magic == MOVIE_FILE_MAGIC && Header.version == MOVIE_FILE_VERSION
+        && Header.initialStateHash == HashSystemState(ConnectedSystem);
+    if (!isOpened) {
+        Close();
+        return false;
+    }
+    RunFramesLeft = 0;
+    FrameCount = 0;
+    return true;
+}
+
+void
+MoviePlayer::Close()
+{
+    if (File != nullptr) {
+        std::fclose(File);
+        File = nullptr;
+    }
+}
+
+MovieStatus::Status
+MoviePlayer::RunFrame()
+{
+    if (File == nullptr) {
+        return MovieStatus::Failed;
+    }
+    if (FrameCount == Header.frameCount) {
+        return MovieStatus::Finished;
+    }
+
+    if (RunFramesLeft == 0) {
+        Byte run[3];
+        if (std::fread(run, sizeof(run), 1, File) != 1) {
+            return MovieStatus::Failed;
+        }
+        RunFramesLeft = static_cast<size_t>(run[0]) + 1;
+        RunButtons = { run[1], run[2] };
+    }
+
+    uint32_t recordedHash;
+    if (std::fread(&recordedHash, sizeof(recordedHash), 1, File) != 1) {
+        return MovieStatus::Failed;
+    }
+    ConnectedSystem.GetController(0).SetButtons(RunButtons[0]);
+    ConnectedSystem.GetController(1).SetButtons(RunButtons[1]);
+    ConnectedSystem.RunFrame();
+    --RunFramesLeft;
+    ++FrameCount;
+    return HashSystemState(ConnectedSystem) == recordedHash ? MovieStatus::Running : MovieStatus::Diverged;
+}
+
+MovieStatus::Status
+MoviePlayer::Play()
+{
+    PPU& ppu = ConnectedSystem.GetPPU();
+    const bool wasSkippingFrames = ppu.IsFrameSkippingEnabled();
+    ppu.SetFrameSkipping(true);
+
+    MovieStatus::Status status;
+    do {
+        status = RunFrame();
+    } while (status == MovieStatus::Running);
+
+    ppu.SetFrameSkipping(wasSkippingFrames);
+    return status;
+}
@@ -0,0 +1,67 @@
+#include "../include/OutputPipeline.hpp"
+
+Byte*
+OutputPipeline::PublishFrame()
+{
+    // The frame number is written before the release exchange that hands the slot over
+    const uint64_t frameNumber = FramesPublished.load(std::memory_order_relaxed) + 1;
+    FrameNumbers[BackIndex] = frameNumber;
+    FramesPublished.store(frameNumber, std::memory_order_relaxed);
+
+    const uint8_t previous = MiddleSlot.exchange(BackIndex | FRESH_FRAME, std::memory_order_acq_rel);
+    if (previous & FRESH_FRAME) {
+        FramesDropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    BackIndex = previous & ~FRESH_FRAME;
+    return Frames[BackIndex].data();
+}
+
+void
+OutputPipeline::WriteSamples(const int16_t* samples, const size_t count)
+{
+    const size_t accepted = Audio.Write(samples, count);
+    SamplesWritten.fetch_add(accepted, std::memory_order_relaxed);
+    if (accepted < count) {
+        SamplesDropped.fetch_add(count - accepted, std::memory_order_relaxed);
+    }
+}
+
+bool
+OutputPipeline::AcquireFrame()
+{
+    if (!(MiddleSlot.load(std::memory_order_relaxed) & FRESH_FRAME)) {
+        FramesLate.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // Only the producer can change the slot in between, and it only ever leaves a
+    // fresh frame there, so the exchange always takes one
+    const uint8_t previous = MiddleSlot.exchange(FrontIndex, std::memory_order_acq_rel);
+    FrontIndex = previous & ~FRESH_FRAME;
+    FramesPresented.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+size_t
+OutputPipeline::ReadSamples(int16_t* samples, const size_t count)
+{
+    const size_t samplesRead = Audio.Read(samples, count);
+    if (samplesRead < count) {
+        AudioUnderruns.fetch_add(1, std::memory_order_relaxed);
+    }
+    return samplesRead;
+}
+
+OutputStatistics
+OutputPipeline::GetStatistics() const
+{
+    OutputStatistics statistics;
+    statistics.framesPublished = FramesPublished.load(std::memory_order_relaxed);
+    statistics.framesPresented = FramesPresented.load(std::memory_order_relaxed);
+    statistics.framesDropped = FramesDropped.load(std::memory_order_relaxed);
+    statistics.framesLate = FramesLate.load(std::memory_order_relaxed);
+    statistics.samplesWritten = SamplesWritten.load(std::memory_order_relaxed);
+    statistics.samplesDropped = SamplesDropped.load(std::memory_order_relaxed);
+    statistics.audioUnderruns = AudioUnderruns.load(std::memory_order_relaxed);
+    return statistics;
+}
@@ -0,0 +1,866 @@
+#include "../include/PPU.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+    // Expands one row of a 2bpp tile into eight pixels, leftmost first, with the
+    // attribute palette in bits 2-3.
+    inline void DecodeTileRow(const Byte lowPlane, const Byte highPlane, const Byte palette, Byte* output)
+    {
+#if defined(__SSE2__)
+        const __m128i bitMasks = _mm_setr_epi8(
+            static_cast<char>(0x80), 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01,
+            static_cast<char>(0x80), 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01);
+        const __m128i low = _mm_cmpeq_epi8(_mm_and_si128(_mm_set1_epi8(static_cast<char>(lowPlane)), bitMasks), bitMasks);
+        const __m128i high = _mm_cmpeq_epi8(_mm_and_si128(_mm_set1_epi8(static_cast<char>(highPlane)), bitMasks), bitMasks);
+        const __m128i pixels = _mm_or_si128(
+            _mm_or_si128(_mm_and_si128(low, _mm_set1_epi8(0x01)), _mm_and_si128(high, _mm_set1_epi8(0x02))),
+            _mm_set1_epi8(static_cast<char>(palette << 2)));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(output), pixels);
+#else
+        for (int pixel = 0; pixel < 8; ++pixel) {
+            const int shift = 7 - pixel;
+            output[pixel] = static_cast<Byte>((palette << 2) | (((highPlane >> shift) & 1) << 1) | ((lowPlane >> shift) & 1));
+        }
+#endif
+    }
+
+    inline Byte ReverseBits(Byte value)
+    {
+        value = static_cast<Byte>((value & 0xF0) >> 4 | (value & 0x0F) << 4);
+        value = static_cast<Byte>((value & 0xCC) >> 2 | (value & 0x33) << 2);
+        value = static_cast<Byte>((value & 0xAA) >> 1 | (value & 0x55) << 1);
+        return value;
+    }
+
+    inline Byte MergePixel(const Byte background, const Byte sprite, const Byte behind)
+    {
+        const bool backgroundOpaque = (background & 0x03) != 0;
+        const bool spriteOpaque = (sprite & 0x03) != 0;
+        if (spriteOpaque && (!backgroundOpaque || !behind)) {
+            return sprite;
+        }
+        return backgroundOpaque ? background : 0x00;
+    }
+}
+
+PPU::PPU()
+{
+    for (size_t bank = 0; bank < NUMBER_OF_PATTERN_BANKS; ++bank) {
+        SetWritablePatternBank(bank, ChrRam.data() + bank * PPU_PATTERN_BANK_SIZE);
+    }
+    SetMirroring(NametableMirroring::Horizontal);
+}
+
+void
+PPU::Reset()
+{
+    ControlRegister = 0x00;
+    MaskRegister = 0x00;
+    StatusRegister = 0x00;
+    DataBuffer = 0x00;
+    WriteToggle = false;
+    Scanline = 0;
+    Dot = 0;
+    OddFrame = false;
+    NmiOccurred = false;
+    RenderedX = 0;
+    SpriteLineReady = false;
+    LineSpriteCount = 0;
+}
+
+void
+PPU::SetPatternBank(const size_t slot, const Byte* memory)
+{
+    PatternBanks[slot] = memory;
+    WritablePatternBanks[slot] = nullptr;
+}
+
+void
+PPU::SetWritablePatternBank(const size_t slot, Byte* memory)
+{
+    PatternBanks[slot] = memory;
+    WritablePatternBanks[slot] = memory;
+}
+
+void
+PPU::SetNametableBank(const size_t slot, Byte* memory)
+{
+    NametableBanks[slot] = memory;
+}
+
+void
+PPU::SetMirroring(const NametableMirroring::Mode mode)
+{
+    Byte* first = Vram.data();
+    Byte* second = Vram.data() + PPU_NAMETABLE_SIZE;
+    switch (mode) {
+        case NametableMirroring::Horizontal:
+            NametableBanks = { first, first, second, second };
+            break;
+        case NametableMirroring::Vertical:
+            NametableBanks = { first, second, first, second };
+            break;
+        case NametableMirroring::SingleScreenLow:
+            NametableBanks = { first, first, first, first };
+            break;
+        case NametableMirroring::SingleScreenHigh:
+            NametableBanks = { second, second, second, second };
+            break;
+    }
+}
+
+void
+PPU::ConnectFrameSink(FrameSink* sink)
+{
+    ConnectedFrameSink = sink;
+    FrameTarget = sink != nullptr ? sink->GetBackBuffer() : FrameBuffer.data();
+}
+
+bool
+PPU::PollNonMaskableInterrupt()
+{
+    const bool occurred = NmiOccurred;
+    NmiOccurred = false;
+    return occurred;
+}
+
+bool
+PPU::PollFrameComplete()
+{
+    const bool complete = FrameComplete;
+    FrameComplete = false;
+    return complete;
+}
+
+Byte
+PPU::Read(const Address address)
+{
+    Byte data = 0x00;
+    switch (address & 0x0007) {
+        case PPURegisters::Status:
+            CatchUpRendering(); // Sprite 0 hit depends on the pixels drawn so far
+            data = (StatusRegister & 0xE0) | (DataBuffer & 0x1F);
+            StatusRegister &= ~0x80;
+            WriteToggle = false;
+            break;
+        case PPURegisters::OamData:
+            data = Oam[OamAddressRegister];
+            break;
+        case PPURegisters::Data:
+            data = DataBuffer;
+            DataBuffer = ReadMemory(VramAddress);
+            // Palette reads are not buffered
+            if ((VramAddress & 0x3FFF) >= PPU_PALLETES_UNIT.first) {
+                data = DataBuffer;
+                DataBuffer = ReadMemory(VramAddress - 0x1000);
+            }
+            VramAddress = (VramAddress + ((ControlRegister & 0x04) ? 32 : 1)) & 0x7FFF;
+            break;
+        default:
+            break;
+    }
+    return data;
+}
+
+void
+PPU::Write(const Address address, const Byte data)
+{
+    const uint8_t reg = address & 0x0007;
+    if (reg != PPURegisters::OamAddress && reg != PPURegisters::OamData) {
+        CatchUpRendering();
+    }
+
+    switch (reg) {
+        case PPURegisters::Control: {
+            const bool nmiWasEnabled = ControlRegister & 0x80;
+            ControlRegister = data;
+            TemporaryVramAddress = (TemporaryVramAddress & 0xF3FF) | ((data & 0x03) << 10);
+            // Enabling NMI while the vblank flag is still set raises one immediately
+            if (!nmiWasEnabled && (data & 0x80) && (StatusRegister & 0x80)) {
+                NmiOccurred = true;
+            }
+            break;
+        }
+        case PPURegisters::Mask:
+            MaskRegister = data;
+            break;
+        case PPURegisters::OamAddress:
+            OamAddressRegister = data;
+            break;
+        case PPURegisters::OamData:
+            Oam[OamAddressRegister++] = data;
+            break;
+        case PPURegisters::Scroll:
+            if (!WriteToggle) {
+                TemporaryVramAddress = (TemporaryVramAddress & 0xFFE0) | (data >> 3);
+                FineX = data & 0x07;
+            } else {
+                TemporaryVramAddress = (TemporaryVramAddress & 0x8C1F) | ((data & 0x07) << 12) | ((data & 0xF8) << 2);
+            }
+            WriteToggle = !WriteToggle;
+            break;
+        case PPURegisters::Address:
+            if (!WriteToggle) {
+                TemporaryVramAddress = (TemporaryVramAddress & 0x00FF) | ((data & 0x3F) << 8);
+            } else {
+                TemporaryVramAddress = (TemporaryVramAddress & 0xFF00) | data;
+                VramAddress = TemporaryVramAddress;
+            }
+            WriteToggle = !WriteToggle;
+            break;
+        case PPURegisters::Data:
+            WriteMemory(VramAddress, data);
+            VramAddress = (VramAddress + ((ControlRegister & 0x04) ? 32 : 1)) & 0x7FFF;
+            break;
+        default:
+            break;
+    }
+}
+
+uint64_t
+PPU::GetStableReadCycle(const Address address)
+{
+    // Only $2002 is polled in practice. A read clears vblank and the write toggle, so
+    // it repeats only once both are clear. Bits 5-7 then change at vblank and on the
+    // pre-render line, and while rendering sprite 0 hit and overflow can appear on
+    // any visible line.
+    if ((address & 0x0007) != PPURegisters::Status || (StatusRegister & 0x80) || WriteToggle) {
+        return 0;
+    }
+    if ((Scanline == PPU_VBLANK_SCANLINE || Scanline == PPU_PRERENDER_SCANLINE) && Dot <= 1) {
+        return 0;
+    }
+
+    uint64_t dots = GetDotsUntil(PPU_VBLANK_SCANLINE, 1);
+    if (StatusRegister & 0x60) {
+        dots = std::min(dots, GetDotsUntil(PPU_PRERENDER_SCANLINE, 1));
+    }
+    if (IsRenderingEnabled() && (StatusRegister & 0x60) != 0x60) {
+        if (Scanline < SCREEN_HEIGHT) {
+            return 0;
+        }
+        dots = std::min(dots, GetDotsUntil(0, 0));
+    }
+    return SynchronizedCycle + dots / PPU_DOTS_PER_CPU_CYCLE;
+}
+
+void
+PPU::WriteOamDma(const Byte data)
+{
+    Oam[OamAddressRegister++] = data;
+}
+
+Byte
+PPU::ReadMemory(const Address address)
+{
+    const Address ppuAddress = address & 0x3FFF;
+    if (ppuAddress < PPU_VRAM_UNIT.first) {
+        return PatternBanks[ppuAddress >> 10][ppuAddress & 0x03FF];
+    }
+    if (ppuAddress < PPU_PALLETES_UNIT.first) {
+        return NametableBanks[(ppuAddress >> 10) & 0x03][ppuAddress & 0x03FF];
+    }
+
+    Byte index = ppuAddress & 0x1F;
+    if ((index & 0x13) == 0x10) {
+        index &= ~0x10;
+    }
+    return PaletteRam[index] & ((MaskRegister & 0x01) ? 0x30 : 0x3F);
+}
+
+void
+PPU::WriteMemory(const Address address, const Byte data)
+{
+    const Address ppuAddress = address & 0x3FFF;
+    if (ppuAddress < PPU_VRAM_UNIT.first) {
+        if (WritablePatternBanks[ppuAddress >> 10] != nullptr) {
+            WritablePatternBanks[ppuAddress >> 10][ppuAddress & 0x03FF] = data;
+        }
+        return;
+    }
+    if (ppuAddress < PPU_PALLETES_UNIT.first) {
+        NametableBanks[(ppuAddress >> 10) & 0x03][ppuAddress & 0x03FF] = data;
+        return;
+    }
+
+    // $3F10/$3F14/$3F18/$3F1C share storage with the background entries
+    Byte index = ppuAddress & 0x1F;
+    if ((index & 0x13) == 0x10) {
+        index &= ~0x10;
+    }
+    PaletteRam[index] = data & 0x3F;
+}
+
+void
+PPU::Clock()
+{
+    RunDots(1);
+}
+
+void
+PPU::RunDots(uint64_t dots)
+{
+    while (dots > 0) {
+        const uint16_t lineLength = GetLineLength();
+        const uint16_t eventDot = GetNextEventDot();
+        const uint64_t distance = eventDot - Dot;
+
+        if (distance >= dots) {
+            Dot += static_cast<uint16_t>(dots);
+            break;
+        }
+
+        dots -= distance;
+        Dot = eventDot;
+        if (Dot >= lineLength) {
+            StartNextLine();
+            continue;
+        }
+
+        ProcessDot();
+        ++Dot;
+        --dots;
+    }
+
+    if (Dot >= GetLineLength()) {
+        StartNextLine();
+    }
+}
+
+void
+PPU::CatchUp(const uint64_t cycle)
+{
+    if (cycle <= SynchronizedCycle) {
+        return;
+    }
+    RunDots((cycle - SynchronizedCycle) * PPU_DOTS_PER_CPU_CYCLE);
+    SynchronizedCycle = cycle;
+}
+
+uint64_t
+PPU::GetNextEventCycle() const
+{
+    if (NmiOccurred) {
+        return SynchronizedCycle;
+    }
+    if (!(ControlRegister & 0x80)) {
+        return NO_PENDING_EVENT;
+    }
+    // Vblank is raised while processing dot 1, so the NMI is visible from dot 2
+    return GetCycleAfterDots(GetDotsUntil(PPU_VBLANK_SCANLINE, 2));
+}
+
+uint64_t
+PPU::GetFrameEndCycle() const
+{
+    return GetCycleAfterDots(GetDotsUntil(0, 0));
+}
+
+uint64_t
+PPU::GetScanlineClockCycle(uint32_t count) const
+{
+    // Walks forward line by line to the count-th line that clocks the counter,
+    // assuming rendering stays enabled; an odd frame's short pre-render line ends
+    // one dot early.
+    if (count == 0 || !IsRenderingEnabled()) {
+        return NO_PENDING_EVENT;
+    }
+
+    uint16_t line = Scanline;
+    bool isOddFrame = OddFrame;
+    int64_t lineOffset = -static_cast<int64_t>(Dot); // Dots from now to the start of line
+    bool isCurrentLine = true;
+    while (true) {
+        const bool isRenderLine = line < SCREEN_HEIGHT || line == PPU_PRERENDER_SCANLINE;
+        if (isRenderLine && (!isCurrentLine || Dot <= PPU_SCANLINE_COUNTER_DOT) && --count == 0) {
+            return GetCycleAfterDots(static_cast<uint64_t>(lineOffset + PPU_SCANLINE_COUNTER_DOT + 1));
+        }
+
+        lineOffset += PPU_DOTS_PER_SCANLINE;
+        if (line == PPU_PRERENDER_SCANLINE) {
+            lineOffset -= isOddFrame ? 1 : 0;
+            isOddFrame = !isOddFrame;
+            line = 0;
+        } else {
+            ++line;
+        }
+        isCurrentLine = false;
+    }
+}
+
+uint64_t
+PPU::GetDotsUntil(const uint16_t scanline, const uint16_t dot) const
+{
+    // Dots until the PPU next stands at (scanline, dot), never zero. Crossing the end
+    // of an odd frame's pre-render line costs one dot less while rendering.
+    const int64_t frameDots = static_cast<int64_t>(PPU_SCANLINES_PER_FRAME) * PPU_DOTS_PER_SCANLINE;
+    const int64_t current = static_cast<int64_t>(Scanline) * PPU_DOTS_PER_SCANLINE + Dot;
+    const int64_t target = static_cast<int64_t>(scanline) * PPU_DOTS_PER_SCANLINE + dot;
+
+    int64_t distance = target - current;
+    if (distance <= 0) {
+        distance += frameDots;
+        if (OddFrame && IsRenderingEnabled()) {
+            --distance;
+        }
+    }
+    return static_cast<uint64_t>(distance);
+}
+
+uint64_t
+PPU::GetCycleAfterDots(const uint64_t dots) const
+{
+    return SynchronizedCycle + (dots + PPU_DOTS_PER_CPU_CYCLE - 1) / PPU_DOTS_PER_CPU_CYCLE;
+}
+
+uint16_t
+PPU::GetLineLength() const
+{
+    // The pre-render line is one dot short on odd frames while rendering
+    if (Scanline == PPU_PRERENDER_SCANLINE && OddFrame && IsRenderingEnabled()) {
+        return PPU_DOTS_PER_SCANLINE - 1;
+    }
+    return PPU_DOTS_PER_SCANLINE;
+}
+
+uint16_t
+PPU::GetNextEventDot() const
+{
+    const bool isVisible = Scanline < SCREEN_HEIGHT;
+    const bool isPrerender = Scanline == PPU_PRERENDER_SCANLINE;
+
+    if ((Scanline == PPU_VBLANK_SCANLINE || isPrerender) && Dot <= 1) {
+        return 1;
+    }
+    if (isVisible || isPrerender) {
+        if (Dot <= 256) {
+            return 256;
+        }
+        if (Dot <= 257) {
+            return 257;
+        }
+        if (ConnectedScanlineCounter != nullptr && Dot <= PPU_SCANLINE_COUNTER_DOT) {
+            return PPU_SCANLINE_COUNTER_DOT;
+        }
+        if (isPrerender && Dot <= 280) {
+            return 280;
+        }
+    }
+    return GetLineLength();
+}
+
+void
+PPU::ProcessDot()
+{
+    const bool isVisible = Scanline < SCREEN_HEIGHT;
+    const bool isPrerender = Scanline == PPU_PRERENDER_SCANLINE;
+    const bool rendering = IsRenderingEnabled();
+
+    switch (Dot) {
+        case 1:
+            if (Scanline == PPU_VBLANK_SCANLINE) {
+                StatusRegister |= 0x80;
+                if (ControlRegister & 0x80) {
+                    NmiOccurred = true;
+                }
+            } else if (isPrerender) {
+                StatusRegister &= ~0xE0;
+            }
+            break;
+        case 256:
+            if (isVisible) {
+                RenderPixels(SCREEN_WIDTH);
+            }
+            if (rendering) {
+                IncrementY();
+            }
+            break;
+        case 257:
+            if (rendering) {
+                VramAddress = (VramAddress & ~0x041F) | (TemporaryVramAddress & 0x041F);
+            }
+            if (isVisible && rendering) {
+                EvaluateSprites();
+            } else {
+                LineSpriteCount = 0;
+            }
+            break;
+        case PPU_SCANLINE_COUNTER_DOT:
+            if (rendering && ConnectedScanlineCounter != nullptr) {
+                ConnectedScanlineCounter->ClockScanline();
+            }
+            break;
+        case 280:
+            if (rendering) {
+                VramAddress = (VramAddress & ~0x7BE0) | (TemporaryVramAddress & 0x7BE0);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+void
+PPU::StartNextLine()
+{
+    Dot = 0;
+    RenderedX = 0;
+    SpriteLineReady = false;
+
+    if (++Scanline == PPU_SCANLINES_PER_FRAME) {
+        Scanline = 0;
+        ++FrameCount;
+        OddFrame = !OddFrame;
+        FrameComplete = true;
+        if (ConnectedFrameSink != nullptr && !IsFrameSkipped) {
+            FrameTarget = ConnectedFrameSink->PublishFrame();
+        }
+    }
+}
+
+void
+PPU::CatchUpRendering()
+{
+    if (Scanline < SCREEN_HEIGHT && Dot > 1) {
+        RenderPixels(std::min<uint16_t>(Dot - 1, SCREEN_WIDTH));
+    }
+}
+
+void
+PPU::RenderPixels(const uint16_t end)
+{
+    if (RenderedX >= end) {
+        return;
+    }
+    if (Scanline == 0 && RenderedX == 0) {
+        IsFrameSkipped = IsSkipRequested;
+    }
+    if (IsFrameSkipped) {
+        SkipPixels(end);
+        return;
+    }
+
+    Byte* output = FrameTarget + Scanline * SCREEN_WIDTH;
+    if (!IsRenderingEnabled()) {
+        std::memset(output + RenderedX, ReadMemory(PPU_PALLETES_UNIT.first), end - RenderedX);
+        RenderedX = end;
+        return;
+    }
+
+    if (RenderedX == 0) {
+        TileOffset = FineX;
+    }
+    if (!SpriteLineReady) {
+        BuildSpriteLine();
+    }
+
+    FetchBackground(RenderedX, end);
+    ComposePixels(RenderedX, end);
+    RenderedX = end;
+}
+
+void
+PPU::SkipPixels(const uint16_t end)
+{
+    if (!IsRenderingEnabled()) {
+        RenderedX = end;
+        return;
+    }
+    if (RenderedX == 0) {
+        TileOffset = FineX;
+    }
+
+    // Only a line carrying sprite 0, before the hit, needs its background fetched.
+    // Elsewhere the VRAM address just moves on as the tile fetches would move it.
+    // The sprite line is built where drawing would build it, as a later $2000 write
+    // must not change it.
+    const bool hasSpriteZero = LineSpriteCount != 0 && LineSprites[0] == 0;
+    if (hasSpriteZero && !SpriteLineReady) {
+        BuildSpriteLine();
+    }
+    if (hasSpriteZero && (MaskRegister & 0x18) == 0x18 && !(StatusRegister & 0x40)) {
+        FetchBackground(RenderedX, end);
+        DetectSpriteZeroHit(RenderedX, end);
+    } else {
+        const uint16_t pixels = TileOffset + (end - RenderedX);
+        for (uint16_t tile = 0; tile < pixels / 8; ++tile) {
+            IncrementCoarseX();
+        }
+        TileOffset = pixels % 8;
+    }
+    RenderedX = end;
+}
+
+void
+PPU::DetectSpriteZeroHit(const uint16_t start, const uint16_t end)
+{
+    // The same test ComposePixels() makes, minus the merge: left-column clipping
+    // applies and the last column never hits.
+    const uint16_t backgroundClip = (MaskRegister & 0x02) ? 0 : 8;
+    const uint16_t spriteClip = (MaskRegister & 0x04) ? 0 : 8;
+    const uint16_t last = std::min<uint16_t>(end, SCREEN_WIDTH - 1);
+    for (uint16_t x = std::max({ start, backgroundClip, spriteClip }); x < last; ++x) {
+        if (SpriteZero[x] && (BackgroundLine[x] & 0x03) && (SpriteColors[x] & 0x03)) {
+            StatusRegister |= 0x40;
+            return;
+        }
+    }
+}
+
+void
+PPU::FetchBackground(const uint16_t start, const uint16_t end)
+{
+    const Address patternTable = (ControlRegister & 0x10) ? 0x1000 : 0x0000;
+
+    uint16_t x = start;
+    while (x < end) {
+        const Byte tile = ReadMemory(0x2000 | (VramAddress & 0x0FFF));
+        const Byte attribute = ReadMemory(0x23C0 | (VramAddress & 0x0C00) | ((VramAddress >> 4) & 0x38) | ((VramAddress >> 2) & 0x07));
+        const Byte palette = (attribute >> (((VramAddress >> 4) & 0x04) | (VramAddress & 0x02))) & 0x03;
+        const Address patternAddress = patternTable + tile * 16 + ((VramAddress >> 12) & 0x07);
+        const Byte lowPlane = ReadMemory(patternAddress);
+        const Byte highPlane = ReadMemory(patternAddress + 8);
+
+        // Whole tiles decode straight into the line; partial ones go through a scratch row
+        if (TileOffset == 0 && x + 8 <= end) {
+            DecodeTileRow(lowPlane, highPlane, palette, &BackgroundLine[x]);
+            x += 8;
+            IncrementCoarseX();
+            continue;
+        }
+
+        Byte row[16];
+        DecodeTileRow(lowPlane, highPlane, palette, row);
+        const uint16_t count = std::min<uint16_t>(8 - TileOffset, end - x);
+        std::memcpy(&BackgroundLine[x], row + TileOffset, count);
+        x += count;
+        TileOffset += count;
+        if (TileOffset == 8) {
+            TileOffset = 0;
+            IncrementCoarseX();
+        }
+    }
+}
+
+void
+PPU::EvaluateSprites()
+{
+    // Picks the sprites for the next scanline; OAM Y is one less than the first line drawn
+    const uint8_t height = (ControlRegister & 0x20) ? 16 : 8;
+    LineSpriteCount = 0;
+
+    // Once overflow is flagged, all a skipped frame still needs is whether sprite 0 is on the line
+    const uint16_t spriteCount = (IsFrameSkipped && (StatusRegister & 0x20)) ? 1 : OAM_SIZE / 4;
+    for (uint16_t sprite = 0; sprite < spriteCount; ++sprite) {
+        const int row = static_cast<int>(Scanline) - Oam[sprite * 4];
+        if (row < 0 || row >= height) {
+            continue;
+        }
+        if (LineSpriteCount == MAXIMUM_SPRITES_PER_SCANLINE) {
+            StatusRegister |= 0x20;
+            break;
+        }
+        LineSprites[LineSpriteCount++] = static_cast<Byte>(sprite);
+    }
+}
+
+void
+PPU::BuildSpriteLine()
+{
+    SpriteLineReady = true;
+    SpriteColors.fill(0);
+    SpriteBehind.fill(0);
+    SpriteZero.fill(0);
+
+    const uint8_t height = (ControlRegister & 0x20) ? 16 : 8;
+
+    // Walk backwards so lower OAM indices overwrite higher ones, as on hardware
+    for (int slot = LineSpriteCount - 1; slot >= 0; --slot) {
+        const Byte sprite = LineSprites[slot];
+        const Byte* entry = &Oam[sprite * 4];
+        const Byte attributes = entry[2];
+        const uint16_t left = entry[3];
+
+        int row = static_cast<int>(Scanline) - 1 - entry[0];
+        if (row < 0 || row >= height) {
+            continue;
+        }
+        if (attributes & 0x80) {
+            row = height - 1 - row;
+        }
+
+        Address patternAddress;
+        if (height == 16) {
+            Byte tile = entry[1] & 0xFE;
+            if (row >= 8) {
+                ++tile;
+                row -= 8;
+            }
+            patternAddress = ((entry[1] & 0x01) ? 0x1000 : 0x0000) + tile * 16 + row;
+        } else {
+            patternAddress = ((ControlRegister & 0x08) ? 0x1000 : 0x0000) + entry[1] * 16 + row;
+        }
+
+        Byte lowPlane = ReadMemory(patternAddress);
+        Byte highPlane = ReadMemory(patternAddress + 8);
+        if (attributes & 0x40) {
+            lowPlane = ReverseBits(lowPlane);
+            highPlane = ReverseBits(highPlane);
+        }
+
+        Byte pixels[16];
+        DecodeTileRow(lowPlane, highPlane, 0x04 | (attributes & 0x03), pixels);
+        for (uint16_t pixel = 0; pixel < 8 && left + pixel < SCREEN_WIDTH; ++pixel) {
+            if (pixels[pixel] & 0x03) {
+                SpriteColors[left + pixel] = pixels[pixel];
+                SpriteBehind[left + pixel] = (attributes & 0x20) ? 0xFF : 0x00;
+                SpriteZero[left + pixel] = sprite == 0 ? 0xFF : 0x00;
+            }
+        }
+    }
+}
+
+void
+PPU::ComposePixels(const uint16_t start, const uint16_t end)
+{
+    Byte* output = FrameTarget + Scanline * SCREEN_WIDTH;
+    const bool showBackground = MaskRegister & 0x08;
+    const bool showSprites = MaskRegister & 0x10;
+    const Byte greyscale = (MaskRegister & 0x01) ? 0x30 : 0x3F;
+
+    // Left-column clipping and disabled layers are rare; handle them by clearing the
+    // affected inputs so the merge below stays branch-free.
+    const uint16_t backgroundClip = showBackground ? ((MaskRegister & 0x02) ? 0 : 8) : SCREEN_WIDTH;
+    const uint16_t spriteClip = showSprites ? ((MaskRegister & 0x04) ? 0 : 8) : SCREEN_WIDTH;
+    if (start < backgroundClip) {
+        std::memset(&BackgroundLine[start], 0, std::min(backgroundClip, end) - start);
+    }
+    if (start < spriteClip) {
+        const uint16_t clipEnd = std::min(spriteClip, end);
+        std::memset(&SpriteColors[start], 0, clipEnd - start);
+        std::memset(&SpriteZero[start], 0, clipEnd - start);
+    }
+
+    // Sprite 0 never hits on the last column
+    bool spriteZeroHit = false;
+    uint16_t x = start;
+
+#if defined(__AVX2__)
+    const __m256i lowBits = _mm256_set1_epi8(0x03);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m128i paletteLow = _mm_load_si128(reinterpret_cast<const __m128i*>(PaletteRam.data()));
+    const __m128i paletteHigh = _mm_load_si128(reinterpret_cast<const __m128i*>(PaletteRam.data() + 16));
+    const __m256i paletteLowLanes = _mm256_broadcastsi128_si256(paletteLow);
+    const __m256i paletteHighLanes = _mm256_broadcastsi128_si256(paletteHigh);
+    const __m256i greyscaleMask = _mm256_set1_epi8(static_cast<char>(greyscale));
+
+    for (; x + 32 <= end; x += 32) {
+        const __m256i background = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&BackgroundLine[x]));
+        const __m256i sprite = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&SpriteColors[x]));
+        const __m256i behind = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&SpriteBehind[x]));
+        const __m256i spriteZero = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&SpriteZero[x]));
+
+        const __m256i backgroundClear = _mm256_cmpeq_epi8(_mm256_and_si256(background, lowBits), zero);
+        const __m256i spriteClear = _mm256_cmpeq_epi8(_mm256_and_si256(sprite, lowBits), zero);
+        const __m256i useSprite = _mm256_andnot_si256(spriteClear, _mm256_or_si256(backgroundClear, _mm256_xor_si256(behind, _mm256_set1_epi8(-1))));
+        const __m256i color = _mm256_or_si256(
+            _mm256_and_si256(useSprite, sprite),
+            _mm256_andnot_si256(_mm256_or_si256(useSprite, backgroundClear), background));
+
+        const __m256i hit = _mm256_andnot_si256(_mm256_or_si256(backgroundClear, spriteClear), spriteZero);
+        uint32_t hitMask = static_cast<uint32_t>(_mm256_movemask_epi8(hit));
+        if (x + 32 == SCREEN_WIDTH) {
+            hitMask &= 0x7FFFFFFF;
+        }
+        spriteZeroHit |= hitMask != 0;
+
+        // 32-entry palette lookup as two 16-entry shuffles selected by bit 4
+        const __m256i index = _mm256_and_si256(color, _mm256_set1_epi8(0x0F));
+        const __m256i fromLow = _mm256_shuffle_epi8(paletteLowLanes, index);
+        const __m256i fromHigh = _mm256_shuffle_epi8(paletteHighLanes, index);
+        const __m256i selectHigh = _mm256_cmpeq_epi8(_mm256_and_si256(color, _mm256_set1_epi8(0x10)), _mm256_set1_epi8(0x10));
+        const __m256i pixels = _mm256_blendv_epi8(fromLow, fromHigh, selectHigh);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + x), _mm256_and_si256(pixels, greyscaleMask));
+    }
+#elif defined(__SSE2__)
+    const __m128i lowBits = _mm_set1_epi8(0x03);
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; x + 16 <= end; x += 16) {
+        const __m128i background = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&BackgroundLine[x]));
+        const __m128i sprite = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&SpriteColors[x]));
+        const __m128i behind = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&SpriteBehind[x]));
+        const __m128i spriteZero = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&SpriteZero[x]));
+
+        const __m128i backgroundClear = _mm_cmpeq_epi8(_mm_and_si128(background, lowBits), zero);
+        const __m128i spriteClear = _mm_cmpeq_epi8(_mm_and_si128(sprite, lowBits), zero);
+        const __m128i useSprite = _mm_andnot_si128(spriteClear, _mm_or_si128(backgroundClear, _mm_xor_si128(behind, _mm_set1_epi8(-1))));
+        const __m128i color = _mm_or_si128(
+            _mm_and_si128(useSprite, sprite),
+            _mm_andnot_si128(_mm_or_si128(useSprite, backgroundClear), background));
+
+        const __m128i hit = _mm_andnot_si128(_mm_or_si128(backgroundClear, spriteClear), spriteZero);
+        uint32_t hitMask = static_cast<uint32_t>(_mm_movemask_epi8(hit));
+        if (x + 16 == SCREEN_WIDTH) {
+            hitMask &= 0x7FFF;
+        }
+        spriteZeroHit |= hitMask != 0;
+
+        alignas(16) Byte colors[16];
+        _mm_store_si128(reinterpret_cast<__m128i*>(colors), color);
+        for (int pixel = 0; pixel < 16; ++pixel) {
+            output[x + pixel] = PaletteRam[colors[pixel]] & greyscale;
+        }
+    }
+#endif
+
+    for (; x < end; ++x) {
+        const Byte color = MergePixel(BackgroundLine[x], SpriteColors[x], SpriteBehind[x]);
+        if (SpriteZero[x] && (BackgroundLine[x] & 0x03) && (SpriteColors[x] & 0x03) && x != SCREEN_WIDTH - 1) {
+            spriteZeroHit = true;
+        }
+        output[x] = PaletteRam[color] & greyscale;
+    }
+
+    if (spriteZeroHit) {
+        StatusRegister |= 0x40;
+    }
+}
+
+void
+PPU::IncrementCoarseX()
+{
+    if ((VramAddress & 0x001F) == 31) {
+        VramAddress &= ~0x001F;
+        VramAddress ^= 0x0400;
+    } else {
+        ++VramAddress;
+    }
+}
+
+void
+PPU::IncrementY()
+{
+    if ((VramAddress & 0x7000) != 0x7000) {
+        VramAddress += 0x1000;
+        return;
+    }
+
+    VramAddress &= ~0x7000;
+    uint16_t coarseY = (VramAddress & 0x03E0) >> 5;
+    if (coarseY == 29) {
+        coarseY = 0;
+        VramAddress ^= 0x0800;
+    } else if (coarseY == 31) {
+        coarseY = 0;
+    } else {
+        ++coarseY;
+    }
+    VramAddress = (VramAddress & ~0x03E0) | (coarseY << 5);
+}
@@ -0,0 +1,75 @@
+#include "../include/Profiler.hpp"
+
+#include <algorithm>
+
+ExecutionProfiler::ExecutionProfiler()
+    : ProgramCounters(NUMBER_OF_PROGRAM_COUNTERS, ProfileCounter{ 0, 0 })
+{
+}
+
+void
+ExecutionProfiler::Reset()
+{
+    Opcodes.fill({ 0, 0, 0, 0 });
+    Modes.fill({ 0, 0 });
+    CycleHistogram.fill(0);
+    std::fill(ProgramCounters.begin(), ProgramCounters.end(), ProfileCounter{ 0, 0 });
+}
+
+uint64_t
+ExecutionProfiler::GetTotalInstructions() const
+{
+    uint64_t total = 0;
+    for (const OpcodeProfile& profile : Opcodes) {
+        total += profile.executions;
+    }
+    return total;
+}
+
+uint64_t
+ExecutionProfiler::GetTotalCycles() const
+{
+    uint64_t total = 0;
+    for (const OpcodeProfile& profile : Opcodes) {
+        total += profile.cycles;
+    }
+    return total;
+}
+
+uint64_t
+ExecutionProfiler::GetTotalPageCrossPenalties() const
+{
+    uint64_t total = 0;
+    for (const OpcodeProfile& profile : Opcodes) {
+        total += profile.pageCrossPenalties;
+    }
+    return total;
+}
+
+uint64_t
+ExecutionProfiler::GetTotalBranchesTaken() const
+{
+    uint64_t total = 0;
+    for (const OpcodeProfile& profile : Opcodes) {
+        total += profile.branchesTaken;
+    }
+    return total;
+}
+
+std::vector<HotSpot>
+ExecutionProfiler::GetHotSpots(const size_t count) const
+{
+    std::vector<HotSpot> hotSpots;
+    for (uint32_t address = 0; address < NUMBER_OF_PROGRAM_COUNTERS; ++address) {
+        if (ProgramCounters[address].executions != 0) {
+            hotSpots.push_back({ static_cast<Address>(address), ProgramCounters[address] });
+        }
+    }
+
+    const size_t kept = std::min(count, hotSpots.size());
+    std::partial_sort(hotSpots.begin(), hotSpots.begin() + kept, hotSpots.end(), [](const HotSpot& left, const HotSpot& right) {
+        return left.counter.cycles > right.counter.cycles;
+    });
+    hotSpots.resize(kept);
+    return hotSpots;
+}
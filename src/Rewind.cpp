@@ -0,0 +1,219 @@
+#include "../include/Rewind.hpp"
+
+#include <cstring>
+
+namespace {
+    constexpr size_t STATE_SIZE = SaveState::GetSize();
+
+    // Control bytes below 0x80 are a run of (n + 1) unchanged bytes, anything else
+    // is followed by (n - 0x7F) literal XOR bytes.
+    constexpr Byte MAXIMUM_RUN = 0x80;
+
+    // Alternating changed and unchanged bytes would encode to about 1.5 times the
+    // state, so a delta that would outgrow a keyframe is stored as one instead.
+    constexpr size_t MAXIMUM_ENTRY_SIZE = STATE_SIZE;
+}
+
+RewindBuffer::RewindBuffer(const size_t maximumFrames, const size_t arenaSize, const size_t keyframeInterval)
+    : Arena(arenaSize < MAXIMUM_ENTRY_SIZE * 2 ? MAXIMUM_ENTRY_SIZE * 2 : arenaSize),
+      Frames(maximumFrames < 1 ? 1 : maximumFrames),
+      KeyframeInterval(keyframeInterval < 1 ? 1 : keyframeInterval)
+{
+}
+
+void
+RewindBuffer::Push(const SaveState& state)
+{
+    const Byte* stateData = state.GetData();
+    const bool isKeyframe = Count == 0 || FramesSinceKeyframe >= KeyframeInterval;
+
+    if (Count == Frames.size()) {
+        DropOldestGroup();
+    }
+
+    // Making room may drop the keyframe this delta would refer to, so reserve the
+    // worst case first and decide afterwards.
+    const size_t offset = Reserve(MAXIMUM_ENTRY_SIZE);
+    bool needsKeyframe = isKeyframe || Count == 0;
+
+    Frame& frame = Frames[Head];
+    frame.offset = offset;
+
+    if (!needsKeyframe) {
+        const Frame& newest = Frames[GetNewestSlot()];
+        const size_t keyframe = newest.isKeyframe ? GetNewestSlot() : newest.keyframe;
+        frame.size = EncodeDelta(&Arena[Frames[keyframe].offset], stateData, &Arena[offset]);
+        frame.keyframe = keyframe;
+        needsKeyframe = frame.size == 0;
+    }
+
+    frame.isKeyframe = needsKeyframe;
+    if (needsKeyframe) {
+        std::memcpy(&Arena[offset], stateData, STATE_SIZE);
+        frame.size = STATE_SIZE;
+        frame.keyframe = Head;
+        FramesSinceKeyframe = 0;
+    }
+
+    WriteOffset = offset + frame.size;
+    Head = (Head + 1) % Frames.size();
+    ++Count;
+    ++FramesSinceKeyframe;
+}
+
+bool
+RewindBuffer::Pop(SaveState& state)
+{
+    if (Count == 0) {
+        return false;
+    }
+
+    const size_t slot = GetNewestSlot();
+    const Frame& frame = Frames[slot];
+    Byte* stateData = reinterpret_cast<Byte*>(&state);
+
+    std::memcpy(stateData, &Arena[Frames[frame.keyframe].offset], STATE_SIZE);
+    if (!frame.isKeyframe) {
+        DecodeDelta(&Arena[frame.offset], frame.size, stateData);
+    }
+
+    // The newest frame was appended last, so rolling the write offset back frees it.
+    WriteOffset = frame.offset;
+    Head = slot;
+    --Count;
+
+    if (Count == 0) {
+        Clear();
+    } else {
+        const size_t newest = GetNewestSlot();
+        const size_t keyframe = Frames[newest].isKeyframe ? newest : Frames[newest].keyframe;
+        FramesSinceKeyframe = (newest + Frames.size() - keyframe) % Frames.size() + 1;
+    }
+    return true;
+}
+
+void
+RewindBuffer::Clear()
+{
+    Head = 0;
+    Count = 0;
+    WriteOffset = 0;
+    FramesSinceKeyframe = 0;
+}
+
+size_t
+RewindBuffer::GetMemoryUsage() const
+{
+    return Arena.size() + Frames.size() * sizeof(Frame);
+}
+
+size_t
+RewindBuffer::GetOldestSlot() const
+{
+    return (Head + Frames.size() - Count) % Frames.size();
+}
+
+size_t
+RewindBuffer::GetNewestSlot() const
+{
+    return (Head + Frames.size() - 1) % Frames.size();
+}
+
+size_t
+RewindBuffer::Reserve(const size_t size)
+{
+    // Entries are contiguous; one that does not fit before the end of the arena
+    // starts again at offset zero.
+    while (Count > 0) {
+        const size_t readOffset = Frames[GetOldestSlot()].offset;
+        if (WriteOffset > readOffset) {
+            if (WriteOffset + size <= Arena.size()) {
+                return WriteOffset;
+            }
+            if (size <= readOffset) {
+                WriteOffset = 0;
+                return 0;
+            }
+        } else if (WriteOffset + size <= readOffset) {
+            return WriteOffset;
+        }
+        DropOldestGroup();
+    }
+
+    WriteOffset = 0;
+    return 0;
+}
+
+void
+RewindBuffer::DropOldestGroup()
+{
+    // Deltas are useless without their keyframe, so the keyframe and everything
+    // encoded against it leave together.
+    do {
+        --Count;
+    } while (Count > 0 && !Frames[GetOldestSlot()].isKeyframe);
+
+    if (Count == 0) {
+        Clear();
+    }
+}
+
+size_t
+RewindBuffer::EncodeDelta(const Byte* keyframe, const Byte* state, Byte* output)
+{
+    size_t written = 0;
+    size_t position = 0;
+
+    while (position < STATE_SIZE) {
+        size_t run = 0;
+        while (position + run < STATE_SIZE && run < MAXIMUM_RUN && keyframe[position + run] == state[position + run]) {
+            ++run;
+        }
+
+        if (run > 0) {
+            if (written + 1 > MAXIMUM_ENTRY_SIZE) {
+                return 0;
+            }
+            output[written++] = static_cast<Byte>(run - 1);
+            position += run;
+            continue;
+        }
+
+        while (position + run < STATE_SIZE && run < MAXIMUM_RUN && keyframe[position + run] != state[position + run]) {
+            ++run;
+        }
+
+        if (written + 1 + run > MAXIMUM_ENTRY_SIZE) {
+            return 0;
+        }
+        output[written++] = static_cast<Byte>(0x7F + run);
+        for (size_t index = 0; index < run; ++index) {
+            output[written++] = keyframe[position + index] ^ state[position + index];
+        }
+        position += run;
+    }
+
+    return written;
+}
+
+void
+RewindBuffer::DecodeDelta(const Byte* delta, const size_t size, Byte* state)
+{
+    size_t position = 0;
+    size_t read = 0;
+
+    while (read < size) {
+        const Byte control = delta[read++];
+        if (control < MAXIMUM_RUN) {
+            position += control + 1;
+            continue;
+        }
+
+        const size_t run = control - 0x7F;
+        for (size_t index = 0; index < run; ++index) {
+            state[position + index] ^= delta[read + index];
+        }
+        position += run;
+        read += run;
+    }
+}
@@ -0,0 +1,44 @@
+#include "../include/SaveState.hpp"
+
+#include <cstring>
+
+#include "../include/Bus.hpp"
+#include "../include/CPU.hpp"
+
+void
+SaveState::Capture(const CPU& cpu, const Bus& bus)
+{
+    magic = SAVE_STATE_MAGIC;
+    version = SAVE_STATE_VERSION;
+    size = static_cast<uint16_t>(sizeof(SaveState));
+    cpu.CaptureState(this->cpu);
+    std::memcpy(ram.data(), bus.GetRam(), ram.size());
+}
+
+bool
+SaveState::Restore(CPU& cpu, Bus& bus) const
+{
+    if (!IsValid()) {
+        return false;
+    }
+    cpu.RestoreState(this->cpu);
+    std::memcpy(bus.GetRam(), ram.data(), ram.size());
+    bus.MarkDirty(MEMORY_UNIT.first, MEMORY_UNIT.second);
+    return true;
+}
+
+bool
+SaveState::IsValid() const
+{
+    return magic == SAVE_STATE_MAGIC && version == SAVE_STATE_VERSION && size == sizeof(SaveState);
+}
+
+bool
+SaveState::LoadFromData(const Byte* data, const size_t dataSize)
+{
+    if (dataSize != sizeof(SaveState)) {
+        return false;
+    }
+    std::memcpy(static_cast<void*>(this), data, sizeof(SaveState));
+    return IsValid();
+}
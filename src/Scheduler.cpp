@@ -0,0 +1,171 @@
+#include "../include/Scheduler.hpp"
+
+#include <algorithm>
+
+Scheduler::Scheduler(CPU& cpu, Bus& bus)
+    : ConnectedCPU(cpu), ConnectedBus(bus)
+{
+}
+
+bool
+Scheduler::MapDevice(const Address first, const Address last, BusDevice* device, SynchronizedDevice* synchronizedDevice)
+{
+    if (RouteCount == Routes.size()) {
+        return false;
+    }
+    if (synchronizedDevice != nullptr && !AddDevice(synchronizedDevice)) {
+        return false;
+    }
+
+    Routes[RouteCount++] = { first, last, device, synchronizedDevice };
+    ConnectedBus.MapDevice(first & 0xFF00, last | 0x00FF, this);
+    return true;
+}
+
+bool
+Scheduler::AddDevice(SynchronizedDevice* synchronizedDevice)
+{
+    if (std::find(Devices.begin(), Devices.begin() + DeviceCount, synchronizedDevice) != Devices.begin() + DeviceCount) {
+        return true;
+    }
+    if (DeviceCount == Devices.size()) {
+        return false;
+    }
+    const uint8_t deviceIndex = DeviceCount++;
+    Devices[deviceIndex] = synchronizedDevice;
+    Predictions[deviceIndex] = NO_PENDING_EVENT;
+    RefreshDevice(deviceIndex);
+    return true;
+}
+
+bool
+Scheduler::RefreshDevice(const uint8_t deviceIndex)
+{
+    // Returns true when the device's event moved earlier than the queue knew about
+    const SynchronizedDevice* synchronizedDevice = Devices[deviceIndex];
+    const uint64_t eventCycle = synchronizedDevice->GetNextEventCycle();
+    const bool isEarlier = eventCycle < Predictions[deviceIndex];
+    if (eventCycle != Predictions[deviceIndex]) {
+        Predictions[deviceIndex] = eventCycle;
+        Events.Reschedule(synchronizedDevice->GetEventType(), deviceIndex, eventCycle);
+    }
+    return isEarlier;
+}
+
+const SynchronizedRoute*
+Scheduler::FindRoute(const Address address) const
+{
+    for (uint8_t index = 0; index < RouteCount; ++index) {
+        if (address >= Routes[index].first && address <= Routes[index].last) {
+            return &Routes[index];
+        }
+    }
+    return nullptr;
+}
+
+Byte
+Scheduler::Read(const Address address)
+{
+    const SynchronizedRoute* route = FindRoute(address);
+    if (route == nullptr) {
+        return 0x00; // Open bus
+    }
+    if (route->synchronizedDevice == nullptr) {
+        return route->device->Read(address);
+    }
+
+    // Reads have side effects too ($2002 clears vblank, $4015 acknowledges the frame IRQ)
+    route->synchronizedDevice->CatchUp(ConnectedCPU.GetAccessCycle());
+    const Byte data = route->device->Read(address);
+    if (RefreshPredictions()) {
+        ConnectedCPU.EndTimeslice();
+    }
+    return data;
+}
+
+void
+Scheduler::Write(const Address address, const Byte data)
+{
+    const SynchronizedRoute* route = FindRoute(address);
+    if (route == nullptr) {
+        return;
+    }
+    if (route->synchronizedDevice == nullptr) {
+        route->device->Write(address, data);
+        return;
+    }
+
+    route->synchronizedDevice->CatchUp(ConnectedCPU.GetAccessCycle());
+    route->device->Write(address, data);
+
+    // A write can also raise an IRQ on the spot (a one-byte DMC sample ends at once)
+    if (RefreshPredictions() || IsInterruptRequested()) {
+        ConnectedCPU.EndTimeslice();
+    }
+}
+
+uint64_t
+Scheduler::GetStableReadCycle(const Address address)
+{
+    const SynchronizedRoute* route = FindRoute(address);
+    if (route == nullptr) {
+        return NO_PENDING_EVENT;
+    }
+    if (route->synchronizedDevice != nullptr) {
+        route->synchronizedDevice->CatchUp(ConnectedCPU.GetTotalCycles());
+    }
+    return route->device->GetStableReadCycle(address);
+}
+
+void
+Scheduler::CatchUpAll(const uint64_t cycle)
+{
+    for (uint8_t index = 0; index < DeviceCount; ++index) {
+        Devices[index]->CatchUp(cycle);
+    }
+}
+
+bool
+Scheduler::RefreshPredictions()
+{
+    // Predictions can depend on other devices (MMC3 counts PPU scanlines), so an
+    // access to one device rechecks them all
+    bool isEarlier = false;
+    for (uint8_t index = 0; index < DeviceCount; ++index) {
+        isEarlier |= RefreshDevice(index);
+    }
+    return isEarlier;
+}
+
+bool
+Scheduler::ScheduleEvent(const ScheduledEvent& event)
+{
+    ConnectedCPU.EndTimeslice();
+    return Events.Push(event);
+}
+
+bool
+Scheduler::PopDueEvent(const uint64_t cycle, ScheduledEvent& event)
+{
+    if (Events.GetNextCycle() > cycle) {
+        return false;
+    }
+    Events.Pop(event);
+
+    // A device event has been consumed; whatever it predicts next goes back in
+    if (event.type != EventTypes::DirectMemoryAccess) {
+        Predictions[event.source] = NO_PENDING_EVENT;
+    }
+    return true;
+}
+
+bool
+Scheduler::IsInterruptRequested() const
+{
+    for (uint8_t index = 0; index < DeviceCount; ++index) {
+        if (Devices[index]->IsInterruptRequested()) {
+            return true;
+        }
+    }
+    return false;
+}
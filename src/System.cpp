@@ -0,0 +1,161 @@
+#include "../include/System.hpp"
+
+#include <algorithm>
+
+System::System()
+    : SystemAPU(SystemBus), SystemScheduler(SystemCPU, SystemBus)
+{
+    SystemCPU.ConnectBus(&SystemBus);
+    SystemCPU.SetIdleLoopSkipping(true);
+    SystemPPU.ConnectFrameSink(&Output);
+    SystemAPU.ConnectAudioSink(&Output);
+    SystemScheduler.MapDevice(PPU_MIRRORED_UNIT.first, PPU_MIRRORED_UNIT.second, &SystemPPU, &SystemPPU);
+    SystemScheduler.MapDevice(OAM_DMA_REGISTER, OAM_DMA_REGISTER, this, nullptr);
+    SystemScheduler.MapDevice(APU_UNIT.first, 0x4013, &SystemAPU, &SystemAPU);
+    SystemScheduler.MapDevice(0x4015, 0x4015, &SystemAPU, &SystemAPU);
+    SystemScheduler.MapDevice(CONTROLLER_PORT_1, CONTROLLER_PORT_2, this, &SystemAPU);
+}
+
+bool
+System::InsertCartridge(const Cartridge& cartridge)
+{
+    if (CartridgeMapper != nullptr) {
+        return false;
+    }
+    CartridgeMapper = Mapper::Create(cartridge, SystemBus, SystemPPU);
+    if (CartridgeMapper == nullptr) {
+        return false;
+    }
+
+    // Register writes under PRG-ROM reach the mapper through the scheduler, so the
+    // PPU is caught up before any bank or IRQ change; reads stay direct loads.
+    SystemScheduler.MapDevice(PRG_ROM_UNIT.first, PRG_ROM_UNIT.second, CartridgeMapper.get(), CartridgeMapper.get());
+    CartridgeMapper->Reset();
+    SystemScheduler.RefreshPredictions();
+    return true;
+}
+
+void
+System::Reset()
+{
+    SystemScheduler.CatchUpAll(SystemCPU.GetTotalCycles());
+    SystemPPU.Reset();
+    SystemAPU.Reset();
+    SystemCPU.Reset();
+    SystemScheduler.RefreshPredictions();
+    IsPollingInterrupt = false;
+}
+
+uint64_t
+System::RunCycles(const uint64_t cycles)
+{
+    const uint64_t startCycle = SystemCPU.GetTotalCycles();
+    const uint64_t targetCycle = startCycle + cycles;
+
+    while (SystemCPU.GetTotalCycles() < targetCycle) {
+        const uint64_t now = SystemCPU.GetTotalCycles();
+        uint64_t deadline = std::min(targetCycle, SystemScheduler.GetNextEventCycle());
+        if (IsPollingInterrupt) {
+            deadline = std::min(deadline, now + 1);
+        }
+        if (deadline > now) {
+            SystemCPU.RunCycles(deadline - now);
+        }
+        ServiceEvents();
+    }
+    return SystemCPU.GetTotalCycles() - startCycle;
+}
+
+uint64_t
+System::RunFrame()
+{
+    // Catch up at the end so the frame buffer holds the whole picture and the audio
+    // output every sample up to the same point
+    const uint64_t frameEndCycle = SystemPPU.GetFrameEndCycle();
+    const uint64_t now = SystemCPU.GetTotalCycles();
+    const uint64_t cyclesConsumed = RunCycles(frameEndCycle > now ? frameEndCycle - now : 0);
+    SystemScheduler.CatchUpAll(SystemCPU.GetTotalCycles());
+    SystemAPU.FlushAudio();
+    return cyclesConsumed;
+}
+
+Byte
+System::Read(const Address address)
+{
+    switch (address) {
+        case CONTROLLER_PORT_1:
+            return Controllers[0].Read();
+        case CONTROLLER_PORT_2:
+            return Controllers[1].Read();
+        default:
+            return 0x00; // $4014 is write-only
+    }
+}
+
+void
+System::Write(const Address address, const Byte data)
+{
+    switch (address) {
+        case OAM_DMA_REGISTER:
+            // The transfer starts once the writing instruction has finished
+            SystemScheduler.ScheduleEvent({ SystemCPU.GetAccessCycle() + 1, EventTypes::DirectMemoryAccess, 0, data });
+            break;
+        case CONTROLLER_PORT_1:
+            // One strobe line goes to both ports
+            for (Controller& controller : Controllers) {
+                controller.Strobe(data);
+            }
+            break;
+        case CONTROLLER_PORT_2:
+            SystemAPU.Write(address, data);
+            break;
+    }
+}
+
+void
+System::ServiceEvents()
+{
+    ScheduledEvent event;
+    bool hasServicedEvent = false;
+    while (SystemScheduler.PopDueEvent(SystemCPU.GetTotalCycles(), event)) {
+        SystemScheduler.CatchUpAll(SystemCPU.GetTotalCycles());
+        hasServicedEvent = true;
+
+        switch (event.type) {
+            case EventTypes::NonMaskableInterrupt:
+                if (SystemPPU.PollNonMaskableInterrupt()) {
+                    SystemCPU.NonMaskableInterrupt();
+                }
+                break;
+            case EventTypes::InterruptRequest:
+                break; // The line is level-triggered and sampled below
+            case EventTypes::DirectMemoryAccess:
+                RunOamDma(event.data);
+                break;
+        }
+    }
+    if (hasServicedEvent) {
+        SystemScheduler.RefreshPredictions();
+    }
+
+    IsPollingInterrupt = false;
+    if (SystemScheduler.IsInterruptRequested()) {
+        if (SystemCPU.IsInterruptDisabled()) {
+            IsPollingInterrupt = true;
+        } else {
+            SystemCPU.InterruptRequest();
+        }
+    }
+}
+
+void
+System::RunOamDma(const Byte page)
+{
+    // One dummy cycle, plus one more to align on an odd cycle, then 256 read/write pairs
+    const uint32_t stallCycles = OAM_DMA_CYCLES + (SystemCPU.GetTotalCycles() & 1);
+    const Address base = static_cast<Address>(page) << 8;
+    for (uint16_t offset = 0; offset < OAM_SIZE; ++offset) {
+        SystemPPU.WriteOamDma(SystemBus.Read(base + offset));
+    }
+    SystemCPU.Stall(stallCycles);
+}
@@ -0,0 +1,167 @@
+#include "../include/TraceRecorder.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+
+#include "../include/OpcodeTable.hpp"
+#include "../include/PPU.hpp"
+
+namespace {
+    constexpr std::array<const char*, Operations::XXX + 1> MNEMONICS = {
+        "ADC", "AND", "ASL", "BCC", "BCS", "BEQ", "BIT", "BMI",
+        "BNE", "BPL", "BRK", "BVC", "BVS", "CLC", "CLD", "CLI",
+        "CLV", "CMP", "CPX", "CPY", "DEC", "DEX", "DEY", "EOR",
+        "INC", "INX", "INY", "JMP", "JSR", "LDA", "LDX", "LDY",
+        "LSR", "NOP", "ORA", "PHA", "PHP", "PLA", "PLP", "ROL",
+        "ROR", "RTI", "RTS", "SBC", "SEC", "SED", "SEI", "STA",
+        "STX", "STY", "TAX", "TAY", "TSX", "TXA", "TXS", "TYA",
+        "???"
+    };
+
+    struct TraceFileHeader {
+        uint32_t magic;
+        uint32_t recordSize;
+        uint64_t count;
+    };
+
+    void FormatOperand(const TraceRecord& record, const AddressingModes::Mode mode, char* output, const size_t size)
+    {
+        const unsigned operand = record.operand;
+        const unsigned low = operand & 0x00FF;
+        switch (mode) {
+            case AddressingModes::Implicit:    output[0] = '\0'; break;
+            case AddressingModes::Accumulator: std::snprintf(output, size, "A"); break;
+            case AddressingModes::Immediate:   std::snprintf(output, size, "#$%02X", low); break;
+            case AddressingModes::ZeroPage:    std::snprintf(output, size, "$%02X", low); break;
+            case AddressingModes::ZeroPageX:   std::snprintf(output, size, "$%02X,X", low); break;
+            case AddressingModes::ZeroPageY:   std::snprintf(output, size, "$%02X,Y", low); break;
+            case AddressingModes::Absolute:    std::snprintf(output, size, "$%04X", operand); break;
+            case AddressingModes::AbsoluteX:   std::snprintf(output, size, "$%04X,X", operand); break;
+            case AddressingModes::AbsoluteY:   std::snprintf(output, size, "$%04X,Y", operand); break;
+            case AddressingModes::Indirect:    std::snprintf(output, size, "($%04X)", operand); break;
+            case AddressingModes::IndirectX:   std::snprintf(output, size, "($%02X,X)", low); break;
+            case AddressingModes::IndirectY:   std::snprintf(output, size, "($%02X),Y", low); break;
+            case AddressingModes::Relative: {
+                const Address target = record.programCounter + 2 + static_cast<int8_t>(low);
+                std::snprintf(output, size, "$%04X", static_cast<unsigned>(target));
+                break;
+            }
+        }
+    }
+}
+
+TraceRecorder::TraceRecorder(const size_t capacity)
+{
+    size_t roundedCapacity = 1;
+    while (roundedCapacity < capacity) {
+        roundedCapacity <<= 1;
+    }
+    Records.assign(roundedCapacity, TraceRecord{});
+    IndexMask = roundedCapacity - 1;
+}
+
+size_t
+TraceRecorder::GetCount() const
+{
+    return RecordCount < Records.size() ? static_cast<size_t>(RecordCount) : Records.size();
+}
+
+const TraceRecord&
+TraceRecorder::GetRecord(const size_t index) const
+{
+    const uint64_t oldest = RecordCount - GetCount();
+    return Records[(oldest + index) & IndexMask];
+}
+
+bool
+TraceRecorder::SaveBinary(const char* path) const
+{
+    FILE* file = std::fopen(path, "wb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    const TraceFileHeader header = { TRACE_FILE_MAGIC, sizeof(TraceRecord), GetCount() };
+    bool isWritten = std::fwrite(&header, sizeof(header), 1, file) == 1;
+    for (size_t index = 0; index < header.count && isWritten; ++index) {
+        isWritten = std::fwrite(&GetRecord(index), sizeof(TraceRecord), 1, file) == 1;
+    }
+    return std::fclose(file) == 0 && isWritten;
+}
+
+bool
+TraceRecorder::LoadBinary(const char* path)
+{
+    FILE* file = std::fopen(path, "rb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    TraceFileHeader header;
+    bool isRead = std::fread(&header, sizeof(header), 1, file) == 1
+        && header.magic == TRACE_FILE_MAGIC && header.recordSize == sizeof(TraceRecord);
+    if (isRead) {
+        // Keeps the newest records if the file holds more than the ring
+        const size_t count = header.count < Records.size() ? static_cast<size_t>(header.count) : Records.size();
+        std::fseek(file, static_cast<long>((header.count - count) * sizeof(TraceRecord)), SEEK_CUR);
+        Clear();
+        for (size_t index = 0; index < count && isRead; ++index) {
+            isRead = std::fread(&Records[index], sizeof(TraceRecord), 1, file) == 1;
+            RecordCount += isRead ? 1 : 0;
+        }
+    }
+    std::fclose(file);
+    return isRead;
+}
+
+bool
+TraceRecorder::WriteNestestLog(const char* path) const
+{
+    FILE* file = std::fopen(path, "w");
+    if (file == nullptr) {
+        return false;
+    }
+
+    char line[NESTEST_LINE_SIZE];
+    bool isWritten = true;
+    for (size_t index = 0; index < GetCount() && isWritten; ++index) {
+        const size_t length = FormatNestestLine(GetRecord(index), line);
+        line[length] = '\n';
+        isWritten = std::fwrite(line, 1, length + 1, file) == length + 1;
+    }
+    return std::fclose(file) == 0 && isWritten;
+}
+
+size_t
+TraceRecorder::FormatNestestLine(const TraceRecord& record, char* output)
+{
+    // Matches nestest.log column for column, except that the "= xx" memory values
+    // are left out: reading them back at record time would touch I/O registers.
+    // The PPU position assumes no odd-frame skips, as in nestest itself.
+    const Instruction& instruction = OPCODE_TABLE[record.opcode];
+    const uint8_t length = 1 + GetOperandLength(instruction.addressingMode);
+
+    char bytes[12];
+    if (length == 1) {
+        std::snprintf(bytes, sizeof(bytes), "%02X", record.opcode);
+    } else if (length == 2) {
+        std::snprintf(bytes, sizeof(bytes), "%02X %02X", record.opcode, record.operand & 0x00FF);
+    } else {
+        std::snprintf(bytes, sizeof(bytes), "%02X %02X %02X", record.opcode, record.operand & 0x00FF, record.operand >> 8);
+    }
+
+    char operand[16];
+    FormatOperand(record, instruction.addressingMode, operand, sizeof(operand));
+    char disassembly[40];
+    std::snprintf(disassembly, sizeof(disassembly), "%s %s", MNEMONICS[instruction.operation], operand);
+
+    const uint64_t dot = record.cycle * PPU_DOTS_PER_CPU_CYCLE;
+    const unsigned scanline = static_cast<unsigned>((dot / PPU_DOTS_PER_SCANLINE) % PPU_SCANLINES_PER_FRAME);
+    const int written = std::snprintf(output, NESTEST_LINE_SIZE,
+        "%04X  %-8s %c%-31s A:%02X X:%02X Y:%02X P:%02X SP:%02X PPU:%3u,%3u CYC:%llu",
+        record.programCounter, bytes, instruction.isLegal ? ' ' : '*', disassembly,
+        record.accumulator, record.x, record.y, record.statusRegister, record.stackPointer,
+        scanline, static_cast<unsigned>(dot % PPU_DOTS_PER_SCANLINE), static_cast<unsigned long long>(record.cycle));
+    return written < 0 ? 0 : std::min<size_t>(static_cast<size_t>(written), NESTEST_LINE_SIZE - 1);
+}